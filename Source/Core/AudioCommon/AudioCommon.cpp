@@ -3,8 +3,12 @@
 // Refer to the license.txt file included.
 
 #include "AudioCommon/AudioCommon.h"
+
+#include <algorithm>
+
 #include "AudioCommon/AlsaSoundStream.h"
 #include "AudioCommon/CubebStream.h"
+#include "AudioCommon/FlacFile.h"
 #include "AudioCommon/Mixer.h"
 #include "AudioCommon/NullSoundStream.h"
 #include "AudioCommon/OpenALStream.h"
@@ -46,6 +50,25 @@ static std::unique_ptr<SoundStream> CreateSoundStreamForBackend(std::string_view
   return {};
 }
 
+static void ConfigureLatencyController(std::string_view backend)
+{
+  Mixer* mixer = g_sound_stream->GetMixer();
+  if (!mixer)
+    return;
+
+  // Keeping less buffered than the backend's own latency can't prevent underruns, and the
+  // stretcher never keeps more than its maximum latency buffered. Each session starts from the
+  // fixed latency that is used when adaptive latency is disabled.
+  const SConfig& config = SConfig::GetInstance();
+  double min_latency_ms = LatencyController::DEFAULT_MIN_LATENCY_MS;
+  if (SupportsLatencyControl(backend))
+    min_latency_ms = std::max<double>(min_latency_ms, config.iLatency);
+
+  LatencyController& controller = mixer->GetLatencyController();
+  controller.SetLimits(min_latency_ms, config.m_audio_stretch_max_latency);
+  controller.Reset(config.iTimingVariance);
+}
+
 void InitSoundStream()
 {
   std::string backend = SConfig::GetInstance().sBackend;
@@ -63,10 +86,12 @@ void InitSoundStream()
   {
     WARN_LOG(AUDIO, "Could not initialize backend %s, using %s instead.", backend.c_str(),
              BACKEND_NULLSOUND);
+    backend = BACKEND_NULLSOUND;
     g_sound_stream = std::make_unique<NullSound>();
     g_sound_stream->Init();
   }
 
+  ConfigureLatencyController(backend);
   UpdateSoundStream();
   SetSoundStreamRunning(true);
 
@@ -193,14 +218,24 @@ void SendAIBuffer(const short* samples, unsigned int num_samples)
   g_sound_stream->Update();
 }
 
+LatencyController::Stats GetLatencyStats()
+{
+  if (!g_sound_stream)
+    return {};
+
+  return g_sound_stream->GetMixer()->GetLatencyController().GetStats();
+}
+
 void StartAudioDump()
 {
-  std::string audio_file_name_dtk = File::GetUserPath(D_DUMPAUDIO_IDX) + "dtkdump.wav";
-  std::string audio_file_name_dsp = File::GetUserPath(D_DUMPAUDIO_IDX) + "dspdump.wav";
+  const bool compress = SConfig::GetInstance().m_DumpAudioFLAC && FlacFileWriter::IsSupported();
+  const std::string extension = compress ? ".flac" : ".wav";
+  std::string audio_file_name_dtk = File::GetUserPath(D_DUMPAUDIO_IDX) + "dtkdump" + extension;
+  std::string audio_file_name_dsp = File::GetUserPath(D_DUMPAUDIO_IDX) + "dspdump" + extension;
   File::CreateFullPath(audio_file_name_dtk);
   File::CreateFullPath(audio_file_name_dsp);
-  g_sound_stream->GetMixer()->StartLogDTKAudio(audio_file_name_dtk);
-  g_sound_stream->GetMixer()->StartLogDSPAudio(audio_file_name_dsp);
+  g_sound_stream->GetMixer()->StartLogDTKAudio(audio_file_name_dtk, compress);
+  g_sound_stream->GetMixer()->StartLogDSPAudio(audio_file_name_dsp, compress);
   s_audio_dump_start = true;
 }
 
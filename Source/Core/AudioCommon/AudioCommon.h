@@ -27,6 +27,7 @@ bool SupportsVolumeChanges(std::string_view backend);
 void UpdateSoundStream();
 void SetSoundStreamRunning(bool running);
 void SendAIBuffer(const short* samples, unsigned int num_samples);
+LatencyController::Stats GetLatencyStats();
 void StartAudioDump();
 void StopAudioDump();
 void IncreaseVolume(unsigned short offset);
@@ -15,14 +15,17 @@ class AudioStretcher
 public:
   explicit AudioStretcher(unsigned int sample_rate);
   void ProcessSamples(const short* in, unsigned int num_in, unsigned int num_out);
-  void GetStretchedSamples(short* out, unsigned int num_out);
+  // Returns how many of the samples came from the backlog, the rest is padding.
+  unsigned int GetStretchedSamples(short* out, unsigned int num_out);
   void Clear();
+  void SetMaxLatency(double max_latency_ms) { m_max_latency = max_latency_ms; }
 
 private:
   unsigned int m_sample_rate;
   std::array<short, 2> m_last_stretched_sample = {};
   soundtouch::SoundTouch m_sound_touch;
   double m_stretch_ratio = 1.0;
+  double m_max_latency = 80.0;
 };
 
 }  // namespace AudioCommon
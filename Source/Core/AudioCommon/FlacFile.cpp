@@ -0,0 +1,405 @@
+// Copyright 2019 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#if defined(__FreeBSD__)
+#define __STDC_CONSTANT_MACROS 1
+#endif
+
+#include "AudioCommon/FlacFile.h"
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+
+#if defined(HAVE_FFMPEG)
+extern "C" {
+#include <libavcodec/avcodec.h>
+#include <libavformat/avformat.h>
+#include <libavutil/channel_layout.h>
+}
+#endif
+
+#include "Common/CommonTypes.h"
+#include "Common/FileUtil.h"
+#include "Common/Logging/Log.h"
+#include "Common/MsgHandler.h"
+#include "Common/StringUtil.h"
+#include "Common/Swap.h"
+#include "Common/Thread.h"
+#include "Core/ConfigManager.h"
+
+struct FlacFileWriter::Encoder
+{
+#if defined(HAVE_FFMPEG)
+  AVFormatContext* format_context = nullptr;
+  AVCodecContext* codec_context = nullptr;
+  AVStream* stream = nullptr;
+  AVFrame* frame = nullptr;
+  AVPacket* packet = nullptr;
+  bool header_written = false;
+  // Number of samples (per channel) in frame which haven't been encoded yet.
+  int frame_fill = 0;
+  s64 next_pts = 0;
+#endif
+};
+
+#if defined(HAVE_FFMPEG)
+static void InitAVFormat()
+{
+  static const bool initialized = [] {
+#if LIBAVCODEC_VERSION_MICRO >= 100 && LIBAVCODEC_VERSION_INT < AV_VERSION_INT(58, 9, 100)
+    av_register_all();
+#endif
+    return true;
+  }();
+  (void)initialized;
+}
+
+// Sends a frame (or nullptr to flush the encoder) and writes all resulting packets.
+static bool SendFrame(AVFormatContext* format_context, AVCodecContext* codec_context,
+                      AVStream* stream, AVPacket* packet, AVFrame* frame)
+{
+  int error = avcodec_send_frame(codec_context, frame);
+  while (error >= 0)
+  {
+    error = avcodec_receive_packet(codec_context, packet);
+    if (error == AVERROR(EAGAIN) || error == AVERROR_EOF)
+      return true;
+    if (error < 0)
+      break;
+
+    av_packet_rescale_ts(packet, codec_context->time_base, stream->time_base);
+    packet->stream_index = stream->index;
+    error = av_interleaved_write_frame(format_context, packet);
+  }
+
+  ERROR_LOG(AUDIO, "Error while encoding FLAC audio: %d", error);
+  return false;
+}
+#endif
+
+FlacFileWriter::FlacFileWriter() = default;
+
+FlacFileWriter::~FlacFileWriter()
+{
+  Stop();
+}
+
+bool FlacFileWriter::IsSupported()
+{
+#if defined(HAVE_FFMPEG)
+  return true;
+#else
+  return false;
+#endif
+}
+
+bool FlacFileWriter::Start(const std::string& filename, unsigned int sample_rate)
+{
+  if (m_running)
+  {
+    PanicAlertT("The file %s was already open, the file header will not be written.",
+                filename.c_str());
+    return false;
+  }
+
+  // Ask to delete file
+  if (File::Exists(filename))
+  {
+    if (SConfig::GetInstance().m_DumpAudioSilent ||
+        AskYesNoT("Delete the existing file '%s'?", filename.c_str()))
+    {
+      File::Delete(filename);
+    }
+    else
+    {
+      // Stop and cancel dumping the audio
+      return false;
+    }
+  }
+
+  if (m_basename.empty())
+    SplitPath(filename, nullptr, &m_basename, nullptr);
+
+  if (!OpenFile(filename, sample_rate))
+  {
+    CloseFile();
+    PanicAlertT("The file %s could not be opened for writing. Please check if it's already opened "
+                "by another program.",
+                filename.c_str());
+    return false;
+  }
+
+  m_dropped_samples = 0;
+  m_dropping = false;
+  m_stop_requested = false;
+  m_running = true;
+  m_thread = std::thread(&FlacFileWriter::WorkerLoop, this);
+  return true;
+}
+
+void FlacFileWriter::Stop()
+{
+  {
+    std::lock_guard lk(m_lock);
+    if (!m_running)
+      return;
+    m_stop_requested = true;
+  }
+  m_cv.notify_one();
+  m_thread.join();
+
+  std::lock_guard lk(m_lock);
+  m_running = false;
+  if (m_dropped_samples != 0)
+  {
+    WARN_LOG(AUDIO, "%llu samples were dropped from the FLAC dump",
+             static_cast<unsigned long long>(m_dropped_samples));
+  }
+}
+
+void FlacFileWriter::AddStereoSamplesBE(const short* sample_data, u32 count, int sample_rate)
+{
+  std::vector<s16> buffer;
+  {
+    std::lock_guard lk(m_lock);
+    if (!m_running || m_stop_requested)
+      return;
+
+    if (m_queued_samples + count > MAX_QUEUED_SAMPLES)
+    {
+      if (!m_dropping)
+        WARN_LOG(AUDIO, "FLAC encoding can't keep up, dropping samples from the dump");
+      m_dropping = true;
+      m_dropped_samples += count;
+      return;
+    }
+    m_dropping = false;
+    m_queued_samples += count;
+
+    if (!m_free_buffers.empty())
+    {
+      buffer = std::move(m_free_buffers.back());
+      m_free_buffers.pop_back();
+    }
+  }
+
+  buffer.resize(count * 2);
+  for (u32 i = 0; i < count; i++)
+  {
+    // Flip the audio channels from RL to LR
+    buffer[2 * i] = Common::swap16(static_cast<u16>(sample_data[2 * i + 1]));
+    buffer[2 * i + 1] = Common::swap16(static_cast<u16>(sample_data[2 * i]));
+  }
+
+  {
+    std::lock_guard lk(m_lock);
+    m_queue.push_back({std::move(buffer), sample_rate});
+  }
+  m_cv.notify_one();
+}
+
+u64 FlacFileWriter::GetDroppedSamples() const
+{
+  std::lock_guard lk(m_lock);
+  return m_dropped_samples;
+}
+
+void FlacFileWriter::WorkerLoop()
+{
+  Common::SetCurrentThreadName("FLAC audio dump");
+
+  std::unique_lock lk(m_lock);
+  while (true)
+  {
+    m_cv.wait(lk, [this] { return !m_queue.empty() || m_stop_requested; });
+    // Everything that was queued before stopping still gets written.
+    if (m_queue.empty())
+      break;
+
+    Block block = std::move(m_queue.front());
+    m_queue.pop_front();
+    lk.unlock();
+
+    const size_t count = block.samples.size() / 2;
+    if (block.sample_rate != m_current_sample_rate)
+    {
+      CloseFile();
+      m_file_index++;
+      const std::string filename = File::GetUserPath(D_DUMPAUDIO_IDX) + m_basename +
+                                   std::to_string(m_file_index) + ".flac";
+      File::Delete(filename);
+      OpenFile(filename, block.sample_rate);
+    }
+    if (m_encoder)
+      EncodeSamples(block.samples.data(), count);
+
+    lk.lock();
+    m_queued_samples -= count;
+    m_free_buffers.push_back(std::move(block.samples));
+  }
+  lk.unlock();
+
+  CloseFile();
+}
+
+bool FlacFileWriter::OpenFile(const std::string& filename, int sample_rate)
+{
+  m_current_sample_rate = sample_rate;
+
+#if defined(HAVE_FFMPEG)
+  InitAVFormat();
+  m_encoder = std::make_unique<Encoder>();
+  Encoder& encoder = *m_encoder;
+
+  const AVCodec* codec = avcodec_find_encoder(AV_CODEC_ID_FLAC);
+  if (!codec || avformat_alloc_output_context2(&encoder.format_context, nullptr, "flac",
+                                               filename.c_str()) < 0)
+  {
+    ERROR_LOG(AUDIO, "Could not find FLAC encoder or allocate output context");
+    CloseFile();
+    return false;
+  }
+
+  encoder.codec_context = avcodec_alloc_context3(codec);
+  if (!encoder.codec_context)
+  {
+    ERROR_LOG(AUDIO, "Could not allocate codec context");
+    CloseFile();
+    return false;
+  }
+
+  AVCodecContext* codec_context = encoder.codec_context;
+  codec_context->sample_fmt = AV_SAMPLE_FMT_S16;
+  codec_context->sample_rate = sample_rate;
+  codec_context->time_base.num = 1;
+  codec_context->time_base.den = sample_rate;
+#if LIBAVUTIL_VERSION_INT >= AV_VERSION_INT(57, 28, 100)
+  av_channel_layout_default(&codec_context->ch_layout, 2);
+#else
+  codec_context->channels = 2;
+  codec_context->channel_layout = AV_CH_LAYOUT_STEREO;
+#endif
+  if (encoder.format_context->oformat->flags & AVFMT_GLOBALHEADER)
+    codec_context->flags |= AV_CODEC_FLAG_GLOBAL_HEADER;
+
+  if (avcodec_open2(codec_context, codec, nullptr) < 0)
+  {
+    ERROR_LOG(AUDIO, "Could not open FLAC encoder");
+    CloseFile();
+    return false;
+  }
+
+  encoder.frame = av_frame_alloc();
+  encoder.packet = av_packet_alloc();
+  if (!encoder.frame || !encoder.packet)
+  {
+    CloseFile();
+    return false;
+  }
+  encoder.frame->format = codec_context->sample_fmt;
+  encoder.frame->sample_rate = sample_rate;
+  encoder.frame->nb_samples = codec_context->frame_size != 0 ? codec_context->frame_size : 4608;
+#if LIBAVUTIL_VERSION_INT >= AV_VERSION_INT(57, 28, 100)
+  av_channel_layout_copy(&encoder.frame->ch_layout, &codec_context->ch_layout);
+#else
+  encoder.frame->channels = 2;
+  encoder.frame->channel_layout = AV_CH_LAYOUT_STEREO;
+#endif
+  if (av_frame_get_buffer(encoder.frame, 0) < 0)
+  {
+    CloseFile();
+    return false;
+  }
+
+  encoder.stream = avformat_new_stream(encoder.format_context, nullptr);
+  if (!encoder.stream ||
+      avcodec_parameters_from_context(encoder.stream->codecpar, codec_context) < 0)
+  {
+    ERROR_LOG(AUDIO, "Could not create stream");
+    CloseFile();
+    return false;
+  }
+  encoder.stream->time_base = codec_context->time_base;
+
+  if (avio_open(&encoder.format_context->pb, filename.c_str(), AVIO_FLAG_WRITE) < 0 ||
+      avformat_write_header(encoder.format_context, nullptr) < 0)
+  {
+    ERROR_LOG(AUDIO, "Could not open %s", filename.c_str());
+    CloseFile();
+    return false;
+  }
+  encoder.header_written = true;
+
+  NOTICE_LOG(AUDIO, "Dumping FLAC audio to %s (%d Hz)", filename.c_str(), sample_rate);
+  return true;
+#else
+  ERROR_LOG(AUDIO, "FLAC dumping requires FFmpeg");
+  return false;
+#endif
+}
+
+void FlacFileWriter::CloseFile()
+{
+  if (!m_encoder)
+    return;
+
+#if defined(HAVE_FFMPEG)
+  Encoder& encoder = *m_encoder;
+  if (encoder.header_written)
+  {
+    if (encoder.frame_fill != 0)
+    {
+      // The last frame is allowed to be shorter.
+      encoder.frame->nb_samples = encoder.frame_fill;
+      encoder.frame->pts = encoder.next_pts;
+      SendFrame(encoder.format_context, encoder.codec_context, encoder.stream, encoder.packet,
+                encoder.frame);
+    }
+    SendFrame(encoder.format_context, encoder.codec_context, encoder.stream, encoder.packet,
+              nullptr);
+    av_write_trailer(encoder.format_context);
+  }
+
+  if (encoder.format_context && encoder.format_context->pb)
+    avio_closep(&encoder.format_context->pb);
+  avformat_free_context(encoder.format_context);
+  avcodec_free_context(&encoder.codec_context);
+  av_frame_free(&encoder.frame);
+  av_packet_free(&encoder.packet);
+#endif
+
+  m_encoder.reset();
+}
+
+void FlacFileWriter::EncodeSamples(const s16* samples, size_t count)
+{
+#if defined(HAVE_FFMPEG)
+  Encoder& encoder = *m_encoder;
+  AVFrame* frame = encoder.frame;
+  while (count != 0)
+  {
+    // The encoder may still hold a reference to the previous frame's buffer.
+    if (encoder.frame_fill == 0 && av_frame_make_writable(frame) < 0)
+      return;
+
+    const size_t frame_count =
+        std::min<size_t>(count, static_cast<size_t>(frame->nb_samples - encoder.frame_fill));
+    std::memcpy(frame->data[0] + encoder.frame_fill * 2 * sizeof(s16), samples,
+                frame_count * 2 * sizeof(s16));
+    encoder.frame_fill += static_cast<int>(frame_count);
+    samples += frame_count * 2;
+    count -= frame_count;
+
+    if (encoder.frame_fill == frame->nb_samples)
+    {
+      frame->pts = encoder.next_pts;
+      encoder.next_pts += frame->nb_samples;
+      encoder.frame_fill = 0;
+      SendFrame(encoder.format_context, encoder.codec_context, encoder.stream, encoder.packet,
+                frame);
+    }
+  }
+#endif
+}
@@ -0,0 +1,78 @@
+// Copyright 2019 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+// ---------------------------------------------------------------------------------
+// Class: FlacFileWriter
+// Description: Counterpart of WaveFileWriter which compresses the dump to FLAC using
+// libavcodec. Encoding and disk writes happen on a separate thread, and samples are
+// handed over through a bounded queue: if the encoder can't keep up, samples are
+// dropped rather than stalling emulation.
+// ---------------------------------------------------------------------------------
+
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Common/CommonTypes.h"
+
+class FlacFileWriter
+{
+public:
+  FlacFileWriter();
+  ~FlacFileWriter();
+
+  FlacFileWriter(const FlacFileWriter&) = delete;
+  FlacFileWriter& operator=(const FlacFileWriter&) = delete;
+  FlacFileWriter(FlacFileWriter&&) = delete;
+  FlacFileWriter& operator=(FlacFileWriter&&) = delete;
+
+  // False if Dolphin was built without FFmpeg.
+  static bool IsSupported();
+
+  bool Start(const std::string& filename, unsigned int sample_rate);
+  // Waits for all queued samples to be written.
+  void Stop();
+
+  void AddStereoSamplesBE(const short* sample_data, u32 count, int sample_rate);  // big endian
+  u64 GetDroppedSamples() const;
+
+private:
+  // About 4 seconds of 48 kHz audio.
+  static constexpr size_t MAX_QUEUED_SAMPLES = 192 * 1024;
+
+  struct Block
+  {
+    std::vector<s16> samples;  // Interleaved, native endian, left channel first
+    int sample_rate;
+  };
+  struct Encoder;
+
+  void WorkerLoop();
+  bool OpenFile(const std::string& filename, int sample_rate);
+  void CloseFile();
+  void EncodeSamples(const s16* samples, size_t count);
+
+  // Only used by the thread which currently owns the file.
+  std::unique_ptr<Encoder> m_encoder;
+  std::string m_basename;
+  int m_current_sample_rate = 0;
+  int m_file_index = 0;
+
+  std::thread m_thread;
+  mutable std::mutex m_lock;
+  std::condition_variable m_cv;
+  std::deque<Block> m_queue;
+  std::vector<std::vector<s16>> m_free_buffers;
+  size_t m_queued_samples = 0;
+  u64 m_dropped_samples = 0;
+  bool m_dropping = false;
+  bool m_running = false;
+  bool m_stop_requested = false;
+};
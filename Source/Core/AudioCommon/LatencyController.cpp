@@ -0,0 +1,144 @@
+// Copyright 2019 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include "AudioCommon/LatencyController.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "Common/Logging/Log.h"
+#include "Common/Timer.h"
+
+namespace AudioCommon
+{
+namespace
+{
+// Weight of a new measurement in the running averages of the callback period and jitter.
+constexpr double SMOOTHING = 1.0 / 16.0;
+// Gaps longer than this are a stream that was stopped and restarted, not jitter.
+constexpr u64 MAX_CALLBACK_INTERVAL_US = 500000;
+// How much the target grows on an underrun, at least.
+constexpr double GROW_STEP_MS = 5.0;
+// How long playback has to be free of underruns before the target starts shrinking, and how fast
+// it then shrinks (in ms of latency per second).
+constexpr u64 SHRINK_HOLD_US = 2000000;
+constexpr double SHRINK_RATE = 1.0;
+// The target never goes below this many callback periods, plus this many times the jitter.
+constexpr double PERIOD_MARGIN = 2.0;
+constexpr double JITTER_MARGIN = 4.0;
+constexpr u64 LOG_INTERVAL_US = 10000000;
+}  // namespace
+
+LatencyController::LatencyController(unsigned int sample_rate)
+    : m_sample_rate(sample_rate), m_clock(Common::Timer::GetTimeUs)
+{
+}
+
+void LatencyController::SetClock(Clock clock)
+{
+  std::lock_guard lk(m_lock);
+  m_clock = std::move(clock);
+}
+
+void LatencyController::SetLimits(double min_latency_ms, double max_latency_ms)
+{
+  std::lock_guard lk(m_lock);
+  m_min_latency_ms = min_latency_ms;
+  m_max_latency_ms = std::max(min_latency_ms, max_latency_ms);
+  m_target_latency_ms = std::clamp(m_target_latency_ms, m_min_latency_ms, m_max_latency_ms);
+}
+
+void LatencyController::Reset(double initial_latency_ms)
+{
+  std::lock_guard lk(m_lock);
+  m_target_latency_ms = std::clamp(initial_latency_ms, m_min_latency_ms, m_max_latency_ms);
+  m_jitter_us = 0.0;
+  m_average_period_us = 0.0;
+  m_last_callback_time = 0;
+  m_last_underrun_time = 0;
+  m_last_log_time = 0;
+  m_callbacks = 0;
+  m_underruns = 0;
+  m_starved = true;
+}
+
+void LatencyController::OnCallback(unsigned int requested, unsigned int delivered)
+{
+  std::lock_guard lk(m_lock);
+
+  const u64 now = m_clock();
+  const double period_us = 1000000.0 * requested / m_sample_rate;
+  if (m_last_callback_time != 0 && now - m_last_callback_time <= MAX_CALLBACK_INTERVAL_US)
+  {
+    const double interval_us = static_cast<double>(now - m_last_callback_time);
+    if (m_average_period_us == 0.0)
+      m_average_period_us = interval_us;
+    m_average_period_us += SMOOTHING * (interval_us - m_average_period_us);
+    m_jitter_us += SMOOTHING * (std::abs(interval_us - period_us) - m_jitter_us);
+  }
+
+  // Only the first callback of a dropout counts. If emulation stops producing audio altogether
+  // (e.g. while paused), adding more buffering wouldn't help.
+  const bool starved = delivered < requested;
+  const bool underrun = starved && !m_starved;
+  m_starved = starved;
+
+  ++m_callbacks;
+  if (underrun)
+    ++m_underruns;
+
+  UpdateTarget(now, period_us, underrun);
+  m_last_callback_time = now;
+
+  if (now - m_last_log_time >= LOG_INTERVAL_US)
+  {
+    INFO_LOG(AUDIO, "Audio latency: target %.1f ms, jitter %.2f ms, period %.2f ms, %llu underruns",
+             m_target_latency_ms, m_jitter_us / 1000.0, m_average_period_us / 1000.0,
+             static_cast<unsigned long long>(m_underruns));
+    m_last_log_time = now;
+  }
+}
+
+void LatencyController::UpdateTarget(u64 now, double period_us, bool underrun)
+{
+  const double floor_ms = std::max(
+      m_min_latency_ms, (PERIOD_MARGIN * period_us + JITTER_MARGIN * m_jitter_us) / 1000.0);
+
+  if (underrun)
+  {
+    m_target_latency_ms += std::max(GROW_STEP_MS, period_us / 1000.0);
+    m_last_underrun_time = now;
+  }
+  else if (m_last_callback_time != 0 && now - m_last_underrun_time >= SHRINK_HOLD_US &&
+           m_target_latency_ms > floor_ms)
+  {
+    const double elapsed_s =
+        std::min(now - m_last_callback_time, MAX_CALLBACK_INTERVAL_US) / 1000000.0;
+    m_target_latency_ms = std::max(floor_ms, m_target_latency_ms - SHRINK_RATE * elapsed_s);
+  }
+
+  // Jitter has to be covered right away, not only after the next underrun.
+  m_target_latency_ms = std::clamp(std::max(m_target_latency_ms, floor_ms), m_min_latency_ms,
+                                   m_max_latency_ms);
+}
+
+double LatencyController::GetTargetLatency() const
+{
+  std::lock_guard lk(m_lock);
+  return m_target_latency_ms;
+}
+
+LatencyController::Stats LatencyController::GetStats() const
+{
+  std::lock_guard lk(m_lock);
+  Stats stats;
+  stats.target_latency_ms = m_target_latency_ms;
+  stats.jitter_ms = m_jitter_us / 1000.0;
+  stats.average_period_ms = m_average_period_us / 1000.0;
+  stats.callbacks = m_callbacks;
+  stats.underruns = m_underruns;
+  return stats;
+}
+
+}  // namespace AudioCommon
@@ -0,0 +1,67 @@
+// Copyright 2019 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <functional>
+#include <mutex>
+
+#include "Common/CommonTypes.h"
+
+namespace AudioCommon
+{
+// Watches the timing of the backend's requests for samples, and derives how much audio the mixer
+// should keep buffered. The target grows when the backend runs dry, and slowly shrinks back
+// towards what the measured callback jitter requires once playback has been stable for a while.
+class LatencyController
+{
+public:
+  struct Stats
+  {
+    double target_latency_ms = 0.0;
+    double jitter_ms = 0.0;
+    double average_period_ms = 0.0;
+    u64 callbacks = 0;
+    u64 underruns = 0;
+  };
+
+  // Returns the current time in microseconds.
+  using Clock = std::function<u64()>;
+
+  static constexpr double DEFAULT_MIN_LATENCY_MS = 5.0;
+
+  explicit LatencyController(unsigned int sample_rate);
+
+  void SetClock(Clock clock);
+  void SetLimits(double min_latency_ms, double max_latency_ms);
+  void Reset(double initial_latency_ms);
+
+  // Called from the audio thread every time the backend asks for <requested> frames, of which
+  // <delivered> could be filled from emulated audio.
+  void OnCallback(unsigned int requested, unsigned int delivered);
+
+  double GetTargetLatency() const;
+  Stats GetStats() const;
+
+private:
+  void UpdateTarget(u64 now, double period_us, bool underrun);
+
+  const unsigned int m_sample_rate;
+  Clock m_clock;
+
+  mutable std::mutex m_lock;
+  double m_min_latency_ms = DEFAULT_MIN_LATENCY_MS;
+  double m_max_latency_ms = 100.0;
+  double m_target_latency_ms = 40.0;
+  double m_jitter_us = 0.0;
+  double m_average_period_us = 0.0;
+  u64 m_last_callback_time = 0;
+  u64 m_last_underrun_time = 0;
+  u64 m_last_log_time = 0;
+  u64 m_callbacks = 0;
+  u64 m_underruns = 0;
+  bool m_starved = true;
+};
+
+}  // namespace AudioCommon
@@ -7,15 +7,27 @@
 #include <algorithm>
 #include <cmath>
 #include <cstring>
+#include <limits>
 
+#include "AudioCommon/Resampler.h"
 #include "Common/ChunkFile.h"
 #include "Common/CommonTypes.h"
+#include "Common/Intrinsics.h"
 #include "Common/Logging/Log.h"
 #include "Common/Swap.h"
 #include "Core/ConfigManager.h"
 
+#ifdef _M_ARM_64
+#include <arm_neon.h>
+#endif
+
+using AudioCommon::ApplyResamplerTaps;
+using AudioCommon::RESAMPLER_PHASE_BITS;
+using AudioCommon::RESAMPLER_TAPS;
+
 Mixer::Mixer(unsigned int BackendSampleRate)
     : m_sampleRate(BackendSampleRate), m_stretcher(BackendSampleRate),
+      m_latency_controller(BackendSampleRate),
       m_surround_decoder(BackendSampleRate, SURROUND_BLOCK_SIZE)
 {
   INFO_LOG(AUDIO_INTERFACE, "Mixer is initialized");
@@ -32,33 +44,37 @@ void Mixer::DoState(PointerWrap& p)
   m_wiimote_speaker_mixer.DoState(p);
 }
 
-// Executed from sound stream thread
-unsigned int Mixer::MixerFifo::Mix(short* samples, unsigned int numSamples,
-                                   bool consider_framelimit)
+namespace
 {
-  unsigned int currentSample = 0;
-
-  // Cache access in non-volatile variable
-  // This is the only function changing the read value, so it's safe to
-  // cache it locally although it's written here.
-  // The writing pointer will be modified outside, but it will only increase,
-  // so we will just ignore new written data while interpolating.
-  // Without this cache, the compiler wouldn't be allowed to optimize the
-  // interpolation loop.
-  u32 indexR = m_indexR.load();
-  u32 indexW = m_indexW.load();
-
-  // render numleft sample pairs to samples[]
-  // advance indexR with sample position
-  // remember fractional offset
+// Converts big endian samples to native endian.
+void SwapSamples(s16* dst, const s16* src, size_t count)
+{
+  size_t i = 0;
+#if defined(_M_X86)
+  for (; i + 8 <= count; i += 8)
+  {
+    const __m128i value = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i),
+                     _mm_or_si128(_mm_slli_epi16(value, 8), _mm_srli_epi16(value, 8)));
+  }
+#elif defined(_M_ARM_64)
+  for (; i + 8 <= count; i += 8)
+    vst1q_s16(dst + i, vreinterpretq_s16_u8(vrev16q_u8(vreinterpretq_u8_s16(vld1q_s16(src + i)))));
+#endif
+  for (; i < count; ++i)
+    dst[i] = Common::swap16(src[i]);
+}
+}  // namespace
 
+u32 Mixer::MixerFifo::GetResampleRatio(u32 available_frames, bool consider_framelimit)
+{
   float emulationspeed = SConfig::GetInstance().m_EmulationSpeed;
   float aid_sample_rate = static_cast<float>(m_input_sample_rate);
   if (consider_framelimit && emulationspeed > 0.0f)
   {
-    float numLeft = static_cast<float>(((indexW - indexR) & INDEX_MASK) / 2);
+    float numLeft = static_cast<float>(available_frames);
 
-    u32 low_waterwark = m_input_sample_rate * SConfig::GetInstance().iTimingVariance / 1000;
+    u32 low_waterwark = m_input_sample_rate * m_mixer->m_target_latency_ms / 1000;
     low_waterwark = std::min(low_waterwark, MAX_SAMPLES / 2);
 
     m_numLeftI = (numLeft + m_numLeftI * (CONTROL_AVG - 1)) / CONTROL_AVG;
@@ -71,57 +87,83 @@ unsigned int Mixer::MixerFifo::Mix(short* samples, unsigned int numSamples,
     aid_sample_rate = (aid_sample_rate + offset) * emulationspeed;
   }
 
-  const u32 ratio = (u32)(65536.0f * aid_sample_rate / (float)m_mixer->m_sampleRate);
-
-  s32 lvolume = m_LVolume.load();
-  s32 rvolume = m_RVolume.load();
+  return (u32)(65536.0f * aid_sample_rate / (float)m_mixer->m_sampleRate);
+}
 
-  // TODO: consider a higher-quality resampling algorithm.
-  for (; currentSample < numSamples * 2 && ((indexW - indexR) & INDEX_MASK) > 2; currentSample += 2)
+// Executed from sound stream thread
+unsigned int Mixer::MixerFifo::Mix(short* samples, unsigned int numSamples,
+                                   bool consider_framelimit)
+{
+  // This is the only function changing the read index, and the write index only ever increases,
+  // so whatever gets pushed while mixing will simply be picked up by the next call.
+  u32 indexR = m_indexR.load(std::memory_order_relaxed);
+  const u32 indexW = m_indexW.load(std::memory_order_acquire);
+  const u32 available_frames = ((indexW - indexR) & INDEX_MASK) / 2;
+
+  // The rate is adjusted once per call, and applies to the whole block.
+  const u32 ratio = std::max<u32>(GetResampleRatio(available_frames, consider_framelimit), 1);
+
+  const s32 lvolume = m_LVolume.load();
+  const s32 rvolume = m_RVolume.load();
+
+  // Output sample i is at input position m_frac + i * ratio (in 16.16 fixed point) relative to the
+  // window at indexR, and the whole window has to be in the FIFO.
+  unsigned int count = 0;
+  if (available_frames >= RESAMPLER_TAPS)
   {
-    u32 indexR2 = indexR + 2;  // next sample
-
-    s16 l1 = Common::swap16(m_buffer[indexR & INDEX_MASK]);   // current
-    s16 l2 = Common::swap16(m_buffer[indexR2 & INDEX_MASK]);  // next
-    int sampleL = ((l1 << 16) + (l2 - l1) * (u16)m_frac) >> 16;
-    sampleL = (sampleL * lvolume) >> 8;
-    sampleL += samples[currentSample + 1];
-    samples[currentSample + 1] = std::clamp(sampleL, -32767, 32767);
-
-    s16 r1 = Common::swap16(m_buffer[(indexR + 1) & INDEX_MASK]);   // current
-    s16 r2 = Common::swap16(m_buffer[(indexR2 + 1) & INDEX_MASK]);  // next
-    int sampleR = ((r1 << 16) + (r2 - r1) * (u16)m_frac) >> 16;
-    sampleR = (sampleR * rvolume) >> 8;
-    sampleR += samples[currentSample];
-    samples[currentSample] = std::clamp(sampleR, -32767, 32767);
-
-    m_frac += ratio;
-    indexR += 2 * (u16)(m_frac >> 16);
-    m_frac &= 0xffff;
+    const u64 last_position = (static_cast<u64>(available_frames - RESAMPLER_TAPS) << 16) | 0xffff;
+    count = static_cast<unsigned int>(
+        std::min<u64>(numSamples, (last_position - m_frac) / ratio + 1));
   }
 
-  // Actual number of samples written to the buffer without padding.
-  unsigned int actual_sample_count = currentSample / 2;
+  u64 position = m_frac;
+  if (count != 0)
+  {
+    const u32 input_frames =
+        static_cast<u32>((position + static_cast<u64>(count - 1) * ratio) >> 16) + RESAMPLER_TAPS;
+    for (u32 i = 0; i < input_frames; ++i)
+    {
+      m_resampler_input[0][i] = m_buffer[(indexR + i * 2) & INDEX_MASK];
+      m_resampler_input[1][i] = m_buffer[(indexR + i * 2 + 1) & INDEX_MASK];
+    }
+
+    if (!m_resampler_table || m_resampler_table_input_rate != m_input_sample_rate)
+    {
+      m_resampler_table =
+          &AudioCommon::GetResamplerTable(m_input_sample_rate, m_mixer->m_sampleRate);
+      m_resampler_table_input_rate = m_input_sample_rate;
+    }
+    const AudioCommon::ResamplerTable& table = *m_resampler_table;
+    for (unsigned int i = 0; i < count; ++i, position += ratio)
+    {
+      const u32 index = static_cast<u32>(position >> 16);
+      const s16* coefficients =
+          table[(position & 0xffff) >> (16 - RESAMPLER_PHASE_BITS)].coefficients.data();
+      m_last_samples[0] = ApplyResamplerTaps(&m_resampler_input[0][index], coefficients);
+      m_last_samples[1] = ApplyResamplerTaps(&m_resampler_input[1][index], coefficients);
+
+      const int sampleL = ((m_last_samples[0] * lvolume) >> 8) + samples[i * 2 + 1];
+      samples[i * 2 + 1] = std::clamp(sampleL, -32767, 32767);
+      const int sampleR = ((m_last_samples[1] * rvolume) >> 8) + samples[i * 2];
+      samples[i * 2] = std::clamp(sampleR, -32767, 32767);
+    }
+
+    indexR += static_cast<u32>(position >> 16) * 2;
+    m_frac = static_cast<u32>(position & 0xffff);
+  }
 
   // Padding
-  short s[2];
-  s[0] = Common::swap16(m_buffer[(indexR - 1) & INDEX_MASK]);
-  s[1] = Common::swap16(m_buffer[(indexR - 2) & INDEX_MASK]);
-  s[0] = (s[0] * rvolume) >> 8;
-  s[1] = (s[1] * lvolume) >> 8;
-  for (; currentSample < numSamples * 2; currentSample += 2)
+  const int padL = (m_last_samples[0] * lvolume) >> 8;
+  const int padR = (m_last_samples[1] * rvolume) >> 8;
+  for (unsigned int i = count; i < numSamples; ++i)
   {
-    int sampleR = std::clamp(s[0] + samples[currentSample + 0], -32767, 32767);
-    int sampleL = std::clamp(s[1] + samples[currentSample + 1], -32767, 32767);
-
-    samples[currentSample + 0] = sampleR;
-    samples[currentSample + 1] = sampleL;
+    samples[i * 2] = std::clamp(padR + samples[i * 2], -32767, 32767);
+    samples[i * 2 + 1] = std::clamp(padL + samples[i * 2 + 1], -32767, 32767);
   }
 
-  // Flush cached variable
-  m_indexR.store(indexR);
+  m_indexR.store(indexR, std::memory_order_release);
 
-  return actual_sample_count;
+  return count;
 }
 
 unsigned int Mixer::Mix(short* samples, unsigned int num_samples)
@@ -131,7 +173,11 @@ unsigned int Mixer::Mix(short* samples, unsigned int num_samples)
 
   memset(samples, 0, num_samples * 2 * sizeof(short));
 
-  if (SConfig::GetInstance().m_audio_stretch)
+  const SConfig& config = SConfig::GetInstance();
+  const double target_latency_ms = m_latency_controller.GetTargetLatency();
+
+  unsigned int delivered_samples;
+  if (config.m_audio_stretch)
   {
     unsigned int available_samples =
         std::min(m_dma_mixer.AvailableSamples(), m_streaming_mixer.AvailableSamples());
@@ -147,17 +193,28 @@ unsigned int Mixer::Mix(short* samples, unsigned int num_samples)
       m_stretcher.Clear();
       m_is_stretching = true;
     }
+    // The stretcher aims to keep its backlog half full.
+    double max_latency = config.m_audio_stretch_max_latency;
+    if (config.m_audio_adaptive_latency)
+      max_latency = std::min(max_latency, target_latency_ms * 2);
+    m_stretcher.SetMaxLatency(max_latency);
     m_stretcher.ProcessSamples(m_scratch_buffer.data(), available_samples, num_samples);
-    m_stretcher.GetStretchedSamples(samples, num_samples);
+    delivered_samples = m_stretcher.GetStretchedSamples(samples, num_samples);
   }
   else
   {
-    m_dma_mixer.Mix(samples, num_samples, true);
+    m_target_latency_ms = config.m_audio_adaptive_latency ?
+                              static_cast<u32>(std::lround(target_latency_ms)) :
+                              static_cast<u32>(config.iTimingVariance);
+
+    delivered_samples = m_dma_mixer.Mix(samples, num_samples, true);
     m_streaming_mixer.Mix(samples, num_samples, true);
     m_wiimote_speaker_mixer.Mix(samples, num_samples, true);
     m_is_stretching = false;
   }
 
+  m_latency_controller.OnCallback(num_samples, delivered_samples);
+
   return num_samples;
 }
 
@@ -168,6 +225,23 @@ unsigned int Mixer::MixSurround(float* samples, unsigned int num_samples)
 
   memset(samples, 0, num_samples * SURROUND_CHANNELS * sizeof(float));
 
+  // Only use the discrete channels while something is providing them, and fall back to decoding
+  // the stereo mix otherwise.
+  const SConfig& config = SConfig::GetInstance();
+  if (config.m_audio_discrete_surround && !config.m_audio_stretch &&
+      m_surround_front_mixer.AvailableSamples() != 0)
+  {
+    MixDiscreteSurround(samples, num_samples);
+    m_is_mixing_discrete_surround = true;
+    return num_samples;
+  }
+
+  if (m_is_mixing_discrete_surround)
+  {
+    m_surround_decoder.Clear();
+    m_is_mixing_discrete_surround = false;
+  }
+
   size_t needed_frames = m_surround_decoder.QueryFramesNeededForSurroundOutput(num_samples);
 
   // Mix() may also use m_scratch_buffer internally, but is safe because it alternates reads
@@ -185,33 +259,67 @@ unsigned int Mixer::MixSurround(float* samples, unsigned int num_samples)
   return num_samples;
 }
 
+void Mixer::MixDiscreteSurround(float* samples, unsigned int num_samples)
+{
+  const SConfig& config = SConfig::GetInstance();
+  const double target_latency_ms = m_latency_controller.GetTargetLatency();
+  m_target_latency_ms = config.m_audio_adaptive_latency ?
+                            static_cast<u32>(std::lround(target_latency_ms)) :
+                            static_cast<u32>(config.iTimingVariance);
+
+  // The DMA samples are the same audio mixed down to stereo. They still have to be consumed, and
+  // whether they keep up is what decides if the backend got what it asked for.
+  std::fill_n(m_scratch_buffer.begin(), num_samples * 2, 0);
+  const unsigned int delivered_samples =
+      m_dma_mixer.Mix(m_scratch_buffer.data(), num_samples, true);
+
+  auto& front = m_surround_buffers[0];
+  auto& rear = m_surround_buffers[1];
+  std::fill_n(front.begin(), num_samples * 2, 0);
+  std::fill_n(rear.begin(), num_samples * 2, 0);
+  m_surround_front_mixer.Mix(front.data(), num_samples, true);
+  m_streaming_mixer.Mix(front.data(), num_samples, true);
+  m_wiimote_speaker_mixer.Mix(front.data(), num_samples, true);
+  m_surround_rear_mixer.Mix(rear.data(), num_samples, true);
+  m_is_stretching = false;
+
+  m_latency_controller.OnCallback(num_samples, delivered_samples);
+
+  // FL | FR | FC | LFE | BL | BR, like the surround decoder. There is nothing for the centre
+  // speaker and the subwoofer.
+  constexpr float scale = 1.0f / std::numeric_limits<short>::max();
+  for (unsigned int i = 0; i < num_samples; ++i)
+  {
+    float* frame = &samples[i * SURROUND_CHANNELS];
+    frame[0] = front[i * 2] * scale;
+    frame[1] = front[i * 2 + 1] * scale;
+    frame[4] = rear[i * 2] * scale;
+    frame[5] = rear[i * 2 + 1] * scale;
+  }
+}
+
 void Mixer::MixerFifo::PushSamples(const short* samples, unsigned int num_samples)
 {
-  // Cache access in non-volatile variable
-  // indexR isn't allowed to cache in the audio throttling loop as it
-  // needs to get updates to not deadlock.
-  u32 indexW = m_indexW.load();
+  // This is the only function changing the write index. The read index needs to be loaded again
+  // every time, as the audio throttling loop waits for it to change.
+  const u32 indexW = m_indexW.load(std::memory_order_relaxed);
 
   // Check if we have enough free space
   // indexW == m_indexR results in empty buffer, so indexR must always be smaller than indexW
-  if (num_samples * 2 + ((indexW - m_indexR.load()) & INDEX_MASK) >= MAX_SAMPLES * 2)
-    return;
-
-  // AyuanX: Actual re-sampling work has been moved to sound thread
-  // to alleviate the workload on main thread
-  // and we simply store raw data here to make fast mem copy
-  int over_bytes = num_samples * 4 - (MAX_SAMPLES * 2 - (indexW & INDEX_MASK)) * sizeof(short);
-  if (over_bytes > 0)
-  {
-    memcpy(&m_buffer[indexW & INDEX_MASK], samples, num_samples * 4 - over_bytes);
-    memcpy(&m_buffer[0], samples + (num_samples * 4 - over_bytes) / sizeof(short), over_bytes);
-  }
-  else
+  if (num_samples * 2 + ((indexW - m_indexR.load(std::memory_order_acquire)) & INDEX_MASK) >=
+      MAX_SAMPLES * 2)
   {
-    memcpy(&m_buffer[indexW & INDEX_MASK], samples, num_samples * 4);
+    return;
   }
 
-  m_indexW.fetch_add(num_samples * 2);
+  // Swapping is done here in bulk so that mixing can work on native samples. Resampling is left
+  // to the sound thread, to keep the work on the emulation thread to a minimum.
+  const u32 start = indexW & INDEX_MASK;
+  const u32 first_part = std::min(num_samples * 2, MAX_SAMPLES * 2 - start);
+  SwapSamples(&m_buffer[start], samples, first_part);
+  SwapSamples(&m_buffer[0], samples + first_part, num_samples * 2 - first_part);
+
+  m_indexW.store(indexW + num_samples * 2, std::memory_order_release);
 }
 
 void Mixer::PushSamples(const short* samples, unsigned int num_samples)
@@ -219,7 +327,12 @@ void Mixer::PushSamples(const short* samples, unsigned int num_samples)
   m_dma_mixer.PushSamples(samples, num_samples);
   int sample_rate = m_dma_mixer.GetInputSampleRate();
   if (m_log_dsp_audio)
-    m_wave_writer_dsp.AddStereoSamplesBE(samples, num_samples, sample_rate);
+  {
+    if (m_compress_dsp_audio)
+      m_flac_writer_dsp.AddStereoSamplesBE(samples, num_samples, sample_rate);
+    else
+      m_wave_writer_dsp.AddStereoSamplesBE(samples, num_samples, sample_rate);
+  }
 }
 
 void Mixer::PushStreamingSamples(const short* samples, unsigned int num_samples)
@@ -227,7 +340,12 @@ void Mixer::PushStreamingSamples(const short* samples, unsigned int num_samples)
   m_streaming_mixer.PushSamples(samples, num_samples);
   int sample_rate = m_streaming_mixer.GetInputSampleRate();
   if (m_log_dtk_audio)
-    m_wave_writer_dtk.AddStereoSamplesBE(samples, num_samples, sample_rate);
+  {
+    if (m_compress_dtk_audio)
+      m_flac_writer_dtk.AddStereoSamplesBE(samples, num_samples, sample_rate);
+    else
+      m_wave_writer_dtk.AddStereoSamplesBE(samples, num_samples, sample_rate);
+  }
 }
 
 void Mixer::PushWiimoteSpeakerSamples(const short* samples, unsigned int num_samples,
@@ -249,6 +367,26 @@ void Mixer::PushWiimoteSpeakerSamples(const short* samples, unsigned int num_sam
   }
 }
 
+void Mixer::PushSurroundSamples(const short* samples, const short* surround_samples,
+                                unsigned int num_samples)
+{
+  short rear_samples[MAX_SAMPLES * 2];
+
+  if (num_samples < MAX_SAMPLES)
+  {
+    // The surround channel goes to both rear speakers, 3 dB down so that it's as loud as before.
+    for (unsigned int i = 0; i < num_samples; ++i)
+    {
+      const short sample = static_cast<short>((surround_samples[i] * 23170) >> 15);
+      rear_samples[i * 2] = Common::swap16(sample);
+      rear_samples[i * 2 + 1] = Common::swap16(sample);
+    }
+
+    m_surround_front_mixer.PushSamples(samples, num_samples);
+    m_surround_rear_mixer.PushSamples(rear_samples, num_samples);
+  }
+}
+
 void Mixer::SetDMAInputSampleRate(unsigned int rate)
 {
   m_dma_mixer.SetInputSampleRate(rate);
@@ -269,11 +407,14 @@ void Mixer::SetWiimoteSpeakerVolume(unsigned int lvolume, unsigned int rvolume)
   m_wiimote_speaker_mixer.SetVolume(lvolume, rvolume);
 }
 
-void Mixer::StartLogDTKAudio(const std::string& filename)
+void Mixer::StartLogDTKAudio(const std::string& filename, bool compress)
 {
   if (!m_log_dtk_audio)
   {
-    bool success = m_wave_writer_dtk.Start(filename, m_streaming_mixer.GetInputSampleRate());
+    m_compress_dtk_audio = compress;
+    bool success = compress ?
+                       m_flac_writer_dtk.Start(filename, m_streaming_mixer.GetInputSampleRate()) :
+                       m_wave_writer_dtk.Start(filename, m_streaming_mixer.GetInputSampleRate());
     if (success)
     {
       m_log_dtk_audio = true;
@@ -282,7 +423,8 @@ void Mixer::StartLogDTKAudio(const std::string& filename)
     }
     else
     {
-      m_wave_writer_dtk.Stop();
+      if (!compress)
+        m_wave_writer_dtk.Stop();
       NOTICE_LOG(AUDIO, "Unable to start DTK Audio logging");
     }
   }
@@ -297,7 +439,10 @@ void Mixer::StopLogDTKAudio()
   if (m_log_dtk_audio)
   {
     m_log_dtk_audio = false;
-    m_wave_writer_dtk.Stop();
+    if (m_compress_dtk_audio)
+      m_flac_writer_dtk.Stop();
+    else
+      m_wave_writer_dtk.Stop();
     NOTICE_LOG(AUDIO, "Stopping DTK Audio logging");
   }
   else
@@ -306,11 +451,14 @@ void Mixer::StopLogDTKAudio()
   }
 }
 
-void Mixer::StartLogDSPAudio(const std::string& filename)
+void Mixer::StartLogDSPAudio(const std::string& filename, bool compress)
 {
   if (!m_log_dsp_audio)
   {
-    bool success = m_wave_writer_dsp.Start(filename, m_dma_mixer.GetInputSampleRate());
+    m_compress_dsp_audio = compress;
+    bool success = compress ?
+                       m_flac_writer_dsp.Start(filename, m_dma_mixer.GetInputSampleRate()) :
+                       m_wave_writer_dsp.Start(filename, m_dma_mixer.GetInputSampleRate());
     if (success)
     {
       m_log_dsp_audio = true;
@@ -319,7 +467,8 @@ void Mixer::StartLogDSPAudio(const std::string& filename)
     }
     else
     {
-      m_wave_writer_dsp.Stop();
+      if (!compress)
+        m_wave_writer_dsp.Stop();
       NOTICE_LOG(AUDIO, "Unable to start DSP Audio logging");
     }
   }
@@ -334,7 +483,10 @@ void Mixer::StopLogDSPAudio()
   if (m_log_dsp_audio)
   {
     m_log_dsp_audio = false;
-    m_wave_writer_dsp.Stop();
+    if (m_compress_dsp_audio)
+      m_flac_writer_dsp.Stop();
+    else
+      m_wave_writer_dsp.Stop();
     NOTICE_LOG(AUDIO, "Stopping DSP Audio logging");
   }
   else
@@ -369,7 +521,7 @@ void Mixer::MixerFifo::SetVolume(unsigned int lvolume, unsigned int rvolume)
 unsigned int Mixer::MixerFifo::AvailableSamples() const
 {
   unsigned int samples_in_fifo = ((m_indexW.load() - m_indexR.load()) & INDEX_MASK) / 2;
-  if (samples_in_fifo <= 1)
-    return 0;  // Mixer::MixerFifo::Mix always keeps one sample in the buffer.
-  return (samples_in_fifo - 1) * m_mixer->m_sampleRate / m_input_sample_rate;
+  if (samples_in_fifo < RESAMPLER_TAPS)
+    return 0;  // Mixer::MixerFifo::Mix always keeps a window of samples in the buffer.
+  return (samples_in_fifo - RESAMPLER_TAPS + 1) * m_mixer->m_sampleRate / m_input_sample_rate;
 }
@@ -8,6 +8,9 @@
 #include <atomic>
 
 #include "AudioCommon/AudioStretcher.h"
+#include "AudioCommon/FlacFile.h"
+#include "AudioCommon/LatencyController.h"
+#include "AudioCommon/Resampler.h"
 #include "AudioCommon/SurroundDecoder.h"
 #include "AudioCommon/WaveFile.h"
 #include "Common/CommonTypes.h"
@@ -31,22 +34,35 @@ public:
   void PushStreamingSamples(const short* samples, unsigned int num_samples);
   void PushWiimoteSpeakerSamples(const short* samples, unsigned int num_samples,
                                  unsigned int sample_rate);
+  // Takes the same big endian stereo samples as PushSamples, before they were mixed down with the
+  // (native endian, mono) surround channel. MixSurround plays these directly if it can.
+  void PushSurroundSamples(const short* samples, const short* surround_samples,
+                           unsigned int num_samples);
   unsigned int GetSampleRate() const { return m_sampleRate; }
   void SetDMAInputSampleRate(unsigned int rate);
   void SetStreamInputSampleRate(unsigned int rate);
   void SetStreamingVolume(unsigned int lvolume, unsigned int rvolume);
   void SetWiimoteSpeakerVolume(unsigned int lvolume, unsigned int rvolume);
 
-  void StartLogDTKAudio(const std::string& filename);
+  // With compress, the dump is encoded to FLAC on a separate thread instead of written as WAV.
+  void StartLogDTKAudio(const std::string& filename, bool compress = false);
   void StopLogDTKAudio();
 
-  void StartLogDSPAudio(const std::string& filename);
+  void StartLogDSPAudio(const std::string& filename, bool compress = false);
   void StopLogDSPAudio();
 
   float GetCurrentSpeed() const { return m_speed.load(); }
   void UpdateSpeed(float val) { m_speed.store(val); }
 
+  AudioCommon::LatencyController& GetLatencyController() { return m_latency_controller; }
+  const AudioCommon::LatencyController& GetLatencyController() const
+  {
+    return m_latency_controller;
+  }
+
 private:
+  void MixDiscreteSurround(float* samples, unsigned int num_samples);
+
   static constexpr u32 MAX_SAMPLES = 1024 * 4;  // 128 ms
   static constexpr u32 INDEX_MASK = MAX_SAMPLES * 2 - 1;
   static constexpr int MAX_FREQ_SHIFT = 200;  // Per 32000 Hz
@@ -55,6 +71,8 @@ private:
 
   const unsigned int SURROUND_CHANNELS = 6;
   const unsigned int SURROUND_BLOCK_SIZE = 512;
+  // Sample rate of the audio the HLE AX ucode produces.
+  static constexpr unsigned int SURROUND_SAMPLE_RATE = 32000;
 
   class MixerFifo final
   {
@@ -63,6 +81,7 @@ private:
     {
     }
     void DoState(PointerWrap& p);
+    // Takes big endian samples.
     void PushSamples(const short* samples, unsigned int num_samples);
     unsigned int Mix(short* samples, unsigned int numSamples, bool consider_framelimit = true);
     void SetInputSampleRate(unsigned int rate);
@@ -71,8 +90,11 @@ private:
     unsigned int AvailableSamples() const;
 
   private:
+    u32 GetResampleRatio(u32 available_frames, bool consider_framelimit);
+
     Mixer* m_mixer;
     unsigned m_input_sample_rate;
+    // Native endian samples. m_indexR is the first sample of the resampler's window.
     std::array<short, MAX_SAMPLES * 2> m_buffer{};
     std::atomic<u32> m_indexW{0};
     std::atomic<u32> m_indexR{0};
@@ -81,23 +103,44 @@ private:
     std::atomic<s32> m_RVolume{256};
     float m_numLeftI = 0.0f;
     u32 m_frac = 0;
+    // The input of a Mix call, split into channels so that the resampler can read each window
+    // from contiguous memory.
+    std::array<std::array<short, MAX_SAMPLES>, 2> m_resampler_input{};
+    // The last resampled samples, which are repeated if the FIFO runs dry.
+    std::array<s32, 2> m_last_samples{};
+    // The resampler's filter, and the input rate it was chosen for.
+    const AudioCommon::ResamplerTable* m_resampler_table = nullptr;
+    unsigned int m_resampler_table_input_rate = 0;
   };
 
   MixerFifo m_dma_mixer{this, 32000};
   MixerFifo m_streaming_mixer{this, 48000};
   MixerFifo m_wiimote_speaker_mixer{this, 3000};
+  // The front and rear speakers' samples from PushSurroundSamples. As they are always pushed and
+  // mixed together, the two FIFOs stay in sync.
+  MixerFifo m_surround_front_mixer{this, SURROUND_SAMPLE_RATE};
+  MixerFifo m_surround_rear_mixer{this, SURROUND_SAMPLE_RATE};
   unsigned int m_sampleRate;
 
   bool m_is_stretching = false;
   AudioCommon::AudioStretcher m_stretcher;
+  AudioCommon::LatencyController m_latency_controller;
+  // How much audio the FIFOs try to keep buffered. Only used from the audio thread.
+  u32 m_target_latency_ms = 0;
   AudioCommon::SurroundDecoder m_surround_decoder;
+  bool m_is_mixing_discrete_surround = false;
   std::array<short, MAX_SAMPLES * 2> m_scratch_buffer;
+  std::array<std::array<short, MAX_SAMPLES * 2>, 2> m_surround_buffers;
 
   WaveFileWriter m_wave_writer_dtk;
   WaveFileWriter m_wave_writer_dsp;
+  FlacFileWriter m_flac_writer_dtk;
+  FlacFileWriter m_flac_writer_dsp;
 
   bool m_log_dtk_audio = false;
   bool m_log_dsp_audio = false;
+  bool m_compress_dtk_audio = false;
+  bool m_compress_dsp_audio = false;
 
   // Current rate of emulation (1.0 = 100% speed)
   std::atomic<float> m_speed{0.0f};
@@ -0,0 +1,70 @@
+// Copyright 2019 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include "AudioCommon/Resampler.h"
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <utility>
+
+namespace AudioCommon
+{
+// Relative to the Nyquist frequency, leaving some room for the window's transition band.
+constexpr double RESAMPLER_CUTOFF = 0.9;
+
+static void BuildResamplerTable(ResamplerTable* table, double cutoff)
+{
+  constexpr double pi = 3.14159265358979323846;
+  for (u32 phase = 0; phase < RESAMPLER_PHASES; ++phase)
+  {
+    // Tap RESAMPLER_TAPS / 2 - 1 is the input sample right before the output sample.
+    const double offset = static_cast<double>(phase) / RESAMPLER_PHASES;
+    std::array<double, RESAMPLER_TAPS> taps;
+    double sum = 0.0;
+    for (u32 i = 0; i < RESAMPLER_TAPS; ++i)
+    {
+      const double x = static_cast<double>(i) - (RESAMPLER_TAPS / 2 - 1) - offset;
+      const double sinc_x = pi * cutoff * x;
+      const double sinc = x == 0.0 ? 1.0 : std::sin(sinc_x) / sinc_x;
+      const double window_x = 2 * pi * x / RESAMPLER_TAPS;
+      const double window = 0.42 + 0.5 * std::cos(window_x) + 0.08 * std::cos(2 * window_x);
+      taps[i] = sinc * window;
+      sum += taps[i];
+    }
+
+    // Normalize to unity gain, and put the rounding error on the center tap so that the
+    // coefficients add up exactly.
+    s32 int_sum = 0;
+    for (u32 i = 0; i < RESAMPLER_TAPS; ++i)
+    {
+      const double coefficient = taps[i] / sum * (1 << RESAMPLER_COEFFICIENT_SHIFT);
+      (*table)[phase].coefficients[i] = static_cast<s16>(std::lround(coefficient));
+      int_sum += (*table)[phase].coefficients[i];
+    }
+    const u32 center = RESAMPLER_TAPS / 2 - 1 + (offset >= 0.5);
+    (*table)[phase].coefficients[center] += (1 << RESAMPLER_COEFFICIENT_SHIFT) - int_sum;
+  }
+}
+
+const ResamplerTable& GetResamplerTable(u32 input_rate, u32 output_rate)
+{
+  // Only a handful of rate combinations are ever used, so tables are never freed.
+  static std::mutex s_lock;
+  static std::map<std::pair<u32, u32>, std::unique_ptr<ResamplerTable>> s_tables;
+
+  std::lock_guard lk(s_lock);
+  std::unique_ptr<ResamplerTable>& table = s_tables[{input_rate, output_rate}];
+  if (!table)
+  {
+    const double ratio =
+        input_rate == 0 ? 1.0 : static_cast<double>(output_rate) / static_cast<double>(input_rate);
+    table = std::make_unique<ResamplerTable>();
+    BuildResamplerTable(table.get(), RESAMPLER_CUTOFF * std::min(1.0, ratio));
+  }
+  return *table;
+}
+}  // namespace AudioCommon
@@ -0,0 +1,67 @@
+// Copyright 2019 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+
+#include "Common/CommonTypes.h"
+#include "Common/Intrinsics.h"
+
+#ifdef _M_ARM_64
+#include <arm_neon.h>
+#endif
+
+// The mixer's resampler, a Blackman windowed sinc filter. Its coefficients are precomputed for a
+// number of positions between two input samples, and the nearest one is used for each output
+// sample.
+
+namespace AudioCommon
+{
+constexpr u32 RESAMPLER_PHASE_BITS = 8;
+constexpr u32 RESAMPLER_PHASES = 1 << RESAMPLER_PHASE_BITS;
+// Number of input samples each output sample is computed from.
+constexpr u32 RESAMPLER_TAPS = 8;
+constexpr int RESAMPLER_COEFFICIENT_SHIFT = 14;
+
+struct alignas(16) ResamplerPhase
+{
+  std::array<s16, RESAMPLER_TAPS> coefficients;
+};
+using ResamplerTable = std::array<ResamplerPhase, RESAMPLER_PHASES>;
+
+// Returns the filter for converting audio from <input_rate> to <output_rate>. When downsampling,
+// the cutoff is lowered along with the output's Nyquist frequency, so that frequencies the output
+// can't represent are filtered out instead of aliasing. Thread safe.
+const ResamplerTable& GetResamplerTable(u32 input_rate, u32 output_rate);
+
+// Computes an output sample from RESAMPLER_TAPS input samples, without vectorization.
+inline s32 ApplyResamplerTapsGeneric(const s16* samples, const s16* coefficients)
+{
+  s32 sum = 0;
+  for (u32 i = 0; i < RESAMPLER_TAPS; ++i)
+    sum += samples[i] * coefficients[i];
+  return sum >> RESAMPLER_COEFFICIENT_SHIFT;
+}
+
+// Same as ApplyResamplerTapsGeneric, using SSE2 or NEON where available. <coefficients> must be
+// the aligned coefficients of a ResamplerPhase.
+inline s32 ApplyResamplerTaps(const s16* samples, const s16* coefficients)
+{
+#if defined(_M_X86)
+  const __m128i products =
+      _mm_madd_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(samples)),
+                     _mm_load_si128(reinterpret_cast<const __m128i*>(coefficients)));
+  __m128i sum = _mm_add_epi32(products, _mm_shuffle_epi32(products, _MM_SHUFFLE(1, 0, 3, 2)));
+  sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(2, 3, 0, 1)));
+  return _mm_cvtsi128_si32(sum) >> RESAMPLER_COEFFICIENT_SHIFT;
+#elif defined(_M_ARM_64)
+  int32x4_t sum = vmull_s16(vld1_s16(samples), vld1_s16(coefficients));
+  sum = vmlal_s16(sum, vld1_s16(samples + 4), vld1_s16(coefficients + 4));
+  return vaddvq_s32(sum) >> RESAMPLER_COEFFICIENT_SHIFT;
+#else
+  return ApplyResamplerTapsGeneric(samples, coefficients);
+#endif
+}
+}  // namespace AudioCommon
@@ -45,6 +45,8 @@ struct CPUInfo
   bool bFMA = false;
   bool bFMA4 = false;
   bool bAES = false;
+  // AES instructions on 256-bit registers
+  bool bVAES = false;
   // FXSAVE/FXRSTOR
   bool bFXSR = false;
   bool bMOVBE = false;
@@ -55,12 +57,14 @@ struct CPUInfo
   bool bLongMode = false;
   bool bAtom = false;
 
+  // SHA extensions (SHA-NI on x86)
+  bool bSHA1 = false;
+  bool bSHA2 = false;
+
   // ARMv8 specific
   bool bFP = false;
   bool bASIMD = false;
   bool bCRC32 = false;
-  bool bSHA1 = false;
-  bool bSHA2 = false;
 
   // Call Detect()
   explicit CPUInfo();
@@ -2,25 +2,496 @@
 // Licensed under GPLv2+
 // Refer to the license.txt file included.
 
+#include <array>
+#include <cstring>
+#include <memory>
+
 #include <mbedtls/aes.h>
 
+#include "Common/CPUDetect.h"
 #include "Common/Crypto/AES.h"
+#include "Common/Intrinsics.h"
+
+#ifdef _M_ARM_64
+#include <arm_neon.h>
+#endif
+
+#if defined(_MSC_VER)
+#define FUNCTION_TARGET_AES
+#define FUNCTION_TARGET_VAES
+#define FUNCTION_TARGET_ARMV8_CRYPTO
+#else
+#define FUNCTION_TARGET_AES [[gnu::target("aes")]]
+#define FUNCTION_TARGET_VAES [[gnu::target("aes,avx2,vaes")]]
+#define FUNCTION_TARGET_ARMV8_CRYPTO [[gnu::target("+crypto")]]
+#endif
 
 namespace Common::AES
 {
-std::vector<u8> DecryptEncrypt(const u8* key, u8* iv, const u8* src, size_t size, Mode mode)
+constexpr size_t BLOCK_SIZE = 16;
+constexpr size_t NUM_ROUNDS = 10;
+
+// The decryption paths keep this many blocks in flight to hide the latency of the AES instructions.
+constexpr size_t PARALLEL_BLOCKS = 8;
+
+class ContextGeneric final : public Context
 {
-  mbedtls_aes_context aes_ctx;
-  std::vector<u8> buffer(size);
+public:
+  ContextGeneric(const u8* key, Mode mode) : m_mode(mode)
+  {
+    mbedtls_aes_init(&m_ctx);
+    if (mode == Mode::Encrypt)
+      mbedtls_aes_setkey_enc(&m_ctx, key, 128);
+    else
+      mbedtls_aes_setkey_dec(&m_ctx, key, 128);
+  }
+  ~ContextGeneric() override { mbedtls_aes_free(&m_ctx); }
+
+  void Crypt(u8* iv, const u8* src, u8* dst, size_t size) const override
+  {
+    // mbedtls doesn't modify the context, it just isn't declared const.
+    mbedtls_aes_crypt_cbc(const_cast<mbedtls_aes_context*>(&m_ctx),
+                          m_mode == Mode::Encrypt ? MBEDTLS_AES_ENCRYPT : MBEDTLS_AES_DECRYPT,
+                          size, iv, src, dst);
+  }
+
+private:
+  mbedtls_aes_context m_ctx;
+  Mode m_mode;
+};
+
+#ifdef _M_X86_64
+
+template <int RCON>
+FUNCTION_TARGET_AES static inline __m128i ExpandRoundKey(__m128i key)
+{
+  __m128i assist = _mm_aeskeygenassist_si128(key, RCON);
+  assist = _mm_shuffle_epi32(assist, _MM_SHUFFLE(3, 3, 3, 3));
+  key = _mm_xor_si128(key, _mm_slli_si128(key, 4));
+  key = _mm_xor_si128(key, _mm_slli_si128(key, 4));
+  key = _mm_xor_si128(key, _mm_slli_si128(key, 4));
+  return _mm_xor_si128(key, assist);
+}
+
+FUNCTION_TARGET_AES
+static void ExpandKeyAESNI(const u8* key, Mode mode, __m128i* round_keys)
+{
+  __m128i rk[NUM_ROUNDS + 1];
+  rk[0] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(key));
+  rk[1] = ExpandRoundKey<0x01>(rk[0]);
+  rk[2] = ExpandRoundKey<0x02>(rk[1]);
+  rk[3] = ExpandRoundKey<0x04>(rk[2]);
+  rk[4] = ExpandRoundKey<0x08>(rk[3]);
+  rk[5] = ExpandRoundKey<0x10>(rk[4]);
+  rk[6] = ExpandRoundKey<0x20>(rk[5]);
+  rk[7] = ExpandRoundKey<0x40>(rk[6]);
+  rk[8] = ExpandRoundKey<0x80>(rk[7]);
+  rk[9] = ExpandRoundKey<0x1b>(rk[8]);
+  rk[10] = ExpandRoundKey<0x36>(rk[9]);
+
+  if (mode == Mode::Encrypt)
+  {
+    std::copy(std::begin(rk), std::end(rk), round_keys);
+    return;
+  }
+
+  // Keys for the equivalent inverse cipher, which is what AESDEC implements.
+  round_keys[0] = rk[NUM_ROUNDS];
+  for (size_t i = 1; i < NUM_ROUNDS; ++i)
+    round_keys[i] = _mm_aesimc_si128(rk[NUM_ROUNDS - i]);
+  round_keys[NUM_ROUNDS] = rk[0];
+}
+
+FUNCTION_TARGET_AES
+static void EncryptCBCAESNI(const __m128i* rk, u8* iv, const u8* src, u8* dst, size_t blocks)
+{
+  __m128i state = _mm_loadu_si128(reinterpret_cast<const __m128i*>(iv));
+  for (size_t i = 0; i < blocks; ++i)
+  {
+    const __m128i plain = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * BLOCK_SIZE));
+    state = _mm_xor_si128(_mm_xor_si128(state, plain), rk[0]);
+    for (size_t round = 1; round < NUM_ROUNDS; ++round)
+      state = _mm_aesenc_si128(state, rk[round]);
+    state = _mm_aesenclast_si128(state, rk[NUM_ROUNDS]);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i * BLOCK_SIZE), state);
+  }
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(iv), state);
+}
+
+// Returns the last ciphertext block, which is the IV for the following blocks.
+FUNCTION_TARGET_AES
+static __m128i DecryptCBCAESNI(const __m128i* rk, __m128i prev, const u8* src, u8* dst,
+                               size_t blocks)
+{
+  size_t i = 0;
+  for (; i + PARALLEL_BLOCKS <= blocks; i += PARALLEL_BLOCKS)
+  {
+    const u8* in = src + i * BLOCK_SIZE;
+    __m128i cipher[PARALLEL_BLOCKS];
+    __m128i state[PARALLEL_BLOCKS];
+    for (size_t j = 0; j < PARALLEL_BLOCKS; ++j)
+    {
+      cipher[j] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + j * BLOCK_SIZE));
+      state[j] = _mm_xor_si128(cipher[j], rk[0]);
+    }
+    for (size_t round = 1; round < NUM_ROUNDS; ++round)
+    {
+      for (size_t j = 0; j < PARALLEL_BLOCKS; ++j)
+        state[j] = _mm_aesdec_si128(state[j], rk[round]);
+    }
+    for (size_t j = 0; j < PARALLEL_BLOCKS; ++j)
+    {
+      state[j] = _mm_aesdeclast_si128(state[j], rk[NUM_ROUNDS]);
+      state[j] = _mm_xor_si128(state[j], j == 0 ? prev : cipher[j - 1]);
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + (i + j) * BLOCK_SIZE), state[j]);
+    }
+    prev = cipher[PARALLEL_BLOCKS - 1];
+  }
+
+  for (; i < blocks; ++i)
+  {
+    const __m128i cipher = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * BLOCK_SIZE));
+    __m128i state = _mm_xor_si128(cipher, rk[0]);
+    for (size_t round = 1; round < NUM_ROUNDS; ++round)
+      state = _mm_aesdec_si128(state, rk[round]);
+    state = _mm_xor_si128(_mm_aesdeclast_si128(state, rk[NUM_ROUNDS]), prev);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i * BLOCK_SIZE), state);
+    prev = cipher;
+  }
+
+  return prev;
+}
+
+// Decrypts pairs of blocks per instruction. Only whole groups of 2 * PARALLEL_BLOCKS are handled;
+// returns the number of blocks which were decrypted.
+FUNCTION_TARGET_VAES
+static size_t DecryptCBCVAES(const __m128i* rk, __m128i* prev, const u8* src, u8* dst,
+                             size_t blocks)
+{
+  constexpr size_t LANES = PARALLEL_BLOCKS;
+  constexpr size_t GROUP_BLOCKS = LANES * 2;
+
+  size_t i = 0;
+  for (; i + GROUP_BLOCKS <= blocks; i += GROUP_BLOCKS)
+  {
+    const u8* in = src + i * BLOCK_SIZE;
+    __m256i state[LANES];
+    const __m256i first_key = _mm256_broadcastsi128_si256(rk[0]);
+    for (size_t j = 0; j < LANES; ++j)
+    {
+      state[j] = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + j * 2 * BLOCK_SIZE));
+      state[j] = _mm256_xor_si256(state[j], first_key);
+    }
+    for (size_t round = 1; round < NUM_ROUNDS; ++round)
+    {
+      const __m256i key = _mm256_broadcastsi128_si256(rk[round]);
+      for (size_t j = 0; j < LANES; ++j)
+        state[j] = _mm256_aesdec_epi128(state[j], key);
+    }
+    const __m256i last_key = _mm256_broadcastsi128_si256(rk[NUM_ROUNDS]);
+    for (size_t j = 0; j < LANES; ++j)
+      state[j] = _mm256_aesdeclast_epi128(state[j], last_key);
+
+    // All ciphertext has to be read before anything is written, since src and dst may be the same.
+    state[0] = _mm256_xor_si256(
+        state[0], _mm256_inserti128_si256(_mm256_castsi128_si256(*prev),
+                                          _mm_loadu_si128(reinterpret_cast<const __m128i*>(in)), 1));
+    for (size_t j = 1; j < LANES; ++j)
+    {
+      const u8* previous = in + (j * 2 - 1) * BLOCK_SIZE;
+      state[j] = _mm256_xor_si256(
+          state[j], _mm256_loadu_si256(reinterpret_cast<const __m256i*>(previous)));
+    }
+    *prev = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + (GROUP_BLOCKS - 1) * BLOCK_SIZE));
+
+    for (size_t j = 0; j < LANES; ++j)
+    {
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + (i + j * 2) * BLOCK_SIZE), state[j]);
+    }
+  }
+  return i;
+}
+
+class ContextAESNI : public Context
+{
+public:
+  ContextAESNI(const u8* key, Mode mode) : m_mode(mode) { ExpandKeyAESNI(key, mode, m_round_keys); }
+
+  void Crypt(u8* iv, const u8* src, u8* dst, size_t size) const override
+  {
+    if (m_mode == Mode::Encrypt)
+    {
+      EncryptCBCAESNI(m_round_keys, iv, src, dst, size / BLOCK_SIZE);
+      return;
+    }
+
+    __m128i prev;
+    std::memcpy(&prev, iv, BLOCK_SIZE);
+    prev = DecryptCBCAESNI(m_round_keys, prev, src, dst, size / BLOCK_SIZE);
+    std::memcpy(iv, &prev, BLOCK_SIZE);
+  }
+
+protected:
+  __m128i m_round_keys[NUM_ROUNDS + 1];
+  Mode m_mode;
+};
+
+class ContextVAES final : public ContextAESNI
+{
+public:
+  using ContextAESNI::ContextAESNI;
+
+  void Crypt(u8* iv, const u8* src, u8* dst, size_t size) const override
+  {
+    // CBC encryption is serial, so there is nothing to gain from wider registers.
+    if (m_mode == Mode::Encrypt)
+    {
+      ContextAESNI::Crypt(iv, src, dst, size);
+      return;
+    }
+
+    __m128i prev;
+    std::memcpy(&prev, iv, BLOCK_SIZE);
+    const size_t blocks = size / BLOCK_SIZE;
+    const size_t done = DecryptCBCVAES(m_round_keys, &prev, src, dst, blocks);
+    prev = DecryptCBCAESNI(m_round_keys, prev, src + done * BLOCK_SIZE, dst + done * BLOCK_SIZE,
+                           blocks - done);
+    std::memcpy(iv, &prev, BLOCK_SIZE);
+  }
+};
+
+#endif  // _M_X86_64
+
+#ifdef _M_ARM_64
+
+// AESE with an all-zero key and all four columns equal is just SubBytes, since ShiftRows has no
+// visible effect on such a state.
+FUNCTION_TARGET_ARMV8_CRYPTO
+static u32 SubWord(u32 word)
+{
+  const uint8x16_t state = vreinterpretq_u8_u32(vdupq_n_u32(word));
+  return vgetq_lane_u32(vreinterpretq_u32_u8(vaeseq_u8(state, vdupq_n_u8(0))), 0);
+}
+
+FUNCTION_TARGET_ARMV8_CRYPTO
+static void ExpandKeyARMv8(const u8* key, Mode mode, uint8x16_t* round_keys)
+{
+  static constexpr std::array<u8, NUM_ROUNDS> RCON{
+      {0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80, 0x1b, 0x36}};
+
+  std::array<u32, (NUM_ROUNDS + 1) * 4> words;
+  std::memcpy(words.data(), key, BLOCK_SIZE);
+  for (size_t i = 4; i < words.size(); ++i)
+  {
+    u32 temp = words[i - 1];
+    if (i % 4 == 0)
+      temp = SubWord((temp >> 8) | (temp << 24)) ^ RCON[i / 4 - 1];
+    words[i] = words[i - 4] ^ temp;
+  }
+
+  uint8x16_t rk[NUM_ROUNDS + 1];
+  for (size_t i = 0; i <= NUM_ROUNDS; ++i)
+    rk[i] = vld1q_u8(reinterpret_cast<const u8*>(&words[i * 4]));
 
   if (mode == Mode::Encrypt)
-    mbedtls_aes_setkey_enc(&aes_ctx, key, 128);
-  else
-    mbedtls_aes_setkey_dec(&aes_ctx, key, 128);
+  {
+    std::copy(std::begin(rk), std::end(rk), round_keys);
+    return;
+  }
+
+  round_keys[0] = rk[NUM_ROUNDS];
+  for (size_t i = 1; i < NUM_ROUNDS; ++i)
+    round_keys[i] = vaesimcq_u8(rk[NUM_ROUNDS - i]);
+  round_keys[NUM_ROUNDS] = rk[0];
+}
+
+FUNCTION_TARGET_ARMV8_CRYPTO
+static void EncryptCBCARMv8(const uint8x16_t* rk, u8* iv, const u8* src, u8* dst, size_t blocks)
+{
+  uint8x16_t state = vld1q_u8(iv);
+  for (size_t i = 0; i < blocks; ++i)
+  {
+    state = veorq_u8(state, vld1q_u8(src + i * BLOCK_SIZE));
+    for (size_t round = 0; round < NUM_ROUNDS - 1; ++round)
+      state = vaesmcq_u8(vaeseq_u8(state, rk[round]));
+    state = veorq_u8(vaeseq_u8(state, rk[NUM_ROUNDS - 1]), rk[NUM_ROUNDS]);
+    vst1q_u8(dst + i * BLOCK_SIZE, state);
+  }
+  vst1q_u8(iv, state);
+}
+
+FUNCTION_TARGET_ARMV8_CRYPTO
+static void DecryptCBCARMv8(const uint8x16_t* rk, u8* iv, const u8* src, u8* dst, size_t blocks)
+{
+  uint8x16_t prev = vld1q_u8(iv);
+  size_t i = 0;
+  for (; i + PARALLEL_BLOCKS <= blocks; i += PARALLEL_BLOCKS)
+  {
+    const u8* in = src + i * BLOCK_SIZE;
+    uint8x16_t cipher[PARALLEL_BLOCKS];
+    uint8x16_t state[PARALLEL_BLOCKS];
+    for (size_t j = 0; j < PARALLEL_BLOCKS; ++j)
+      state[j] = cipher[j] = vld1q_u8(in + j * BLOCK_SIZE);
+    for (size_t round = 0; round < NUM_ROUNDS - 1; ++round)
+    {
+      for (size_t j = 0; j < PARALLEL_BLOCKS; ++j)
+        state[j] = vaesimcq_u8(vaesdq_u8(state[j], rk[round]));
+    }
+    for (size_t j = 0; j < PARALLEL_BLOCKS; ++j)
+    {
+      state[j] = veorq_u8(vaesdq_u8(state[j], rk[NUM_ROUNDS - 1]), rk[NUM_ROUNDS]);
+      state[j] = veorq_u8(state[j], j == 0 ? prev : cipher[j - 1]);
+      vst1q_u8(dst + (i + j) * BLOCK_SIZE, state[j]);
+    }
+    prev = cipher[PARALLEL_BLOCKS - 1];
+  }
 
-  mbedtls_aes_crypt_cbc(&aes_ctx, mode == Mode::Encrypt ? MBEDTLS_AES_ENCRYPT : MBEDTLS_AES_DECRYPT,
-                        size, iv, src, buffer.data());
+  for (; i < blocks; ++i)
+  {
+    const uint8x16_t cipher = vld1q_u8(src + i * BLOCK_SIZE);
+    uint8x16_t state = cipher;
+    for (size_t round = 0; round < NUM_ROUNDS - 1; ++round)
+      state = vaesimcq_u8(vaesdq_u8(state, rk[round]));
+    state = veorq_u8(vaesdq_u8(state, rk[NUM_ROUNDS - 1]), rk[NUM_ROUNDS]);
+    vst1q_u8(dst + i * BLOCK_SIZE, veorq_u8(state, prev));
+    prev = cipher;
+  }
+  vst1q_u8(iv, prev);
+}
 
+class ContextARMv8 final : public Context
+{
+public:
+  ContextARMv8(const u8* key, Mode mode) : m_mode(mode) { ExpandKeyARMv8(key, mode, m_round_keys); }
+
+  void Crypt(u8* iv, const u8* src, u8* dst, size_t size) const override
+  {
+    if (m_mode == Mode::Encrypt)
+      EncryptCBCARMv8(m_round_keys, iv, src, dst, size / BLOCK_SIZE);
+    else
+      DecryptCBCARMv8(m_round_keys, iv, src, dst, size / BLOCK_SIZE);
+  }
+
+private:
+  uint8x16_t m_round_keys[NUM_ROUNDS + 1];
+  Mode m_mode;
+};
+
+#endif  // _M_ARM_64
+
+static Implementation GetBestImplementation()
+{
+  static const Implementation s_best = [] {
+    for (Implementation implementation :
+         {Implementation::VAES, Implementation::AESNI, Implementation::ARMv8})
+    {
+      if (IsSupported(implementation))
+        return implementation;
+    }
+    return Implementation::Generic;
+  }();
+  return s_best;
+}
+
+bool IsSupported(Implementation implementation)
+{
+  switch (implementation)
+  {
+  case Implementation::Best:
+  case Implementation::Generic:
+    return true;
+#ifdef _M_X86_64
+  case Implementation::AESNI:
+    return cpu_info.bAES;
+  case Implementation::VAES:
+    return cpu_info.bAES && cpu_info.bVAES;
+#endif
+#ifdef _M_ARM_64
+  case Implementation::ARMv8:
+    return cpu_info.bAES;
+#endif
+  default:
+    return false;
+  }
+}
+
+const char* GetImplementationName(Implementation implementation)
+{
+  switch (implementation)
+  {
+  case Implementation::Best:
+    return GetImplementationName(GetBestImplementation());
+  case Implementation::Generic:
+    return "Generic";
+  case Implementation::AESNI:
+    return "AES-NI";
+  case Implementation::VAES:
+    return "VAES";
+  case Implementation::ARMv8:
+    return "ARMv8";
+  }
+  return "Unknown";
+}
+
+void Context::CryptIV(const u8* iv, const u8* src, u8* dst, size_t size) const
+{
+  std::array<u8, BLOCK_SIZE> iv_copy;
+  std::memcpy(iv_copy.data(), iv, BLOCK_SIZE);
+  Crypt(iv_copy.data(), src, dst, size);
+}
+
+std::unique_ptr<Context> CreateContext(const u8* key, Mode mode, Implementation implementation)
+{
+  if (implementation == Implementation::Best)
+    implementation = GetBestImplementation();
+  else if (!IsSupported(implementation))
+    return nullptr;
+
+  switch (implementation)
+  {
+#ifdef _M_X86_64
+  case Implementation::VAES:
+    return std::make_unique<ContextVAES>(key, mode);
+  case Implementation::AESNI:
+    return std::make_unique<ContextAESNI>(key, mode);
+#endif
+#ifdef _M_ARM_64
+  case Implementation::ARMv8:
+    return std::make_unique<ContextARMv8>(key, mode);
+#endif
+  default:
+    return std::make_unique<ContextGeneric>(key, mode);
+  }
+}
+
+void DecryptEncrypt(const u8* key, u8* iv, const u8* src, u8* dst, size_t size, Mode mode)
+{
+  // The context lives on the stack, so that one-off operations don't allocate.
+  switch (GetBestImplementation())
+  {
+#ifdef _M_X86_64
+  case Implementation::VAES:
+    ContextVAES(key, mode).Crypt(iv, src, dst, size);
+    return;
+  case Implementation::AESNI:
+    ContextAESNI(key, mode).Crypt(iv, src, dst, size);
+    return;
+#endif
+#ifdef _M_ARM_64
+  case Implementation::ARMv8:
+    ContextARMv8(key, mode).Crypt(iv, src, dst, size);
+    return;
+#endif
+  default:
+    ContextGeneric(key, mode).Crypt(iv, src, dst, size);
+    return;
+  }
+}
+
+std::vector<u8> DecryptEncrypt(const u8* key, u8* iv, const u8* src, size_t size, Mode mode)
+{
+  std::vector<u8> buffer(size);
+  DecryptEncrypt(key, iv, src, buffer.data(), size, mode);
   return buffer;
 }
 
@@ -5,6 +5,7 @@
 #pragma once
 
 #include <cstddef>
+#include <memory>
 #include <vector>
 
 #include "Common/CommonTypes.h"
@@ -16,6 +17,44 @@ enum class Mode
   Decrypt,
   Encrypt,
 };
+
+enum class Implementation
+{
+  // The fastest implementation supported by the host CPU.
+  Best,
+  // mbedtls, which works everywhere.
+  Generic,
+  // x86 AES-NI, decrypting 8 blocks at a time.
+  AESNI,
+  // x86 VAES, decrypting 8 blocks at a time using 256-bit registers.
+  VAES,
+  // ARMv8 Cryptography Extensions.
+  ARMv8,
+};
+
+bool IsSupported(Implementation implementation);
+const char* GetImplementationName(Implementation implementation);
+
+// An expanded 128-bit key which can be used for any number of AES-CBC operations.
+class Context
+{
+public:
+  virtual ~Context() = default;
+
+  // Crypts <size> bytes (a multiple of 16) from <src> to <dst>, which may be the same buffer.
+  // Like mbedtls_aes_crypt_cbc, <iv> is updated so that a following call continues the chain.
+  virtual void Crypt(u8* iv, const u8* src, u8* dst, size_t size) const = 0;
+
+  // Same as Crypt, but leaves <iv> untouched.
+  void CryptIV(const u8* iv, const u8* src, u8* dst, size_t size) const;
+};
+
+std::unique_ptr<Context> CreateContext(const u8* key, Mode mode,
+                                       Implementation implementation = Implementation::Best);
+
+// Crypts in place or into a caller-provided buffer without allocating.
+void DecryptEncrypt(const u8* key, u8* iv, const u8* src, u8* dst, size_t size, Mode mode);
+
 std::vector<u8> DecryptEncrypt(const u8* key, u8* iv, const u8* src, size_t size, Mode mode);
 
 // Convenience functions
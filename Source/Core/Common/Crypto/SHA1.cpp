@@ -0,0 +1,567 @@
+// Copyright 2019 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include "Common/Crypto/SHA1.h"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <memory>
+#include <utility>
+
+#include <mbedtls/sha1.h>
+
+#include "Common/CPUDetect.h"
+#include "Common/Intrinsics.h"
+#include "Common/Swap.h"
+
+#ifdef _M_ARM_64
+#include <arm_neon.h>
+#endif
+
+#if defined(_MSC_VER)
+#define FUNCTION_TARGET_SHA
+#define FUNCTION_TARGET_ARMV8_CRYPTO
+#else
+#define FUNCTION_TARGET_SHA [[gnu::target("sha,sse4.1")]]
+#define FUNCTION_TARGET_ARMV8_CRYPTO [[gnu::target("+crypto")]]
+#endif
+
+namespace Common::SHA1
+{
+constexpr size_t BLOCK_SIZE = 64;
+constexpr std::array<u32, 4> ROUND_CONSTANTS{{0x5a827999, 0x6ed9eba1, 0x8f1bbcdc, 0xca62c1d6}};
+
+using State = std::array<u32, 5>;
+constexpr State INITIAL_STATE{{0x67452301, 0xefcdab89, 0x98badcfe, 0x10325476, 0xc3d2e1f0}};
+
+// Processes <num_blocks> 64-byte blocks for each of several messages at once. <blocks> holds one
+// pointer per message.
+using CompressFunction = void (*)(State* states, const u8* const* blocks, size_t num_blocks);
+
+// Writes the final block(s) of a message to <tail>, which must be zeroed and 2 blocks large.
+// Returns how many blocks were written.
+static size_t Pad(u8* tail, const u8* remainder, size_t remainder_size, u64 message_size)
+{
+  std::memcpy(tail, remainder, remainder_size);
+  tail[remainder_size] = 0x80;
+  const size_t tail_blocks = remainder_size + 1 + sizeof(u64) > BLOCK_SIZE ? 2 : 1;
+  const u64 bit_count = Common::swap64(message_size * 8);
+  std::memcpy(tail + tail_blocks * BLOCK_SIZE - sizeof(u64), &bit_count, sizeof(u64));
+  return tail_blocks;
+}
+
+static void StoreDigest(const State& state, u8* digest)
+{
+  for (size_t i = 0; i < state.size(); ++i)
+  {
+    const u32 word = Common::swap32(state[i]);
+    std::memcpy(digest + i * sizeof(u32), &word, sizeof(u32));
+  }
+}
+
+// Hashes <count> messages of <size> bytes, N at a time.
+template <size_t N>
+static void HashMessages(CompressFunction compress, const u8* data, size_t size, size_t count,
+                         u8* digests)
+{
+  const size_t remainder_size = size % BLOCK_SIZE;
+  for (size_t first = 0; first < count; first += N)
+  {
+    std::array<State, N> states;
+    std::array<const u8*, N> messages;
+    for (size_t i = 0; i < N; ++i)
+    {
+      states[i] = INITIAL_STATE;
+      // Unused lanes just hash the last message again.
+      messages[i] = data + std::min(first + i, count - 1) * size;
+    }
+    compress(states.data(), messages.data(), size / BLOCK_SIZE);
+
+    std::array<std::array<u8, BLOCK_SIZE * 2>, N> tails{};
+    std::array<const u8*, N> tail_pointers;
+    size_t tail_blocks = 0;
+    for (size_t i = 0; i < N; ++i)
+    {
+      tail_blocks = Pad(tails[i].data(), messages[i] + size - remainder_size, remainder_size, size);
+      tail_pointers[i] = tails[i].data();
+    }
+    compress(states.data(), tail_pointers.data(), tail_blocks);
+
+    for (size_t i = 0; i < N && first + i < count; ++i)
+      StoreDigest(states[i], digests + (first + i) * DIGEST_LEN);
+  }
+}
+
+// A streaming context for any of the single message compression functions.
+class BlockContext final : public Context
+{
+public:
+  explicit BlockContext(CompressFunction compress) : m_compress(compress) {}
+
+  void Update(const u8* msg, size_t len) override
+  {
+    m_size += len;
+    if (m_buffered != 0)
+    {
+      const size_t copy_size = std::min(len, BLOCK_SIZE - m_buffered);
+      std::memcpy(m_buffer.data() + m_buffered, msg, copy_size);
+      m_buffered += copy_size;
+      msg += copy_size;
+      len -= copy_size;
+      if (m_buffered != BLOCK_SIZE)
+        return;
+      const u8* block = m_buffer.data();
+      m_compress(&m_state, &block, 1);
+      m_buffered = 0;
+    }
+
+    m_compress(&m_state, &msg, len / BLOCK_SIZE);
+    m_buffered = len % BLOCK_SIZE;
+    std::memcpy(m_buffer.data(), msg + len - m_buffered, m_buffered);
+  }
+
+  Digest Finish() override
+  {
+    std::array<u8, BLOCK_SIZE * 2> tail{};
+    const u8* tail_pointer = tail.data();
+    m_compress(&m_state, &tail_pointer, Pad(tail.data(), m_buffer.data(), m_buffered, m_size));
+    Digest digest;
+    StoreDigest(m_state, digest.data());
+    return digest;
+  }
+
+private:
+  CompressFunction m_compress;
+  State m_state = INITIAL_STATE;
+  std::array<u8, BLOCK_SIZE> m_buffer;
+  size_t m_buffered = 0;
+  u64 m_size = 0;
+};
+
+class ContextGeneric final : public Context
+{
+public:
+  ContextGeneric()
+  {
+    mbedtls_sha1_init(&m_ctx);
+    mbedtls_sha1_starts_ret(&m_ctx);
+  }
+  ~ContextGeneric() override { mbedtls_sha1_free(&m_ctx); }
+
+  void Update(const u8* msg, size_t len) override { mbedtls_sha1_update_ret(&m_ctx, msg, len); }
+
+  Digest Finish() override
+  {
+    Digest digest;
+    mbedtls_sha1_finish_ret(&m_ctx, digest.data());
+    return digest;
+  }
+
+private:
+  mbedtls_sha1_context m_ctx;
+};
+
+// The portable SHA-1 rounds, with each lane of a vector belonging to a different message.
+template <typename Lanes>
+static void CompressLanes(State* states, const u8* const* blocks, size_t num_blocks)
+{
+  using Vector = typename Lanes::Vector;
+  constexpr size_t LANE_COUNT = Lanes::COUNT;
+
+  Vector state[5];
+  for (size_t i = 0; i < 5; ++i)
+  {
+    alignas(16) std::array<u32, LANE_COUNT> words;
+    for (size_t lane = 0; lane < LANE_COUNT; ++lane)
+      words[lane] = states[lane][i];
+    state[i] = Lanes::Load(words.data());
+  }
+
+  for (size_t block = 0; block < num_blocks; ++block)
+  {
+    Vector w[16];
+    for (size_t i = 0; i < 16; ++i)
+    {
+      alignas(16) std::array<u32, LANE_COUNT> words;
+      for (size_t lane = 0; lane < LANE_COUNT; ++lane)
+        words[lane] = Common::swap32(blocks[lane] + block * BLOCK_SIZE + i * sizeof(u32));
+      w[i] = Lanes::Load(words.data());
+    }
+
+    Vector a = state[0], b = state[1], c = state[2], d = state[3], e = state[4];
+    const auto round = [&](size_t t, Vector f, u32 k) {
+      if (t >= 16)
+      {
+        w[t % 16] = Lanes::template RotateLeft<1>(
+            Lanes::Xor(Lanes::Xor(w[(t - 3) % 16], w[(t - 8) % 16]),
+                       Lanes::Xor(w[(t - 14) % 16], w[t % 16])));
+      }
+      const Vector temp =
+          Lanes::Add(Lanes::Add(Lanes::template RotateLeft<5>(a), f),
+                     Lanes::Add(Lanes::Add(e, Lanes::Set(k)), w[t % 16]));
+      e = d;
+      d = c;
+      c = Lanes::template RotateLeft<30>(b);
+      b = a;
+      a = temp;
+    };
+
+    for (size_t t = 0; t < 20; ++t)
+      round(t, Lanes::Xor(d, Lanes::And(b, Lanes::Xor(c, d))), ROUND_CONSTANTS[0]);
+    for (size_t t = 20; t < 40; ++t)
+      round(t, Lanes::Xor(Lanes::Xor(b, c), d), ROUND_CONSTANTS[1]);
+    for (size_t t = 40; t < 60; ++t)
+      round(t, Lanes::Or(Lanes::And(b, c), Lanes::And(d, Lanes::Or(b, c))), ROUND_CONSTANTS[2]);
+    for (size_t t = 60; t < 80; ++t)
+      round(t, Lanes::Xor(Lanes::Xor(b, c), d), ROUND_CONSTANTS[3]);
+
+    state[0] = Lanes::Add(state[0], a);
+    state[1] = Lanes::Add(state[1], b);
+    state[2] = Lanes::Add(state[2], c);
+    state[3] = Lanes::Add(state[3], d);
+    state[4] = Lanes::Add(state[4], e);
+  }
+
+  for (size_t i = 0; i < 5; ++i)
+  {
+    alignas(16) std::array<u32, LANE_COUNT> words;
+    Lanes::Store(words.data(), state[i]);
+    for (size_t lane = 0; lane < LANE_COUNT; ++lane)
+      states[lane][i] = words[lane];
+  }
+}
+
+#ifdef _M_X86_64
+
+struct LanesSSE2
+{
+  using Vector = __m128i;
+  static constexpr size_t COUNT = 4;
+
+  static Vector Set(u32 value) { return _mm_set1_epi32(static_cast<int>(value)); }
+  static Vector Load(const u32* src) { return _mm_load_si128(reinterpret_cast<const __m128i*>(src)); }
+  static void Store(u32* dst, Vector v) { _mm_store_si128(reinterpret_cast<__m128i*>(dst), v); }
+  static Vector Add(Vector a, Vector b) { return _mm_add_epi32(a, b); }
+  static Vector Xor(Vector a, Vector b) { return _mm_xor_si128(a, b); }
+  static Vector And(Vector a, Vector b) { return _mm_and_si128(a, b); }
+  static Vector Or(Vector a, Vector b) { return _mm_or_si128(a, b); }
+  template <int SHIFT>
+  static Vector RotateLeft(Vector v)
+  {
+    return _mm_or_si128(_mm_slli_epi32(v, SHIFT), _mm_srli_epi32(v, 32 - SHIFT));
+  }
+};
+using LanesSIMD = LanesSSE2;
+
+// Working state for N messages hashed with the SHA extensions. Interleaving two messages hides
+// most of the latency of SHA1RNDS4.
+template <size_t N>
+struct SHANIState
+{
+  __m128i abcd[N];
+  __m128i e[N];
+  __m128i previous_abcd[N];
+  __m128i msg[N][4];
+};
+
+template <size_t GROUP, size_t N>
+FUNCTION_TARGET_SHA static inline void RoundsSHANI(SHANIState<N>& s)
+{
+  for (size_t i = 0; i < N; ++i)
+  {
+    __m128i& msg = s.msg[i][GROUP % 4];
+    if constexpr (GROUP >= 4)
+    {
+      msg = _mm_sha1msg1_epu32(msg, s.msg[i][(GROUP + 1) % 4]);
+      msg = _mm_xor_si128(msg, s.msg[i][(GROUP + 2) % 4]);
+      msg = _mm_sha1msg2_epu32(msg, s.msg[i][(GROUP + 3) % 4]);
+    }
+
+    __m128i e;
+    if constexpr (GROUP == 0)
+      e = _mm_add_epi32(s.e[i], msg);
+    else
+      e = _mm_sha1nexte_epu32(s.previous_abcd[i], msg);
+    s.previous_abcd[i] = s.abcd[i];
+    s.abcd[i] = _mm_sha1rnds4_epu32(s.abcd[i], e, GROUP / 5);
+  }
+}
+
+template <size_t N, size_t... GROUPS>
+FUNCTION_TARGET_SHA static inline void AllRoundsSHANI(SHANIState<N>& s,
+                                                      std::index_sequence<GROUPS...>)
+{
+  (RoundsSHANI<GROUPS, N>(s), ...);
+}
+
+template <size_t N>
+FUNCTION_TARGET_SHA static void CompressSHANI(State* states, const u8* const* blocks,
+                                              size_t num_blocks)
+{
+  const __m128i byte_swap = _mm_set_epi64x(0x0001020304050607ULL, 0x08090a0b0c0d0e0fULL);
+
+  SHANIState<N> s;
+  for (size_t i = 0; i < N; ++i)
+  {
+    s.abcd[i] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(states[i].data()));
+    s.abcd[i] = _mm_shuffle_epi32(s.abcd[i], 0x1b);
+    s.e[i] = _mm_set_epi32(static_cast<int>(states[i][4]), 0, 0, 0);
+  }
+
+  for (size_t block = 0; block < num_blocks; ++block)
+  {
+    __m128i abcd_save[N];
+    __m128i e_save[N];
+    for (size_t i = 0; i < N; ++i)
+    {
+      abcd_save[i] = s.abcd[i];
+      e_save[i] = s.e[i];
+      const u8* src = blocks[i] + block * BLOCK_SIZE;
+      for (size_t j = 0; j < 4; ++j)
+      {
+        const __m128i msg = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + j * 16));
+        s.msg[i][j] = _mm_shuffle_epi8(msg, byte_swap);
+      }
+    }
+
+    AllRoundsSHANI(s, std::make_index_sequence<20>());
+
+    for (size_t i = 0; i < N; ++i)
+    {
+      s.e[i] = _mm_sha1nexte_epu32(s.previous_abcd[i], e_save[i]);
+      s.abcd[i] = _mm_add_epi32(s.abcd[i], abcd_save[i]);
+    }
+  }
+
+  for (size_t i = 0; i < N; ++i)
+  {
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(states[i].data()),
+                     _mm_shuffle_epi32(s.abcd[i], 0x1b));
+    states[i][4] = static_cast<u32>(_mm_extract_epi32(s.e[i], 3));
+  }
+}
+
+#endif  // _M_X86_64
+
+#ifdef _M_ARM_64
+
+struct LanesNEON
+{
+  using Vector = uint32x4_t;
+  static constexpr size_t COUNT = 4;
+
+  static Vector Set(u32 value) { return vdupq_n_u32(value); }
+  static Vector Load(const u32* src) { return vld1q_u32(src); }
+  static void Store(u32* dst, Vector v) { vst1q_u32(dst, v); }
+  static Vector Add(Vector a, Vector b) { return vaddq_u32(a, b); }
+  static Vector Xor(Vector a, Vector b) { return veorq_u32(a, b); }
+  static Vector And(Vector a, Vector b) { return vandq_u32(a, b); }
+  static Vector Or(Vector a, Vector b) { return vorrq_u32(a, b); }
+  template <int SHIFT>
+  static Vector RotateLeft(Vector v)
+  {
+    return vsriq_n_u32(vshlq_n_u32(v, SHIFT), v, 32 - SHIFT);
+  }
+};
+using LanesSIMD = LanesNEON;
+
+template <size_t GROUP>
+FUNCTION_TARGET_ARMV8_CRYPTO static inline void RoundsARMv8(uint32x4_t& abcd, u32& e,
+                                                            uint32x4_t* msg)
+{
+  uint32x4_t& w = msg[GROUP % 4];
+  if constexpr (GROUP >= 4)
+  {
+    w = vsha1su0q_u32(w, msg[(GROUP + 1) % 4], msg[(GROUP + 2) % 4]);
+    w = vsha1su1q_u32(w, msg[(GROUP + 3) % 4]);
+  }
+
+  const uint32x4_t wk = vaddq_u32(w, vdupq_n_u32(ROUND_CONSTANTS[GROUP / 5]));
+  const u32 next_e = vsha1h_u32(vgetq_lane_u32(abcd, 0));
+  if constexpr (GROUP / 5 == 0)
+    abcd = vsha1cq_u32(abcd, e, wk);
+  else if constexpr (GROUP / 5 == 2)
+    abcd = vsha1mq_u32(abcd, e, wk);
+  else
+    abcd = vsha1pq_u32(abcd, e, wk);
+  e = next_e;
+}
+
+template <size_t... GROUPS>
+FUNCTION_TARGET_ARMV8_CRYPTO static inline void AllRoundsARMv8(uint32x4_t& abcd, u32& e,
+                                                               uint32x4_t* msg,
+                                                               std::index_sequence<GROUPS...>)
+{
+  (RoundsARMv8<GROUPS>(abcd, e, msg), ...);
+}
+
+FUNCTION_TARGET_ARMV8_CRYPTO
+static void CompressARMv8(State* states, const u8* const* blocks, size_t num_blocks)
+{
+  uint32x4_t abcd = vld1q_u32(states[0].data());
+  u32 e = states[0][4];
+  const u8* src = blocks[0];
+
+  for (size_t block = 0; block < num_blocks; ++block)
+  {
+    const uint32x4_t abcd_save = abcd;
+    const u32 e_save = e;
+
+    uint32x4_t msg[4];
+    for (size_t j = 0; j < 4; ++j)
+      msg[j] = vreinterpretq_u32_u8(vrev32q_u8(vld1q_u8(src + block * BLOCK_SIZE + j * 16)));
+
+    AllRoundsARMv8(abcd, e, msg, std::make_index_sequence<20>());
+
+    abcd = vaddq_u32(abcd, abcd_save);
+    e += e_save;
+  }
+
+  vst1q_u32(states[0].data(), abcd);
+  states[0][4] = e;
+}
+
+#endif  // _M_ARM_64
+
+static Implementation GetBestImplementation()
+{
+  static const Implementation s_best = [] {
+    for (Implementation implementation : {Implementation::SHANI, Implementation::ARMv8})
+    {
+      if (IsSupported(implementation))
+        return implementation;
+    }
+    return Implementation::Generic;
+  }();
+  return s_best;
+}
+
+bool IsSupported(Implementation implementation)
+{
+  switch (implementation)
+  {
+  case Implementation::Best:
+  case Implementation::Generic:
+    return true;
+#if defined(_M_X86_64) || defined(_M_ARM_64)
+  case Implementation::MultiBuffer:
+    return true;
+#endif
+#ifdef _M_X86_64
+  case Implementation::SHANI:
+    return cpu_info.bSHA1 && cpu_info.bSSE4_1;
+#endif
+#ifdef _M_ARM_64
+  case Implementation::ARMv8:
+    return cpu_info.bSHA1;
+#endif
+  default:
+    return false;
+  }
+}
+
+const char* GetImplementationName(Implementation implementation)
+{
+  switch (implementation)
+  {
+  case Implementation::Best:
+    return GetImplementationName(GetBestImplementation());
+  case Implementation::Generic:
+    return "Generic";
+  case Implementation::MultiBuffer:
+    return "Multi-buffer SIMD";
+  case Implementation::SHANI:
+    return "SHA-NI";
+  case Implementation::ARMv8:
+    return "ARMv8";
+  }
+  return "Unknown";
+}
+
+std::unique_ptr<Context> CreateContext(Implementation implementation)
+{
+  if (implementation == Implementation::Best)
+    implementation = GetBestImplementation();
+  else if (!IsSupported(implementation))
+    return nullptr;
+
+  switch (implementation)
+  {
+#ifdef _M_X86_64
+  case Implementation::SHANI:
+    return std::make_unique<BlockContext>(CompressSHANI<1>);
+#endif
+#ifdef _M_ARM_64
+  case Implementation::ARMv8:
+    return std::make_unique<BlockContext>(CompressARMv8);
+#endif
+  default:
+    return std::make_unique<ContextGeneric>();
+  }
+}
+
+Digest CalculateDigest(const u8* msg, size_t len)
+{
+  Digest digest;
+  switch (GetBestImplementation())
+  {
+#ifdef _M_X86_64
+  case Implementation::SHANI:
+    HashMessages<1>(CompressSHANI<1>, msg, len, 1, digest.data());
+    break;
+#endif
+#ifdef _M_ARM_64
+  case Implementation::ARMv8:
+    HashMessages<1>(CompressARMv8, msg, len, 1, digest.data());
+    break;
+#endif
+  default:
+    mbedtls_sha1_ret(msg, len, digest.data());
+    break;
+  }
+  return digest;
+}
+
+void CalculateDigests(const u8* data, size_t size, size_t count, u8* digests,
+                      Implementation implementation)
+{
+  if (count == 0)
+    return;
+
+  if (implementation == Implementation::Best)
+  {
+    implementation = GetBestImplementation();
+    if (implementation == Implementation::Generic && IsSupported(Implementation::MultiBuffer))
+      implementation = Implementation::MultiBuffer;
+  }
+  else if (!IsSupported(implementation))
+  {
+    implementation = Implementation::Generic;
+  }
+
+  switch (implementation)
+  {
+#ifdef _M_X86_64
+  case Implementation::SHANI:
+    HashMessages<2>(CompressSHANI<2>, data, size, count, digests);
+    return;
+#endif
+#ifdef _M_ARM_64
+  case Implementation::ARMv8:
+    HashMessages<1>(CompressARMv8, data, size, count, digests);
+    return;
+#endif
+#if defined(_M_X86_64) || defined(_M_ARM_64)
+  case Implementation::MultiBuffer:
+    HashMessages<LanesSIMD::COUNT>(CompressLanes<LanesSIMD>, data, size, count, digests);
+    return;
+#endif
+  default:
+    for (size_t i = 0; i < count; ++i)
+      mbedtls_sha1_ret(data + i * size, size, digests + i * DIGEST_LEN);
+    return;
+  }
+}
+}  // namespace Common::SHA1
@@ -0,0 +1,52 @@
+// Copyright 2019 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <memory>
+
+#include "Common/CommonTypes.h"
+
+namespace Common::SHA1
+{
+constexpr size_t DIGEST_LEN = 20;
+using Digest = std::array<u8, DIGEST_LEN>;
+
+enum class Implementation
+{
+  // The fastest implementation supported by the host CPU.
+  Best,
+  // mbedtls, which works everywhere.
+  Generic,
+  // Plain SIMD, hashing one message per vector lane. Only used by CalculateDigests.
+  MultiBuffer,
+  // x86 SHA extensions.
+  SHANI,
+  // ARMv8 Cryptography Extensions.
+  ARMv8,
+};
+
+bool IsSupported(Implementation implementation);
+const char* GetImplementationName(Implementation implementation);
+
+class Context
+{
+public:
+  virtual ~Context() = default;
+  virtual void Update(const u8* msg, size_t len) = 0;
+  virtual Digest Finish() = 0;
+};
+
+std::unique_ptr<Context> CreateContext(Implementation implementation = Implementation::Best);
+
+Digest CalculateDigest(const u8* msg, size_t len);
+
+// Hashes <count> messages of <size> bytes each, which are stored back to back starting at <data>,
+// and writes their digests back to back to <digests>. This is the layout of the H0 hashes of a Wii
+// disc cluster. Where the CPU allows it, several messages are hashed at the same time.
+void CalculateDigests(const u8* data, size_t size, size_t count, u8* digests,
+                      Implementation implementation = Implementation::Best);
+}  // namespace Common::SHA1
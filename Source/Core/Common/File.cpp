@@ -2,16 +2,19 @@
 // Licensed under GPLv2+
 // Refer to the license.txt file included.
 
+#include <algorithm>
 #include <cstddef>
 #include <cstdio>
 #include <string>
 
 #ifdef _WIN32
 #include <io.h>
+#include <windows.h>
 
 #include "Common/CommonFuncs.h"
 #include "Common/StringUtil.h"
 #else
+#include <cerrno>
 #include <unistd.h>
 #endif
 
@@ -109,6 +112,44 @@ u64 IOFile::Tell() const
     return UINT64_MAX;
 }
 
+bool IOFile::ReadBytesAt(void* data, size_t length, u64 offset) const
+{
+  if (!IsOpen())
+    return false;
+
+  u8* out = static_cast<u8*>(data);
+#ifdef _WIN32
+  const HANDLE handle = reinterpret_cast<HANDLE>(_get_osfhandle(_fileno(m_file)));
+#endif
+  while (length > 0)
+  {
+#ifdef _WIN32
+    // An explicit offset in the OVERLAPPED struct makes ReadFile read from that offset. The handle
+    // isn't opened for overlapped I/O though, so this still moves the file pointer (which is why
+    // the other functions can't be used in the meantime), and Windows serializes concurrent
+    // reads of the same handle. Callers get correct results, but no parallelism.
+    OVERLAPPED overlapped{};
+    overlapped.Offset = static_cast<DWORD>(offset);
+    overlapped.OffsetHigh = static_cast<DWORD>(offset >> 32);
+    const DWORD to_read = static_cast<DWORD>(std::min<size_t>(length, 0x40000000));
+    DWORD bytes_read;
+    if (!ReadFile(handle, out, to_read, &bytes_read, &overlapped) || bytes_read == 0)
+      return false;
+#else
+    const ssize_t bytes_read = pread(fileno(m_file), out, length, static_cast<off_t>(offset));
+    if (bytes_read < 0 && errno == EINTR)
+      continue;
+    if (bytes_read <= 0)
+      return false;
+#endif
+    out += bytes_read;
+    offset += bytes_read;
+    length -= bytes_read;
+  }
+
+  return true;
+}
+
 bool IOFile::Flush()
 {
   if (!IsOpen() || 0 != std::fflush(m_file))
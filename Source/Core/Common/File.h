@@ -67,6 +67,11 @@ public:
     return WriteArray(reinterpret_cast<const char*>(data), length);
   }
 
+  // Reads from <offset> without going through the stdio buffer, and without affecting IsGood().
+  // Several threads can call this at the same time, as long as the file isn't also read or
+  // written with the other functions in the meantime. On Windows, such calls are run one at a time.
+  bool ReadBytesAt(void* data, size_t length, u64 offset) const;
+
   bool IsOpen() const { return nullptr != m_file; }
   // m_good is set to false when a read, write or other function fails
   bool IsGood() const { return m_good; }
@@ -11,6 +11,7 @@
 #include <limits.h>
 #include <string>
 #include <sys/stat.h>
+#include <utility>
 #include <vector>
 
 #include "Common/Assert.h"
@@ -104,6 +105,11 @@ u64 FileInfo::GetSize() const
   return IsFile() ? m_stat.st_size : 0;
 }
 
+s64 FileInfo::GetModificationTime() const
+{
+  return m_exists ? static_cast<s64>(m_stat.st_mtime) : 0;
+}
+
 // Returns true if the path exists
 bool Exists(const std::string& path)
 {
@@ -451,7 +457,7 @@ FSTEntry ScanDirectoryTree(const std::string& directory, bool recursive)
 
     ++parent_entry.size;
     // Push into the tree
-    parent_entry.children.push_back(entry);
+    parent_entry.children.push_back(std::move(entry));
 #ifdef _WIN32
   } while (FindNextFile(hFind, &ffd) != 0);
   FindClose(hFind);
@@ -0,0 +1,133 @@
+// Copyright 2019 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Common/CommonTypes.h"
+#include "Common/Thread.h"
+
+// A fixed set of threads which can run a function over a range of indices, for splitting up work
+// that has to be finished before the caller can continue.
+
+namespace Common
+{
+class WorkerPool
+{
+public:
+  // The calling thread always takes part in the work, so <num_threads> - 1 threads are created.
+  WorkerPool(size_t num_threads, std::string name) : m_name(std::move(name))
+  {
+    for (size_t i = 1; i < num_threads; ++i)
+      m_threads.emplace_back(&WorkerPool::ThreadLoop, this);
+  }
+
+  ~WorkerPool()
+  {
+    {
+      std::lock_guard lk(m_lock);
+      m_shutdown = true;
+    }
+    m_work_available.notify_all();
+    for (std::thread& thread : m_threads)
+      thread.join();
+  }
+
+  WorkerPool(const WorkerPool&) = delete;
+  WorkerPool& operator=(const WorkerPool&) = delete;
+
+  size_t GetThreadCount() const { return m_threads.size() + 1; }
+
+  // Calls function(i) for every i in [0, count), and returns once all calls have returned.
+  // The order in which indices are processed, and on which thread, is unspecified.
+  void ParallelFor(size_t count, const std::function<void(size_t)>& function)
+  {
+    if (m_threads.empty() || count <= 1)
+    {
+      for (size_t i = 0; i < count; ++i)
+        function(i);
+      return;
+    }
+
+    {
+      std::lock_guard lk(m_lock);
+      m_function = &function;
+      m_count = count;
+      m_next_index.store(0, std::memory_order_relaxed);
+      m_busy_threads = m_threads.size();
+      ++m_generation;
+    }
+    m_work_available.notify_all();
+
+    RunItems(function, count);
+
+    std::unique_lock lk(m_lock);
+    m_work_done.wait(lk, [this] { return m_busy_threads == 0; });
+    m_function = nullptr;
+  }
+
+private:
+  void RunItems(const std::function<void(size_t)>& function, size_t count)
+  {
+    while (true)
+    {
+      const size_t i = m_next_index.fetch_add(1, std::memory_order_relaxed);
+      if (i >= count)
+        break;
+      function(i);
+    }
+  }
+
+  void ThreadLoop()
+  {
+    Common::SetCurrentThreadName(m_name.c_str());
+
+    u64 generation = 0;
+    while (true)
+    {
+      const std::function<void(size_t)>* function;
+      size_t count;
+      {
+        std::unique_lock lk(m_lock);
+        m_work_available.wait(lk, [&] { return m_shutdown || m_generation != generation; });
+        if (m_shutdown)
+          return;
+        generation = m_generation;
+        function = m_function;
+        count = m_count;
+      }
+
+      RunItems(*function, count);
+
+      {
+        std::lock_guard lk(m_lock);
+        --m_busy_threads;
+      }
+      m_work_done.notify_one();
+    }
+  }
+
+  std::string m_name;
+  std::vector<std::thread> m_threads;
+
+  std::mutex m_lock;
+  std::condition_variable m_work_available;
+  std::condition_variable m_work_done;
+  const std::function<void(size_t)>* m_function = nullptr;
+  size_t m_count = 0;
+  size_t m_busy_threads = 0;
+  u64 m_generation = 0;
+  bool m_shutdown = false;
+  std::atomic<size_t> m_next_index{0};
+};
+
+}  // namespace Common
@@ -168,6 +168,14 @@ void CPUInfo::Detect()
         bBMI1 = true;
       if ((cpu_id[1] >> 8) & 1)
         bBMI2 = true;
+      if ((cpu_id[1] >> 29) & 1)
+      {
+        bSHA1 = true;
+        bSHA2 = true;
+      }
+      // The VAES code paths also use AVX2 integer instructions on the YMM registers
+      if ((cpu_id[2] >> 9) & 1)
+        bVAES = bAVX2;
     }
   }
 
@@ -266,6 +274,10 @@ std::string CPUInfo::Summarize()
     sum += ", FMA";
   if (bAES)
     sum += ", AES";
+  if (bVAES)
+    sum += ", VAES";
+  if (bSHA1)
+    sum += ", SHA";
   if (bMOVBE)
     sum += ", MOVBE";
   if (bLongMode)
@@ -25,6 +25,7 @@ const ConfigInfo<bool> MAIN_DSP_HLE{{System::Main, "Core", "DSPHLE"}, true};
 const ConfigInfo<int> MAIN_TIMING_VARIANCE{{System::Main, "Core", "TimingVariance"}, 40};
 const ConfigInfo<bool> MAIN_CPU_THREAD{{System::Main, "Core", "CPUThread"}, true};
 const ConfigInfo<bool> MAIN_SYNC_ON_SKIP_IDLE{{System::Main, "Core", "SyncOnSkipIdle"}, true};
+const ConfigInfo<bool> MAIN_TIMING_WHEEL{{System::Main, "Core", "TimingWheel"}, false};
 const ConfigInfo<std::string> MAIN_DEFAULT_ISO{{System::Main, "Core", "DefaultISO"}, ""};
 const ConfigInfo<bool> MAIN_ENABLE_CHEATS{{System::Main, "Core", "EnableCheats"}, false};
 const ConfigInfo<int> MAIN_GC_LANGUAGE{{System::Main, "Core", "SelectedLanguage"}, 0};
@@ -35,6 +36,10 @@ const ConfigInfo<int> MAIN_AUDIO_LATENCY{{System::Main, "Core", "AudioLatency"},
 const ConfigInfo<bool> MAIN_AUDIO_STRETCH{{System::Main, "Core", "AudioStretch"}, false};
 const ConfigInfo<int> MAIN_AUDIO_STRETCH_LATENCY{{System::Main, "Core", "AudioStretchMaxLatency"},
                                                  80};
+const ConfigInfo<bool> MAIN_AUDIO_ADAPTIVE_LATENCY{{System::Main, "Core", "AudioAdaptiveLatency"},
+                                                   false};
+const ConfigInfo<bool> MAIN_AUDIO_DISCRETE_SURROUND{
+    {System::Main, "Core", "AudioDiscreteSurround"}, false};
 const ConfigInfo<std::string> MAIN_MEMCARD_A_PATH{{System::Main, "Core", "MemcardAPath"}, ""};
 const ConfigInfo<std::string> MAIN_MEMCARD_B_PATH{{System::Main, "Core", "MemcardBPath"}, ""};
 const ConfigInfo<std::string> MAIN_AGP_CART_A_PATH{{System::Main, "Core", "AgpCartAPath"}, ""};
@@ -89,6 +94,14 @@ const ConfigInfo<int> MAIN_SYNC_GPU_MIN_DISTANCE{{System::Main, "Core", "SyncGpu
                                                  -200000};
 const ConfigInfo<float> MAIN_SYNC_GPU_OVERCLOCK{{System::Main, "Core", "SyncGpuOverclock"}, 1.0f};
 const ConfigInfo<bool> MAIN_FAST_DISC_SPEED{{System::Main, "Core", "FastDiscSpeed"}, false};
+const ConfigInfo<int> MAIN_WII_CLUSTER_CACHE_SIZE{{System::Main, "Core", "WiiClusterCacheSize"}, 8};
+const ConfigInfo<int> MAIN_WII_READ_AHEAD_CLUSTERS{{System::Main, "Core", "WiiReadAheadClusters"},
+                                                   4};
+const ConfigInfo<int> MAIN_BLOB_CACHE_SIZE{{System::Main, "Core", "BlobCacheSize"}, 8};
+const ConfigInfo<int> MAIN_BLOB_READ_QUEUE_DEPTH{{System::Main, "Core", "BlobReadQueueDepth"}, 4};
+const ConfigInfo<bool> MAIN_MAP_DISC_IMAGES{{System::Main, "Core", "MapDiscImages"}, false};
+const ConfigInfo<bool> MAIN_DVD_PREFETCH{{System::Main, "Core", "DVDPrefetch"}, true};
+const ConfigInfo<bool> MAIN_DVD_ACCESS_LOGS{{System::Main, "Core", "DVDAccessLogs"}, false};
 const ConfigInfo<bool> MAIN_LOW_DCBZ_HACK{{System::Main, "Core", "LowDCBZHack"}, false};
 const ConfigInfo<bool> MAIN_FPRF{{System::Main, "Core", "FPRF"}, false};
 const ConfigInfo<bool> MAIN_ACCURATE_NANS{{System::Main, "Core", "AccurateNaNs"}, false};
@@ -125,8 +138,10 @@ const ConfigInfo<bool> MAIN_DISABLE_SCREENSAVER{{System::Main, "Display", "Disab
 
 const ConfigInfo<bool> MAIN_DSP_CAPTURE_LOG{{System::Main, "DSP", "CaptureLog"}, false};
 const ConfigInfo<bool> MAIN_DSP_JIT{{System::Main, "DSP", "EnableJIT"}, true};
+const ConfigInfo<int> MAIN_DSP_HLE_VOICE_THREADS{{System::Main, "DSP", "HLEVoiceThreads"}, 1};
 const ConfigInfo<bool> MAIN_DUMP_AUDIO{{System::Main, "DSP", "DumpAudio"}, false};
 const ConfigInfo<bool> MAIN_DUMP_AUDIO_SILENT{{System::Main, "DSP", "DumpAudioSilent"}, false};
+const ConfigInfo<bool> MAIN_DUMP_AUDIO_FLAC{{System::Main, "DSP", "DumpAudioFLAC"}, false};
 const ConfigInfo<bool> MAIN_DUMP_UCODE{{System::Main, "DSP", "DumpUCode"}, false};
 const ConfigInfo<std::string> MAIN_AUDIO_BACKEND{{System::Main, "DSP", "Backend"},
                                                  AudioCommon::GetDefaultSoundBackend()};
@@ -27,6 +27,7 @@ extern const ConfigInfo<bool> MAIN_DSP_HLE;
 extern const ConfigInfo<int> MAIN_TIMING_VARIANCE;
 extern const ConfigInfo<bool> MAIN_CPU_THREAD;
 extern const ConfigInfo<bool> MAIN_SYNC_ON_SKIP_IDLE;
+extern const ConfigInfo<bool> MAIN_TIMING_WHEEL;
 extern const ConfigInfo<std::string> MAIN_DEFAULT_ISO;
 extern const ConfigInfo<bool> MAIN_ENABLE_CHEATS;
 extern const ConfigInfo<int> MAIN_GC_LANGUAGE;
@@ -35,6 +36,8 @@ extern const ConfigInfo<bool> MAIN_DPL2_DECODER;
 extern const ConfigInfo<int> MAIN_AUDIO_LATENCY;
 extern const ConfigInfo<bool> MAIN_AUDIO_STRETCH;
 extern const ConfigInfo<int> MAIN_AUDIO_STRETCH_LATENCY;
+extern const ConfigInfo<bool> MAIN_AUDIO_ADAPTIVE_LATENCY;
+extern const ConfigInfo<bool> MAIN_AUDIO_DISCRETE_SURROUND;
 extern const ConfigInfo<std::string> MAIN_MEMCARD_A_PATH;
 extern const ConfigInfo<std::string> MAIN_MEMCARD_B_PATH;
 extern const ConfigInfo<std::string> MAIN_AGP_CART_A_PATH;
@@ -64,6 +67,13 @@ extern const ConfigInfo<int> MAIN_SYNC_GPU_MAX_DISTANCE;
 extern const ConfigInfo<int> MAIN_SYNC_GPU_MIN_DISTANCE;
 extern const ConfigInfo<float> MAIN_SYNC_GPU_OVERCLOCK;
 extern const ConfigInfo<bool> MAIN_FAST_DISC_SPEED;
+extern const ConfigInfo<int> MAIN_WII_CLUSTER_CACHE_SIZE;
+extern const ConfigInfo<int> MAIN_WII_READ_AHEAD_CLUSTERS;
+extern const ConfigInfo<int> MAIN_BLOB_CACHE_SIZE;
+extern const ConfigInfo<int> MAIN_BLOB_READ_QUEUE_DEPTH;
+extern const ConfigInfo<bool> MAIN_MAP_DISC_IMAGES;
+extern const ConfigInfo<bool> MAIN_DVD_PREFETCH;
+extern const ConfigInfo<bool> MAIN_DVD_ACCESS_LOGS;
 extern const ConfigInfo<bool> MAIN_LOW_DCBZ_HACK;
 extern const ConfigInfo<bool> MAIN_FPRF;
 extern const ConfigInfo<bool> MAIN_ACCURATE_NANS;
@@ -82,8 +92,10 @@ extern const ConfigInfo<bool> MAIN_AUTO_DISC_CHANGE;
 
 extern const ConfigInfo<bool> MAIN_DSP_CAPTURE_LOG;
 extern const ConfigInfo<bool> MAIN_DSP_JIT;
+extern const ConfigInfo<int> MAIN_DSP_HLE_VOICE_THREADS;
 extern const ConfigInfo<bool> MAIN_DUMP_AUDIO;
 extern const ConfigInfo<bool> MAIN_DUMP_AUDIO_SILENT;
+extern const ConfigInfo<bool> MAIN_DUMP_AUDIO_FLAC;
 extern const ConfigInfo<bool> MAIN_DUMP_UCODE;
 extern const ConfigInfo<std::string> MAIN_AUDIO_BACKEND;
 extern const ConfigInfo<int> MAIN_AUDIO_VOLUME;
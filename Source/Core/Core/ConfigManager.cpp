@@ -209,6 +209,13 @@ void SConfig::SaveCoreSettings(IniFile& ini)
   core->Set("SyncGpuOverclock", fSyncGpuOverclock);
   core->Set("FPRF", bFPRF);
   core->Set("AccurateNaNs", bAccurateNaNs);
+  core->Set("WiiClusterCacheSize", m_wii_cluster_cache_size_mb);
+  core->Set("WiiReadAheadClusters", m_wii_read_ahead_clusters);
+  core->Set("BlobCacheSize", m_blob_cache_size_mb);
+  core->Set("BlobReadQueueDepth", m_blob_read_queue_depth);
+  core->Set("MapDiscImages", m_map_disc_images);
+  core->Set("DVDPrefetch", m_dvd_prefetch);
+  core->Set("DVDAccessLogs", m_dvd_access_logs);
   core->Set("EnableCheats", bEnableCheats);
   core->Set("SelectedLanguage", SelectedLanguage);
   core->Set("OverrideRegionSettings", bOverrideRegionSettings);
@@ -216,6 +223,8 @@ void SConfig::SaveCoreSettings(IniFile& ini)
   core->Set("AudioLatency", iLatency);
   core->Set("AudioStretch", m_audio_stretch);
   core->Set("AudioStretchMaxLatency", m_audio_stretch_max_latency);
+  core->Set("AudioAdaptiveLatency", m_audio_adaptive_latency);
+  core->Set("AudioDiscreteSurround", m_audio_discrete_surround);
   core->Set("AgpCartAPath", m_strGbaCartA);
   core->Set("AgpCartBPath", m_strGbaCartB);
   core->Set("SlotA", m_EXIDevice[0]);
@@ -263,6 +272,7 @@ void SConfig::SaveDSPSettings(IniFile& ini)
   dsp->Set("EnableJIT", m_DSPEnableJIT);
   dsp->Set("DumpAudio", m_DumpAudio);
   dsp->Set("DumpAudioSilent", m_DumpAudioSilent);
+  dsp->Set("DumpAudioFLAC", m_DumpAudioFLAC);
   dsp->Set("DumpUCode", m_DumpUCode);
   dsp->Set("Backend", sBackend);
   dsp->Set("Volume", m_Volume);
@@ -490,6 +500,8 @@ void SConfig::LoadCoreSettings(IniFile& ini)
   core->Get("AudioLatency", &iLatency, 20);
   core->Get("AudioStretch", &m_audio_stretch, false);
   core->Get("AudioStretchMaxLatency", &m_audio_stretch_max_latency, 80);
+  core->Get("AudioAdaptiveLatency", &m_audio_adaptive_latency, false);
+  core->Get("AudioDiscreteSurround", &m_audio_discrete_surround, false);
   core->Get("AgpCartAPath", &m_strGbaCartA);
   core->Get("AgpCartBPath", &m_strGbaCartB);
   core->Get("SlotA", (int*)&m_EXIDevice[0], ExpansionInterface::EXIDEVICE_MEMORYCARDFOLDER);
@@ -516,6 +528,13 @@ void SConfig::LoadCoreSettings(IniFile& ini)
   core->Get("SyncGpuMinDistance", &iSyncGpuMinDistance, -200000);
   core->Get("SyncGpuOverclock", &fSyncGpuOverclock, 1.0f);
   core->Get("FastDiscSpeed", &bFastDiscSpeed, false);
+  core->Get("WiiClusterCacheSize", &m_wii_cluster_cache_size_mb, 8);
+  core->Get("WiiReadAheadClusters", &m_wii_read_ahead_clusters, 4);
+  core->Get("BlobCacheSize", &m_blob_cache_size_mb, 8);
+  core->Get("BlobReadQueueDepth", &m_blob_read_queue_depth, 4);
+  core->Get("MapDiscImages", &m_map_disc_images, false);
+  core->Get("DVDPrefetch", &m_dvd_prefetch, true);
+  core->Get("DVDAccessLogs", &m_dvd_access_logs, false);
   core->Get("LowDCBZHack", &bLowDCBZHack, false);
   core->Get("FPRF", &bFPRF, false);
   core->Get("AccurateNaNs", &bAccurateNaNs, false);
@@ -549,6 +568,7 @@ void SConfig::LoadDSPSettings(IniFile& ini)
   dsp->Get("EnableJIT", &m_DSPEnableJIT, true);
   dsp->Get("DumpAudio", &m_DumpAudio, false);
   dsp->Get("DumpAudioSilent", &m_DumpAudioSilent, false);
+  dsp->Get("DumpAudioFLAC", &m_DumpAudioFLAC, false);
   dsp->Get("DumpUCode", &m_DumpUCode, false);
   dsp->Get("Backend", &sBackend, AudioCommon::GetDefaultSoundBackend());
   dsp->Get("Volume", &m_Volume, 100);
@@ -774,6 +794,13 @@ void SConfig::LoadDefaults()
   iBBDumpPort = -1;
   bSyncGPU = false;
   bFastDiscSpeed = false;
+  m_wii_cluster_cache_size_mb = 8;
+  m_wii_read_ahead_clusters = 4;
+  m_blob_cache_size_mb = 8;
+  m_blob_read_queue_depth = 4;
+  m_map_disc_images = false;
+  m_dvd_prefetch = true;
+  m_dvd_access_logs = false;
   bEnableMemcardSdWriting = true;
   SelectedLanguage = 0;
   bOverrideRegionSettings = false;
@@ -782,6 +809,8 @@ void SConfig::LoadDefaults()
   iLatency = 20;
   m_audio_stretch = false;
   m_audio_stretch_max_latency = 80;
+  m_audio_adaptive_latency = false;
+  m_audio_discrete_surround = false;
   bUsePanicHandlers = true;
   bOnScreenDisplayMessages = true;
 
@@ -124,6 +124,8 @@ struct SConfig
   int iLatency = 20;
   bool m_audio_stretch = false;
   int m_audio_stretch_max_latency = 80;
+  bool m_audio_adaptive_latency = false;
+  bool m_audio_discrete_surround = false;
 
   bool bRunCompareServer = false;
   bool bRunCompareClient = false;
@@ -132,6 +134,22 @@ struct SConfig
   bool bLowDCBZHack = false;
   int iBBDumpPort = 0;
   bool bFastDiscSpeed = false;
+  // Size of the cache of decrypted Wii disc clusters, and how many clusters are decrypted ahead
+  // of sequential reads
+  int m_wii_cluster_cache_size_mb = 8;
+  int m_wii_read_ahead_clusters = 4;
+  // Size of the block cache of compressed and drive disc images, and how many reads from the
+  // disc image file can be in flight at once
+  int m_blob_cache_size_mb = 8;
+  int m_blob_read_queue_depth = 4;
+  // Map uncompressed disc images into memory. Off by default, because an I/O error while reading
+  // from a mapping (for instance on a network share that goes away) can't be recovered from.
+  bool m_map_disc_images = false;
+  // Read ahead of sequential disc reads using idle time on the DVD thread
+  bool m_dvd_prefetch = true;
+  // Also record what gets read to a log in the cache directory, and read ahead of what earlier
+  // sessions with the same disc read. Off by default, since it writes a file for every game played.
+  bool m_dvd_access_logs = false;
 
   bool bSyncGPU = false;
   int iSyncGpuMaxDistance;
@@ -285,6 +303,7 @@ struct SConfig
   bool m_DSPCaptureLog;
   bool m_DumpAudio;
   bool m_DumpAudioSilent;
+  bool m_DumpAudioFLAC;
   bool m_IsMuted;
   bool m_DumpUCode;
   int m_Volume;
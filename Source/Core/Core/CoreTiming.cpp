@@ -5,7 +5,10 @@
 #include "Core/CoreTiming.h"
 
 #include <algorithm>
+#include <array>
+#include <chrono>
 #include <cinttypes>
+#include <memory>
 #include <mutex>
 #include <string>
 #include <unordered_map>
@@ -14,10 +17,12 @@
 #include "Common/Assert.h"
 #include "Common/ChunkFile.h"
 #include "Common/Logging/Log.h"
+#include "Common/MathUtil.h"
 #include "Common/SPSCQueue.h"
 #include "Common/StringUtil.h"
 #include "Common/Thread.h"
 
+#include "Core/Config/MainSettings.h"
 #include "Core/ConfigManager.h"
 #include "Core/Core.h"
 #include "Core/PowerPC/PowerPC.h"
@@ -31,6 +36,10 @@ struct EventType
 {
   TimedCallback callback;
   const std::string* name;
+
+  u64 fires;
+  u64 host_time_ns;
+  std::array<u64, EventTypeStats::LATENESS_BUCKETS> lateness_histogram;
 };
 
 struct Event
@@ -55,12 +64,251 @@ static bool operator<(const Event& left, const Event& right)
 // remain stable regardless of rehashes/resizing.
 static std::unordered_map<std::string, EventType> s_event_types;
 
-// STATE_TO_SAVE
+// Interface shared by the two event queue implementations. Both must return events in exactly
+// the same (time, fifo_order) order, since that order is observable by the emulated software.
+class EventQueue
+{
+public:
+  virtual ~EventQueue() = default;
+  virtual bool Empty() const = 0;
+  virtual void Push(const Event& ev) = 0;
+  // Returns the earliest event, or nullptr if the queue is empty.
+  virtual const Event* Peek() = 0;
+  // Removes the event returned by the last call to Peek().
+  virtual void Pop() = 0;
+  virtual void RemoveType(const EventType* type) = 0;
+  // Unordered copy of all pending events.
+  virtual std::vector<Event> GetEvents() const = 0;
+  // Replaces all pending events. The order of the input is irrelevant.
+  virtual void SetEvents(std::vector<Event> events) = 0;
+};
+
 // The queue is a min-heap using std::make_heap/push_heap/pop_heap.
 // We don't use std::priority_queue because we need to be able to serialize, unserialize and
 // erase arbitrary events (RemoveEvent()) regardless of the queue order. These aren't accomodated
 // by the standard adaptor class.
-static std::vector<Event> s_event_queue;
+class HeapEventQueue final : public EventQueue
+{
+public:
+  bool Empty() const override { return m_heap.empty(); }
+  void Push(const Event& ev) override
+  {
+    m_heap.push_back(ev);
+    std::push_heap(m_heap.begin(), m_heap.end(), std::greater<Event>());
+  }
+  const Event* Peek() override { return m_heap.empty() ? nullptr : &m_heap.front(); }
+  void Pop() override
+  {
+    std::pop_heap(m_heap.begin(), m_heap.end(), std::greater<Event>());
+    m_heap.pop_back();
+  }
+  void RemoveType(const EventType* type) override
+  {
+    auto itr = std::remove_if(m_heap.begin(), m_heap.end(),
+                              [&](const Event& e) { return e.type == type; });
+
+    // Removing random items breaks the invariant so we have to re-establish it.
+    if (itr != m_heap.end())
+    {
+      m_heap.erase(itr, m_heap.end());
+      std::make_heap(m_heap.begin(), m_heap.end(), std::greater<Event>());
+    }
+  }
+  std::vector<Event> GetEvents() const override { return m_heap; }
+  void SetEvents(std::vector<Event> events) override
+  {
+    m_heap = std::move(events);
+    std::make_heap(m_heap.begin(), m_heap.end(), std::greater<Event>());
+  }
+
+private:
+  std::vector<Event> m_heap;
+};
+
+// Hierarchical timing wheel. Each level has 256 slots and covers 8 more bits of time than the
+// level below it. An event is stored in the level of the highest bit in which its time differs
+// from m_now, so every event in a level 0 slot has exactly the same time. When the lower levels
+// run dry, the earliest non-empty slot of the next level is cascaded down. Events before m_now
+// (which can only happen after a cascade moved m_now ahead of the global timer) and events too
+// far away for the wheel are kept in small sorted side lists.
+class TimingWheelEventQueue final : public EventQueue
+{
+public:
+  bool Empty() const override { return m_size == 0; }
+
+  void Push(const Event& ev) override
+  {
+    ++m_size;
+    Insert(ev);
+  }
+
+  const Event* Peek() override
+  {
+    if (m_size == 0)
+      return nullptr;
+
+    if (!m_overdue.empty())
+    {
+      m_peeked_slot = &m_overdue;
+      m_peeked_index = 0;
+      return &m_overdue.front();
+    }
+
+    while (true)
+    {
+      int level = 0;
+      while (level < LEVELS && m_level_size[level] == 0)
+        ++level;
+
+      if (level == LEVELS)
+      {
+        // Everything is in the far list; restart the wheel at the earliest event.
+        std::vector<Event> far = std::move(m_far);
+        m_far.clear();
+        m_now = far.front().time;
+        for (const Event& ev : far)
+          Insert(ev);
+        continue;
+      }
+
+      const int shift = level * SLOT_BITS;
+      std::array<std::vector<Event>, SLOTS>& slots = m_levels[level];
+      // Level 0 events can be in the current slot, higher levels only in later ones.
+      size_t slot = ((m_now >> shift) & SLOT_MASK) + (level == 0 ? 0 : 1);
+      while (slots[slot].empty())
+        ++slot;
+
+      if (level == 0)
+      {
+        // Cascading can append events out of fifo order, so look for the first one.
+        const std::vector<Event>& events = slots[slot];
+        const auto it = std::min_element(events.begin(), events.end());
+        m_peeked_slot = &slots[slot];
+        m_peeked_index = static_cast<size_t>(it - events.begin());
+        return &*it;
+      }
+
+      const s64 upper_mask = ~((s64{1} << (shift + SLOT_BITS)) - 1);
+      m_now = (m_now & upper_mask) | (static_cast<s64>(slot) << shift);
+      std::vector<Event> events = std::move(slots[slot]);
+      slots[slot].clear();
+      m_level_size[level] -= events.size();
+      for (const Event& ev : events)
+        Insert(ev);
+    }
+  }
+
+  void Pop() override
+  {
+    std::vector<Event>& events = *m_peeked_slot;
+    events.erase(events.begin() + m_peeked_index);
+    if (m_peeked_slot != &m_overdue)
+      --m_level_size[0];
+    --m_size;
+  }
+
+  void RemoveType(const EventType* type) override
+  {
+    const auto matches = [&](const Event& e) { return e.type == type; };
+    const auto remove_from = [&](std::vector<Event>& events) {
+      const auto it = std::remove_if(events.begin(), events.end(), matches);
+      const size_t removed = static_cast<size_t>(events.end() - it);
+      events.erase(it, events.end());
+      m_size -= removed;
+      return removed;
+    };
+
+    remove_from(m_overdue);
+    remove_from(m_far);
+    for (int level = 0; level < LEVELS; ++level)
+    {
+      if (m_level_size[level] == 0)
+        continue;
+      for (std::vector<Event>& events : m_levels[level])
+        m_level_size[level] -= remove_from(events);
+    }
+  }
+
+  std::vector<Event> GetEvents() const override
+  {
+    std::vector<Event> result;
+    result.reserve(m_size);
+    result.insert(result.end(), m_overdue.begin(), m_overdue.end());
+    for (int level = 0; level < LEVELS; ++level)
+    {
+      if (m_level_size[level] == 0)
+        continue;
+      for (const std::vector<Event>& events : m_levels[level])
+        result.insert(result.end(), events.begin(), events.end());
+    }
+    result.insert(result.end(), m_far.begin(), m_far.end());
+    return result;
+  }
+
+  void SetEvents(std::vector<Event> events) override
+  {
+    m_overdue.clear();
+    m_far.clear();
+    for (int level = 0; level < LEVELS; ++level)
+    {
+      for (std::vector<Event>& slot : m_levels[level])
+        slot.clear();
+      m_level_size[level] = 0;
+    }
+
+    m_size = events.size();
+    if (events.empty())
+      return;
+
+    m_now = std::min_element(events.begin(), events.end())->time;
+    for (const Event& ev : events)
+      Insert(ev);
+  }
+
+private:
+  static constexpr int SLOT_BITS = 8;
+  static constexpr size_t SLOTS = size_t{1} << SLOT_BITS;
+  static constexpr s64 SLOT_MASK = SLOTS - 1;
+  static constexpr int LEVELS = 4;
+
+  static void InsertSorted(std::vector<Event>& events, const Event& ev)
+  {
+    events.insert(std::upper_bound(events.begin(), events.end(), ev), ev);
+  }
+
+  void Insert(const Event& ev)
+  {
+    if (ev.time < m_now)
+    {
+      InsertSorted(m_overdue, ev);
+      return;
+    }
+
+    const u64 diff = static_cast<u64>(ev.time ^ m_now);
+    const int level = diff == 0 ? 0 : IntLog2(diff) / SLOT_BITS;
+    if (level >= LEVELS)
+    {
+      InsertSorted(m_far, ev);
+      return;
+    }
+
+    m_levels[level][(ev.time >> (level * SLOT_BITS)) & SLOT_MASK].push_back(ev);
+    ++m_level_size[level];
+  }
+
+  std::array<std::array<std::vector<Event>, SLOTS>, LEVELS> m_levels;
+  std::array<size_t, LEVELS> m_level_size{};
+  std::vector<Event> m_overdue;
+  std::vector<Event> m_far;
+  s64 m_now = 0;
+  size_t m_size = 0;
+
+  std::vector<Event>* m_peeked_slot = nullptr;
+  size_t m_peeked_index = 0;
+};
+
+// STATE_TO_SAVE
+static std::unique_ptr<EventQueue> s_event_queue = std::make_unique<HeapEventQueue>();
 static u64 s_event_fifo_id;
 static std::mutex s_ts_write_lock;
 static Common::SPSCQueue<Event, false> s_ts_queue;
@@ -69,6 +317,7 @@ static float s_last_OC_factor;
 static constexpr int MAX_SLICE_LENGTH = 20000;
 
 static s64 s_idled_cycles;
+static bool s_collect_stats;
 static u32 s_fake_dec_start_value;
 static u64 s_fake_dec_start_ticks;
 
@@ -109,7 +358,7 @@ EventType* RegisterEvent(const std::string& name, TimedCallback callback)
              "during Init to avoid breaking save states.",
              name.c_str());
 
-  auto info = s_event_types.emplace(name, EventType{callback, nullptr});
+  auto info = s_event_types.emplace(name, EventType{callback, nullptr, 0, 0, {}});
   EventType* event_type = &info.first->second;
   event_type->name = &info.first->first;
   return event_type;
@@ -117,7 +366,7 @@ EventType* RegisterEvent(const std::string& name, TimedCallback callback)
 
 void UnregisterAllEvents()
 {
-  ASSERT_MSG(POWERPC, s_event_queue.empty(), "Cannot unregister events with events pending");
+  ASSERT_MSG(POWERPC, s_event_queue->Empty(), "Cannot unregister events with events pending");
   s_event_types.clear();
 }
 
@@ -138,6 +387,12 @@ void Init()
 
   s_event_fifo_id = 0;
   s_ev_lost = RegisterEvent("_lost_event", &EmptyTimedCallback);
+  s_collect_stats = false;
+
+  if (Config::Get(Config::MAIN_TIMING_WHEEL))
+    s_event_queue = std::make_unique<TimingWheelEventQueue>();
+  else
+    s_event_queue = std::make_unique<HeapEventQueue>();
 }
 
 void Shutdown()
@@ -165,7 +420,8 @@ void DoState(PointerWrap& p)
   p.DoMarker("CoreTimingData");
 
   MoveEvents();
-  p.DoEachElement(s_event_queue, [](PointerWrap& pw, Event& ev) {
+  std::vector<Event> events = s_event_queue->GetEvents();
+  p.DoEachElement(events, [](PointerWrap& pw, Event& ev) {
     pw.Do(ev.time);
     pw.Do(ev.fifo_order);
 
@@ -199,10 +455,10 @@ void DoState(PointerWrap& p)
   p.DoMarker("CoreTimingEvents");
 
   // When loading from a save state, we must assume the Event order is random and meaningless.
-  // The exact layout of the heap in memory is implementation defined, therefore it is platform
+  // The exact layout of the queue in memory is implementation defined, therefore it is platform
   // and library version specific.
   if (p.GetMode() == PointerWrap::MODE_READ)
-    std::make_heap(s_event_queue.begin(), s_event_queue.end(), std::greater<Event>());
+    s_event_queue->SetEvents(std::move(events));
 }
 
 // This should only be called from the CPU thread. If you are calling
@@ -225,7 +481,7 @@ u64 GetIdleTicks()
 
 void ClearPendingEvents()
 {
-  s_event_queue.clear();
+  s_event_queue->SetEvents({});
 }
 
 void ScheduleEvent(s64 cycles_into_future, EventType* event_type, u64 userdata, FromThread from)
@@ -253,8 +509,7 @@ void ScheduleEvent(s64 cycles_into_future, EventType* event_type, u64 userdata,
     if (!s_is_global_timer_sane)
       ForceExceptionCheck(cycles_into_future);
 
-    s_event_queue.emplace_back(Event{timeout, s_event_fifo_id++, userdata, event_type});
-    std::push_heap(s_event_queue.begin(), s_event_queue.end(), std::greater<Event>());
+    s_event_queue->Push(Event{timeout, s_event_fifo_id++, userdata, event_type});
   }
   else
   {
@@ -273,15 +528,7 @@ void ScheduleEvent(s64 cycles_into_future, EventType* event_type, u64 userdata,
 
 void RemoveEvent(EventType* event_type)
 {
-  auto itr = std::remove_if(s_event_queue.begin(), s_event_queue.end(),
-                            [&](const Event& e) { return e.type == event_type; });
-
-  // Removing random items breaks the invariant so we have to re-establish it.
-  if (itr != s_event_queue.end())
-  {
-    s_event_queue.erase(itr, s_event_queue.end());
-    std::make_heap(s_event_queue.begin(), s_event_queue.end(), std::greater<Event>());
-  }
+  s_event_queue->RemoveType(event_type);
 }
 
 void RemoveAllEvents(EventType* event_type)
@@ -307,11 +554,32 @@ void MoveEvents()
   for (Event ev; s_ts_queue.Pop(ev);)
   {
     ev.fifo_order = s_event_fifo_id++;
-    s_event_queue.emplace_back(std::move(ev));
-    std::push_heap(s_event_queue.begin(), s_event_queue.end(), std::greater<Event>());
+    s_event_queue->Push(ev);
   }
 }
 
+static void RunCallbackWithStats(const Event& evt)
+{
+  const s64 cycles_late = g.global_timer - evt.time;
+  const auto start = std::chrono::steady_clock::now();
+  evt.type->callback(evt.userdata, cycles_late);
+  const auto end = std::chrono::steady_clock::now();
+
+  EventType* type = evt.type;
+  type->fires++;
+  type->host_time_ns += static_cast<u64>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
+
+  // Bucket 0 is for events that ran on time, bucket n for lateness in [2^(n-1), 2^n) cycles.
+  size_t bucket = 0;
+  if (cycles_late > 0)
+  {
+    bucket = std::min<size_t>(IntLog2(static_cast<u64>(cycles_late)) + 1,
+                              EventTypeStats::LATENESS_BUCKETS - 1);
+  }
+  type->lateness_histogram[bucket]++;
+}
+
 void Advance()
 {
   MoveEvents();
@@ -324,23 +592,26 @@ void Advance()
 
   s_is_global_timer_sane = true;
 
-  while (!s_event_queue.empty() && s_event_queue.front().time <= g.global_timer)
+  const Event* next;
+  while ((next = s_event_queue->Peek()) && next->time <= g.global_timer)
   {
-    Event evt = std::move(s_event_queue.front());
-    std::pop_heap(s_event_queue.begin(), s_event_queue.end(), std::greater<Event>());
-    s_event_queue.pop_back();
+    Event evt = *next;
+    s_event_queue->Pop();
     // NOTICE_LOG(POWERPC, "[Scheduler] %-20s (%lld, %lld)", evt.type->name->c_str(),
     //            g.global_timer, evt.time);
-    evt.type->callback(evt.userdata, g.global_timer - evt.time);
+    if (s_collect_stats)
+      RunCallbackWithStats(evt);
+    else
+      evt.type->callback(evt.userdata, g.global_timer - evt.time);
   }
 
   s_is_global_timer_sane = false;
 
   // Still events left (scheduled in the future)
-  if (!s_event_queue.empty())
+  if (next)
   {
-    g.slice_length = static_cast<int>(
-        std::min<s64>(s_event_queue.front().time - g.global_timer, MAX_SLICE_LENGTH));
+    g.slice_length =
+        static_cast<int>(std::min<s64>(next->time - g.global_timer, MAX_SLICE_LENGTH));
   }
 
   PowerPC::ppcState.downcount = CyclesToDowncount(g.slice_length);
@@ -354,7 +625,7 @@ void Advance()
 
 void LogPendingEvents()
 {
-  auto clone = s_event_queue;
+  auto clone = s_event_queue->GetEvents();
   std::sort(clone.begin(), clone.end());
   for (const Event& ev : clone)
   {
@@ -366,11 +637,13 @@ void LogPendingEvents()
 // Should only be called from the CPU thread after the PPC clock has changed
 void AdjustEventQueueTimes(u32 new_ppc_clock, u32 old_ppc_clock)
 {
-  for (Event& ev : s_event_queue)
+  std::vector<Event> events = s_event_queue->GetEvents();
+  for (Event& ev : events)
   {
     const s64 ticks = (ev.time - g.global_timer) * new_ppc_clock / old_ppc_clock;
     ev.time = g.global_timer + ticks;
   }
+  s_event_queue->SetEvents(std::move(events));
 }
 
 void Idle()
@@ -392,7 +665,7 @@ std::string GetScheduledEventsSummary()
   std::string text = "Scheduled events\n";
   text.reserve(1000);
 
-  auto clone = s_event_queue;
+  auto clone = s_event_queue->GetEvents();
   std::sort(clone.begin(), clone.end());
   for (const Event& ev : clone)
   {
@@ -402,6 +675,40 @@ std::string GetScheduledEventsSummary()
   return text;
 }
 
+void SetStatsEnabled(bool enabled)
+{
+  s_collect_stats = enabled;
+}
+
+bool AreStatsEnabled()
+{
+  return s_collect_stats;
+}
+
+std::vector<EventTypeStats> GetEventTypeStats()
+{
+  std::vector<EventTypeStats> stats;
+  stats.reserve(s_event_types.size());
+  for (const auto& entry : s_event_types)
+  {
+    const EventType& type = entry.second;
+    stats.push_back({entry.first, type.fires, type.host_time_ns, type.lateness_histogram});
+  }
+  std::sort(stats.begin(), stats.end(),
+            [](const EventTypeStats& a, const EventTypeStats& b) { return a.name < b.name; });
+  return stats;
+}
+
+void ResetEventTypeStats()
+{
+  for (auto& entry : s_event_types)
+  {
+    entry.second.fires = 0;
+    entry.second.host_time_ns = 0;
+    entry.second.lateness_histogram = {};
+  }
+}
+
 u32 GetFakeDecStartValue()
 {
   return s_fake_dec_start_value;
@@ -17,7 +17,10 @@
 // inside callback:
 //   ScheduleEvent(periodInCycles - cyclesLate, callback, "whatever")
 
+#include <array>
 #include <string>
+#include <vector>
+
 #include "Common/CommonTypes.h"
 
 class PointerWrap;
@@ -97,6 +100,25 @@ std::string GetScheduledEventsSummary();
 
 void AdjustEventQueueTimes(u32 new_ppc_clock, u32 old_ppc_clock);
 
+// Per event type profiling data. Only collected while enabled, since timing each callback
+// isn't free.
+struct EventTypeStats
+{
+  static constexpr size_t LATENESS_BUCKETS = 16;
+
+  std::string name;
+  u64 fires;
+  u64 host_time_ns;
+  // Bucket 0 counts events that ran on time, bucket n (n > 0) events that ran between
+  // 2^(n-1) and 2^n - 1 cycles late. The last bucket also counts everything later than that.
+  std::array<u64, LATENESS_BUCKETS> lateness_histogram;
+};
+
+void SetStatsEnabled(bool enabled);
+bool AreStatsEnabled();
+std::vector<EventTypeStats> GetEventTypeStats();
+void ResetEventTypeStats();
+
 u32 GetFakeDecStartValue();
 void SetFakeDecStartValue(u32 val);
 u64 GetFakeDecStartTicks();
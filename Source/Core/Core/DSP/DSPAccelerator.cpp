@@ -3,6 +3,7 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
+#include <array>
 
 #include "Core/DSP/DSPAccelerator.h"
 
@@ -154,6 +155,7 @@ u16 Accelerator::Read(const s16* coefs)
     // Set address back to start address.
     m_current_address = m_start_address;
     m_reads_stopped = true;
+    m_end_exception_raised = true;
     OnEndException();
   }
 
@@ -161,6 +163,124 @@ u16 Accelerator::Read(const s16* coefs)
   return val;
 }
 
+u32 Accelerator::ReadSamples(const s16* coefs, s16* samples, u32 count)
+{
+  u32 i = 0;
+  while (i < count)
+  {
+    const u32 decoded = m_reads_stopped ? 0 : DecodeRun(coefs, samples + i, count - i);
+    if (decoded != 0)
+    {
+      i += decoded;
+      continue;
+    }
+
+    m_end_exception_raised = false;
+    samples[i++] = static_cast<s16>(Read(coefs));
+    if (m_end_exception_raised)
+      break;
+  }
+  return i;
+}
+
+// Decodes up to <max_count> samples with a single memory access and without any of the checks
+// Read() does for each sample. Returns 0 if the next sample needs the full Read() logic.
+//
+// Read() masks the current address after every sample. A run stays below the end address, which
+// is itself masked to 30 bits, so masking only once at the end of the run gives the
+// same addresses. A current address above the end address (such as one with bit 31 set) never
+// starts a run.
+u32 Accelerator::DecodeRun(const s16* coefs, s16* samples, u32 max_count)
+{
+  switch (m_sample_format)
+  {
+  case 0x00:  // ADPCM audio
+  {
+    // Only decode up to the end of the current frame. None of the addresses we go through
+    // (including the one after the next frame header) may reach end_address - 1, as that would
+    // trigger either looping or the end exception.
+    const u32 frame_pos = m_current_address & 15;
+    if (frame_pos < 2 || m_current_address >= m_end_address)
+      return 0;
+    const u32 count = std::min(max_count, 16 - frame_pos);
+    if (m_end_address - m_current_address <= count + 3)
+      return 0;
+
+    // The nibbles to decode, and the header of the next frame if we reach it.
+    const u32 first_byte = m_current_address >> 1;
+    const bool frame_end = ((m_current_address + count) & 15) == 0;
+    const u32 size = ((m_current_address + count - 1) >> 1) - first_byte + 1 + (frame_end ? 1 : 0);
+    std::array<u8, 9> data;
+    ReadMemoryBlock(first_byte, data.data(), size);
+
+    const int scale = 1 << (m_pred_scale & 0xF);
+    const int coef_idx = (m_pred_scale >> 4) & 0x7;
+    const s32 coef1 = coefs[coef_idx * 2 + 0];
+    const s32 coef2 = coefs[coef_idx * 2 + 1];
+
+    for (u32 i = 0; i < count; ++i)
+    {
+      const u32 address = m_current_address + i;
+      const u8 byte = data[(address >> 1) - first_byte];
+      int temp = (address & 1) ? (byte & 0xF) : (byte >> 4);
+      if (temp >= 8)
+        temp -= 16;
+
+      const s32 val32 = (scale * temp) + ((0x400 + coef1 * m_yn1 + coef2 * m_yn2) >> 11);
+      const s16 val = static_cast<s16>(std::clamp<s32>(val32, -0x7FFF, 0x7FFF));
+      m_yn2 = m_yn1;
+      m_yn1 = val;
+      samples[i] = val;
+    }
+
+    u32 address = m_current_address + count;
+    if (frame_end)
+    {
+      m_pred_scale = data[size - 1];
+      address += 2;
+    }
+    SetCurrentAddress(address);
+    return count;
+  }
+  case 0x0A:  // 16-bit PCM audio
+  case 0x19:  // 8-bit PCM audio
+  {
+    // Reading the sample at end_address triggers looping or the end exception.
+    constexpr u32 MAX_RUN = 64;
+    if (m_current_address >= m_end_address)
+      return 0;
+    const u32 count = std::min({max_count, m_end_address - m_current_address, MAX_RUN});
+
+    std::array<u8, MAX_RUN * 2> data;
+    if (m_sample_format == 0x0A)
+    {
+      ReadMemoryBlock(m_current_address * 2, data.data(), count * 2);
+      for (u32 i = 0; i < count; ++i)
+        samples[i] = static_cast<s16>((data[i * 2] << 8) | data[i * 2 + 1]);
+    }
+    else
+    {
+      ReadMemoryBlock(m_current_address, data.data(), count);
+      for (u32 i = 0; i < count; ++i)
+        samples[i] = static_cast<s16>(data[i] << 8);
+    }
+
+    m_yn2 = count >= 2 ? samples[count - 2] : m_yn1;
+    m_yn1 = samples[count - 1];
+    SetCurrentAddress(m_current_address + count);
+    return count;
+  }
+  default:
+    return 0;
+  }
+}
+
+void Accelerator::ReadMemoryBlock(u32 address, u8* data, u32 size)
+{
+  for (u32 i = 0; i < size; ++i)
+    data[i] = ReadMemory(address + i);
+}
+
 void Accelerator::DoState(PointerWrap& p)
 {
   p.Do(m_start_address);
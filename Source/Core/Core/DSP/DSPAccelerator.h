@@ -16,6 +16,11 @@ public:
   virtual ~Accelerator() = default;
 
   u16 Read(const s16* coefs);
+  // Reads up to <count> samples, with the same results as calling Read() that many times, but
+  // decoding runs of samples which can't reach the end address in one go. Stops after a sample
+  // which raised the end exception, so that the caller can act on it. Returns how many samples
+  // were read (at least one, if count isn't 0).
+  u32 ReadSamples(const s16* coefs, s16* samples, u32 count);
   // Zelda ucode reads ARAM through 0xffd3.
   u16 ReadD3();
   void WriteD3(u16 value);
@@ -41,6 +46,9 @@ protected:
   virtual void OnEndException() = 0;
   virtual u8 ReadMemory(u32 address) = 0;
   virtual void WriteMemory(u32 address, u8 value) = 0;
+  // Reads <size> consecutive bytes, for ReadSamples. Override this if memory can be accessed
+  // faster than one ReadMemory call per byte.
+  virtual void ReadMemoryBlock(u32 address, u8* data, u32 size);
 
   // DSP accelerator registers.
   u32 m_start_address = 0;
@@ -55,5 +63,11 @@ protected:
   // and updating the current address register, unless the YN2 register is written to.
   // This is kept track of internally; this state is not exposed via any register.
   bool m_reads_stopped = false;
+
+private:
+  u32 DecodeRun(const s16* coefs, s16* samples, u32 max_count);
+
+  // Set by Read() when it raises the end exception. Only used by ReadSamples.
+  bool m_end_exception_raised = false;
 };
 }  // namespace DSP
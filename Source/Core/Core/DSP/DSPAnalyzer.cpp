@@ -67,6 +67,11 @@ constexpr u16 idle_skip_sigs[NUM_IDLE_SIGS][MAX_IDLE_SIG_SIZE + 1] = {
      0x0295, 0xFFFF,  // JZ    0x????
      0, 0}};
 
+// Whether each of the loops above polls a mailbox, rather than DRAM (which the DSP's own
+// exception handlers or DMA can change without the CPU doing anything).
+constexpr bool idle_sig_polls_mailbox[NUM_IDLE_SIGS] = {true, true, true, true,
+                                                        true, true, true, false};
+
 void Reset()
 {
   code_flags.fill(0);
@@ -146,6 +151,8 @@ void AnalyzeRange(u16 start_addr, u16 end_addr)
       {
         INFO_LOG(DSPLLE, "Idle skip location found at %02x (sigNum:%zu)", addr, s + 1);
         code_flags[addr] |= CODE_IDLE_SKIP;
+        if (idle_sig_polls_mailbox[s])
+          code_flags[addr] |= CODE_MAILBOX_POLL;
       }
     }
   }
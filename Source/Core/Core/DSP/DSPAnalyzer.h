@@ -20,6 +20,8 @@ enum
   CODE_LOOP_END = 8,
   CODE_UPDATE_SR = 16,
   CODE_CHECK_INT = 32,
+  // An idle skip location whose loop only waits for a mailbox, which only the CPU can change
+  CODE_MAILBOX_POLL = 64,
 };
 
 // This one should be called every time IRAM changes - which is basically
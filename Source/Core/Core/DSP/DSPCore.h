@@ -279,6 +279,9 @@ struct SDSP
   u8 exceptions;  // pending exceptions
   volatile bool external_interrupt_waiting;
   bool reset_dspjit_codespace;
+  // Set by the JIT when the DSP went around a mailbox polling loop without finding anything to do,
+  // i.e. when polling a mailbox the CPU hasn't written yet.
+  bool idle_waiting;
 
   // DSP hardware stacks. They're mapped to a bunch of registers, such that writes
   // to them push and reads pop.
@@ -404,6 +404,8 @@ static void gdsp_do_dma()
             g_dsp.pc, ctl, addr, dsp_addr, len);
 #endif
 
+  Host::PrepareMemoryAccess();
+
   const u8* copied_data_ptr = nullptr;
   switch (ctl & 0x3)
   {
@@ -17,6 +17,8 @@ namespace DSP::Host
 {
 u8 ReadHostMemory(u32 addr);
 void WriteHostMemory(u8 value, u32 addr);
+// Called before the DSP accesses main memory through DMA.
+void PrepareMemoryAccess();
 void OSD_AddMessage(std::string str, u32 ms);
 bool OnThread();
 bool IsWiiHost();
@@ -58,6 +58,7 @@ u16 DSPEmitter::RunCycles(u16 cycles)
     DSPCore_SetExternalInterrupt(false);
   }
 
+  g_dsp.idle_waiting = false;
   m_cycles_left = cycles;
   auto exec_addr = (DSPCompiledCode)m_enter_dispatcher;
   exec_addr();
@@ -75,12 +76,15 @@ void DSPEmitter::DoState(PointerWrap& p)
 
 void DSPEmitter::ClearIRAM()
 {
+  // The code space only gets reset once the current slice is over, so make sure none of the
+  // remaining blocks jump into stale code for the old IRAM contents until then.
+  UnlinkBlocks();
+
   for (size_t i = 0; i < DSP_IRAM_SIZE; i++)
   {
     m_blocks[i] = (DSPCompiledCode)m_stub_entry_point;
     m_block_links[i] = nullptr;
     m_block_size[i] = 0;
-    m_unresolved_jumps[i].clear();
   }
   g_dsp.reset_dspjit_codespace = true;
 }
@@ -96,7 +100,7 @@ void DSPEmitter::ClearIRAMandDSPJITCodespaceReset()
     m_blocks[i] = (DSPCompiledCode)m_stub_entry_point;
     m_block_links[i] = nullptr;
     m_block_size[i] = 0;
-    m_unresolved_jumps[i].clear();
+    m_link_jumps[i].clear();
   }
   g_dsp.reset_dspjit_codespace = false;
 }
@@ -212,7 +216,6 @@ void DSPEmitter::Compile(u16 start_addr)
 {
   // Remember the current block address for later
   m_start_address = start_addr;
-  m_unresolved_jumps[start_addr].clear();
 
   const u8* entryPoint = AlignCode16();
 
@@ -237,9 +240,6 @@ void DSPEmitter::Compile(u16 start_addr)
     m_block_size[start_addr]++;
     m_compile_pc += opcode->size;
 
-    // If the block was trying to link into itself, remove the link
-    m_unresolved_jumps[start_addr].remove(m_compile_pc);
-
     fixup_pc = true;
 
     // Handle loop condition, only if current instruction was flagged as a loop destination
@@ -324,37 +324,6 @@ void DSPEmitter::Compile(u16 start_addr)
     }
   }
 
-  if (fixup_pc)
-  {
-    MOV(16, M_SDSP_pc(), Imm16(m_compile_pc));
-  }
-
-  m_blocks[start_addr] = (DSPCompiledCode)entryPoint;
-
-  // Mark this block as a linkable destination if it does not contain
-  // any unresolved CALL's
-  if (m_unresolved_jumps[start_addr].empty())
-  {
-    m_block_links[start_addr] = m_block_link_entry;
-
-    for (size_t i = 0; i < 0xffff; ++i)
-    {
-      if (!m_unresolved_jumps[i].empty())
-      {
-        // Check if there were any blocks waiting for this block to be linkable
-        size_t size = m_unresolved_jumps[i].size();
-        m_unresolved_jumps[i].remove(start_addr);
-        if (m_unresolved_jumps[i].size() < size)
-        {
-          // Mark the block to be recompiled again
-          m_blocks[i] = (DSPCompiledCode)m_stub_entry_point;
-          m_block_links[i] = nullptr;
-          m_block_size[i] = 0;
-        }
-      }
-    }
-  }
-
   if (m_block_size[start_addr] == 0)
   {
     // just a safeguard, should never happen anymore.
@@ -363,6 +332,16 @@ void DSPEmitter::Compile(u16 start_addr)
     m_block_size[start_addr] = 1;
   }
 
+  if (fixup_pc)
+  {
+    // The block didn't end with a branch, so carry on straight into the next one.
+    WriteLinkJump(m_compile_pc);
+    MOV(16, M_SDSP_pc(), Imm16(m_compile_pc));
+  }
+
+  m_blocks[start_addr] = (DSPCompiledCode)entryPoint;
+  LinkBlock(start_addr);
+
   m_gpr.SaveRegs();
   if (!Host::OnThread() && Analyzer::GetCodeFlags(start_addr) & Analyzer::CODE_IDLE_SKIP)
   {
@@ -378,23 +357,6 @@ void DSPEmitter::Compile(u16 start_addr)
 void DSPEmitter::CompileCurrent(DSPEmitter& emitter)
 {
   emitter.Compile(g_dsp.pc);
-
-  bool retry = true;
-
-  while (retry)
-  {
-    retry = false;
-    for (size_t i = 0; i < 0xffff; ++i)
-    {
-      if (!emitter.m_unresolved_jumps[i].empty())
-      {
-        const u16 address_to_compile = emitter.m_unresolved_jumps[i].front();
-        emitter.Compile(address_to_compile);
-        if (!emitter.m_unresolved_jumps[i].empty())
-          retry = true;
-      }
-    }
-  }
 }
 
 const u8* DSPEmitter::CompileStub()
@@ -473,6 +435,11 @@ Gen::OpArg DSPEmitter::M_SDSP_external_interrupt_waiting()
   return MDisp(R15, static_cast<int>(offsetof(SDSP, external_interrupt_waiting)));
 }
 
+Gen::OpArg DSPEmitter::M_SDSP_idle_waiting()
+{
+  return MDisp(R15, static_cast<int>(offsetof(SDSP, idle_waiting)));
+}
+
 Gen::OpArg DSPEmitter::M_SDSP_r_st(size_t index)
 {
   return MDisp(R15, static_cast<int>(offsetof(SDSP, r.st[index])));
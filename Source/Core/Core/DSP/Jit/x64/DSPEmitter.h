@@ -6,7 +6,6 @@
 
 #include <array>
 #include <cstddef>
-#include <list>
 #include <vector>
 
 #include "Common/CommonTypes.h"
@@ -210,6 +209,9 @@ private:
 
   void WriteBranchExit();
   void WriteBlockLink(u16 dest);
+  void WriteLinkJump(u16 dest);
+  void LinkBlock(u16 start_addr);
+  void UnlinkBlocks();
 
   void ReJitConditional(UDSPInstruction opc, void (DSPEmitter::*conditional_fn)(UDSPInstruction));
   void r_jcc(UDSPInstruction opc);
@@ -282,6 +284,7 @@ private:
   Gen::OpArg M_SDSP_exceptions();
   Gen::OpArg M_SDSP_cr();
   Gen::OpArg M_SDSP_external_interrupt_waiting();
+  Gen::OpArg M_SDSP_idle_waiting();
   Gen::OpArg M_SDSP_r_st(size_t index);
   Gen::OpArg M_SDSP_reg_stack_ptr(size_t index);
 
@@ -309,7 +312,15 @@ private:
   std::vector<Block> m_block_links;
   Block m_block_link_entry;
 
-  std::array<std::list<u16>, MAX_BLOCKS> m_unresolved_jumps;
+  // A jump from one block directly into another. Until the destination block is compiled, the
+  // jump goes to code which exits to the dispatcher instead.
+  struct LinkJump
+  {
+    u8* jump;
+    const u8* exit;
+  };
+  // The link jumps into each block, by destination address.
+  std::array<std::vector<LinkJump>, MAX_BLOCKS> m_link_jumps;
 
   u16 m_cycles_left = 0;
 
@@ -98,40 +98,73 @@ void DSPEmitter::WriteBranchExit()
 
 void DSPEmitter::WriteBlockLink(u16 dest)
 {
-  // Jump directly to the called block if it has already been compiled.
+  // Branches back into the current block go through the dispatcher.
   if (!(dest >= m_start_address && dest <= m_compile_pc))
+    WriteLinkJump(dest);
+}
+
+void DSPEmitter::WriteLinkJump(u16 dest)
+{
+  m_gpr.FlushRegs();
+  // Check if we have enough cycles left to run another block, like the dispatcher would
+  MOV(64, R(RAX), ImmPtr(&m_cycles_left));
+  MOV(16, R(ECX), MatR(RAX));
+  CMP(16, R(ECX), Imm16(m_block_size[m_start_address]));
+  FixupBranch notEnoughCycles = J_CC(CC_BE);
+
+  SUB(16, R(ECX), Imm16(m_block_size[m_start_address]));
+  MOV(16, MatR(RAX), R(ECX));
+  u8* jump = GetWritableCodePtr();
+  JMP(GetCodePtr(), true);
+
+  // While the destination isn't compiled, give the cycles back and exit to the dispatcher.
+  const u8* exit = GetCodePtr();
+  ADD(16, MatR(RAX), Imm16(m_block_size[m_start_address]));
+  SetJumpTarget(notEnoughCycles);
+
+  XEmitter emitter(jump);
+  emitter.JMP(m_block_links[dest] ? m_block_links[dest] : exit, true);
+  m_link_jumps[dest].push_back({jump, exit});
+}
+
+// Points the link jumps into a newly compiled block at it.
+void DSPEmitter::LinkBlock(u16 start_addr)
+{
+  m_block_links[start_addr] = m_block_link_entry;
+  for (const LinkJump& link : m_link_jumps[start_addr])
   {
-    if (m_block_links[dest] != nullptr)
-    {
-      m_gpr.FlushRegs();
-      // Check if we have enough cycles to execute the next block
-      MOV(64, R(RAX), ImmPtr(&m_cycles_left));
-      MOV(16, R(ECX), MatR(RAX));
-      CMP(16, R(ECX), Imm16(m_block_size[m_start_address] + m_block_size[dest]));
-      FixupBranch notEnoughCycles = J_CC(CC_BE);
-
-      SUB(16, R(ECX), Imm16(m_block_size[m_start_address]));
-      MOV(16, MatR(RAX), R(ECX));
-      JMP(m_block_links[dest], true);
-      SetJumpTarget(notEnoughCycles);
-    }
-    else
+    XEmitter emitter(link.jump);
+    emitter.JMP(m_block_link_entry, true);
+  }
+}
+
+void DSPEmitter::UnlinkBlocks()
+{
+  for (std::vector<LinkJump>& links : m_link_jumps)
+  {
+    for (const LinkJump& link : links)
     {
-      // The destination has not been compiled yet.  Add it to the list
-      // of blocks that this block is waiting on.
-      m_unresolved_jumps[m_start_address].push_back(dest);
+      XEmitter emitter(link.jump);
+      emitter.JMP(link.exit, true);
     }
+    links.clear();
   }
 }
 
 void DSPEmitter::r_jcc(const UDSPInstruction opc)
 {
   u16 dest = dsp_imem_read(m_compile_pc + 1);
-  const DSPOPCTemplate* opcode = GetOpTemplate(opc);
 
-  // If the block is unconditional, attempt to link block
-  if (opcode->uncond_branch)
-    WriteBlockLink(dest);
+  // A mailbox poll going around again hasn't found anything to do. Let the DSP be parked until the
+  // CPU does something that could change that. Loops polling anything else aren't parked, since
+  // the DSP may be the one to end them.
+  if (dest == m_start_address &&
+      (Analyzer::GetCodeFlags(m_start_address) & Analyzer::CODE_MAILBOX_POLL))
+  {
+    MOV(8, M_SDSP_idle_waiting(), Imm8(1));
+  }
+
+  WriteBlockLink(dest);
   MOV(16, M_SDSP_pc(), Imm16(dest));
   WriteBranchExit();
 }
@@ -173,11 +206,7 @@ void DSPEmitter::r_call(const UDSPInstruction opc)
   MOV(16, R(DX), Imm16(m_compile_pc + 2));
   dsp_reg_store_stack(StackRegister::Call);
   u16 dest = dsp_imem_read(m_compile_pc + 1);
-  const DSPOPCTemplate* opcode = GetOpTemplate(opc);
-
-  // If the block is unconditional, attempt to link block
-  if (opcode->uncond_branch)
-    WriteBlockLink(dest);
+  WriteBlockLink(dest);
   MOV(16, M_SDSP_pc(), Imm16(dest));
   WriteBranchExit();
 }
@@ -24,6 +24,8 @@
 
 #include "Core/HW/DSP.h"
 
+#include <algorithm>
+#include <cstring>
 #include <memory>
 
 #include "AudioCommon/AudioCommon.h"
@@ -34,6 +36,7 @@
 #include "Core/CoreTiming.h"
 #include "Core/DSPEmulator.h"
 
+#include "Core/HW/DSPLLE/DSPLLE.h"
 #include "Core/HW/MMIO.h"
 #include "Core/HW/Memmap.h"
 #include "Core/HW/ProcessorInterface.h"
@@ -474,13 +477,19 @@ void UpdateAudioDMA()
 
 static void Do_ARAM_DMA()
 {
+  // In deterministic mode, the DSP has to be done with everything it's supposed to do before the
+  // transfer, and mustn't see any of it early either.
+  if (s_dsp_is_lle)
+    static_cast<LLE::DSPLLE*>(s_dsp_emulator.get())->SyncDSP();
+
   s_dspState.DMAState = 1;
 
   // ARAM DMA transfer rate has been measured on real hw
   int ticksToTransfer = (s_arDMA.Cnt.count / 32) * 246;
   CoreTiming::ScheduleEvent(ticksToTransfer, s_et_CompleteARAM);
 
-  // Real hardware DMAs in 32byte chunks, but we can get by with 8byte chunks
+  // Real hardware DMAs in 32byte chunks. ARAM holds the data in the same (big endian) byte order
+  // as main RAM, so transfers are plain copies, split wherever ARAM wraps around.
   if (s_arDMA.Cnt.dir)
   {
     // ARAM -> MRAM
@@ -495,37 +504,23 @@ static void Do_ARAM_DMA()
     {
       while (s_arDMA.Cnt.count)
       {
-        // These are logically separated in code to show that a memory map has been set up
-        // See below in the write section for more information
-        if ((s_ARAM_Info.Hex & 0xf) == 3)
-        {
-          Memory::Write_U64_Swap(*(u64*)&s_ARAM.ptr[s_arDMA.ARAddr & s_ARAM.mask], s_arDMA.MMAddr);
-        }
-        else if ((s_ARAM_Info.Hex & 0xf) == 4)
-        {
-          Memory::Write_U64_Swap(*(u64*)&s_ARAM.ptr[s_arDMA.ARAddr & s_ARAM.mask], s_arDMA.MMAddr);
-        }
-        else
-        {
-          Memory::Write_U64_Swap(*(u64*)&s_ARAM.ptr[s_arDMA.ARAddr & s_ARAM.mask], s_arDMA.MMAddr);
-        }
+        const u32 offset = s_arDMA.ARAddr & s_ARAM.mask;
+        const u32 size = std::min<u32>(s_arDMA.Cnt.count, s_ARAM.mask + 1 - offset);
+        Memory::CopyToEmu(s_arDMA.MMAddr, &s_ARAM.ptr[offset], size);
 
-        s_arDMA.MMAddr += 8;
-        s_arDMA.ARAddr += 8;
-        s_arDMA.Cnt.count -= 8;
+        s_arDMA.MMAddr += size;
+        s_arDMA.ARAddr += size;
+        s_arDMA.Cnt.count -= size;
       }
     }
     else
     {
       // Assuming no external ARAM installed; returns zeros on out of bounds reads (verified on real
       // HW)
-      while (s_arDMA.Cnt.count)
-      {
-        Memory::Write_U64(0, s_arDMA.MMAddr);
-        s_arDMA.MMAddr += 8;
-        s_arDMA.ARAddr += 8;
-        s_arDMA.Cnt.count -= 8;
-      }
+      Memory::Memset(s_arDMA.MMAddr, 0, s_arDMA.Cnt.count);
+      s_arDMA.MMAddr += s_arDMA.Cnt.count;
+      s_arDMA.ARAddr += s_arDMA.Cnt.count;
+      s_arDMA.Cnt.count = 0;
     }
   }
   else
@@ -542,30 +537,21 @@ static void Do_ARAM_DMA()
     {
       while (s_arDMA.Cnt.count)
       {
-        if ((s_ARAM_Info.Hex & 0xf) == 3)
-        {
-          *(u64*)&s_ARAM.ptr[s_arDMA.ARAddr & s_ARAM.mask] =
-              Common::swap64(Memory::Read_U64(s_arDMA.MMAddr));
-        }
-        else if ((s_ARAM_Info.Hex & 0xf) == 4)
-        {
-          if (s_arDMA.ARAddr < 0x400000)
-          {
-            *(u64*)&s_ARAM.ptr[(s_arDMA.ARAddr + 0x400000) & s_ARAM.mask] =
-                Common::swap64(Memory::Read_U64(s_arDMA.MMAddr));
-          }
-          *(u64*)&s_ARAM.ptr[s_arDMA.ARAddr & s_ARAM.mask] =
-              Common::swap64(Memory::Read_U64(s_arDMA.MMAddr));
-        }
-        else
+        const u32 offset = s_arDMA.ARAddr & s_ARAM.mask;
+        u32 size = std::min<u32>(s_arDMA.Cnt.count, s_ARAM.mask + 1 - offset);
+
+        // With this memory map, the first 4MB are also written 4MB further.
+        if ((s_ARAM_Info.Hex & 0xf) == 4 && s_arDMA.ARAddr < 0x400000)
         {
-          *(u64*)&s_ARAM.ptr[s_arDMA.ARAddr & s_ARAM.mask] =
-              Common::swap64(Memory::Read_U64(s_arDMA.MMAddr));
+          const u32 mirror_offset = (s_arDMA.ARAddr + 0x400000) & s_ARAM.mask;
+          size = std::min({size, 0x400000 - s_arDMA.ARAddr, s_ARAM.mask + 1 - mirror_offset});
+          Memory::CopyFromEmu(&s_ARAM.ptr[mirror_offset], s_arDMA.MMAddr, size);
         }
+        Memory::CopyFromEmu(&s_ARAM.ptr[offset], s_arDMA.MMAddr, size);
 
-        s_arDMA.MMAddr += 8;
-        s_arDMA.ARAddr += 8;
-        s_arDMA.Cnt.count -= 8;
+        s_arDMA.MMAddr += size;
+        s_arDMA.ARAddr += size;
+        s_arDMA.Cnt.count -= size;
       }
     }
     else
@@ -597,6 +583,28 @@ u8 ReadARAM(u32 address)
   }
 }
 
+void CopyFromARAM(u8* data, u32 address, u32 size)
+{
+  u32 i = 0;
+  while (i < size)
+  {
+    const u32 current = address + i;
+    if (s_ARAM.wii_mode && !(current & 0x10000000))
+    {
+      data[i++] = ReadARAM(current);
+      continue;
+    }
+
+    // Copy up to where ARAM wraps around (or where a Wii read would switch to main RAM).
+    const u32 offset = current & s_ARAM.mask;
+    u32 chunk = std::min(size - i, s_ARAM.mask + 1 - offset);
+    if (s_ARAM.wii_mode)
+      chunk = std::min(chunk, 0x10000000 - (current & 0x0fffffff));
+    std::memcpy(&data[i], &s_ARAM.ptr[offset], chunk);
+    i += chunk;
+  }
+}
+
 void WriteARAM(u8 value, u32 address)
 {
   // TODO: verify this on Wii
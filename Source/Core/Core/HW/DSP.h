@@ -74,6 +74,8 @@ void GenerateDSPInterruptFromDSPEmu(DSPInterruptType type, int cycles_into_futur
 
 // Audio/DSP Helper
 u8 ReadARAM(u32 address);
+// Same as calling ReadARAM for each of the <size> bytes starting at <address>.
+void CopyFromARAM(u8* data, u32 address, u32 size);
 void WriteARAM(u8 value, u32 address);
 
 // Debugger Helper
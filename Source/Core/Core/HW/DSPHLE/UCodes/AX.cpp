@@ -6,14 +6,18 @@
 
 #include <algorithm>
 #include <array>
+#include <chrono>
 #include <iterator>
 
+#include "AudioCommon/AudioCommon.h"
 #include "Common/ChunkFile.h"
 #include "Common/CommonTypes.h"
 #include "Common/File.h"
 #include "Common/FileUtil.h"
 #include "Common/Logging/Log.h"
 #include "Common/Swap.h"
+#include "Core/Config/MainSettings.h"
+#include "Core/ConfigManager.h"
 #include "Core/HW/DSP.h"
 #include "Core/HW/DSPHLE/DSPHLE.h"
 #include "Core/HW/DSPHLE/MailHandler.h"
@@ -39,6 +43,10 @@ void AXUCode::Initialize()
   m_mail_handler.PushMail(DSP_INIT, true);
 
   LoadResamplingCoefficients();
+
+  const int voice_threads = Config::Get(Config::MAIN_DSP_HLE_VOICE_THREADS);
+  if (voice_threads > 1)
+    m_voice_workers = std::make_unique<Common::WorkerPool>(voice_threads, "AX voice worker");
 }
 
 void AXUCode::LoadResamplingCoefficients()
@@ -430,15 +438,14 @@ void AXUCode::ProcessPBList(u32 pb_addr)
   // 32KHz to 48KHz, but AX always process at 32KHz.
   const u32 spms = 32;
 
-  AXPB pb;
+  const AXBuffers buffers = {{m_samples_left, m_samples_right, m_samples_surround,
+                              m_samples_auxA_left, m_samples_auxA_right, m_samples_auxA_surround,
+                              m_samples_auxB_left, m_samples_auxB_right, m_samples_auxB_surround}};
 
-  while (pb_addr)
-  {
-    AXBuffers buffers = {{m_samples_left, m_samples_right, m_samples_surround, m_samples_auxA_left,
-                          m_samples_auxA_right, m_samples_auxA_surround, m_samples_auxB_left,
-                          m_samples_auxB_right, m_samples_auxB_surround}};
-
-    ReadPB(pb_addr, pb, m_crc);
+  // Processes one PB and returns the address of the next one.
+  const auto process_pb = [this, spms](u32 addr, AXBuffers pb_buffers) {
+    AXPB pb;
+    ReadPB(addr, pb, m_crc);
 
     u32 updates_addr = HILO_TO_32(pb.updates.data);
     u16* updates = (u16*)HLEMemory_Get_Pointer(updates_addr);
@@ -447,17 +454,112 @@ void AXUCode::ProcessPBList(u32 pb_addr)
     {
       ApplyUpdatesForMs(curr_ms, (u16*)&pb, pb.updates.num_updates, updates);
 
-      ProcessVoice(pb, buffers, spms, ConvertMixerControl(pb.mixer_control),
+      ProcessVoice(pb, pb_buffers, spms, ConvertMixerControl(pb.mixer_control),
                    m_coeffs_available ? m_coeffs : nullptr);
 
       // Forward the buffers
-      for (auto& ptr : buffers.ptrs)
+      for (auto& ptr : pb_buffers.ptrs)
         ptr += spms;
     }
 
-    WritePB(pb_addr, pb, m_crc);
+    WritePB(addr, pb, m_crc);
+    return HILO_TO_32(pb.next_pb);
+  };
+
+  const auto start = std::chrono::steady_clock::now();
+  std::vector<u32> pb_addrs;
+  const bool parallel = m_voice_workers && ShouldProcessVoicesInParallel() &&
+                        GetIndependentPBList(pb_addr, &pb_addrs);
+  if (parallel)
+  {
+    std::array<u32, std::size(buffers.ptrs)> buffer_lengths;
+    buffer_lengths.fill(spms * 5);
+    ProcessPBsInParallel(*m_voice_workers, pb_addrs, buffers, buffer_lengths.data(),
+                         m_voice_partial_buffers, process_pb);
+  }
+  else
+  {
+    while (pb_addr)
+      pb_addr = process_pb(pb_addr, buffers);
+  }
+
+  if (m_voice_workers)
+    RecordVoiceProcessingTime(parallel, std::chrono::steady_clock::now() - start);
+}
+
+bool AXUCode::GetIndependentPBList(u32 pb_addr, std::vector<u32>* pb_addrs)
+{
+  while (pb_addr)
+  {
+    // A longer list would have to contain a loop, which never ends anyway.
+    if (pb_addrs->size() == 0x10000)
+      return false;
+
+    AXPB pb;
+    ReadPB(pb_addr, pb, m_crc);
+
+    // The list can only be walked ahead of processing if no update changes
+    // next_pb (the first two words of the PB).
+    const u16* updates = (u16*)HLEMemory_Get_Pointer(HILO_TO_32(pb.updates.data));
+    u32 num_updates = 0;
+    for (u16 ms_updates : pb.updates.num_updates)
+      num_updates += ms_updates;
+    for (u32 i = 0; i < num_updates; ++i)
+    {
+      if (Common::swap16(updates[2 * i]) < 2)
+        return false;
+    }
+
+    pb_addrs->push_back(pb_addr);
     pb_addr = HILO_TO_32(pb.next_pb);
   }
+
+  return PBsAreIndependent(*pb_addrs);
+}
+
+// Every VOICE_TIMING_PERIOD PB lists (about 10 seconds), the first VOICE_TIMING_LISTS lists are
+// processed alternately in parallel and serially, and whichever way was cheaper on average is
+// used until the next measurement.
+constexpr u32 VOICE_TIMING_PERIOD = 2048;
+constexpr u32 VOICE_TIMING_LISTS = 32;
+
+bool AXUCode::ShouldProcessVoicesInParallel() const
+{
+  if (m_voice_timing_list < VOICE_TIMING_LISTS)
+    return m_voice_timing_list % 2 == 0;
+  return m_voices_in_parallel;
+}
+
+void AXUCode::RecordVoiceProcessingTime(bool parallel, std::chrono::steady_clock::duration time)
+{
+  if (m_voice_timing_list < VOICE_TIMING_LISTS)
+  {
+    m_voice_times[parallel] += time;
+    ++m_voice_time_counts[parallel];
+  }
+
+  // Lists which can't be processed in parallel are timed as serial ones, so if there never was a
+  // parallel one there is nothing to compare.
+  if (m_voice_timing_list == VOICE_TIMING_LISTS - 1 && m_voice_time_counts[true] != 0 &&
+      m_voice_time_counts[false] != 0)
+  {
+    const bool parallel_is_cheaper = m_voice_times[true] * m_voice_time_counts[false] <
+                                     m_voice_times[false] * m_voice_time_counts[true];
+    if (parallel_is_cheaper != m_voices_in_parallel)
+    {
+      INFO_LOG(DSPHLE, "Processing voices %s from now on",
+               parallel_is_cheaper ? "in parallel" : "serially");
+    }
+    m_voices_in_parallel = parallel_is_cheaper;
+  }
+
+  if (m_voice_timing_list == VOICE_TIMING_LISTS - 1)
+  {
+    m_voice_times = {};
+    m_voice_time_counts = {};
+  }
+
+  m_voice_timing_list = (m_voice_timing_list + 1) % VOICE_TIMING_PERIOD;
 }
 
 void AXUCode::MixAUXSamples(int aux_id, u32 write_addr, u32 read_addr)
@@ -546,6 +648,20 @@ void AXUCode::OutputSamples(u32 lr_addr, u32 surround_addr)
   }
 
   memcpy(HLEMemory_Get_Pointer(lr_addr), buffer, sizeof(buffer));
+
+  if (UseDiscreteSurround())
+  {
+    std::array<s16, 5 * 32> surround;
+    for (u32 i = 0; i < 5 * 32; ++i)
+      surround[i] = std::clamp(m_samples_surround[i], -32767, 32767);
+    g_sound_stream->GetMixer()->PushSurroundSamples(buffer, surround.data(), 5 * 32);
+  }
+}
+
+bool AXUCode::UseDiscreteSurround()
+{
+  const SConfig& config = SConfig::GetInstance();
+  return config.bDPL2Decoder && config.m_audio_discrete_surround && g_sound_stream;
 }
 
 void AXUCode::MixAUXBLR(u32 ul_addr, u32 dl_addr)
@@ -12,9 +12,19 @@
 
 #pragma once
 
+#include <array>
+#include <chrono>
+#include <memory>
+#include <vector>
+
 #include "Common/CommonTypes.h"
 #include "Core/HW/DSPHLE/UCodes/UCodes.h"
 
+namespace Common
+{
+class WorkerPool;
+}
+
 namespace DSP::HLE
 {
 class DSPHLE;
@@ -97,6 +107,18 @@ protected:
   bool m_coeffs_available;
   s16 m_coeffs[0x800];
 
+  // Threads used to process voices in parallel, if enabled. Each thread mixes
+  // into its own part of m_voice_partial_buffers.
+  std::unique_ptr<Common::WorkerPool> m_voice_workers;
+  std::vector<int> m_voice_partial_buffers;
+
+  // Whether processing voices in parallel pays off depends on the number of voices and on the
+  // host, so both ways get timed every now and then (see ShouldProcessVoicesInParallel).
+  u32 m_voice_timing_list = 0;
+  std::array<std::chrono::steady_clock::duration, 2> m_voice_times{};
+  std::array<u32, 2> m_voice_time_counts{};
+  bool m_voices_in_parallel = true;
+
   void LoadResamplingCoefficients();
 
   // Copy a command list from memory to our temp buffer
@@ -116,12 +138,20 @@ protected:
   void SetupProcessing(u32 init_addr);
   void DownloadAndMixWithVolume(u32 addr, u16 vol_main, u16 vol_auxa, u16 vol_auxb);
   void ProcessPBList(u32 pb_addr);
+  // Collects the addresses of all PBs in a list, if its voices can be processed
+  // in any order.
+  bool GetIndependentPBList(u32 pb_addr, std::vector<u32>* pb_addrs);
+  bool ShouldProcessVoicesInParallel() const;
+  void RecordVoiceProcessingTime(bool parallel, std::chrono::steady_clock::duration time);
   void MixAUXSamples(int aux_id, u32 write_addr, u32 read_addr);
   void UploadLRS(u32 dst_addr);
   void SetMainLR(u32 src_addr);
   void OutputSamples(u32 out_addr, u32 surround_addr);
   void MixAUXBLR(u32 ul_addr, u32 dl_addr);
   void SetOppositeLR(u32 src_addr);
+  // Whether the main buses should also be handed to the mixer as they are, so that it can play
+  // them on a surround setup instead of decoding the stereo output.
+  static bool UseDiscreteSurround();
   void SendAUXAndMix(u32 main_auxa_up, u32 auxb_s_up, u32 main_l_dl, u32 main_r_dl, u32 auxb_l_dl,
                      u32 auxb_r_dl);
 
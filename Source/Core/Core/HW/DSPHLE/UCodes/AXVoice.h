@@ -13,16 +13,23 @@
 #endif
 
 #include <algorithm>
-#include <functional>
+#include <array>
 #include <memory>
+#include <vector>
 
 #include "Common/CommonTypes.h"
+#include "Common/Intrinsics.h"
+#include "Common/WorkerPool.h"
 #include "Core/DSP/DSPAccelerator.h"
 #include "Core/HW/DSP.h"
 #include "Core/HW/DSPHLE/UCodes/AX.h"
 #include "Core/HW/DSPHLE/UCodes/AXStructs.h"
 #include "Core/HW/Memmap.h"
 
+#ifdef _M_ARM_64
+#include <arm_neon.h>
+#endif
+
 namespace DSP::HLE
 {
 #ifdef AX_GC
@@ -139,6 +146,61 @@ void WritePB(u32 addr, const PB_TYPE& pb, u32 crc)
   }
 }
 
+// Returns true if none of the PBs at the given addresses overlap, which means
+// they can be read, processed and written back in any order.
+bool PBsAreIndependent(std::vector<u32> pb_addrs)
+{
+  std::sort(pb_addrs.begin(), pb_addrs.end());
+  for (size_t i = 1; i < pb_addrs.size(); ++i)
+  {
+    if (pb_addrs[i] - pb_addrs[i - 1] < sizeof(PB_TYPE))
+      return false;
+  }
+  return true;
+}
+
+// Processes independent voices on a worker pool. process_pb(pb_addr, buffers)
+// must process the voice at pb_addr and mix it into buffers, the lengths of
+// which are given by buffer_lengths.
+//
+// The voices are split into one contiguous chunk per thread, and each chunk is
+// mixed into its own zeroed copy of the buffers. The copies are then added to
+// the real buffers in chunk order. Mixing only adds integers, so the result is
+// exactly the same as processing all voices serially.
+template <typename ProcessFunction>
+void ProcessPBsInParallel(Common::WorkerPool& pool, const std::vector<u32>& pb_addrs,
+                          const AXBuffers& buffers, const u32* buffer_lengths,
+                          std::vector<int>& partial_buffers, ProcessFunction process_pb)
+{
+  constexpr size_t num_buffers = sizeof(buffers.ptrs) / sizeof(buffers.ptrs[0]);
+  const size_t num_chunks = std::min(pool.GetThreadCount(), pb_addrs.size());
+  const u32 buffer_length = *std::max_element(buffer_lengths, buffer_lengths + num_buffers);
+  const size_t chunk_size = num_buffers * buffer_length;
+
+  partial_buffers.assign(num_chunks * chunk_size, 0);
+
+  pool.ParallelFor(num_chunks, [&](size_t chunk) {
+    AXBuffers chunk_buffers;
+    for (size_t i = 0; i < num_buffers; ++i)
+      chunk_buffers.ptrs[i] = &partial_buffers[chunk * chunk_size + i * buffer_length];
+
+    const size_t first = pb_addrs.size() * chunk / num_chunks;
+    const size_t last = pb_addrs.size() * (chunk + 1) / num_chunks;
+    for (size_t i = first; i < last; ++i)
+      process_pb(pb_addrs[i], chunk_buffers);
+  });
+
+  for (size_t chunk = 0; chunk < num_chunks; ++chunk)
+  {
+    for (size_t i = 0; i < num_buffers; ++i)
+    {
+      const int* partial = &partial_buffers[chunk * chunk_size + i * buffer_length];
+      for (u32 j = 0; j < buffer_lengths[i]; ++j)
+        buffers.ptrs[i][j] += partial[j];
+    }
+  }
+}
+
 #if 0
 // Dump the value of a PB for debugging
 #define DUMP_U16(field) WARN_LOG(DSPHLE, "    %04x (%s)", pb.field, #field)
@@ -161,9 +223,9 @@ void DumpPB(const PB_TYPE& pb)
 }
 #endif
 
-// Simulated accelerator state.
-static PB_TYPE* acc_pb;
-static bool acc_end_reached;
+// Simulated accelerator state. Voices may be processed on several threads at once.
+static thread_local PB_TYPE* acc_pb;
+static thread_local bool acc_end_reached;
 
 class HLEAccelerator final : public Accelerator
 {
@@ -208,9 +270,14 @@ protected:
 
   u8 ReadMemory(u32 address) override { return ReadARAM(address); }
   void WriteMemory(u32 address, u8 value) override { WriteARAM(value, address); }
+  void ReadMemoryBlock(u32 address, u8* data, u32 size) override
+  {
+    CopyFromARAM(data, address, size);
+  }
 };
 
-static std::unique_ptr<Accelerator> s_accelerator = std::make_unique<HLEAccelerator>();
+static thread_local std::unique_ptr<HLEAccelerator> s_accelerator =
+    std::make_unique<HLEAccelerator>();
 
 // Sets up the simulated accelerator.
 void AcceleratorSetup(PB_TYPE* pb)
@@ -226,20 +293,45 @@ void AcceleratorSetup(PB_TYPE* pb)
   acc_end_reached = false;
 }
 
-// Reads a sample from the accelerator. Also handles looping and
-// disabling streams that reached the end (this is done by an exception raised
-// by the accelerator on real hardware).
-u16 AcceleratorGetSample()
+// Reads samples from the accelerator. Also handles looping and disabling
+// streams that reached the end (this is done by an exception raised by the
+// accelerator on real hardware).
+void AcceleratorGetSamples(s16* samples, u32 count)
 {
-  // See below for explanations about acc_end_reached.
-  if (acc_end_reached)
-    return 0;
+  u32 i = 0;
+  while (i < count)
+  {
+    // See OnEndException for explanations about acc_end_reached.
+    if (acc_end_reached)
+    {
+      std::fill(samples + i, samples + count, 0);
+      return;
+    }
+
+    i += s_accelerator->ReadSamples(acc_pb->adpcm.coefs, samples + i, count - i);
+  }
+}
 
-  return s_accelerator->Read(acc_pb->adpcm.coefs);
+// Returns the number of input samples ResampleAudio consumes to produce
+// <count> output samples.
+u32 GetResampleInputCount(u32 count, u32 curr_pos, u32 ratio, int srctype)
+{
+  if (srctype != SRCTYPE_LINEAR && srctype != SRCTYPE_POLYPHASE)
+    return count;
+
+  u32 input_count = 0;
+  for (u32 i = 0; i < count; ++i)
+  {
+    curr_pos += ratio;
+    input_count += curr_pos >> 16;
+    curr_pos &= 0xFFFF;
+  }
+  return input_count;
 }
 
-// Reads samples from the input callback, resamples them to <count> samples at
-// the wanted sample rate (computed from the ratio, see below).
+// Resamples input samples to <count> samples at the wanted sample rate
+// (computed from the ratio, see below). <input> must point to the four
+// <last_samples> values, followed by GetResampleInputCount() new samples.
 //
 // If srctype is SRCTYPE_POLYPHASE, coefficients need to be provided as well
 // (or the srctype will automatically be changed to LINEAR).
@@ -258,10 +350,11 @@ u16 AcceleratorGetSample()
 // We start getting samples not from sample 0, but 0.<curr_pos_frac>. This
 // avoids discontinuities in the audio stream, especially with very low ratios
 // which interpolate a lot of values between two "real" samples.
-u32 ResampleAudio(std::function<s16(u32)> input_callback, s16* output, u32 count, s16* last_samples,
-                  u32 curr_pos, u32 ratio, int srctype, const s16* coeffs)
+u32 ResampleAudio(const s16* input, s16* output, u32 count, s16* last_samples, u32 curr_pos,
+                  u32 ratio, int srctype, const s16* coeffs)
 {
-  int read_samples_count = 0;
+  // Index one past the most recent input sample.
+  u32 pos = 4;
 
   // TODO(delroth): find out why the polyphase resampling algorithm causes
   // audio glitches in Wii games with non integral ratios.
@@ -269,107 +362,68 @@ u32 ResampleAudio(std::function<s16(u32)> input_callback, s16* output, u32 count
   // If DSP DROM coefficients are available, support polyphase resampling.
   if (0)  // if (coeffs && srctype == SRCTYPE_POLYPHASE)
   {
-    s16 temp[4];
-    u32 idx = 0;
-
-    temp[idx++ & 3] = last_samples[0];
-    temp[idx++ & 3] = last_samples[1];
-    temp[idx++ & 3] = last_samples[2];
-    temp[idx++ & 3] = last_samples[3];
-
     for (u32 i = 0; i < count; ++i)
     {
       curr_pos += ratio;
-      while (curr_pos >= 0x10000)
-      {
-        temp[idx++ & 3] = input_callback(read_samples_count++);
-        curr_pos -= 0x10000;
-      }
+      pos += curr_pos >> 16;
+      curr_pos &= 0xFFFF;
 
       u16 curr_pos_frac = ((curr_pos & 0xFFFF) >> 9) << 2;
       const s16* c = &coeffs[curr_pos_frac];
 
-      s64 t0 = temp[idx++ & 3];
-      s64 t1 = temp[idx++ & 3];
-      s64 t2 = temp[idx++ & 3];
-      s64 t3 = temp[idx++ & 3];
+      s64 t0 = input[pos - 4];
+      s64 t1 = input[pos - 3];
+      s64 t2 = input[pos - 2];
+      s64 t3 = input[pos - 1];
 
       s64 samp = (t0 * c[0] + t1 * c[1] + t2 * c[2] + t3 * c[3]) >> 15;
 
       output[i] = (s16)samp;
     }
-
-    last_samples[3] = temp[--idx & 3];
-    last_samples[2] = temp[--idx & 3];
-    last_samples[1] = temp[--idx & 3];
-    last_samples[0] = temp[--idx & 3];
   }
   else if (srctype == SRCTYPE_LINEAR || srctype == SRCTYPE_POLYPHASE)
   {
-    // This is the circular buffer containing samples to use for the
-    // interpolation. It is initialized with the values from the PB, and it
-    // will be stored back to the PB at the end.
-    s16 temp[4];
-    u32 idx = 0;
-
-    temp[idx++ & 3] = last_samples[0];
-    temp[idx++ & 3] = last_samples[1];
-    temp[idx++ & 3] = last_samples[2];
-    temp[idx++ & 3] = last_samples[3];
-
     for (u32 i = 0; i < count; ++i)
     {
+      // Move forward by the integer part of our current position.
       curr_pos += ratio;
-
-      // While our current position is >= 1.0, push new samples to the
-      // circular buffer.
-      while (curr_pos >= 0x10000)
-      {
-        temp[idx++ & 3] = input_callback(read_samples_count++);
-        curr_pos -= 0x10000;
-      }
+      pos += curr_pos >> 16;
+      curr_pos &= 0xFFFF;
 
       // Get our current fractional position, used to know how much of
       // curr0 and how much of curr1 the output sample should be.
-      u16 curr_frac = curr_pos & 0xFFFF;
+      u16 curr_frac = curr_pos;
       u16 inv_curr_frac = -curr_frac;
 
-      // Interpolate! If curr_frac is 0, we can simply take the last
-      // sample without any multiplying.
+      // Interpolate! If curr_frac is 0, we can simply take the oldest of the
+      // last four samples without any multiplying.
       s16 sample;
       if (curr_frac)
       {
-        s32 s0 = temp[idx++ & 3];
-        s32 s1 = temp[idx++ & 3];
+        s32 s0 = input[pos - 4];
+        s32 s1 = input[pos - 3];
 
         sample = ((s0 * inv_curr_frac) + (s1 * curr_frac)) >> 16;
-        idx += 2;
       }
       else
       {
-        sample = temp[idx++ & 3];
-        idx += 3;
+        sample = input[pos - 4];
       }
 
       output[i] = sample;
     }
-
-    // Update the four last_samples values.
-    last_samples[3] = temp[--idx & 3];
-    last_samples[2] = temp[--idx & 3];
-    last_samples[1] = temp[--idx & 3];
-    last_samples[0] = temp[--idx & 3];
   }
   else  // SRCTYPE_NEAREST
   {
-    // No sample rate conversion here: simply read samples from the
-    // accelerator to the output buffer.
-    for (u32 i = 0; i < count; ++i)
-      output[i] = input_callback(i);
-
-    memcpy(last_samples, output + count - 4, 4 * sizeof(u16));
+    // No sample rate conversion here: simply copy the input samples to the
+    // output buffer.
+    std::copy(input + 4, input + 4 + count, output);
+    pos += count;
   }
 
+  // Update the four last_samples values.
+  std::copy(input + pos - 4, input + pos, last_samples);
+
   return curr_pos;
 }
 
@@ -381,9 +435,25 @@ void GetInputSamples(PB_TYPE& pb, s16* samples, u16 count, const s16* coeffs)
 
   if (coeffs)
     coeffs += pb.coef_select * 0x200;
-  u32 curr_pos =
-      ResampleAudio([](u32) { return AcceleratorGetSample(); }, samples, count, pb.src.last_samples,
-                    pb.src.cur_addr_frac, HILO_TO_32(pb.src.ratio), pb.src_type, coeffs);
+
+  const u32 ratio = HILO_TO_32(pb.src.ratio);
+  const u32 input_count = GetResampleInputCount(count, pb.src.cur_addr_frac, ratio, pb.src_type);
+
+  // Decode everything the resampler needs at once, after the history samples. Ratios above 8
+  // are outside of the documented range and only handled for safety.
+  std::array<s16, 4 + MAX_SAMPLES_PER_FRAME * 8> input_buffer;
+  std::vector<s16> large_input_buffer;
+  s16* input = input_buffer.data();
+  if (input_count + 4 > input_buffer.size())
+  {
+    large_input_buffer.resize(input_count + 4);
+    input = large_input_buffer.data();
+  }
+  std::copy(std::begin(pb.src.last_samples), std::end(pb.src.last_samples), input);
+  AcceleratorGetSamples(input + 4, input_count);
+
+  u32 curr_pos = ResampleAudio(input, samples, count, pb.src.last_samples, pb.src.cur_addr_frac,
+                               ratio, pb.src_type, coeffs);
   pb.src.cur_addr_frac = (curr_pos & 0xFFFF);
 
   // Update current position, YN1, YN2 and pred scale in the PB.
@@ -394,6 +464,69 @@ void GetInputSamples(PB_TYPE& pb, s16* samples, u16 count, const s16* coeffs)
   pb.adpcm.pred_scale = s_accelerator->GetPredScale();
 }
 
+// Multiply samples by a 1.15 fixed point volume which is ramped by
+// <volume_delta> after each sample, and clamp the results to [-32767, 32767].
+// <volume> is updated to the volume for the next sample.
+void ApplyVolume(s16* output, const s16* input, u32 count, u16& volume, u16 volume_delta)
+{
+  u32 i = 0;
+
+#if defined(_M_X86)
+  // SSE2 only has signed 16 bit multiplies, so compute input * (s16)volume
+  // and add input << 16 back for volumes >= 0x8000.
+  const __m128i steps = _mm_setr_epi16(0, 1, 2, 3, 4, 5, 6, 7);
+  const __m128i vol_step = _mm_set1_epi16(static_cast<s16>(volume_delta * 8));
+  const __m128i min_sample = _mm_set1_epi16(-32767);
+  const __m128i zero = _mm_setzero_si128();
+  __m128i vol = _mm_add_epi16(_mm_set1_epi16(static_cast<s16>(volume)),
+                              _mm_mullo_epi16(_mm_set1_epi16(volume_delta), steps));
+  for (; i + 8 <= count; i += 8)
+  {
+    const __m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i*>(input + i));
+    const __m128i lo = _mm_mullo_epi16(in, vol);
+    const __m128i hi = _mm_mulhi_epi16(in, vol);
+    const __m128i fixup = _mm_and_si128(in, _mm_srai_epi16(vol, 15));
+    __m128i p0 = _mm_add_epi32(_mm_unpacklo_epi16(lo, hi), _mm_unpacklo_epi16(zero, fixup));
+    __m128i p1 = _mm_add_epi32(_mm_unpackhi_epi16(lo, hi), _mm_unpackhi_epi16(zero, fixup));
+    p0 = _mm_srai_epi32(p0, 15);
+    p1 = _mm_srai_epi32(p1, 15);
+    const __m128i out = _mm_max_epi16(_mm_packs_epi32(p0, p1), min_sample);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(output + i), out);
+    vol = _mm_add_epi16(vol, vol_step);
+  }
+#elif defined(_M_ARM_64)
+  static constexpr u16 steps_array[8] = {0, 1, 2, 3, 4, 5, 6, 7};
+  const uint16x8_t vol_step = vdupq_n_u16(static_cast<u16>(volume_delta * 8));
+  const int16x8_t min_sample = vdupq_n_s16(-32767);
+  uint16x8_t vol =
+      vaddq_u16(vdupq_n_u16(volume), vmulq_u16(vdupq_n_u16(volume_delta), vld1q_u16(steps_array)));
+  for (; i + 8 <= count; i += 8)
+  {
+    const int16x8_t in = vld1q_s16(input + i);
+    const int32x4_t p0 = vmulq_s32(vmovl_s16(vget_low_s16(in)),
+                                   vreinterpretq_s32_u32(vmovl_u16(vget_low_u16(vol))));
+    const int32x4_t p1 = vmulq_s32(vmovl_s16(vget_high_s16(in)),
+                                   vreinterpretq_s32_u32(vmovl_u16(vget_high_u16(vol))));
+    const int16x8_t out =
+        vcombine_s16(vqmovn_s32(vshrq_n_s32(p0, 15)), vqmovn_s32(vshrq_n_s32(p1, 15)));
+    vst1q_s16(output + i, vmaxq_s16(out, min_sample));
+    vol = vaddq_u16(vol, vol_step);
+  }
+#endif
+
+  volume += static_cast<u16>(volume_delta * i);
+
+  for (; i < count; ++i)
+  {
+    s64 sample = input[i];
+    sample *= volume;
+    sample >>= 15;
+    output[i] = std::clamp((s32)sample, -32767, 32767);  // -32768 ?
+
+    volume += volume_delta;
+  }
+}
+
 // Add samples to an output buffer, with optional volume ramping.
 void MixAdd(int* out, const s16* input, u32 count, u16* pvol, s16* dpop, bool ramp)
 {
@@ -406,18 +539,35 @@ void MixAdd(int* out, const s16* input, u32 count, u16* pvol, s16* dpop, bool ra
   if (!ramp)
     volume_delta = 0;
 
-  for (u32 i = 0; i < count; ++i)
-  {
-    s64 sample = input[i];
-    sample *= volume;
-    sample >>= 15;
-    sample = std::clamp((s32)sample, -32767, 32767);  // -32768 ?
+  if (count == 0)
+    return;
 
-    out[i] += (s16)sample;
-    volume += volume_delta;
+  s16 samples[MAX_SAMPLES_PER_FRAME];
+  ApplyVolume(samples, input, count, volume, volume_delta);
 
-    *dpop = (s16)sample;
+  u32 i = 0;
+#if defined(_M_X86)
+  for (; i + 8 <= count; i += 8)
+  {
+    const __m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i*>(samples + i));
+    const __m128i in0 = _mm_srai_epi32(_mm_unpacklo_epi16(in, in), 16);
+    const __m128i in1 = _mm_srai_epi32(_mm_unpackhi_epi16(in, in), 16);
+    __m128i* dst = reinterpret_cast<__m128i*>(out + i);
+    _mm_storeu_si128(dst, _mm_add_epi32(_mm_loadu_si128(dst), in0));
+    _mm_storeu_si128(dst + 1, _mm_add_epi32(_mm_loadu_si128(dst + 1), in1));
+  }
+#elif defined(_M_ARM_64)
+  for (; i + 8 <= count; i += 8)
+  {
+    const int16x8_t in = vld1q_s16(samples + i);
+    vst1q_s32(out + i, vaddq_s32(vld1q_s32(out + i), vmovl_s16(vget_low_s16(in))));
+    vst1q_s32(out + i + 4, vaddq_s32(vld1q_s32(out + i + 4), vmovl_s16(vget_high_s16(in))));
   }
+#endif
+  for (; i < count; ++i)
+    out[i] += samples[i];
+
+  *dpop = samples[count - 1];
 }
 
 // Execute a low pass filter on the samples using one history value. Returns
@@ -443,12 +593,8 @@ void ProcessVoice(PB_TYPE& pb, const AXBuffers& buffers, u16 count, AXMixControl
   GetInputSamples(pb, samples, count, coeffs);
 
   // Apply a global volume ramp using the volume envelope parameters.
-  for (u32 i = 0; i < count; ++i)
-  {
-    samples[i] = std::clamp(((s32)samples[i] * pb.vol_env.cur_volume) >> 15, -32767,
-                            32767);  // -32768 ?
-    pb.vol_env.cur_volume += pb.vol_env.cur_volume_delta;
-  }
+  ApplyVolume(samples, samples, count, pb.vol_env.cur_volume,
+              static_cast<u16>(pb.vol_env.cur_volume_delta));
 
   // Optionally, execute a low pass filter
   // TODO: LPF code is currently broken, causing Super Monkey Ball sound
@@ -524,9 +670,12 @@ void ProcessVoice(PB_TYPE& pb, const AXBuffers& buffers, u16 count, AXMixControl
 
     // We use ratio 0x55555 == (5 * 65536 + 21845) / 65536 == 5.3333 which
     // is the nearest we can get to 96/18
-    u32 curr_pos = ResampleAudio([&samples](u32 i) { return samples[i]; }, wm_samples, wm_count,
-                                 pb.remote_src.last_samples, pb.remote_src.cur_addr_frac, 0x55555,
-                                 SRCTYPE_POLYPHASE, coeffs);
+    s16 wm_input[4 + MAX_SAMPLES_PER_FRAME];
+    std::copy(std::begin(pb.remote_src.last_samples), std::end(pb.remote_src.last_samples),
+              wm_input);
+    std::copy(samples, samples + count, wm_input + 4);
+    u32 curr_pos = ResampleAudio(wm_input, wm_samples, wm_count, pb.remote_src.last_samples,
+                                 pb.remote_src.cur_addr_frac, 0x55555, SRCTYPE_POLYPHASE, coeffs);
     pb.remote_src.cur_addr_frac = curr_pos & 0xFFFF;
 
 // Mix to main[0-3] and aux[0-3]
@@ -8,7 +8,9 @@
 
 #include <algorithm>
 #include <array>
+#include <chrono>
 
+#include "AudioCommon/AudioCommon.h"
 #include "Common/ChunkFile.h"
 #include "Common/CommonTypes.h"
 #include "Common/Logging/Log.h"
@@ -439,19 +441,18 @@ void AXWiiUCode::ReinjectUpdatesFields(AXPBWii& pb, u16* num_updates, u32 update
 
 void AXWiiUCode::ProcessPBList(u32 pb_addr)
 {
-  AXPBWii pb;
-
-  while (pb_addr)
-  {
-    AXBuffers buffers = {{m_samples_left,      m_samples_right,      m_samples_surround,
-                          m_samples_auxA_left, m_samples_auxA_right, m_samples_auxA_surround,
-                          m_samples_auxB_left, m_samples_auxB_right, m_samples_auxB_surround,
-                          m_samples_auxC_left, m_samples_auxC_right, m_samples_auxC_surround,
-                          m_samples_wm0,       m_samples_aux0,       m_samples_wm1,
-                          m_samples_aux1,      m_samples_wm2,        m_samples_aux2,
-                          m_samples_wm3,       m_samples_aux3}};
-
-    ReadPB(pb_addr, pb, m_crc);
+  const AXBuffers buffers = {{m_samples_left,      m_samples_right,      m_samples_surround,
+                              m_samples_auxA_left, m_samples_auxA_right, m_samples_auxA_surround,
+                              m_samples_auxB_left, m_samples_auxB_right, m_samples_auxB_surround,
+                              m_samples_auxC_left, m_samples_auxC_right, m_samples_auxC_surround,
+                              m_samples_wm0,       m_samples_aux0,       m_samples_wm1,
+                              m_samples_aux1,      m_samples_wm2,        m_samples_aux2,
+                              m_samples_wm3,       m_samples_aux3}};
+
+  // Processes one PB and returns the address of the next one.
+  const auto process_pb = [this](u32 addr, AXBuffers pb_buffers) {
+    AXPBWii pb;
+    ReadPB(addr, pb, m_crc);
 
     u16 num_updates[3];
     u16 updates[1024];
@@ -461,24 +462,68 @@ void AXWiiUCode::ProcessPBList(u32 pb_addr)
       for (int curr_ms = 0; curr_ms < 3; ++curr_ms)
       {
         ApplyUpdatesForMs(curr_ms, (u16*)&pb, num_updates, updates);
-        ProcessVoice(pb, buffers, 32, ConvertMixerControl(HILO_TO_32(pb.mixer_control)),
+        ProcessVoice(pb, pb_buffers, 32, ConvertMixerControl(HILO_TO_32(pb.mixer_control)),
                      m_coeffs_available ? m_coeffs : nullptr);
 
         // Forward the buffers
-        for (auto& ptr : buffers.ptrs)
+        for (auto& ptr : pb_buffers.ptrs)
           ptr += 32;
       }
       ReinjectUpdatesFields(pb, num_updates, updates_addr);
     }
     else
     {
-      ProcessVoice(pb, buffers, 96, ConvertMixerControl(HILO_TO_32(pb.mixer_control)),
+      ProcessVoice(pb, pb_buffers, 96, ConvertMixerControl(HILO_TO_32(pb.mixer_control)),
                    m_coeffs_available ? m_coeffs : nullptr);
     }
 
-    WritePB(pb_addr, pb, m_crc);
+    WritePB(addr, pb, m_crc);
+    return HILO_TO_32(pb.next_pb);
+  };
+
+  // Old AXWii versions process ms per ms, and don't fit the Wiimote buffers.
+  const bool use_workers = m_voice_workers && !m_old_axwii;
+
+  const auto start = std::chrono::steady_clock::now();
+  std::vector<u32> pb_addrs;
+  const bool parallel =
+      use_workers && ShouldProcessVoicesInParallel() && GetIndependentPBList(pb_addr, &pb_addrs);
+  if (parallel)
+  {
+    static constexpr u32 buffer_lengths[] = {96, 96, 96, 96, 96, 96, 96, 96, 96, 96,
+                                             96, 96, 18, 18, 18, 18, 18, 18, 18, 18};
+    static_assert(std::size(buffer_lengths) == std::size(buffers.ptrs));
+    ProcessPBsInParallel(*m_voice_workers, pb_addrs, buffers, buffer_lengths,
+                         m_voice_partial_buffers, process_pb);
+  }
+  else
+  {
+    while (pb_addr)
+      pb_addr = process_pb(pb_addr, buffers);
+  }
+
+  if (use_workers)
+    RecordVoiceProcessingTime(parallel, std::chrono::steady_clock::now() - start);
+}
+
+bool AXWiiUCode::GetIndependentPBList(u32 pb_addr, std::vector<u32>* pb_addrs)
+{
+  while (pb_addr)
+  {
+    // A longer list would have to contain a loop, which never ends anyway.
+    if (pb_addrs->size() == 0x10000)
+      return false;
+
+    // Only used with newer AXWii versions, which have no PB updates that could
+    // change next_pb while the list is being processed.
+    AXPBWii pb;
+    ReadPB(pb_addr, pb, m_crc);
+
+    pb_addrs->push_back(pb_addr);
     pb_addr = HILO_TO_32(pb.next_pb);
   }
+
+  return PBsAreIndependent(*pb_addrs);
 }
 
 void AXWiiUCode::MixAUXSamples(int aux_id, u32 write_addr, u32 read_addr, u16 volume)
@@ -626,6 +671,19 @@ void AXWiiUCode::OutputSamples(u32 lr_addr, u32 surround_addr, u16 volume, bool
   }
 
   memcpy(HLEMemory_Get_Pointer(lr_addr), buffer.data(), sizeof(buffer));
+
+  if (UseDiscreteSurround())
+  {
+    // The main volume applies to the surround channel as well.
+    std::array<s16, 3 * 32> surround;
+    for (size_t i = 0; i < surround.size(); ++i)
+    {
+      const int sample = static_cast<int>(((s64)m_samples_surround[i] * volume_ramp[i]) >> 15);
+      surround[i] = std::clamp(sample, -32767, 32767);
+    }
+    g_sound_stream->GetMixer()->PushSurroundSamples(buffer.data(), surround.data(), 3 * 32);
+  }
+
   m_mail_handler.PushMail(DSP_SYNC, true);
 }
 
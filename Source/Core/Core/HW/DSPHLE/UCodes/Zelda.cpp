@@ -6,10 +6,12 @@
 
 #include <algorithm>
 #include <array>
+#include <cstring>
 #include <map>
 
 #include "Common/ChunkFile.h"
 #include "Common/CommonTypes.h"
+#include "Common/Intrinsics.h"
 #include "Common/Logging/Log.h"
 #include "Common/Swap.h"
 #include "Core/HW/DSP.h"
@@ -18,6 +20,10 @@
 #include "Core/HW/DSPHLE/UCodes/GBA.h"
 #include "Core/HW/DSPHLE/UCodes/UCodes.h"
 
+#ifdef _M_ARM_64
+#include <arm_neon.h>
+#endif
+
 namespace DSP::HLE
 {
 // Uncomment this to have a strict version of the HLE implementation, which
@@ -667,6 +673,403 @@ void ZeldaUCode::RenderAudio()
   }
 }
 
+namespace ZeldaMixing
+{
+#if defined(_M_X86)
+// Multiplies signed samples by an unsigned volume, giving the 32 bit products of the low and high
+// 4 samples.
+static void MultiplyByVolume(__m128i samples, __m128i vol, __m128i* products_lo,
+                             __m128i* products_hi)
+{
+  const __m128i lo = _mm_mullo_epi16(samples, vol);
+  // _mm_mulhi_epu16 treats the samples as unsigned, which needs correcting for negative ones.
+  const __m128i hi = _mm_sub_epi16(_mm_mulhi_epu16(samples, vol),
+                                   _mm_and_si128(_mm_srai_epi16(samples, 15), vol));
+  *products_lo = _mm_unpacklo_epi16(lo, hi);
+  *products_hi = _mm_unpackhi_epi16(lo, hi);
+}
+
+// Returns the sums of the elements of a, b, c and d.
+static __m128i HorizontalSums(__m128i a, __m128i b, __m128i c, __m128i d)
+{
+  const __m128i ab = _mm_add_epi32(_mm_unpacklo_epi32(a, b), _mm_unpackhi_epi32(a, b));
+  const __m128i cd = _mm_add_epi32(_mm_unpacklo_epi32(c, d), _mm_unpackhi_epi32(c, d));
+  return _mm_add_epi32(_mm_unpacklo_epi64(ab, cd), _mm_unpackhi_epi64(ab, cd));
+}
+#endif
+
+void ApplyVolumeInPlace(s16* buf, size_t count, u16 vol, u32 int_bits)
+{
+  const u32 shift = 16 - int_bits;
+  size_t i = 0;
+
+#if defined(_M_X86)
+  const __m128i vol_vec = _mm_set1_epi16(static_cast<s16>(vol));
+  const __m128i shift_vec = _mm_cvtsi32_si128(shift);
+  for (; i + 8 <= count; i += 8)
+  {
+    __m128i lo, hi;
+    MultiplyByVolume(_mm_loadu_si128(reinterpret_cast<const __m128i*>(buf + i)), vol_vec, &lo,
+                     &hi);
+    lo = _mm_sra_epi32(lo, shift_vec);
+    hi = _mm_sra_epi32(hi, shift_vec);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(buf + i), _mm_packs_epi32(lo, hi));
+  }
+#elif defined(_M_ARM_64)
+  const int32x4_t vol_vec = vdupq_n_s32(vol);
+  const int32x4_t shift_vec = vdupq_n_s32(-static_cast<s32>(shift));
+  for (; i + 8 <= count; i += 8)
+  {
+    const int16x8_t samples = vld1q_s16(buf + i);
+    const int32x4_t lo =
+        vshlq_s32(vmulq_s32(vmovl_s16(vget_low_s16(samples)), vol_vec), shift_vec);
+    const int32x4_t hi =
+        vshlq_s32(vmulq_s32(vmovl_s16(vget_high_s16(samples)), vol_vec), shift_vec);
+    vst1q_s16(buf + i, vcombine_s16(vqmovn_s32(lo), vqmovn_s32(hi)));
+  }
+#endif
+
+  for (; i < count; ++i)
+  {
+    s32 tmp = (u32)buf[i] * (u32)vol;
+    tmp >>= shift;
+
+    buf[i] = (s16)std::clamp(tmp, -0x8000, 0x7FFF);
+  }
+}
+
+s32 AddBuffersWithVolumeRamp(s16* dst, const s16* src, size_t count, s32 vol, s32 step)
+{
+  size_t i = 0;
+
+#if defined(_M_X86) || defined(_M_ARM_64)
+  // The volume of each of 8 consecutive samples, kept in 32 bits so that it steps exactly like
+  // the per-sample loop.
+  const u32 base = static_cast<u32>(vol);
+  const u32 ustep = static_cast<u32>(step);
+  const s32 lane_volumes[4] = {static_cast<s32>(base), static_cast<s32>(base + ustep),
+                               static_cast<s32>(base + 2 * ustep),
+                               static_cast<s32>(base + 3 * ustep)};
+#endif
+
+#if defined(_M_X86)
+  __m128i vol_lo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(lane_volumes));
+  __m128i vol_hi = _mm_add_epi32(vol_lo, _mm_set1_epi32(static_cast<s32>(4 * ustep)));
+  const __m128i vol_inc = _mm_set1_epi32(static_cast<s32>(8 * ustep));
+  for (; i + 8 <= count; i += 8)
+  {
+    const __m128i vol16 =
+        _mm_packs_epi32(_mm_srai_epi32(vol_lo, 16), _mm_srai_epi32(vol_hi, 16));
+    const __m128i samples = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+    const __m128i mixed = _mm_add_epi16(_mm_loadu_si128(reinterpret_cast<__m128i*>(dst + i)),
+                                        _mm_mulhi_epi16(vol16, samples));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), mixed);
+    vol_lo = _mm_add_epi32(vol_lo, vol_inc);
+    vol_hi = _mm_add_epi32(vol_hi, vol_inc);
+  }
+  vol = _mm_cvtsi128_si32(vol_lo);
+#elif defined(_M_ARM_64)
+  int32x4_t vol_lo = vld1q_s32(lane_volumes);
+  int32x4_t vol_hi = vaddq_s32(vol_lo, vdupq_n_s32(static_cast<s32>(4 * ustep)));
+  const int32x4_t vol_inc = vdupq_n_s32(static_cast<s32>(8 * ustep));
+  for (; i + 8 <= count; i += 8)
+  {
+    const int16x8_t samples = vld1q_s16(src + i);
+    const int16x4_t lo =
+        vshrn_n_s32(vmull_s16(vshrn_n_s32(vol_lo, 16), vget_low_s16(samples)), 16);
+    const int16x4_t hi =
+        vshrn_n_s32(vmull_s16(vshrn_n_s32(vol_hi, 16), vget_high_s16(samples)), 16);
+    vst1q_s16(dst + i, vaddq_s16(vld1q_s16(dst + i), vcombine_s16(lo, hi)));
+    vol_lo = vaddq_s32(vol_lo, vol_inc);
+    vol_hi = vaddq_s32(vol_hi, vol_inc);
+  }
+  vol = vgetq_lane_s32(vol_lo, 0);
+#endif
+
+  for (; i < count; ++i)
+  {
+    dst[i] += ((vol >> 16) * src[i]) >> 16;
+    vol += step;
+  }
+
+  return vol;
+}
+
+void AddBuffersWithVolume(s16* dst, const s16* src, size_t count, u16 vol)
+{
+  size_t i = 0;
+
+#if defined(_M_X86)
+  const __m128i vol_vec = _mm_set1_epi16(static_cast<s16>(vol));
+  for (; i + 8 <= count; i += 8)
+  {
+    __m128i lo, hi;
+    MultiplyByVolume(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i)), vol_vec, &lo,
+                     &hi);
+    const __m128i scaled = _mm_packs_epi32(_mm_srai_epi32(lo, 15), _mm_srai_epi32(hi, 15));
+    const __m128i mixed =
+        _mm_add_epi16(_mm_loadu_si128(reinterpret_cast<__m128i*>(dst + i)), scaled);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), mixed);
+  }
+#elif defined(_M_ARM_64)
+  const int32x4_t vol_vec = vdupq_n_s32(vol);
+  for (; i + 8 <= count; i += 8)
+  {
+    const int16x8_t samples = vld1q_s16(src + i);
+    const int16x4_t lo = vqshrn_n_s32(vmulq_s32(vmovl_s16(vget_low_s16(samples)), vol_vec), 15);
+    const int16x4_t hi = vqshrn_n_s32(vmulq_s32(vmovl_s16(vget_high_s16(samples)), vol_vec), 15);
+    vst1q_s16(dst + i, vaddq_s16(vld1q_s16(dst + i), vcombine_s16(lo, hi)));
+  }
+#endif
+
+  for (; i < count; ++i)
+  {
+    s32 vol_src = ((s32)src[i] * (s32)vol) >> 15;
+    dst[i] += std::clamp(vol_src, -0x8000, 0x7FFF);
+  }
+}
+
+void Resample(s16* dst, size_t count, const s16* src, u32* pos_ptr, u32 ratio, const s16* coeffs)
+{
+  u32 pos = *pos_ptr;
+  size_t i = 0;
+
+  // We have 0x40 * 4 coeffs that need to be selected based on the most
+  // significant bits of the fractional part of the position. 12 bits >> 6 =
+  // 6 bits = 0x40. Multiply by 4 since there are 4 consecutive coeffs.
+  const auto coeffs_for = [coeffs](u32 p) { return coeffs + ((p & 0xFFF) >> 6) * 4; };
+
+#if defined(_M_X86)
+  // Each output sample is the sum of 4 products, shifted right by 15. The products are split in
+  // two parts so that the sums can't overflow: (hi << 15) + lo, with 0 <= lo < 0x8000.
+  const __m128i low_mask = _mm_set1_epi32(0x7FFF);
+  for (; i + 4 <= count; i += 4)
+  {
+    __m128i products[4];
+    for (size_t j = 0; j < 4; j += 2)
+    {
+      const u32 pos0 = pos;
+      const u32 pos1 = pos + ratio;
+      pos += 2 * ratio;
+
+      const __m128i input = _mm_unpacklo_epi64(
+          _mm_loadl_epi64(reinterpret_cast<const __m128i*>(src + (pos0 >> 12))),
+          _mm_loadl_epi64(reinterpret_cast<const __m128i*>(src + (pos1 >> 12))));
+      const __m128i coeff = _mm_unpacklo_epi64(
+          _mm_loadl_epi64(reinterpret_cast<const __m128i*>(coeffs_for(pos0))),
+          _mm_loadl_epi64(reinterpret_cast<const __m128i*>(coeffs_for(pos1))));
+      const __m128i lo = _mm_mullo_epi16(input, coeff);
+      const __m128i hi = _mm_mulhi_epi16(input, coeff);
+      products[j] = _mm_unpacklo_epi16(lo, hi);
+      products[j + 1] = _mm_unpackhi_epi16(lo, hi);
+    }
+
+    const __m128i high_sums =
+        HorizontalSums(_mm_srai_epi32(products[0], 15), _mm_srai_epi32(products[1], 15),
+                       _mm_srai_epi32(products[2], 15), _mm_srai_epi32(products[3], 15));
+    const __m128i low_sums = HorizontalSums(
+        _mm_and_si128(products[0], low_mask), _mm_and_si128(products[1], low_mask),
+        _mm_and_si128(products[2], low_mask), _mm_and_si128(products[3], low_mask));
+    const __m128i sums = _mm_add_epi32(high_sums, _mm_srli_epi32(low_sums, 15));
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(dst + i), _mm_packs_epi32(sums, sums));
+  }
+#elif defined(_M_ARM_64)
+  for (; i < count; ++i)
+  {
+    const int32x4_t products = vmull_s16(vld1_s16(src + (pos >> 12)), vld1_s16(coeffs_for(pos)));
+    dst[i] = (s16)std::clamp<s64>(vaddlvq_s32(products) >> 15, -0x8000, 0x7FFF);
+    pos += ratio;
+  }
+#endif
+
+  for (; i < count; ++i)
+  {
+    const s16* input = &src[pos >> 12];
+    const s16* sample_coeffs = coeffs_for(pos);
+
+    s64 dst_sample_unclamped = 0;
+    for (size_t j = 0; j < 4; ++j)
+      dst_sample_unclamped += (s64)2 * sample_coeffs[j] * input[j];
+    dst_sample_unclamped >>= 16;
+
+    dst[i] = (s16)std::clamp<s64>(dst_sample_unclamped, -0x8000, 0x7FFF);
+
+    pos += ratio;
+  }
+
+  *pos_ptr = pos;
+}
+
+void ApplyReverbFilter(s16* buf, size_t count, const s16* coeffs)
+{
+  // Each block of output samples only depends on input samples at the same or later positions, so
+  // filtering can be done in place as long as a block is fully computed before being stored.
+  size_t i = 0;
+
+#if defined(_M_X86)
+  for (; i + 8 <= count; i += 8)
+  {
+    __m128i sum_lo = _mm_setzero_si128();
+    __m128i sum_hi = _mm_setzero_si128();
+    for (size_t j = 0; j < 8; ++j)
+    {
+      const __m128i samples = _mm_loadu_si128(reinterpret_cast<const __m128i*>(buf + i + j));
+      const __m128i coeff = _mm_set1_epi16(coeffs[j]);
+      const __m128i lo = _mm_mullo_epi16(samples, coeff);
+      const __m128i hi = _mm_mulhi_epi16(samples, coeff);
+      sum_lo = _mm_add_epi32(sum_lo, _mm_unpacklo_epi16(lo, hi));
+      sum_hi = _mm_add_epi32(sum_hi, _mm_unpackhi_epi16(lo, hi));
+    }
+    const __m128i filtered =
+        _mm_packs_epi32(_mm_srai_epi32(sum_lo, 15), _mm_srai_epi32(sum_hi, 15));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(buf + i), filtered);
+  }
+#elif defined(_M_ARM_64)
+  for (; i + 8 <= count; i += 8)
+  {
+    int32x4_t sum_lo = vdupq_n_s32(0);
+    int32x4_t sum_hi = vdupq_n_s32(0);
+    for (size_t j = 0; j < 8; ++j)
+    {
+      const int16x8_t samples = vld1q_s16(buf + i + j);
+      sum_lo = vmlal_n_s16(sum_lo, vget_low_s16(samples), coeffs[j]);
+      sum_hi = vmlal_n_s16(sum_hi, vget_high_s16(samples), coeffs[j]);
+    }
+    vst1q_s16(buf + i, vcombine_s16(vqshrn_n_s32(sum_lo, 15), vqshrn_n_s32(sum_hi, 15)));
+  }
+#endif
+
+  for (; i < count; ++i)
+  {
+    s32 sample = 0;
+    for (size_t j = 0; j < 8; ++j)
+      sample += (s32)buf[i + j] * coeffs[j];
+    sample >>= 15;
+    buf[i] = std::clamp(sample, -0x8000, 0x7FFF);
+  }
+}
+
+void DecodeAFCBlock(s16* dst, const u8* src, bool hq, const s16* coeffs, s16* yn1_ptr,
+                    s16* yn2_ptr)
+{
+  s16 delta = 1 << ((*src >> 4) & 0xF);
+  s16 idx = (*src & 0xF);
+  src++;
+
+  // Unpack the nibbles and sign extend them to the top bits of each sample. Only this can be done
+  // in parallel, as each decoded sample depends on the previous two.
+  alignas(16) s16 nibbles[16];
+#if defined(_M_X86)
+  if (hq)
+  {
+    // Move each nibble to the top of its lane, then shift it back down arithmetically.
+    const __m128i bytes = _mm_unpacklo_epi8(
+        _mm_loadl_epi64(reinterpret_cast<const __m128i*>(src)), _mm_setzero_si128());
+    const __m128i scale = _mm_setr_epi16(1 << 8, 1 << 12, 1 << 8, 1 << 12, 1 << 8, 1 << 12,
+                                         1 << 8, 1 << 12);
+    const __m128i first = _mm_mullo_epi16(_mm_unpacklo_epi16(bytes, bytes), scale);
+    const __m128i second = _mm_mullo_epi16(_mm_unpackhi_epi16(bytes, bytes), scale);
+    _mm_store_si128(reinterpret_cast<__m128i*>(nibbles),
+                    _mm_slli_epi16(_mm_srai_epi16(first, 12), 11));
+    _mm_store_si128(reinterpret_cast<__m128i*>(nibbles + 8),
+                    _mm_slli_epi16(_mm_srai_epi16(second, 12), 11));
+  }
+  else
+  {
+    u32 word;
+    std::memcpy(&word, src, sizeof(word));
+    const __m128i bytes = _mm_unpacklo_epi8(_mm_cvtsi32_si128(word), _mm_setzero_si128());
+    const __m128i pairs = _mm_unpacklo_epi16(bytes, bytes);
+    const __m128i scale = _mm_setr_epi16(1 << 8, 1 << 10, 1 << 12, 1 << 14, 1 << 8, 1 << 10,
+                                         1 << 12, 1 << 14);
+    const __m128i first = _mm_mullo_epi16(_mm_unpacklo_epi32(pairs, pairs), scale);
+    const __m128i second = _mm_mullo_epi16(_mm_unpackhi_epi32(pairs, pairs), scale);
+    _mm_store_si128(reinterpret_cast<__m128i*>(nibbles),
+                    _mm_slli_epi16(_mm_srai_epi16(first, 14), 13));
+    _mm_store_si128(reinterpret_cast<__m128i*>(nibbles + 8),
+                    _mm_slli_epi16(_mm_srai_epi16(second, 14), 13));
+  }
+#elif defined(_M_ARM_64)
+  if (hq)
+  {
+    const int16x8_t bytes = vreinterpretq_s16_u16(vmovl_u8(vld1_u8(src)));
+    const int16x8x2_t pairs = vzipq_s16(bytes, bytes);
+    const int16_t shift_values[8] = {8, 12, 8, 12, 8, 12, 8, 12};
+    const int16x8_t shifts = vld1q_s16(shift_values);
+    vst1q_s16(nibbles, vshlq_n_s16(vshrq_n_s16(vshlq_s16(pairs.val[0], shifts), 12), 11));
+    vst1q_s16(nibbles + 8, vshlq_n_s16(vshrq_n_s16(vshlq_s16(pairs.val[1], shifts), 12), 11));
+  }
+  else
+  {
+    u32 word;
+    std::memcpy(&word, src, sizeof(word));
+    const int16x8_t bytes = vreinterpretq_s16_u16(vmovl_u8(vreinterpret_u8_u32(vdup_n_u32(word))));
+    const int16x8_t pairs = vzipq_s16(bytes, bytes).val[0];
+    const int32x4x2_t quads =
+        vzipq_s32(vreinterpretq_s32_s16(pairs), vreinterpretq_s32_s16(pairs));
+    const int16_t shift_values[8] = {8, 10, 12, 14, 8, 10, 12, 14};
+    const int16x8_t shifts = vld1q_s16(shift_values);
+    vst1q_s16(nibbles, vshlq_n_s16(
+                           vshrq_n_s16(vshlq_s16(vreinterpretq_s16_s32(quads.val[0]), shifts), 14),
+                           13));
+    vst1q_s16(nibbles + 8, vshlq_n_s16(vshrq_n_s16(vshlq_s16(vreinterpretq_s16_s32(quads.val[1]),
+                                                             shifts),
+                                                   14),
+                                       13));
+  }
+#else
+  if (hq)
+  {
+    for (size_t i = 0; i < 16; i += 2)
+    {
+      nibbles[i + 0] = *src >> 4;
+      nibbles[i + 1] = *src & 0xF;
+      src++;
+    }
+    for (auto& nibble : nibbles)
+    {
+      if (nibble >= 8)
+        nibble -= 16;
+      nibble <<= 11;
+    }
+  }
+  else
+  {
+    for (size_t i = 0; i < 16; i += 4)
+    {
+      nibbles[i + 0] = (*src >> 6) & 3;
+      nibbles[i + 1] = (*src >> 4) & 3;
+      nibbles[i + 2] = (*src >> 2) & 3;
+      nibbles[i + 3] = (*src >> 0) & 3;
+      src++;
+    }
+    for (auto& nibble : nibbles)
+    {
+      if (nibble >= 2)
+        nibble -= 4;
+      nibble <<= 13;
+    }
+  }
+#endif
+
+  const s32 coef1 = coeffs[idx * 2];
+  const s32 coef2 = coeffs[idx * 2 + 1];
+  s32 yn1 = *yn1_ptr, yn2 = *yn2_ptr;
+  for (size_t i = 0; i < 16; ++i)
+  {
+    s32 sample = delta * nibbles[i] + yn1 * coef1 + yn2 * coef2;
+    sample >>= 11;
+    sample = std::clamp(sample, -0x8000, 0x7fff);
+    *dst++ = (s16)sample;
+    yn2 = yn1;
+    yn1 = sample;
+  }
+
+  *yn2_ptr = yn2;
+  *yn1_ptr = yn1;
+}
+}  // namespace ZeldaMixing
+
 // Utility to define 32 bit accessors/modifiers methods based on two 16 bit
 // fields named _l and _h.
 #define DEFINE_32BIT_ACCESSOR(field_name, name)                                                    \
@@ -1079,14 +1482,7 @@ void ZeldaAudioRenderer::ApplyReverb(bool post_rendering)
 
       auto ApplyFilter = [&]() {
         // Filter the buffer using provided coefficients.
-        for (u16 i = 0; i < 0x50; ++i)
-        {
-          s32 sample = 0;
-          for (u16 j = 0; j < 8; ++j)
-            sample += (s32)buffer[i + j] * rpb.filter_coeffs[j];
-          sample >>= 15;
-          buffer[i] = std::clamp(sample, -0x8000, 0x7FFF);
-        }
+        ZeldaMixing::ApplyReverbFilter(buffer.data(), 0x50, rpb.filter_coeffs);
       };
 
       // LSB set -> pre-filtering.
@@ -1510,25 +1906,7 @@ void ZeldaAudioRenderer::Resample(VPB* vpb, const s16* src, MixingBuffer* dst)
   }
   else
   {
-    for (auto& dst_sample : *dst)
-    {
-      // We have 0x40 * 4 coeffs that need to be selected based on the
-      // most significant bits of the fractional part of the position. 12
-      // bits >> 6 = 6 bits = 0x40. Multiply by 4 since there are 4
-      // consecutive coeffs.
-      u32 coeffs_idx = ((pos & 0xFFF) >> 6) * 4;
-      const s16* coeffs = &m_resampling_coeffs[coeffs_idx];
-      const s16* input = &src[pos >> 12];
-
-      s64 dst_sample_unclamped = 0;
-      for (size_t i = 0; i < 4; ++i)
-        dst_sample_unclamped += (s64)2 * coeffs[i] * input[i];
-      dst_sample_unclamped >>= 16;
-
-      dst_sample = (s16)std::clamp<s64>(dst_sample_unclamped, -0x8000, 0x7FFF);
-
-      pos += ratio;
-    }
+    ZeldaMixing::Resample(dst->data(), dst->size(), src, &pos, ratio, m_resampling_coeffs.data());
   }
 
   for (u32 i = 0; i < 4; ++i)
@@ -1717,60 +2095,12 @@ void ZeldaAudioRenderer::DecodeAFC(VPB* vpb, s16* dst, size_t block_count)
   u8* src = (u8*)GetARAMPtr() + addr;
   vpb->SetCurrentARAMAddr(addr + (u32)block_count * vpb->samples_source_type);
 
+  const bool hq = vpb->samples_source_type == VPB::SRC_AFC_HQ_FROM_ARAM;
   for (size_t b = 0; b < block_count; ++b)
   {
-    s16 nibbles[16];
-    s16 delta = 1 << ((*src >> 4) & 0xF);
-    s16 idx = (*src & 0xF);
-    src++;
-
-    if (vpb->samples_source_type == VPB::SRC_AFC_HQ_FROM_ARAM)
-    {
-      for (size_t i = 0; i < 16; i += 2)
-      {
-        nibbles[i + 0] = *src >> 4;
-        nibbles[i + 1] = *src & 0xF;
-        src++;
-      }
-      for (auto& nibble : nibbles)
-      {
-        if (nibble >= 8)
-          nibble -= 16;
-        nibble <<= 11;
-      }
-    }
-    else
-    {
-      for (size_t i = 0; i < 16; i += 4)
-      {
-        nibbles[i + 0] = (*src >> 6) & 3;
-        nibbles[i + 1] = (*src >> 4) & 3;
-        nibbles[i + 2] = (*src >> 2) & 3;
-        nibbles[i + 3] = (*src >> 0) & 3;
-        src++;
-      }
-      for (auto& nibble : nibbles)
-      {
-        if (nibble >= 2)
-          nibble -= 4;
-        nibble <<= 13;
-      }
-    }
-
-    s32 yn1 = *vpb->AFCYN1(), yn2 = *vpb->AFCYN2();
-    for (size_t i = 0; i < 16; ++i)
-    {
-      s32 sample =
-          delta * nibbles[i] + yn1 * m_afc_coeffs[idx * 2] + yn2 * m_afc_coeffs[idx * 2 + 1];
-      sample >>= 11;
-      sample = std::clamp(sample, -0x8000, 0x7fff);
-      *dst++ = (s16)sample;
-      yn2 = yn1;
-      yn1 = sample;
-    }
-
-    *vpb->AFCYN2() = yn2;
-    *vpb->AFCYN1() = yn1;
+    ZeldaMixing::DecodeAFCBlock(dst, src, hq, m_afc_coeffs.data(), vpb->AFCYN1(), vpb->AFCYN2());
+    src += vpb->samples_source_type;
+    dst += 16;
   }
 }
 
@@ -14,6 +14,31 @@ namespace DSP::HLE
 {
 class DSPHLE;
 
+// Sample processing routines used by the Zelda UCode renderer. They work on whole buffers at a
+// time, using SIMD where possible, and give the same results as processing samples one by one.
+namespace ZeldaMixing
+{
+// Applies a volume in 1.15 (int_bits = 1) or 4.12 (int_bits = 4) fixed point format to a buffer.
+void ApplyVolumeInPlace(s16* buf, size_t count, u16 vol, u32 int_bits);
+
+// Mixes src into dst with a volume in 16.16 format which is increased by step after each sample.
+// Returns the volume after the last sample.
+s32 AddBuffersWithVolumeRamp(s16* dst, const s16* src, size_t count, s32 vol, s32 step);
+
+// Mixes src into dst with a volume in 1.15 format.
+void AddBuffersWithVolume(s16* dst, const s16* src, size_t count, u16 vol);
+
+// Resamples src to count samples with a 4-tap filter. pos and ratio are in 20.12 format, and pos
+// is updated to the position after the last sample. coeffs contains 0x40 sets of 4 coefficients.
+void Resample(s16* dst, size_t count, const s16* src, u32* pos, u32 ratio, const s16* coeffs);
+
+// Filters count samples in place with an 8-tap filter. buf must hold count + 7 samples.
+void ApplyReverbFilter(s16* buf, size_t count, const s16* coeffs);
+
+// Decodes one AFC block (9 bytes in HQ mode, 5 bytes otherwise) to 16 samples.
+void DecodeAFCBlock(s16* dst, const u8* src, bool hq, const s16* coeffs, s16* yn1, s16* yn2);
+}  // namespace ZeldaMixing
+
 class ZeldaAudioRenderer
 {
 public:
@@ -44,26 +69,15 @@ private:
 
   // Apply volume to a buffer. The volume is a fixed point integer, usually
   // 1.15 or 4.12 in the DAC UCode.
-  template <size_t N, size_t B>
-  void ApplyVolumeInPlace(std::array<s16, N>* buf, u16 vol)
-  {
-    for (size_t i = 0; i < N; ++i)
-    {
-      s32 tmp = (u32)(*buf)[i] * (u32)vol;
-      tmp >>= 16 - B;
-
-      (*buf)[i] = (s16)std::clamp(tmp, -0x8000, 0x7FFF);
-    }
-  }
   template <size_t N>
   void ApplyVolumeInPlace_1_15(std::array<s16, N>* buf, u16 vol)
   {
-    ApplyVolumeInPlace<N, 1>(buf, vol);
+    ZeldaMixing::ApplyVolumeInPlace(buf->data(), N, vol, 1);
   }
   template <size_t N>
   void ApplyVolumeInPlace_4_12(std::array<s16, N>* buf, u16 vol)
   {
-    ApplyVolumeInPlace<N, 4>(buf, vol);
+    ZeldaMixing::ApplyVolumeInPlace(buf->data(), N, vol, 4);
   }
 
   // Mixes two buffers together while applying a volume to one of them. The
@@ -78,24 +92,14 @@ private:
     if (!vol && !step)
       return vol;
 
-    for (size_t i = 0; i < N; ++i)
-    {
-      (*dst)[i] += ((vol >> 16) * src[i]) >> 16;
-      vol += step;
-    }
-
-    return vol;
+    return ZeldaMixing::AddBuffersWithVolumeRamp(dst->data(), src.data(), N, vol, step);
   }
 
   // Does not use std::array because it needs to be able to process partial
   // buffers. Volume is in 1.15 format.
   void AddBuffersWithVolume(s16* dst, const s16* src, size_t count, u16 vol)
   {
-    while (count--)
-    {
-      s32 vol_src = ((s32)*src++ * (s32)vol) >> 15;
-      *dst++ += std::clamp(vol_src, -0x8000, 0x7FFF);
-    }
+    ZeldaMixing::AddBuffersWithVolume(dst, src, count, vol);
   }
 
   // Whether the frame needs to be prepared or not.
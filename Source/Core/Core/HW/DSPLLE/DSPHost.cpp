@@ -10,11 +10,13 @@
 #include "Common/Hash.h"
 #include "Common/Logging/Log.h"
 #include "Core/ConfigManager.h"
+#include "Core/Core.h"
 #include "Core/DSP/DSPAnalyzer.h"
 #include "Core/DSP/DSPCodeUtil.h"
 #include "Core/DSP/DSPCore.h"
 #include "Core/DSP/Jit/x64/DSPEmitter.h"
 #include "Core/HW/DSP.h"
+#include "Core/HW/DSPLLE/DSPLLE.h"
 #include "Core/HW/DSPLLE/DSPSymbols.h"
 #include "Core/Host.h"
 #include "VideoCommon/OnScreenDisplay.h"
@@ -26,16 +28,31 @@
 
 namespace DSP::Host
 {
+static LLE::DSPLLE* GetLLE()
+{
+  return static_cast<LLE::DSPLLE*>(DSP::GetDSPEmulator());
+}
+
 u8 ReadHostMemory(u32 addr)
 {
+  // On the Wii, "ARAM" is memory the CPU can access directly.
+  if (IsWiiHost())
+    PrepareMemoryAccess();
   return DSP::ReadARAM(addr);
 }
 
 void WriteHostMemory(u8 value, u32 addr)
 {
+  if (IsWiiHost())
+    PrepareMemoryAccess();
   DSP::WriteARAM(value, addr);
 }
 
+void PrepareMemoryAccess()
+{
+  GetLLE()->PrepareMemoryAccess();
+}
+
 void OSD_AddMessage(std::string str, u32 ms)
 {
   OSD::AddMessage(std::move(str), ms);
@@ -43,7 +60,9 @@ void OSD_AddMessage(std::string str, u32 ms)
 
 bool OnThread()
 {
-  return SConfig::GetInstance().bDSPThread;
+  // In deterministic mode, the DSP thread never runs while the CPU is accessing the DSP, so it
+  // must behave exactly as if it ran on the CPU thread.
+  return SConfig::GetInstance().bDSPThread && !Core::WantsDeterminism();
 }
 
 bool IsWiiHost()
@@ -54,7 +73,7 @@ bool IsWiiHost()
 void InterruptRequest()
 {
   // Fire an interrupt on the PPC ASAP.
-  DSP::GenerateDSPInterruptFromDSPEmu(DSP::INT_DSP);
+  GetLLE()->RequestInterrupt();
 }
 
 void CodeLoaded(const u8* ptr, int size)
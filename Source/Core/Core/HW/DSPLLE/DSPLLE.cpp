@@ -26,6 +26,7 @@
 #include "Core/DSP/DSPTables.h"
 #include "Core/DSP/Interpreter/DSPInterpreter.h"
 #include "Core/DSP/Jit/DSPEmitterBase.h"
+#include "Core/HW/DSP.h"
 #include "Core/HW/DSPLLE/DSPLLEGlobals.h"
 #include "Core/HW/Memmap.h"
 #include "Core/Host.h"
@@ -34,6 +35,7 @@ namespace DSP::LLE
 {
 static Common::Event s_dsp_event;
 static Common::Event s_ppc_event;
+static Common::Event s_memory_event;
 static bool s_request_disable_thread;
 
 DSPLLE::DSPLLE() = default;
@@ -83,9 +85,16 @@ void DSPLLE::DoState(PointerWrap& p)
   p.DoArray(g_dsp.dram, DSP_DRAM_SIZE);
   p.Do(g_init_hax);
   p.Do(m_cycle_count);
+  p.Do(m_pending_interrupts);
 
   if (g_dsp_jit)
     g_dsp_jit->DoState(p);
+
+  WakeUp();
+
+  // The loaded state may have a slice left to run.
+  if (p.GetMode() == PointerWrap::MODE_READ && m_is_dsp_on_thread)
+    s_dsp_event.Set();
 }
 
 // Regular thread
@@ -95,13 +104,14 @@ void DSPLLE::DSPThread(DSPLLE* dsp_lle)
 
   while (dsp_lle->m_is_running.IsSet())
   {
-    const int cycles = static_cast<int>(dsp_lle->m_cycle_count.load());
-    if (cycles > 0)
+    if (dsp_lle->m_cycle_count.load() > 0)
     {
       std::lock_guard<std::mutex> dsp_thread_lock(dsp_lle->m_dsp_thread_mutex);
+      // Loading a state while we were waiting for the lock may have changed this.
+      const int cycles = static_cast<int>(dsp_lle->m_cycle_count.load());
       if (g_dsp_jit)
       {
-        DSPCore_RunCycles(cycles);
+        dsp_lle->RunDSP(cycles);
       }
       else
       {
@@ -117,6 +127,83 @@ void DSPLLE::DSPThread(DSPLLE* dsp_lle)
   }
 }
 
+void DSPLLE::RunDSP(int cycles)
+{
+  const u32 wake_count = m_wake_count.load();
+  m_is_parked.store(false);
+
+  DSPCore_RunCycles(cycles);
+
+  // Nothing the DSP does by itself can get it out of the idle loop, so running it again would
+  // only repeat the same polling until the CPU touches the mailboxes or the control register.
+  if (g_dsp.idle_waiting)
+  {
+    m_parked_wake_count.store(wake_count);
+    m_is_parked.store(true);
+  }
+}
+
+void DSPLLE::WaitForSlice()
+{
+  // The event may still be set from a slice that has already been waited for.
+  while (m_cycle_count.load() != 0)
+    s_ppc_event.Wait();
+}
+
+void DSPLLE::SyncDSP()
+{
+  if (!m_is_deterministic)
+    return;
+
+  if (!m_is_dsp_on_thread)
+  {
+    const int cycles = static_cast<int>(m_cycle_count.exchange(0));
+    if (cycles > 0)
+      RunDSP(cycles);
+    return;
+  }
+
+  if (m_cycle_count.load() != 0)
+  {
+    // The CPU can't change main memory while it's waiting here, so the rest of the slice can
+    // access it.
+    m_memory_unlocked.Set();
+    s_memory_event.Set();
+    WaitForSlice();
+    m_memory_unlocked.Clear();
+  }
+
+  for (u32 count = m_pending_interrupts.exchange(0); count > 0; --count)
+    DSP::GenerateDSPInterruptFromDSPEmu(DSP::INT_DSP);
+}
+
+void DSPLLE::RequestInterrupt()
+{
+  if (m_is_deterministic && m_is_dsp_on_thread)
+    m_pending_interrupts.fetch_add(1);
+  else
+    DSP::GenerateDSPInterruptFromDSPEmu(DSP::INT_DSP);
+}
+
+void DSPLLE::PrepareMemoryAccess()
+{
+  if (!m_is_deterministic || !m_is_dsp_on_thread)
+    return;
+
+  while (!m_memory_unlocked.IsSet() && m_is_running.IsSet())
+    s_memory_event.Wait();
+}
+
+bool DSPLLE::IsParked() const
+{
+  return m_is_parked.load() && m_parked_wake_count.load() == m_wake_count.load();
+}
+
+void DSPLLE::WakeUp()
+{
+  m_wake_count.fetch_add(1);
+}
+
 static bool LoadDSPRom(u16* rom, const std::string& filename, u32 size_in_bytes)
 {
   std::string bytes;
@@ -178,11 +265,13 @@ bool DSPLLE::Initialize(bool wii, bool dsp_thread)
     return false;
 
   // needs to be after DSPCore_Init for the dspjit ptr
-  if (Core::WantsDeterminism() || !g_dsp_jit)
+  if (!g_dsp_jit)
     dsp_thread = false;
 
   m_wii = wii;
   m_is_dsp_on_thread = dsp_thread;
+  m_is_deterministic = Core::WantsDeterminism();
+  m_pending_interrupts.store(0);
 
   // DSPLLE directly accesses the fastmem arena.
   // TODO: The fastmem arena is only supposed to be used by the JIT:
@@ -209,6 +298,7 @@ void DSPLLE::DSP_StopSoundStream()
     m_is_running.Clear();
     s_ppc_event.Set();
     s_dsp_event.Set();
+    s_memory_event.Set();
     m_dsp_thread.join();
   }
 }
@@ -220,11 +310,14 @@ void DSPLLE::Shutdown()
 
 u16 DSPLLE::DSP_WriteControlRegister(u16 value)
 {
+  SyncDSP();
   DSP::Interpreter::WriteCR(value);
+  WakeUp();
 
   if (value & 2)
   {
-    if (!m_is_dsp_on_thread)
+    // In deterministic mode, the DSP thread is never running at this point.
+    if (!m_is_dsp_on_thread || m_is_deterministic)
     {
       DSPCore_CheckExternalInterrupt();
       DSPCore_CheckExceptions();
@@ -244,21 +337,27 @@ u16 DSPLLE::DSP_WriteControlRegister(u16 value)
 
 u16 DSPLLE::DSP_ReadControlRegister()
 {
+  SyncDSP();
   return DSP::Interpreter::ReadCR();
 }
 
 u16 DSPLLE::DSP_ReadMailBoxHigh(bool cpu_mailbox)
 {
+  SyncDSP();
   return gdsp_mbox_read_h(cpu_mailbox ? MAILBOX_CPU : MAILBOX_DSP);
 }
 
 u16 DSPLLE::DSP_ReadMailBoxLow(bool cpu_mailbox)
 {
+  // Reading the low half of a mailbox marks it as empty.
+  SyncDSP();
+  WakeUp();
   return gdsp_mbox_read_l(cpu_mailbox ? MAILBOX_CPU : MAILBOX_DSP);
 }
 
 void DSPLLE::DSP_WriteMailBoxHigh(bool cpu_mailbox, u16 value)
 {
+  SyncDSP();
   if (cpu_mailbox)
   {
     if (gdsp_mbox_peek(MAILBOX_CPU) & 0x80000000)
@@ -274,6 +373,7 @@ void DSPLLE::DSP_WriteMailBoxHigh(bool cpu_mailbox, u16 value)
 #endif
 
     gdsp_mbox_write_h(MAILBOX_CPU, value);
+    WakeUp();
   }
   else
   {
@@ -283,9 +383,11 @@ void DSPLLE::DSP_WriteMailBoxHigh(bool cpu_mailbox, u16 value)
 
 void DSPLLE::DSP_WriteMailBoxLow(bool cpu_mailbox, u16 value)
 {
+  SyncDSP();
   if (cpu_mailbox)
   {
     gdsp_mbox_write_l(MAILBOX_CPU, value);
+    WakeUp();
   }
   else
   {
@@ -300,27 +402,47 @@ void DSPLLE::DSP_Update(int cycles)
   if (dsp_cycles <= 0)
     return;
 
-  if (m_is_dsp_on_thread)
+  // Finish the slice from the last update before anything else looks at the DSP.
+  SyncDSP();
+
+  if (m_is_dsp_on_thread && s_request_disable_thread)
   {
-    if (s_request_disable_thread || Core::WantsDeterminism())
-    {
-      DSP_StopSoundStream();
-      m_is_dsp_on_thread = false;
-      s_request_disable_thread = false;
-      SConfig::GetInstance().bDSPThread = false;
-    }
+    DSP_StopSoundStream();
+    m_is_dsp_on_thread = false;
+    s_request_disable_thread = false;
+    SConfig::GetInstance().bDSPThread = false;
   }
 
+  if (m_is_deterministic != Core::WantsDeterminism())
+  {
+    if (m_is_dsp_on_thread)
+      WaitForSlice();
+    m_is_deterministic = Core::WantsDeterminism();
+    // Whether the JIT skips idle loops depends on this (see Host::OnThread).
+    if (g_dsp_jit)
+      g_dsp_jit->ClearIRAM();
+  }
+
+  // The DSP is only parked while it's done running its last slice, so this is safe to check
+  // without waiting for the DSP thread.
+  if (IsParked())
+    return;
+
   // If we're not on a thread, run cycles here.
   if (!m_is_dsp_on_thread)
   {
     // ~1/6th as many cycles as the period PPC-side.
-    DSPCore_RunCycles(dsp_cycles);
+    // In deterministic mode, the slice is put off until the next sync point, which is where the
+    // DSP thread would have to wait for it.
+    if (m_is_deterministic)
+      m_cycle_count.fetch_add(dsp_cycles);
+    else
+      RunDSP(dsp_cycles);
   }
   else
   {
     // Wait for DSP thread to complete its cycle. Note: this logic should be thought through.
-    s_ppc_event.Wait();
+    WaitForSlice();
     m_cycle_count.fetch_add(dsp_cycles);
     s_dsp_event.Set();
   }
@@ -334,7 +456,17 @@ u32 DSPLLE::DSP_UpdateRate()
 void DSPLLE::PauseAndLock(bool do_lock, bool unpause_on_unlock)
 {
   if (do_lock)
+  {
+    // The CPU is paused, so a slice that's waiting for a sync point can just as well go on from
+    // here. It couldn't finish otherwise.
+    if (m_is_deterministic && m_is_dsp_on_thread)
+    {
+      m_memory_unlocked.Set();
+      s_memory_event.Set();
+    }
     m_dsp_thread_mutex.lock();
+    m_memory_unlocked.Clear();
+  }
   else
     m_dsp_thread_mutex.unlock();
 }
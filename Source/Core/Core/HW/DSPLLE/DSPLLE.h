@@ -38,13 +38,41 @@ public:
   void DSP_StopSoundStream() override;
   u32 DSP_UpdateRate() override;
 
+  // Deterministic mode (used when Core::WantsDeterminism() is set): the DSP only runs a slice
+  // once the CPU reaches a sync point, i.e. a DSP register access, an ARAM DMA or the next
+  // update. On the DSP thread, the slice runs ahead of that in parallel with the CPU, but it
+  // waits for the sync point before touching main memory and holds back its interrupts until
+  // then, so the result doesn't depend on which thread (or how fast) it ran.
+  void SyncDSP();
+
+  // Called by the DSP core, on the DSP thread if there is one.
+  void RequestInterrupt();
+  void PrepareMemoryAccess();
+
 private:
   static void DSPThread(DSPLLE* dsp_lle);
+  void RunDSP(int cycles);
+  void WaitForSlice();
+  bool IsParked() const;
+  void WakeUp();
 
   std::thread m_dsp_thread;
   std::mutex m_dsp_thread_mutex;
   bool m_is_dsp_on_thread = false;
   Common::Flag m_is_running;
   std::atomic<u32> m_cycle_count{};
+
+  bool m_is_deterministic = false;
+  // Set while the CPU thread is blocked in SyncDSP.
+  Common::Flag m_memory_unlocked;
+  // Interrupts the DSP thread requested during its current slice.
+  std::atomic<u32> m_pending_interrupts{};
+
+  // Incremented whenever the CPU does something that could end an idle loop of the DSP.
+  std::atomic<u32> m_wake_count{};
+  // Whether the DSP is waiting in an idle loop, and the value of m_wake_count when it started the
+  // slice that ended up there. The DSP doesn't need to run again until m_wake_count changes.
+  std::atomic<bool> m_is_parked{};
+  std::atomic<u32> m_parked_wake_count{};
 };
 }  // namespace DSP::LLE
@@ -0,0 +1,199 @@
+// Copyright 2019 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include "Core/HW/DVD/DVDPrefetcher.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "Common/CommonTypes.h"
+#include "Common/File.h"
+#include "Common/Logging/Log.h"
+#include "Common/Swap.h"
+
+namespace DVDThread
+{
+// Access log files start with "DVDL" and a version number, followed by the entries. All fields are
+// stored big endian and without padding, so that logs can be shared between hosts.
+constexpr u32 ACCESS_LOG_MAGIC = 0x4456444C;
+constexpr u32 ACCESS_LOG_VERSION = 2;
+constexpr size_t ACCESS_LOG_HEADER_SIZE = 8;
+constexpr size_t ACCESS_LOG_ENTRY_SIZE = 28;
+
+template <typename T>
+static void WriteSwapped(u8** out, T value)
+{
+  value = Common::FromBigEndian(value);
+  std::memcpy(*out, &value, sizeof(T));
+  *out += sizeof(T);
+}
+
+template <typename T>
+static T ReadSwapped(const u8** in)
+{
+  T value;
+  std::memcpy(&value, *in, sizeof(T));
+  *in += sizeof(T);
+  return Common::FromBigEndian(value);
+}
+
+Prefetcher::Prefetcher(u64 replay_lookahead_us)
+    : m_replay_lookahead_us(replay_lookahead_us)
+{
+}
+
+void Prefetcher::OnRead(const DiscIO::Partition& partition, u64 offset, u32 length, u64 time_us)
+{
+  if (!m_first_read_time)
+    m_first_read_time = time_us;
+  // Loading a savestate can move emulated time backwards
+  m_current_time = time_us >= *m_first_read_time ? time_us - *m_first_read_time : 0;
+
+  if (m_recording)
+    Record(partition, offset, length, m_current_time);
+
+  if (partition == m_stream_partition && offset == m_stream_end)
+  {
+    ++m_sequential_reads;
+  }
+  else
+  {
+    m_stream_partition = partition;
+    m_sequential_reads = 0;
+    m_prefetched_until = 0;
+  }
+  m_stream_end = offset + length;
+  m_prefetched_until = std::max(m_prefetched_until, m_stream_end);
+
+  while (m_replay_position < m_replay_log.size() &&
+         m_replay_log[m_replay_position].time_us <= m_current_time + m_replay_lookahead_us)
+  {
+    m_hints.push_back(m_replay_log[m_replay_position++]);
+  }
+}
+
+std::optional<Prefetcher::Range> Prefetcher::GetNextPrefetch()
+{
+  // Continuing the current stream is what is most likely to be needed soon
+  if (m_sequential_reads != 0 && m_prefetched_until < m_stream_end + READ_AHEAD_SIZE)
+  {
+    const u32 length =
+        static_cast<u32>(std::min<u64>(m_stream_end + READ_AHEAD_SIZE - m_prefetched_until,
+                                       MAX_PREFETCH_SIZE));
+    const Range range{m_stream_partition, m_prefetched_until, length};
+    m_prefetched_until += length;
+    return range;
+  }
+
+  while (!m_hints.empty())
+  {
+    AccessLogEntry& hint = m_hints.front();
+
+    // If emulated time has moved well past a hint, the data has most likely been read already
+    if (hint.time_us + m_replay_lookahead_us < m_current_time || hint.length == 0)
+    {
+      m_hints.pop_front();
+      continue;
+    }
+
+    const u32 length = std::min(hint.length, MAX_PREFETCH_SIZE);
+    const Range range{DiscIO::Partition(hint.partition_offset), hint.offset, length};
+    hint.offset += length;
+    hint.length -= length;
+    if (hint.length == 0)
+      m_hints.pop_front();
+    return range;
+  }
+
+  return std::nullopt;
+}
+
+void Prefetcher::SetRecording(bool recording)
+{
+  m_recording = recording;
+}
+
+u64 Prefetcher::GetRecordedDuration() const
+{
+  return m_recorded_log.empty() ? 0 : m_recorded_log.back().time_us;
+}
+
+u64 Prefetcher::GetReplayedDuration() const
+{
+  return m_replay_log.empty() ? 0 : m_replay_log.back().time_us;
+}
+
+void Prefetcher::Record(const DiscIO::Partition& partition, u64 offset, u32 length, u64 time_us)
+{
+  // Sequential reads are merged to keep the log small, but not into ranges so large that
+  // replaying them would read much further ahead than the stream detection does.
+  if (!m_recorded_log.empty())
+  {
+    AccessLogEntry& last = m_recorded_log.back();
+    if (last.partition_offset == partition.offset && last.offset + last.length == offset &&
+        u64(last.length) + length <= READ_AHEAD_SIZE)
+    {
+      last.length += length;
+      return;
+    }
+  }
+
+  if (m_recorded_log.size() < MAX_ACCESS_LOG_ENTRIES)
+    m_recorded_log.push_back(AccessLogEntry{time_us, partition.offset, offset, length});
+}
+
+bool Prefetcher::LoadAccessLog(const std::string& path)
+{
+  File::IOFile file(path, "rb");
+  const u64 file_size = file.GetSize();
+  if (file_size < ACCESS_LOG_HEADER_SIZE ||
+      (file_size - ACCESS_LOG_HEADER_SIZE) % ACCESS_LOG_ENTRY_SIZE != 0 ||
+      (file_size - ACCESS_LOG_HEADER_SIZE) / ACCESS_LOG_ENTRY_SIZE > MAX_ACCESS_LOG_ENTRIES)
+  {
+    return false;
+  }
+
+  std::vector<u8> data(static_cast<size_t>(file_size));
+  if (!file.ReadBytes(data.data(), data.size()))
+    return false;
+
+  const u8* in = data.data();
+  if (ReadSwapped<u32>(&in) != ACCESS_LOG_MAGIC || ReadSwapped<u32>(&in) != ACCESS_LOG_VERSION)
+    return false;
+
+  std::vector<AccessLogEntry> log((data.size() - ACCESS_LOG_HEADER_SIZE) / ACCESS_LOG_ENTRY_SIZE);
+  for (AccessLogEntry& entry : log)
+  {
+    entry.time_us = ReadSwapped<u64>(&in);
+    entry.partition_offset = ReadSwapped<u64>(&in);
+    entry.offset = ReadSwapped<u64>(&in);
+    entry.length = ReadSwapped<u32>(&in);
+  }
+
+  m_replay_log = std::move(log);
+  m_replay_position = 0;
+  m_hints.clear();
+  INFO_LOG(DVDINTERFACE, "Loaded %zu DVD access log entries from %s", m_replay_log.size(),
+           path.c_str());
+  return true;
+}
+
+bool Prefetcher::SaveAccessLog(const std::string& path) const
+{
+  std::vector<u8> data(ACCESS_LOG_HEADER_SIZE + m_recorded_log.size() * ACCESS_LOG_ENTRY_SIZE);
+  u8* out = data.data();
+  WriteSwapped(&out, ACCESS_LOG_MAGIC);
+  WriteSwapped(&out, ACCESS_LOG_VERSION);
+  for (const AccessLogEntry& entry : m_recorded_log)
+  {
+    WriteSwapped(&out, entry.time_us);
+    WriteSwapped(&out, entry.partition_offset);
+    WriteSwapped(&out, entry.offset);
+    WriteSwapped(&out, entry.length);
+  }
+
+  File::IOFile file(path, "wb");
+  return file.WriteBytes(data.data(), data.size());
+}
+}  // namespace DVDThread
@@ -0,0 +1,85 @@
+// Copyright 2019 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <deque>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "Common/CommonTypes.h"
+#include "DiscIO/Volume.h"
+
+namespace DVDThread
+{
+// Decides what the DVD thread should read from the disc while it has nothing else to do, so that
+// the reads the emulated software makes later are served from the host's caches. It never affects
+// what the emulated software sees or when it sees it.
+//
+// Two sources are used: reads that continue a sequential stream, and the access log of an earlier
+// session with the same disc, which gets replayed slightly ahead of emulated time.
+class Prefetcher
+{
+public:
+  struct Range
+  {
+    DiscIO::Partition partition;
+    u64 offset;
+    u32 length;
+  };
+
+  struct AccessLogEntry
+  {
+    // Emulated time in microseconds since the first read of the session
+    u64 time_us;
+    u64 partition_offset;
+    u64 offset;
+    u32 length;
+  };
+
+  // How far ahead of a sequential stream to read
+  static constexpr u32 READ_AHEAD_SIZE = 0x100000;
+  // The largest amount of data returned by a single GetNextPrefetch call
+  static constexpr u32 MAX_PREFETCH_SIZE = 0x20000;
+  static constexpr size_t MAX_ACCESS_LOG_ENTRIES = 0x100000;
+
+  // Access log entries are prefetched once emulated time is within <replay_lookahead_us> of them
+  explicit Prefetcher(u64 replay_lookahead_us);
+
+  // Must be called for every read the emulated software makes, in order. <time_us> is the emulated
+  // time at which the read was started.
+  void OnRead(const DiscIO::Partition& partition, u64 offset, u32 length, u64 time_us);
+  std::optional<Range> GetNextPrefetch();
+
+  void SetRecording(bool recording);
+  const std::vector<AccessLogEntry>& GetAccessLog() const { return m_recorded_log; }
+  // Emulated time covered by the recorded log, or by the log loaded for replaying.
+  u64 GetRecordedDuration() const;
+  u64 GetReplayedDuration() const;
+
+  bool LoadAccessLog(const std::string& path);
+  bool SaveAccessLog(const std::string& path) const;
+
+private:
+  void Record(const DiscIO::Partition& partition, u64 offset, u32 length, u64 time_us);
+
+  const u64 m_replay_lookahead_us;
+  std::optional<u64> m_first_read_time;
+  u64 m_current_time = 0;
+
+  // The sequential stream that was read last
+  DiscIO::Partition m_stream_partition;
+  u64 m_stream_end = 0;
+  u32 m_sequential_reads = 0;
+  u64 m_prefetched_until = 0;
+
+  std::vector<AccessLogEntry> m_replay_log;
+  size_t m_replay_position = 0;
+  std::deque<AccessLogEntry> m_hints;
+
+  bool m_recording = false;
+  std::vector<AccessLogEntry> m_recorded_log;
+};
+}  // namespace DVDThread
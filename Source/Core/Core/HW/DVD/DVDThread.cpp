@@ -4,11 +4,13 @@
 
 #include "Core/HW/DVD/DVDThread.h"
 
+#include <algorithm>
 #include <cinttypes>
 #include <map>
 #include <memory>
 #include <mutex>
 #include <optional>
+#include <string>
 #include <thread>
 #include <utility>
 #include <vector>
@@ -16,10 +18,12 @@
 #include "Common/ChunkFile.h"
 #include "Common/CommonTypes.h"
 #include "Common/Event.h"
+#include "Common/FileUtil.h"
 #include "Common/Flag.h"
 #include "Common/Logging/Log.h"
 #include "Common/MsgHandler.h"
 #include "Common/SPSCQueue.h"
+#include "Common/StringUtil.h"
 #include "Common/Thread.h"
 #include "Common/Timer.h"
 
@@ -27,6 +31,7 @@
 #include "Core/Core.h"
 #include "Core/CoreTiming.h"
 #include "Core/HW/DVD/DVDInterface.h"
+#include "Core/HW/DVD/DVDPrefetcher.h"
 #include "Core/HW/DVD/FileMonitor.h"
 #include "Core/HW/Memmap.h"
 #include "Core/HW/SystemTimers.h"
@@ -65,10 +70,15 @@ using ReadResult = std::pair<ReadRequest, std::vector<u8>>;
 
 static void StartDVDThread();
 static void StopDVDThread();
+static void StopDVDThreadWhenIdle();
 
 static void DVDThread();
 static void WaitUntilIdle();
 
+static void CreatePrefetcher();
+static void SaveAccessLog();
+static void Prefetch(const Prefetcher::Range& range);
+
 static void StartReadInternal(bool copy_to_ram, u32 output_address, u64 dvd_offset, u32 length,
                               const DiscIO::Partition& partition,
                               DVDInterface::ReplyType reply_type, s64 ticks_until_completion);
@@ -89,6 +99,11 @@ static std::map<u64, ReadResult> s_result_map;
 
 static std::unique_ptr<DiscIO::Volume> s_disc;
 
+// Like s_disc, only used by the DVD thread unless it is idle
+static std::unique_ptr<Prefetcher> s_prefetcher;
+static std::string s_access_log_path;
+static std::vector<u8> s_prefetch_buffer;
+
 void Start()
 {
   s_finish_read = CoreTiming::RegisterEvent("FinishReadDVDThread", FinishRead);
@@ -109,12 +124,17 @@ static void StartDVDThread()
 {
   ASSERT(!s_dvd_thread.joinable());
   s_dvd_thread_exiting.Clear();
+  // StopDVDThread leaves the event set if the thread exited without waiting on it. Nothing else can
+  // set it while the thread is stopped, since requests are only pushed by the CPU thread.
+  s_request_queue_expanded.Reset();
   s_dvd_thread = std::thread(DVDThread);
 }
 
 void Stop()
 {
   StopDVDThread();
+  SaveAccessLog();
+  s_prefetcher.reset();
   s_disc.reset();
 }
 
@@ -161,7 +181,7 @@ void DoState(PointerWrap& p)
     if (had_disc)
       PanicAlertT("An inserted disc was expected but not found.");
     else
-      s_disc.reset();
+      SetDisc(nullptr);
   }
 
   // TODO: Savestates can be smaller if the buffers of results aren't saved,
@@ -177,8 +197,72 @@ void DoState(PointerWrap& p)
 
 void SetDisc(std::unique_ptr<DiscIO::Volume> disc)
 {
-  WaitUntilIdle();
+  // The DVD thread must not be running while s_disc and s_prefetcher are replaced,
+  // since it may otherwise still be prefetching from the old disc.
+  StopDVDThreadWhenIdle();
+  SaveAccessLog();
   s_disc = std::move(disc);
+
+  if (s_disc)
+  {
+    const SConfig& config = SConfig::GetInstance();
+    s_disc->ConfigureDecryptionCache(std::max(config.m_wii_cluster_cache_size_mb, 0),
+                                     std::max(config.m_wii_read_ahead_clusters, 0));
+    s_disc->ConfigureBlobReader(std::max(config.m_blob_cache_size_mb, 0),
+                                std::max(config.m_blob_read_queue_depth, 1));
+    if (config.m_map_disc_images && !s_disc->MapIntoMemory())
+      INFO_LOG(DVDINTERFACE, "The disc image could not be mapped into memory");
+  }
+
+  CreatePrefetcher();
+  StartDVDThread();
+}
+
+static std::string GetAccessLogPath(const DiscIO::Volume& disc)
+{
+  const std::string game_id = disc.GetGameID();
+  if (game_id.empty())
+    return {};
+
+  return StringFromFormat("%s%s_r%u_d%u.dvdlog", File::GetUserPath(D_CACHE_IDX).c_str(),
+                          game_id.c_str(), disc.GetRevision().value_or(0),
+                          disc.GetDiscNumber().value_or(0));
+}
+
+static void CreatePrefetcher()
+{
+  s_prefetcher.reset();
+  s_access_log_path.clear();
+
+  const SConfig& config = SConfig::GetInstance();
+  if (!s_disc || !config.m_dvd_prefetch)
+    return;
+
+  // Replay the access log one second of emulated time ahead
+  s_prefetcher = std::make_unique<Prefetcher>(1000000);
+
+  if (config.m_dvd_access_logs)
+  {
+    s_access_log_path = GetAccessLogPath(*s_disc);
+    if (!s_access_log_path.empty())
+    {
+      s_prefetcher->LoadAccessLog(s_access_log_path);
+      s_prefetcher->SetRecording(true);
+    }
+  }
+}
+
+static void SaveAccessLog()
+{
+  if (!s_prefetcher || s_access_log_path.empty() || s_prefetcher->GetAccessLog().empty())
+    return;
+
+  // Booting a game only to quit it shortly after shouldn't replace the log of a longer session
+  if (s_prefetcher->GetRecordedDuration() < s_prefetcher->GetReplayedDuration())
+    return;
+
+  if (!s_prefetcher->SaveAccessLog(s_access_log_path))
+    WARN_LOG(DVDINTERFACE, "Failed to write DVD access log %s", s_access_log_path.c_str());
 }
 
 bool HasDisc()
@@ -244,7 +328,7 @@ bool UpdateRunningGameMetadata(const DiscIO::Partition& partition, std::optional
   return true;
 }
 
-void WaitUntilIdle()
+static void StopDVDThreadWhenIdle()
 {
   ASSERT(Core::IsCPUThread());
 
@@ -252,6 +336,11 @@ void WaitUntilIdle()
     s_result_queue_expanded.Wait();
 
   StopDVDThread();
+}
+
+void WaitUntilIdle()
+{
+  StopDVDThreadWhenIdle();
   StartDVDThread();
 }
 
@@ -358,20 +447,46 @@ static void FinishRead(u64 id, s64 cycles_late)
                                        buffer);
 }
 
+// The data isn't used for anything. Reading it is only done so that it gets cached by the host OS
+// and by the volume, which hides the I/O latency when the emulated software reads it.
+static void Prefetch(const Prefetcher::Range& range)
+{
+  // The range is read in small pieces, and the rest of it is dropped as soon as there is a request
+  // or the CPU thread is waiting for the DVD thread to stop, so that neither waits for long.
+  constexpr u32 PREFETCH_PIECE_SIZE = 0x8000;
+
+  s_prefetch_buffer.resize(PREFETCH_PIECE_SIZE);
+  for (u32 done = 0; done < range.length; done += PREFETCH_PIECE_SIZE)
+  {
+    if (s_dvd_thread_exiting.IsSet() || !s_request_queue.Empty())
+      return;
+
+    const u32 length = std::min(range.length - done, PREFETCH_PIECE_SIZE);
+    if (!s_disc->Read(range.offset + done, length, s_prefetch_buffer.data(), range.partition))
+      return;
+  }
+}
+
 static void DVDThread()
 {
   Common::SetCurrentThreadName("DVD thread");
 
+  std::optional<Prefetcher::Range> prefetch;
   while (true)
   {
-    s_request_queue_expanded.Wait();
+    // While there is something to prefetch, only check for new requests between prefetches
+    if (!prefetch)
+      s_request_queue_expanded.Wait();
 
     if (s_dvd_thread_exiting.IsSet())
       return;
 
+    bool read_something = false;
     ReadRequest request;
     while (s_request_queue.Pop(request))
     {
+      read_something = true;
+
       FileMonitor::Log(*s_disc, request.partition, request.dvd_offset);
 
       std::vector<u8> buffer(request.length);
@@ -380,12 +495,28 @@ static void DVDThread()
 
       request.realtime_done_us = Common::Timer::GetTimeUs();
 
+      if (s_prefetcher)
+      {
+        const u64 time_us =
+            request.time_started_ticks / (SystemTimers::GetTicksPerSecond() / 1000000);
+        s_prefetcher->OnRead(request.partition, request.dvd_offset, request.length, time_us);
+      }
+
       s_result_queue.Push(ReadResult(std::move(request), std::move(buffer)));
       s_result_queue_expanded.Set();
 
       if (s_dvd_thread_exiting.IsSet())
         return;
     }
+
+    // Only the reads above can make something new worth prefetching
+    if (!read_something && !prefetch)
+      continue;
+
+    // Volumes which are mapped into memory can have the OS load the data in the background.
+    prefetch = s_prefetcher ? s_prefetcher->GetNextPrefetch() : std::nullopt;
+    if (prefetch && !s_disc->HintWillRead(prefetch->offset, prefetch->length, prefetch->partition))
+      Prefetch(*prefetch);
   }
 }
 }  // namespace DVDThread
@@ -274,10 +274,7 @@ ReturnCode IOSC::DecryptEncrypt(Common::AES::Mode mode, Handle key_handle, u8* i
   if (entry->data.size() != AES128_KEY_SIZE)
     return IOSC_FAIL_INTERNAL;
 
-  const std::vector<u8> data =
-      Common::AES::DecryptEncrypt(entry->data.data(), iv, input, size, mode);
-
-  std::memcpy(output, data.data(), data.size());
+  Common::AES::DecryptEncrypt(entry->data.data(), iv, input, output, size, mode);
   return IPC_SUCCESS;
 }
 
@@ -267,24 +267,36 @@ bool Jit64::BackPatch(u32 emAddress, SContext* ctx)
   // into the original code if necessary to ensure there is enough space
   // to insert the backpatch jump.)
 
-  js.generatingTrampoline = true;
-  js.trampolineExceptionHandler = exceptionHandler;
-  js.compilerPC = info.pc;
-
-  // Generate the trampoline.
-  const u8* trampoline = trampolines.GenerateTrampoline(info);
-  js.generatingTrampoline = false;
-  js.trampolineExceptionHandler = nullptr;
-
-  u8* start = info.start;
+  // An access which faults again before being patched reuses the trampoline of its first fault.
+  const u8*& cached_trampoline = m_trampoline_at_loc[codePtr];
+  if (!cached_trampoline)
+  {
+    js.generatingTrampoline = true;
+    js.trampolineExceptionHandler = exceptionHandler;
+    js.compilerPC = info.pc;
+
+    // Generate the trampoline.
+    cached_trampoline = trampolines.GenerateTrampoline(info);
+    js.generatingTrampoline = false;
+    js.trampolineExceptionHandler = nullptr;
+  }
+  const u8* trampoline = cached_trampoline;
 
-  // Patch the original memory operation.
-  XEmitter emitter(start);
-  emitter.JMP(trampoline, true);
-  // NOPs become dead code
-  const u8* end = info.start + info.len;
-  for (const u8* i = emitter.GetCodePtr(); i < end; ++i)
-    emitter.INT3();
+  // An access which hasn't faulted often yet only takes the trampoline this once, and keeps its
+  // fastmem code in case the fault was a one-off.
+  const bool patch = RecordFastmemFault(info.pc);
+  if (patch)
+  {
+    u8* start = info.start;
+
+    // Patch the original memory operation.
+    XEmitter emitter(start);
+    emitter.JMP(trampoline, true);
+    // NOPs become dead code
+    const u8* end = info.start + info.len;
+    for (const u8* i = emitter.GetCodePtr(); i < end; ++i)
+      emitter.INT3();
+  }
 
   // Rewind time to just before the start of the write block. If we swapped memory
   // before faulting (eg: the store+swap was not an atomic op like MOVBE), let's
@@ -321,6 +333,12 @@ bool Jit64::BackPatch(u32 emAddress, SContext* ctx)
     *ptr -= static_cast<u32>(info.offset);
   }
 
+  // Since this access keeps faulting, have its block recompiled with an inline address check
+  // rather than leaving it on the trampoline. The code we're returning to stays valid until the
+  // next cache clear, so it's safe to destroy the block from here.
+  if (patch)
+    GetBlockCache()->InvalidateICache(info.pc, 4, true);
+
   ctx->CTX_PC = reinterpret_cast<u64>(trampoline);
 
   return true;
@@ -1055,7 +1073,10 @@ u8* Jit64::DoJit(u32 em_address, JitBlock* b, u32 nextPC)
       fpr.Flush(~op.fprInUse);
 
       if (opinfo->flags & FL_LOADSTORE)
+      {
         ++js.numLoadStoreInst;
+        AgeFastmemFaults(op.address);
+      }
 
       if (opinfo->flags & FL_USE_FPU)
         ++js.numFloatingPointInst;
@@ -7,6 +7,7 @@
 #include "Common/x64Reg.h"
 #include "Core/PowerPC/Jit64/Jit.h"
 #include "Core/PowerPC/Jit64Common/Jit64PowerPCState.h"
+#include "Core/PowerPC/JitCommon/JitRegAlloc.h"
 
 using namespace Gen;
 
@@ -44,15 +45,5 @@ BitSet32 FPURegCache::GetRegUtilization() const
 
 BitSet32 FPURegCache::CountRegsIn(preg_t preg, u32 lookahead) const
 {
-  BitSet32 regs_used;
-
-  for (u32 i = 1; i < lookahead; i++)
-  {
-    BitSet32 regs_in = m_jit.js.op[i].fregsIn;
-    regs_used |= regs_in;
-    if (regs_in[preg])
-      return regs_used;
-  }
-
-  return regs_used;
+  return JitRegAlloc::RegsReadBefore(m_jit.js.op, lookahead, JitRegAlloc::RegClass::FPR, preg);
 }
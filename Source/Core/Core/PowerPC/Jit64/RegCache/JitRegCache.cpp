@@ -20,6 +20,7 @@
 #include "Core/PowerPC/Jit64/Jit.h"
 #include "Core/PowerPC/Jit64/RegCache/CachedReg.h"
 #include "Core/PowerPC/Jit64/RegCache/RCMode.h"
+#include "Core/PowerPC/JitCommon/JitRegAlloc.h"
 #include "Core/PowerPC/PowerPC.h"
 
 using namespace Gen;
@@ -619,10 +620,8 @@ float RegCache::ScoreRegister(X64Reg xreg) const
   // writing it back to the register file isn't quite as bad.
   if (GetRegUtilization()[preg])
   {
-    // Don't look too far ahead; we don't want to have quadratic compilation times for
-    // enormous block sizes!
-    // This actually improves register allocation a tiny bit; I'm not sure why.
-    u32 lookahead = std::min(m_jit.js.instructionsLeft, 64);
+    // Limiting the lookahead actually improves register allocation a tiny bit; I'm not sure why.
+    u32 lookahead = JitRegAlloc::GetLookahead(m_jit.js.instructionsLeft);
     // Count how many other registers are going to be used before we need this one again.
     u32 regs_in_count = CountRegsIn(preg, lookahead).Count();
     // Totally ad-hoc heuristic to bias based on how many other registers we'll need
@@ -322,7 +322,8 @@ void EmuCodeBlock::SafeLoadToReg(X64Reg reg_value, const Gen::OpArg& opAddress,
 
   auto& js = m_jit.js;
   registersInUse[reg_value] = false;
-  if (m_jit.jo.fastmem && !(flags & (SAFE_LOADSTORE_NO_FASTMEM | SAFE_LOADSTORE_NO_UPDATE_PC)) &&
+  if (m_jit.ShouldUseFastmem(js.compilerPC) &&
+      !(flags & (SAFE_LOADSTORE_NO_FASTMEM | SAFE_LOADSTORE_NO_UPDATE_PC)) &&
       !slowmem)
   {
     u8* backpatchStart = GetWritableCodePtr();
@@ -494,7 +495,8 @@ void EmuCodeBlock::SafeWriteRegToReg(OpArg reg_value, X64Reg reg_addr, int acces
   reg_value = FixImmediate(accessSize, reg_value);
 
   auto& js = m_jit.js;
-  if (m_jit.jo.fastmem && !(flags & (SAFE_LOADSTORE_NO_FASTMEM | SAFE_LOADSTORE_NO_UPDATE_PC)) &&
+  if (m_jit.ShouldUseFastmem(js.compilerPC) &&
+      !(flags & (SAFE_LOADSTORE_NO_FASTMEM | SAFE_LOADSTORE_NO_UPDATE_PC)) &&
       !slowmem)
   {
     u8* backpatchStart = GetWritableCodePtr();
@@ -1094,4 +1096,5 @@ void EmuCodeBlock::Clear()
 {
   m_back_patch_info.clear();
   m_exception_handler_at_loc.clear();
+  m_trampoline_at_loc.clear();
 }
@@ -135,4 +135,6 @@ protected:
 
   std::unordered_map<u8*, TrampolineInfo> m_back_patch_info;
   std::unordered_map<u8*, u8*> m_exception_handler_at_loc;
+  // Trampolines of accesses which have faulted without being patched yet
+  std::unordered_map<u8*, const u8*> m_trampoline_at_loc;
 };
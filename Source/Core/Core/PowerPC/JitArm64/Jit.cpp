@@ -780,6 +780,9 @@ void JitArm64::DoJit(u32 em_address, JitBlock* b, u32 nextPC)
       if (!CanMergeNextInstructions(1) || js.op[1].opinfo->type != ::OpType::Integer)
         FlushCarry();
 
+      if (op.opinfo->flags & FL_LOADSTORE)
+        AgeFastmemFaults(op.address);
+
       // If we have a register that will never be used again, flush it.
       gpr.StoreRegisters(~op.gprInUse);
       fpr.StoreRegisters(~op.fprInUse);
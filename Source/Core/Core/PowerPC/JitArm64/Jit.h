@@ -170,6 +170,8 @@ private:
   {
     u32 length;
     const u8* slowmem_code;
+    u32 pc;
+    u32 flags;
   };
 
   static void InitializeInstructionTables();
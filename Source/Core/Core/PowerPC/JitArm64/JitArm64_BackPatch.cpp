@@ -51,6 +51,10 @@ void JitArm64::DoBacktrace(uintptr_t access_address, SContext* ctx)
 void JitArm64::EmitBackpatchRoutine(u32 flags, bool fastmem, bool do_farcode, ARM64Reg RS,
                                     ARM64Reg addr, BitSet32 gprs_to_push, BitSet32 fprs_to_push)
 {
+  // Accesses which keep faulting call the slow path directly rather than being backpatched.
+  if (fastmem && do_farcode && !ShouldUseFastmem(js.compilerPC))
+    fastmem = do_farcode = false;
+
   bool in_far_code = false;
   const u8* fastmem_start = GetCodePtr();
 
@@ -156,6 +160,8 @@ void JitArm64::EmitBackpatchRoutine(u32 flags, bool fastmem, bool do_farcode, AR
       handler.flags = flags;
 
       FastmemArea* fastmem_area = &m_fault_to_handler[fastmem_start];
+      fastmem_area->pc = js.compilerPC;
+      fastmem_area->flags = flags;
       auto handler_loc_iter = m_handler_to_loc.find(handler);
 
       if (handler_loc_iter == m_handler_to_loc.end())
@@ -309,11 +315,25 @@ bool JitArm64::HandleFastmemFault(uintptr_t access_address, SContext* ctx)
 
   const u8* fault_location = slow_handler_iter->first;
   const u32 fastmem_area_length = slow_handler_iter->second.length;
+  const u32 fault_pc = slow_handler_iter->second.pc;
 
   // no overlapping fastmem area found
   if ((const u8*)ctx->CTX_PC - fault_location > fastmem_area_length)
     return false;
 
+  // An access which hasn't faulted often yet only calls the slow path this once, and keeps its
+  // fastmem code in case the fault was a one-off. The slow path was emitted along with the block
+  // and is shared between accesses, so no code is emitted no matter how often this happens.
+  // Before the faulting instruction, the fastmem code only writes to scratch registers, except for
+  // dcbz, which adds the base to the address.
+  const bool recompile = RecordFastmemFault(fault_pc);
+  if (!recompile && !(slow_handler_iter->second.flags & BackPatchInfo::FLAG_ZERO_256))
+  {
+    ctx->CTX_REG(30) = reinterpret_cast<std::uintptr_t>(fault_location + fastmem_area_length);
+    ctx->CTX_PC = reinterpret_cast<std::uintptr_t>(slow_handler_iter->second.slowmem_code);
+    return true;
+  }
+
   ARM64XEmitter emitter((u8*)fault_location);
 
   emitter.BL(slow_handler_iter->second.slowmem_code);
@@ -325,6 +345,11 @@ bool JitArm64::HandleFastmemFault(uintptr_t access_address, SContext* ctx)
   m_fault_to_handler.erase(slow_handler_iter);
 
   emitter.FlushIcache();
+
+  // If this access keeps faulting, have its block recompiled without fastmem.
+  if (recompile)
+    GetBlockCache()->InvalidateICache(fault_pc, 4, true);
+
   ctx->CTX_PC = reinterpret_cast<std::uintptr_t>(fault_location);
   return true;
 }
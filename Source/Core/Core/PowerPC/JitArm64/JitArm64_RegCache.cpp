@@ -14,12 +14,14 @@
 #include "Common/CommonTypes.h"
 #include "Common/Logging/Log.h"
 #include "Core/PowerPC/JitArm64/Jit.h"
+#include "Core/PowerPC/JitCommon/JitRegAlloc.h"
 
 using namespace Arm64Gen;
 
-void Arm64RegCache::Init(ARM64XEmitter* emitter)
+void Arm64RegCache::Init(JitArm64* jit)
 {
-  m_emit = emitter;
+  m_jit = jit;
+  m_emit = jit;
   m_float_emit.reset(new ARM64FloatEmitter(m_emit));
   GetAllocationOrder();
 }
@@ -72,6 +74,10 @@ void Arm64RegCache::UnlockRegister(ARM64Reg host_reg)
 
 void Arm64RegCache::FlushMostStaleRegister()
 {
+  const PPCAnalyst::CodeOp* op = m_jit->js.op;
+  std::vector<JitRegAlloc::SpillCandidate> candidates;
+  candidates.reserve(m_guest_registers.size());
+
   size_t most_stale_preg = 0;
   u32 most_stale_amount = 0;
 
@@ -80,15 +86,30 @@ void Arm64RegCache::FlushMostStaleRegister()
     const auto& reg = m_guest_registers[i];
     const u32 last_used = reg.GetLastUsed();
 
-    if (last_used > most_stale_amount &&
-        (reg.GetType() != REG_NOTLOADED && reg.GetType() != REG_IMM))
+    if (reg.GetType() == REG_NOTLOADED || reg.GetType() == REG_IMM)
+      continue;
+
+    if (last_used > most_stale_amount)
     {
       most_stale_preg = i;
       most_stale_amount = last_used;
     }
+
+    // Registers touched by the instruction being compiled may have their host register in use.
+    if (!op || last_used == 0 || IsUsedBy(*op, i))
+      continue;
+
+    candidates.push_back({i, GetNextRead(op, i), reg.IsDirty(), last_used});
+  }
+
+  if (candidates.empty())
+  {
+    FlushRegister(most_stale_preg, false);
+    return;
   }
 
-  FlushRegister(most_stale_preg, false);
+  const size_t victim = JitRegAlloc::ChooseSpillVictim(candidates.data(), candidates.size());
+  FlushRegister(candidates[victim].preg, false);
 }
 
 // GPR Cache
@@ -386,6 +407,23 @@ void Arm64GPRCache::FlushByHost(ARM64Reg host_reg)
   }
 }
 
+bool Arm64GPRCache::IsUsedBy(const PPCAnalyst::CodeOp& op, size_t index) const
+{
+  // We have no usage information for CRs.
+  return index < GUEST_GPR_COUNT &&
+         JitRegAlloc::RegsUsedBy(op, JitRegAlloc::RegClass::GPR)[index];
+}
+
+u32 Arm64GPRCache::GetNextRead(const PPCAnalyst::CodeOp* op, size_t index) const
+{
+  // CRs are mostly read by the branch right after they are set, so assume they're needed soon.
+  if (index >= GUEST_GPR_COUNT)
+    return 0;
+
+  const u32 lookahead = JitRegAlloc::GetLookahead(m_jit->js.instructionsLeft);
+  return JitRegAlloc::DistanceToNextRead(op, lookahead, JitRegAlloc::RegClass::GPR, index);
+}
+
 // FPR Cache
 constexpr size_t GUEST_FPR_COUNT = 32;
 
@@ -752,3 +790,14 @@ void Arm64FPRCache::FixSinglePrecision(size_t preg)
     break;
   }
 }
+
+bool Arm64FPRCache::IsUsedBy(const PPCAnalyst::CodeOp& op, size_t index) const
+{
+  return JitRegAlloc::RegsUsedBy(op, JitRegAlloc::RegClass::FPR)[index];
+}
+
+u32 Arm64FPRCache::GetNextRead(const PPCAnalyst::CodeOp* op, size_t index) const
+{
+  const u32 lookahead = JitRegAlloc::GetLookahead(m_jit->js.instructionsLeft);
+  return JitRegAlloc::DistanceToNextRead(op, lookahead, JitRegAlloc::RegClass::FPR, index);
+}
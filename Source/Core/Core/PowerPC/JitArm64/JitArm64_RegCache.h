@@ -14,6 +14,8 @@
 #include "Core/PowerPC/PPCAnalyst.h"
 #include "Core/PowerPC/PowerPC.h"
 
+class JitArm64;
+
 // Dedicated host registers
 static const Arm64Gen::ARM64Reg MEM_REG = Arm64Gen::X28;  // memory base register
 static const Arm64Gen::ARM64Reg PPC_REG = Arm64Gen::X29;  // ppcState pointer
@@ -119,11 +121,11 @@ class Arm64RegCache
 {
 public:
   explicit Arm64RegCache(size_t guest_reg_count)
-      : m_emit(nullptr), m_float_emit(nullptr), m_guest_registers(guest_reg_count),
-        m_reg_stats(nullptr){};
+      : m_jit(nullptr), m_emit(nullptr), m_float_emit(nullptr),
+        m_guest_registers(guest_reg_count), m_reg_stats(nullptr){};
   virtual ~Arm64RegCache(){};
 
-  void Init(Arm64Gen::ARM64XEmitter* emitter);
+  void Init(JitArm64* jit);
 
   virtual void Start(PPCAnalyst::BlockRegStats& stats) {}
   // Flushes the register cache in different ways depending on the mode
@@ -163,9 +165,16 @@ protected:
   // Get the order of the host registers
   virtual void GetAllocationOrder() = 0;
 
-  // Flushes the most stale register
+  // Flushes the register that is the cheapest to lose, based on when it is next needed
   void FlushMostStaleRegister();
 
+  // Whether the guest register at index is read or written by the given instruction
+  virtual bool IsUsedBy(const PPCAnalyst::CodeOp& op, size_t index) const = 0;
+
+  // How soon the guest register at index is needed after the given instruction,
+  // see JitRegAlloc::DistanceToNextRead
+  virtual u32 GetNextRead(const PPCAnalyst::CodeOp* op, size_t index) const = 0;
+
   // Lock a register
   void LockRegister(Arm64Gen::ARM64Reg host_reg);
 
@@ -186,6 +195,8 @@ protected:
       reg.IncrementLastUsed();
   }
 
+  JitArm64* m_jit;
+
   // Code emitter
   Arm64Gen::ARM64XEmitter* m_emit;
 
@@ -243,6 +254,9 @@ protected:
 
   void FlushRegister(size_t index, bool maintain_state) override;
 
+  bool IsUsedBy(const PPCAnalyst::CodeOp& op, size_t index) const override;
+  u32 GetNextRead(const PPCAnalyst::CodeOp* op, size_t index) const override;
+
 private:
   bool IsCalleeSaved(Arm64Gen::ARM64Reg reg);
 
@@ -297,6 +311,9 @@ protected:
 
   void FlushRegister(size_t preg, bool maintain_state) override;
 
+  bool IsUsedBy(const PPCAnalyst::CodeOp& op, size_t index) const override;
+  u32 GetNextRead(const PPCAnalyst::CodeOp* op, size_t index) const override;
+
 private:
   bool IsCalleeSaved(Arm64Gen::ARM64Reg reg);
 
@@ -0,0 +1,37 @@
+// Copyright 2019 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include "Core/PowerPC/JitCommon/FastmemFaultCounter.h"
+
+bool FastmemFaultCounter::ShouldUseFastmem(u32 address) const
+{
+  const auto it = m_counts.find(address);
+  return it == m_counts.end() || it->second < THRESHOLD;
+}
+
+bool FastmemFaultCounter::RecordFault(u32 address)
+{
+  return ++m_counts[address] >= THRESHOLD;
+}
+
+void FastmemFaultCounter::OnCompiled(u32 address)
+{
+  const auto it = m_counts.find(address);
+  if (it == m_counts.end() || it->second < THRESHOLD)
+    return;
+
+  // An access compiled with the inline check can't fault, so this is the only way it can get back
+  // to fastmem. If it still hits MMIO, its next fault immediately brings it back here.
+  --it->second;
+}
+
+void FastmemFaultCounter::Forget(u32 address)
+{
+  m_counts.erase(address);
+}
+
+void FastmemFaultCounter::Clear()
+{
+  m_counts.clear();
+}
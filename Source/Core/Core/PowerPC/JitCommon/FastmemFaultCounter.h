@@ -0,0 +1,37 @@
+// Copyright 2019 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <unordered_map>
+
+#include "Common/CommonTypes.h"
+
+// Decides which load/store instructions keep using fastmem after their accesses have faulted.
+//
+// A fault below the threshold is handled once through the slow path, and the fastmem code is left
+// as it is, so a one-off access to MMIO doesn't cost anything afterwards. When an instruction
+// reaches the threshold, its fastmem code is patched to always take the slow path and its block
+// is recompiled with an inline address check instead. Each such compilation ages the count, so
+// later recompilations try fastmem again.
+class FastmemFaultCounter
+{
+public:
+  static constexpr u32 THRESHOLD = 2;
+
+  bool ShouldUseFastmem(u32 address) const;
+
+  // Records a fault of the fastmem access at the given address. Returns true if the access should
+  // be patched to take the slow path, and its block recompiled without fastmem.
+  bool RecordFault(u32 address);
+
+  // Must be called once for each load/store instruction that has been compiled.
+  void OnCompiled(u32 address);
+
+  void Forget(u32 address);
+  void Clear();
+
+private:
+  std::unordered_map<u32, u32> m_counts;
+};
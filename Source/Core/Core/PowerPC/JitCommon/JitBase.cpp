@@ -48,3 +48,18 @@ void JitBase::UpdateMemoryOptions()
   jo.fastmem = SConfig::GetInstance().bFastmem && (MSR.DR || !any_watchpoints);
   jo.memcheck = SConfig::GetInstance().bMMU || any_watchpoints;
 }
+
+bool JitBase::ShouldUseFastmem(u32 address) const
+{
+  return jo.fastmem && js.fastmemFaults.ShouldUseFastmem(address);
+}
+
+bool JitBase::RecordFastmemFault(u32 address)
+{
+  return js.fastmemFaults.RecordFault(address);
+}
+
+void JitBase::AgeFastmemFaults(u32 address)
+{
+  js.fastmemFaults.OnCompiled(address);
+}
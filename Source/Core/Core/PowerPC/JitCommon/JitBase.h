@@ -13,6 +13,7 @@
 #include "Core/ConfigManager.h"
 #include "Core/MachineContext.h"
 #include "Core/PowerPC/CPUCoreBase.h"
+#include "Core/PowerPC/JitCommon/FastmemFaultCounter.h"
 #include "Core/PowerPC/JitCommon/JitAsmCommon.h"
 #include "Core/PowerPC/JitCommon/JitCache.h"
 #include "Core/PowerPC/PPCAnalyst.h"
@@ -91,6 +92,8 @@ protected:
     std::unordered_set<u32> fifoWriteAddresses;
     std::unordered_set<u32> pairedQuantizeAddresses;
     std::unordered_set<u32> noSpeculativeConstantsAddresses;
+
+    FastmemFaultCounter fastmemFaults;
   };
 
   PPCAnalyst::CodeBlock code_block;
@@ -101,6 +104,13 @@ protected:
 
   void UpdateMemoryOptions();
 
+  // Records a fault of the fastmem access at the given address. Returns true if the access should
+  // be patched to take the slow path and its block recompiled without fastmem. Otherwise, the
+  // access should only take the slow path this once.
+  bool RecordFastmemFault(u32 address);
+  // Must be called once for each compiled load/store instruction.
+  void AgeFastmemFaults(u32 address);
+
 public:
   JitBase();
   ~JitBase() override;
@@ -115,6 +125,8 @@ public:
   virtual bool HandleFault(uintptr_t access_address, SContext* ctx) = 0;
   virtual bool HandleStackFault() { return false; }
 
+  bool ShouldUseFastmem(u32 address) const;
+
   static constexpr std::size_t code_buffer_size = 32000;
 
   // This should probably be removed from public:
@@ -65,6 +65,7 @@ void JitBaseBlockCache::Clear()
 #endif
   m_jit.js.fifoWriteAddresses.clear();
   m_jit.js.pairedQuantizeAddresses.clear();
+  m_jit.js.fastmemFaults.Clear();
   for (auto& e : block_map)
   {
     DestroyBlock(e.second);
@@ -216,6 +217,7 @@ void JitBaseBlockCache::InvalidateICache(u32 address, u32 length, bool forced)
       {
         m_jit.js.fifoWriteAddresses.erase(i);
         m_jit.js.pairedQuantizeAddresses.erase(i);
+        m_jit.js.fastmemFaults.Forget(i);
       }
     }
   }
@@ -0,0 +1,85 @@
+// Copyright 2019 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include "Core/PowerPC/JitCommon/JitRegAlloc.h"
+
+#include <algorithm>
+#include <tuple>
+
+#include "Core/PowerPC/PPCAnalyst.h"
+
+namespace JitRegAlloc
+{
+static BitSet32 RegsIn(const PPCAnalyst::CodeOp& op, RegClass reg_class)
+{
+  return reg_class == RegClass::GPR ? op.regsIn : op.fregsIn;
+}
+
+static BitSet32 RegsLiveAfter(const PPCAnalyst::CodeOp& op, RegClass reg_class)
+{
+  return reg_class == RegClass::GPR ? op.gprInUse : op.fprInUse;
+}
+
+u32 GetLookahead(int instructions_left)
+{
+  return std::min<u32>(std::max(instructions_left, 0), MAX_LOOKAHEAD);
+}
+
+BitSet32 RegsUsedBy(const PPCAnalyst::CodeOp& op, RegClass reg_class)
+{
+  if (reg_class == RegClass::GPR)
+    return op.regsIn | op.regsOut;
+
+  BitSet32 regs = op.fregsIn;
+  if (op.fregOut >= 0)
+    regs[op.fregOut] = true;
+  return regs;
+}
+
+BitSet32 RegsReadBefore(const PPCAnalyst::CodeOp* op, u32 lookahead, RegClass reg_class,
+                        size_t preg)
+{
+  BitSet32 regs_used;
+
+  for (u32 i = 1; i < lookahead; i++)
+  {
+    BitSet32 regs_in = RegsIn(op[i], reg_class);
+    regs_used |= regs_in;
+    if (regs_in[preg])
+      return regs_used;
+  }
+
+  return regs_used;
+}
+
+u32 DistanceToNextRead(const PPCAnalyst::CodeOp* op, u32 lookahead, RegClass reg_class,
+                       size_t preg)
+{
+  if (!RegsLiveAfter(*op, reg_class)[preg])
+    return DEAD;
+
+  for (u32 i = 1; i < lookahead; i++)
+  {
+    if (RegsIn(op[i], reg_class)[preg])
+      return i;
+  }
+
+  return lookahead;
+}
+
+size_t ChooseSpillVictim(const SpillCandidate* candidates, size_t count)
+{
+  const auto key = [](const SpillCandidate& c) {
+    return std::make_tuple(c.next_read, !c.dirty, c.staleness);
+  };
+
+  size_t best = 0;
+  for (size_t i = 1; i < count; i++)
+  {
+    if (key(candidates[i]) > key(candidates[best]))
+      best = i;
+  }
+  return best;
+}
+}  // namespace JitRegAlloc
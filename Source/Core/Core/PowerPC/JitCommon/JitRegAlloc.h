@@ -0,0 +1,65 @@
+// Copyright 2019 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <cstddef>
+#include <limits>
+
+#include "Common/BitSet.h"
+#include "Common/CommonTypes.h"
+
+namespace PPCAnalyst
+{
+struct CodeOp;
+}
+
+// Register allocation helpers shared by the Jit64 and JitArm64 register caches. They use the
+// per-instruction register usage computed by PPCAnalyst to look ahead in the current block.
+namespace JitRegAlloc
+{
+enum class RegClass
+{
+  GPR,
+  FPR,
+};
+
+// Don't look too far ahead; we don't want to have quadratic compilation times for
+// enormous block sizes!
+constexpr u32 MAX_LOOKAHEAD = 64;
+
+// Returned by DistanceToNextRead for registers that are dead after the current instruction.
+constexpr u32 DEAD = std::numeric_limits<u32>::max();
+
+u32 GetLookahead(int instructions_left);
+
+// Registers that the current instruction (op) reads or writes.
+BitSet32 RegsUsedBy(const PPCAnalyst::CodeOp& op, RegClass reg_class);
+
+// All registers read by the instructions following op, up to and including the next
+// instruction that reads preg.
+BitSet32 RegsReadBefore(const PPCAnalyst::CodeOp* op, u32 lookahead, RegClass reg_class,
+                        size_t preg);
+
+// Number of instructions after op until preg is read again (1 being the next instruction).
+// Returns lookahead if it's still live but not read within the lookahead, and DEAD if nothing
+// in the rest of the block needs its value.
+u32 DistanceToNextRead(const PPCAnalyst::CodeOp* op, u32 lookahead, RegClass reg_class,
+                       size_t preg);
+
+struct SpillCandidate
+{
+  size_t preg;
+  // From DistanceToNextRead.
+  u32 next_read;
+  bool dirty;
+  // Some measure of how long ago the register was last touched. Larger is older.
+  u32 staleness;
+};
+
+// Picks the register whose eviction costs the least: dead registers first, then the one whose
+// next read is the farthest away (Belady's rule), preferring clean registers (no store needed)
+// and then the least recently used one on ties. Returns the index into candidates.
+size_t ChooseSpillVictim(const SpillCandidate* candidates, size_t count);
+}  // namespace JitRegAlloc
@@ -5,8 +5,10 @@
 #include "Core/PowerPC/PPCAnalyst.h"
 
 #include <algorithm>
+#include <bitset>
 #include <map>
 #include <queue>
+#include <set>
 #include <string>
 #include <vector>
 
@@ -673,55 +675,195 @@ void PPCAnalyzer::SetInstructionStats(CodeBlock* block, CodeOp* code, const Gekk
   }
 }
 
+static bool IsStackAdjustment(UGeckoInstruction inst)
+{
+  // addi r1, r1, SIMM
+  return inst.OPCD == 14 && inst.RD == 1 && inst.RA == 1;
+}
+
+static bool IsLRAccess(UGeckoInstruction inst)
+{
+  // mflr/mtlr
+  return inst.OPCD == 31 && (inst.SUBOP10 == 339 || inst.SUBOP10 == 467) &&
+         ((inst.SPRU << 5) | (inst.SPRL & 0x1F)) == SPR_LR;
+}
+
+static u32 GetDFormAccessSize(UGeckoInstruction inst)
+{
+  switch (inst.OPCD)
+  {
+  case 32:  // lwz
+  case 33:  // lwzu
+  case 36:  // stw
+  case 37:  // stwu
+    return 4;
+  case 40:  // lhz
+  case 41:  // lhzu
+  case 42:  // lha
+  case 43:  // lhau
+  case 44:  // sth
+  case 45:  // sthu
+    return 2;
+  case 34:  // lbz
+  case 35:  // lbzu
+  case 38:  // stb
+  case 39:  // stbu
+    return 1;
+  default:
+    return 0;
+  }
+}
+
 bool PPCAnalyzer::IsBusyWaitLoop(CodeBlock* block, CodeOp* code, size_t instructions)
 {
-  // Very basic algorithm to detect busy wait loops:
-  //   * It loops to itself and does not contain any other branches.
-  //   * It does not write to memory.
+  // Detects busy wait loops, i.e. loops where skipping any number of iterations is
+  // indistinguishable from running them:
+  //   * It loops to itself and does not use CTR.
   //   * It only reads from registers it wrote to earlier in the loop, or it
-  //     does not write to these registers.
+  //     does not write to these registers. LR is treated like a GPR here.
+  //   * It only writes to memory through r1, and only to stack slots that are not read
+  //     before being written in the same iteration (so nothing carries across iterations).
+  //   * r1 is only adjusted by stwu/addi and is back to its original value at the loop end.
   //
-  // Would benefit a lot from basic inlining support - a lot of the most
-  // used busy loops are DSP register interactions, which are bl/cmp/bne
-  // (with the bl target a pure function that follows the above rules). We
-  // don't detect these at the moment.
+  // Since calls to leaf functions are inlined by branch following, this also covers the very
+  // common "bl ReadHardwareRegister; cmpwi; bne" polling loops where the callee has a stack
+  // frame, such as waiting on the DSP mailbox, VI or PI interrupt status. (Calls to functions
+  // which restore LR with mtlr aren't inlined, so their loops are never detected.)
   std::bitset<32> write_disallowed_regs;
   std::bitset<32> written_regs;
+  bool lr_write_disallowed = false;
+  bool lr_written = false;
+  // Stack slots are byte offsets relative to the value r1 had at the start of the loop.
+  std::set<s32> write_disallowed_slots;
+  std::set<s32> written_slots;
+  s32 stack_offset = 0;
+
+  const auto read_slots = [&](s32 address, u32 size) {
+    for (u32 j = 0; j < size; ++j)
+    {
+      if (!written_slots.count(address + j))
+        write_disallowed_slots.insert(address + j);
+    }
+  };
+  const auto write_slots = [&](s32 address, u32 size) {
+    for (u32 j = 0; j < size; ++j)
+    {
+      if (write_disallowed_slots.count(address + j))
+        return false;
+      written_slots.insert(address + j);
+    }
+    return true;
+  };
+
   for (size_t i = 0; i <= instructions; ++i)
   {
+    const UGeckoInstruction inst = code[i].inst;
+    BitSet32 regs_in = code[i].regsIn;
+    BitSet32 regs_out = code[i].regsOut;
+
     if (code[i].opinfo->type == OpType::Branch)
     {
       if (code[i].branchUsesCtr)
         return false;
       if (code[i].branchTo == block->m_address && i == instructions)
-        return true;
+        return stack_offset == 0;
+      if (inst.LK)
+      {
+        if (lr_write_disallowed)
+          return false;
+        lr_written = true;
+      }
+      continue;
     }
-    else if (code[i].opinfo->type != OpType::Integer && code[i].opinfo->type != OpType::Load)
+
+    if (code[i].opinfo->type == OpType::SPR)
     {
-      // In the future, some subsets of other instruction types might get
-      // supported. Right now, only try loops that have this very
-      // restricted instruction set.
-      return false;
+      if (!IsLRAccess(inst))
+        return false;
+
+      if (inst.SUBOP10 == 339)  // mflr
+      {
+        if (!lr_written)
+          lr_write_disallowed = true;
+      }
+      else  // mtlr
+      {
+        if (lr_write_disallowed)
+          return false;
+        lr_written = true;
+      }
     }
-    else
+    else if (code[i].opinfo->type == OpType::Load || code[i].opinfo->type == OpType::Store)
     {
-      for (int reg : code[i].regsIn)
+      const bool is_store = code[i].opinfo->type == OpType::Store;
+      const u32 size = GetDFormAccessSize(inst);
+      if (size == 0 || inst.RA != 1)
       {
-        if (reg == -1)
-          continue;
-        if (written_regs[reg])
-          continue;
-        write_disallowed_regs[reg] = true;
+        // Reads from anywhere are fine (that's what we're polling), writes are not.
+        if (is_store || inst.RA == 1 || (inst.OPCD == 31 && inst.RB == 1))
+          return false;
       }
-      for (int reg : code[i].regsOut)
+      else
       {
-        if (reg == -1)
-          continue;
-        if (write_disallowed_regs[reg])
-          return false;
-        written_regs[reg] = true;
+        const s32 address = stack_offset + inst.SIMM_16;
+        const bool update = (inst.OPCD & 1) != 0;
+        if (!is_store)
+        {
+          // Loading into r1 replaces the stack pointer with something we don't track.
+          if (update || inst.RD == 1)
+            return false;
+          read_slots(address, size);
+        }
+        else
+        {
+          if (update)
+          {
+            // stwu r1, -x(r1) sets up a new stack frame.
+            if (inst.OPCD != 37)
+              return false;
+            stack_offset = address;
+          }
+          if (!write_slots(address, size))
+            return false;
+        }
+        // The address is tracked above, and so is the new r1 of stwu.
+        regs_in[1] = false;
+        if (update)
+          regs_out[1] = false;
       }
     }
+    else if (code[i].opinfo->type == OpType::Integer)
+    {
+      if (IsStackAdjustment(inst))
+      {
+        stack_offset += inst.SIMM_16;
+        continue;
+      }
+    }
+    else
+    {
+      // In the future, some subsets of other instruction types might get
+      // supported. Right now, only try loops that have this very
+      // restricted instruction set.
+      return false;
+    }
+
+    // Any other use of r1 could create pointers into the stack that we don't track.
+    if (regs_in[1] || regs_out[1])
+      return false;
+
+    for (int reg : regs_in)
+    {
+      if (written_regs[reg])
+        continue;
+      write_disallowed_regs[reg] = true;
+    }
+    for (int reg : regs_out)
+    {
+      if (write_disallowed_regs[reg])
+        return false;
+      written_regs[reg] = true;
+    }
   }
   return false;
 }
@@ -0,0 +1,105 @@
+// Copyright 2019 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include "DiscIO/BatchedFileReader.h"
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "Common/CommonTypes.h"
+#include "Common/File.h"
+#include "Common/WorkerPool.h"
+
+namespace DiscIO
+{
+BatchedFileReader::BatchedFileReader(const File::IOFile& file) : m_file(file)
+{
+}
+
+BatchedFileReader::~BatchedFileReader() = default;
+
+void BatchedFileReader::SetQueueDepth(u32 queue_depth)
+{
+  queue_depth = std::max<u32>(queue_depth, 1);
+  if (queue_depth == m_queue_depth)
+    return;
+
+  m_queue_depth = queue_depth;
+  m_pool.reset();
+  if (m_queue_depth > 1)
+    m_pool = std::make_unique<Common::WorkerPool>(m_queue_depth, "Disc Reader");
+}
+
+bool BatchedFileReader::Read(u64 offset, u64 size, u8* out_ptr)
+{
+  // Reads which wouldn't get split up are done directly
+  if (!m_pool || size < 2 * MIN_PIECE_SIZE)
+    return m_file.ReadBytesAt(out_ptr, size, offset);
+
+  return ReadBatch({{offset, size, out_ptr}});
+}
+
+bool BatchedFileReader::ReadBatch(std::vector<Request> requests)
+{
+  std::sort(requests.begin(), requests.end(),
+            [](const Request& a, const Request& b) { return a.offset < b.offset; });
+
+  // Merge reads which are adjacent both in the file and in memory
+  m_pieces.clear();
+  u64 total_size = 0;
+  for (const Request& request : requests)
+  {
+    if (request.size == 0)
+      continue;
+    total_size += request.size;
+
+    if (!m_pieces.empty())
+    {
+      Request& last = m_pieces.back();
+      if (last.offset + last.size == request.offset &&
+          last.out_ptr + last.size == request.out_ptr)
+      {
+        last.size += request.size;
+        continue;
+      }
+    }
+    m_pieces.push_back(request);
+  }
+
+  if (!m_pool)
+  {
+    return std::all_of(m_pieces.begin(), m_pieces.end(), [this](const Request& piece) {
+      return m_file.ReadBytesAt(piece.out_ptr, piece.size, piece.offset);
+    });
+  }
+
+  // Split large reads so that every thread gets a roughly equal share.
+  // The remainders are appended, and get split further when the loop reaches them.
+  const u64 piece_size =
+      std::max<u64>(MIN_PIECE_SIZE, (total_size + m_queue_depth - 1) / m_queue_depth);
+  for (size_t i = 0; i < m_pieces.size(); ++i)
+  {
+    if (m_pieces[i].size <= piece_size)
+      continue;
+
+    const Request& piece = m_pieces[i];
+    const Request rest{piece.offset + piece_size, piece.size - piece_size,
+                       piece.out_ptr + piece_size};
+    m_pieces[i].size = piece_size;
+    m_pieces.push_back(rest);
+  }
+
+  std::atomic<bool> success{true};
+  m_pool->ParallelFor(m_pieces.size(), [&](size_t i) {
+    const Request& piece = m_pieces[i];
+    if (!m_file.ReadBytesAt(piece.out_ptr, piece.size, piece.offset))
+      success.store(false, std::memory_order_relaxed);
+  });
+  return success.load(std::memory_order_relaxed);
+}
+
+}  // namespace DiscIO
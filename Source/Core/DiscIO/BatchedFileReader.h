@@ -0,0 +1,64 @@
+// Copyright 2019 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "Common/CommonTypes.h"
+
+namespace Common
+{
+class WorkerPool;
+}
+
+namespace File
+{
+class IOFile;
+}
+
+namespace DiscIO
+{
+// Reads from a file with positional reads, so that several reads can be in flight at once.
+// The reads of a batch are sorted and merged where they are adjacent, and large reads are split
+// into pieces which are read concurrently by a pool of threads. Network shares and SSDs need
+// more than one outstanding request to reach their full speed.
+class BatchedFileReader
+{
+public:
+  struct Request
+  {
+    u64 offset;
+    u64 size;
+    u8* out_ptr;
+  };
+
+  // Reads smaller than this are never split up
+  static constexpr u64 MIN_PIECE_SIZE = 0x20000;
+
+  // The file must outlive the BatchedFileReader, and must not be read by anything else while
+  // the BatchedFileReader is in use.
+  explicit BatchedFileReader(const File::IOFile& file);
+  ~BatchedFileReader();
+
+  BatchedFileReader(const BatchedFileReader&) = delete;
+  BatchedFileReader& operator=(const BatchedFileReader&) = delete;
+
+  // Until this is called with a value above 1, everything is read on the calling thread.
+  void SetQueueDepth(u32 queue_depth);
+  u32 GetQueueDepth() const { return m_queue_depth; }
+
+  // NOT thread-safe - can't call these from multiple threads.
+  bool Read(u64 offset, u64 size, u8* out_ptr);
+  bool ReadBatch(std::vector<Request> requests);
+
+private:
+  const File::IOFile& m_file;
+  u32 m_queue_depth = 1;
+  std::unique_ptr<Common::WorkerPool> m_pool;
+  std::vector<Request> m_pieces;
+};
+
+}  // namespace DiscIO
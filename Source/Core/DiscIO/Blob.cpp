@@ -3,7 +3,9 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
+#include <cinttypes>
 #include <cstddef>
+#include <iterator>
 #include <limits>
 #include <memory>
 #include <string>
@@ -12,6 +14,7 @@
 #include "Common/CDUtils.h"
 #include "Common/CommonTypes.h"
 #include "Common/File.h"
+#include "Common/Logging/Log.h"
 
 #include "DiscIO/Blob.h"
 #include "DiscIO/CISOBlob.h"
@@ -27,84 +30,159 @@ namespace DiscIO
 void SectorReader::SetSectorSize(int blocksize)
 {
   m_block_size = std::max(blocksize, 0);
-  for (auto& cache_entry : m_cache)
-  {
-    cache_entry.Reset();
-    cache_entry.data.resize(m_chunk_blocks * m_block_size);
-  }
+  ResetCache();
 }
 
 void SectorReader::SetChunkSize(int block_cnt)
 {
   m_chunk_blocks = std::max(block_cnt, 1);
-  // Clear cache and resize the data arrays
-  SetSectorSize(m_block_size);
+  ResetCache();
+}
+
+void SectorReader::SetCacheSize(u32 cache_size_mb)
+{
+  m_cache_size_mb = cache_size_mb;
+  ResetCache();
 }
 
 SectorReader::~SectorReader()
 {
+  if (m_cache_stats.hits + m_cache_stats.misses != 0)
+  {
+    INFO_LOG(DISCIO, "Block cache: %" PRIu64 " hits, %" PRIu64 " misses, %" PRIu64 " reads",
+             m_cache_stats.hits, m_cache_stats.misses, m_cache_stats.reads);
+  }
+}
+
+void SectorReader::ResetCache()
+{
+  m_cache.clear();
+  m_cache_index.clear();
+
+  const u64 chunk_size = u64(m_chunk_blocks) * m_block_size;
+  if (m_cache_size_mb && chunk_size != 0)
+    m_max_cache_lines = std::max<u64>(u64(*m_cache_size_mb) * 1024 * 1024 / chunk_size, 1);
+  else
+    m_max_cache_lines = DEFAULT_CACHE_LINES;
+}
+
+bool SectorReader::IsBlockCached(u64 block_num) const
+{
+  const auto it = m_cache_index.find(block_num / m_chunk_blocks);
+  return it != m_cache_index.end() && it->second->Contains(block_num);
 }
 
 const SectorReader::Cache* SectorReader::FindCacheLine(u64 block_num)
 {
-  auto itr = std::find_if(m_cache.begin(), m_cache.end(),
-                          [&](const Cache& entry) { return entry.Contains(block_num); });
-  if (itr == m_cache.end())
+  const auto it = m_cache_index.find(block_num / m_chunk_blocks);
+  if (it == m_cache_index.end())
     return nullptr;
 
-  itr->MarkUsed();
-  return &*itr;
+  m_cache.splice(m_cache.begin(), m_cache, it->second);
+  return &m_cache.front();
 }
 
 SectorReader::Cache* SectorReader::GetEmptyCacheLine()
 {
-  Cache* oldest = &m_cache[0];
-  // Find the Least Recently Used cache line to replace.
-  std::for_each(m_cache.begin() + 1, m_cache.end(), [&](Cache& line) {
-    if (line.IsLessRecentlyUsedThan(*oldest))
-    {
-      oldest->ShiftLRU();
-      oldest = &line;
-      return;
-    }
-    line.ShiftLRU();
-  });
-  oldest->Reset();
-  return oldest;
+  if (m_cache.size() < m_max_cache_lines)
+  {
+    m_cache.emplace_front();
+    m_cache.front().data.resize(m_chunk_blocks * m_block_size);
+  }
+  else
+  {
+    // Replace the Least Recently Used cache line.
+    Cache& oldest = m_cache.back();
+    if (oldest.num_blocks != 0)
+      m_cache_index.erase(oldest.block_idx / m_chunk_blocks);
+    oldest.block_idx = 0;
+    oldest.num_blocks = 0;
+    m_cache.splice(m_cache.begin(), m_cache, std::prev(m_cache.end()));
+  }
+  return &m_cache.front();
 }
 
-const SectorReader::Cache* SectorReader::GetCacheLine(u64 block_num)
+const SectorReader::Cache* SectorReader::GetCacheLine(u64 block_num, u64 last_block_num)
 {
   if (auto entry = FindCacheLine(block_num))
-    return entry;
+  {
+    ++m_cache_stats.hits;
+    // The chunk may be the last one of the disk, and not contain the block
+    return entry->Contains(block_num) ? entry : nullptr;
+  }
 
-  // Cache miss. Fault in the missing entry.
-  Cache* cache = GetEmptyCacheLine();
+  // Cache miss. Fault in the missing entry, along with the entries after it that the caller
+  // is going to ask for next, so that they can be read with a single call.
   // We only read aligned chunks, this avoids duplicate overlapping entries.
-  u64 chunk_idx = block_num / m_chunk_blocks;
-  u32 blocks_read = ReadChunk(cache->data.data(), chunk_idx);
-  if (!blocks_read)
-    return nullptr;
-  cache->Fill(chunk_idx * m_chunk_blocks, blocks_read);
+  const u64 chunk_idx = block_num / m_chunk_blocks;
+  const u64 last_chunk_idx = std::max(last_block_num, block_num) / m_chunk_blocks;
+  u32 num_chunks = 1;
+  while (num_chunks < MAX_COALESCED_CHUNKS && num_chunks < m_max_cache_lines &&
+         chunk_idx + num_chunks <= last_chunk_idx &&
+         m_cache_index.find(chunk_idx + num_chunks) == m_cache_index.end())
+  {
+    ++num_chunks;
+  }
+  m_cache_stats.misses += num_chunks;
+  ++m_cache_stats.reads;
+
+  const size_t chunk_size = m_chunk_blocks * m_block_size;
+  if (num_chunks == 1)
+  {
+    Cache* cache = GetEmptyCacheLine();
+    const u32 blocks_read = ReadChunks(cache->data.data(), chunk_idx, 1);
+    if (!blocks_read)
+    {
+      // Make the unused line the first one to be replaced
+      m_cache.splice(m_cache.end(), m_cache, m_cache.begin());
+      return nullptr;
+    }
+    cache->block_idx = chunk_idx * m_chunk_blocks;
+    cache->num_blocks = blocks_read;
+    m_cache_index.emplace(chunk_idx, m_cache.begin());
+  }
+  else
+  {
+    m_coalesce_buffer.resize(num_chunks * chunk_size);
+    const u32 blocks_read = ReadChunks(m_coalesce_buffer.data(), chunk_idx, num_chunks);
+    if (!blocks_read)
+      return nullptr;
+
+    // Insert the last chunk first, so that the one that was asked for ends up most recently used.
+    const u32 chunks_read = (blocks_read + m_chunk_blocks - 1) / m_chunk_blocks;
+    for (u32 i = chunks_read; i-- > 0;)
+    {
+      Cache* cache = GetEmptyCacheLine();
+      std::copy_n(m_coalesce_buffer.begin() + i * chunk_size, chunk_size, cache->data.begin());
+      cache->block_idx = (chunk_idx + i) * m_chunk_blocks;
+      cache->num_blocks = std::min(blocks_read - i * m_chunk_blocks, m_chunk_blocks);
+      m_cache_index.emplace(chunk_idx + i, m_cache.begin());
+    }
+  }
 
   // Secondary check for out-of-bounds read.
   // If we got less than m_chunk_blocks, we may still have missed.
   // We do this after the cache fill since the cache line itself is
   // fine, the problem is being asked to read past the end of the disk.
+  const Cache* cache = &m_cache.front();
   return cache->Contains(block_num) ? cache : nullptr;
 }
 
 bool SectorReader::Read(u64 offset, u64 size, u8* out_ptr)
 {
+  if (size == 0)
+    return true;
+
   u64 remain = size;
   u64 block = 0;
   u32 position_in_block = static_cast<u32>(offset % m_block_size);
+  const u64 last_block = (offset + size - 1) / m_block_size;
 
   while (remain > 0)
   {
     block = offset / m_block_size;
 
-    const Cache* cache = GetCacheLine(block);
+    const Cache* cache = GetCacheLine(block, last_block);
     if (!cache)
       return false;
 
@@ -136,22 +214,23 @@ bool SectorReader::ReadMultipleAlignedBlocks(u64 block_num, u64 cnt_blocks, u8*
   return true;
 }
 
-u32 SectorReader::ReadChunk(u8* buffer, u64 chunk_num)
+u32 SectorReader::ReadChunks(u8* buffer, u64 chunk_num, u32 num_chunks)
 {
   u64 block_num = chunk_num * m_chunk_blocks;
-  u32 cnt_blocks = m_chunk_blocks;
+  const u32 max_blocks = m_chunk_blocks * num_chunks;
+  u32 cnt_blocks = max_blocks;
 
   // If we are reading the end of a disk, there may not be enough blocks to
-  // read a whole chunk. We need to clamp down in that case.
+  // read all the chunks. We need to clamp down in that case.
   u64 end_block = (GetDataSize() + m_block_size - 1) / m_block_size;
   if (end_block)
-    cnt_blocks = static_cast<u32>(std::min<u64>(m_chunk_blocks, end_block - block_num));
+    cnt_blocks = static_cast<u32>(std::min<u64>(max_blocks, end_block - block_num));
 
   if (ReadMultipleAlignedBlocks(block_num, cnt_blocks, buffer))
   {
-    if (cnt_blocks < m_chunk_blocks)
+    if (cnt_blocks < max_blocks)
     {
-      std::fill(buffer + cnt_blocks * m_block_size, buffer + m_chunk_blocks * m_block_size, 0u);
+      std::fill(buffer + cnt_blocks * m_block_size, buffer + max_blocks * m_block_size, 0u);
     }
     return cnt_blocks;
   }
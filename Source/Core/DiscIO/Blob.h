@@ -14,10 +14,11 @@
 // detect whether the file is a compressed blob, or just a big hunk of data, or a drive, and
 // automatically do the right thing.
 
-#include <array>
+#include <list>
 #include <memory>
 #include <optional>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include "Common/CommonTypes.h"
@@ -57,6 +58,18 @@ public:
     return Common::FromBigEndian(temp);
   }
 
+  // Lets readers which cache blocks keep up to <cache_size_mb> MiB of them in memory.
+  virtual void SetCacheSize(u32 cache_size_mb) {}
+  // Lets readers which read from a file have up to <queue_depth> reads in flight at once, by
+  // splitting large reads up between threads. 1 means that only the calling thread is used.
+  virtual void SetReadQueueDepth(u32 queue_depth) {}
+  // Lets readers which support it map the whole file into memory, which turns reads into plain
+  // copies. Returns false if the reader doesn't support it or the mapping failed.
+  virtual bool MapIntoMemory() { return false; }
+  // Tells the reader that a range is going to be read soon, so that it can be brought into memory
+  // in the background. Returns false if the reader can't do that without actually reading it.
+  virtual bool HintWillNeed(u64 offset, u64 size) { return false; }
+
   virtual bool SupportsReadWiiDecrypted() const { return false; }
   virtual bool ReadWiiDecrypted(u64 offset, u64 size, u8* out_ptr, u64 partition_offset)
   {
@@ -73,9 +86,19 @@ protected:
 class SectorReader : public BlobReader
 {
 public:
+  struct CacheStats
+  {
+    u64 hits = 0;
+    u64 misses = 0;
+    // Calls to ReadMultipleAlignedBlocks. Less than misses when reads have been coalesced.
+    u64 reads = 0;
+  };
+
   virtual ~SectorReader() = 0;
 
   bool Read(u64 offset, u64 size, u8* out_ptr) override;
+  void SetCacheSize(u32 cache_size_mb) override;
+  const CacheStats& GetCacheStats() const { return m_cache_stats; }
 
 protected:
   void SetSectorSize(int blocksize);
@@ -87,6 +110,8 @@ protected:
   // as large reads are slow and will take too long to resolve.
   void SetChunkSize(int blocks);
   int GetChunkSize() const { return m_chunk_blocks; }
+  // Whether a block can be read without calling GetBlock. Doesn't count as a use of the block.
+  bool IsBlockCached(u64 block_num) const;
   // Read a single block/sector.
   virtual bool GetBlock(u64 block_num, u8* out) = 0;
 
@@ -102,57 +127,44 @@ private:
     u64 block_idx = 0;
     u32 num_blocks = 0;
 
-    // [Pseudo-] Least Recently Used Shift Register
-    // When an empty cache line is needed, the line with the lowest value
-    // is taken and reset; the LRU register is then shifted down 1 place
-    // on all lines (low bit discarded). When a line is used, the high bit
-    // is set marking it as most recently used.
-    u32 lru_sreg = 0;
-
-    void Reset()
-    {
-      block_idx = 0;
-      num_blocks = 0;
-      lru_sreg = 0;
-    }
-    void Fill(u64 block, u32 count)
-    {
-      block_idx = block;
-      num_blocks = count;
-      // NOTE: Setting only the high bit means the newest line will
-      //   be selected for eviction if every line in the cache was
-      //   touched. This gives MRU behavior which is probably
-      //   desirable in that case.
-      MarkUsed();
-    }
     bool Contains(u64 block) const { return block >= block_idx && block - block_idx < num_blocks; }
-    void MarkUsed() { lru_sreg |= 0x80000000; }
-    void ShiftLRU() { lru_sreg >>= 1; }
-    bool IsLessRecentlyUsedThan(const Cache& other) const { return lru_sreg < other.lru_sreg; }
   };
 
-  // Gets the cache line that contains the given block, or nullptr.
-  // NOTE: The cache record only lasts until it expires (next GetEmptyCacheLine)
+  // Clears the cache and recalculates how many lines fit in it.
+  void ResetCache();
+
+  // Gets the cache line of the chunk that contains the given block and marks it as most
+  // recently used, or returns nullptr.
   const Cache* FindCacheLine(u64 block_num);
 
-  // Finds the least recently used cache line, resets and returns it.
+  // Takes a new line, or the least recently used one if the cache is full, and returns it as
+  // the most recently used line. The line has to be filled in by the caller.
   Cache* GetEmptyCacheLine();
 
-  // Combines FindCacheLine with GetEmptyCacheLine and ReadChunk.
+  // Combines FindCacheLine with GetEmptyCacheLine and ReadChunks.
   // Always returns a valid cache line (loading the data if needed).
   // May return nullptr only if the cache missed and the read failed.
-  const Cache* GetCacheLine(u64 block_num);
+  // On a miss, chunks up to <last_block_num> which aren't cached either are read at the same time.
+  const Cache* GetCacheLine(u64 block_num, u64 last_block_num);
 
-  // Read all bytes from a chunk of blocks into a buffer.
-  // Returns the number of blocks read (may be less than m_chunk_blocks
-  // if chunk_num is the last chunk on the disk and the disk size is not
+  // Read all bytes from a run of chunks of blocks into a buffer.
+  // Returns the number of blocks read (may be less than m_chunk_blocks * num_chunks
+  // if the run reaches the end of the disk and the disk size is not
   // evenly divisible into chunks). Returns zero if it fails.
-  u32 ReadChunk(u8* buffer, u64 chunk_num);
+  u32 ReadChunks(u8* buffer, u64 chunk_num, u32 num_chunks);
 
-  static constexpr int CACHE_LINES = 32;
+  static constexpr size_t DEFAULT_CACHE_LINES = 32;
+  static constexpr u32 MAX_COALESCED_CHUNKS = 16;
   u32 m_block_size = 0;    // Bytes in a sector/block
   u32 m_chunk_blocks = 1;  // Number of sectors/blocks in a chunk
-  std::array<Cache, CACHE_LINES> m_cache;
+  std::optional<u32> m_cache_size_mb;
+  size_t m_max_cache_lines = DEFAULT_CACHE_LINES;
+  // Most recently used first
+  std::list<Cache> m_cache;
+  // Keyed by chunk number
+  std::unordered_map<u64, std::list<Cache>::iterator> m_cache_index;
+  std::vector<u8> m_coalesce_buffer;
+  CacheStats m_cache_stats;
 };
 
 // Factory function - examines the path to choose the right type of BlobReader, and returns one.
@@ -6,6 +6,7 @@
 #include <cstdio>
 #include <memory>
 #include <utility>
+#include <vector>
 
 #include "Common/CommonTypes.h"
 #include "Common/File.h"
@@ -49,6 +50,9 @@ u64 CISOFileReader::GetRawSize() const
 
 bool CISOFileReader::Read(u64 offset, u64 nbytes, u8* out_ptr)
 {
+  // The used blocks are stored in order, so the blocks of a read are mostly adjacent in the file
+  // and get merged back into larger reads
+  std::vector<BatchedFileReader::Request> requests;
   while (nbytes != 0)
   {
     u64 const block = offset / m_block_size;
@@ -60,11 +64,7 @@ bool CISOFileReader::Read(u64 offset, u64 nbytes, u8* out_ptr)
       // calculate the base address
       u64 const file_off = CISO_HEADER_SIZE + m_ciso_map[block] * (u64)m_block_size + data_offset;
 
-      if (!(m_file.Seek(file_off, SEEK_SET) && m_file.ReadArray(out_ptr, bytes_to_read)))
-      {
-        m_file.Clear();
-        return false;
-      }
+      requests.push_back({file_off, bytes_to_read, out_ptr});
     }
     else
     {
@@ -76,7 +76,7 @@ bool CISOFileReader::Read(u64 offset, u64 nbytes, u8* out_ptr)
     nbytes -= bytes_to_read;
   }
 
-  return true;
+  return m_reader.ReadBatch(std::move(requests));
 }
 
 }  // namespace DiscIO
@@ -10,6 +10,7 @@
 
 #include "Common/CommonTypes.h"
 #include "Common/File.h"
+#include "DiscIO/BatchedFileReader.h"
 #include "DiscIO/Blob.h"
 
 namespace DiscIO
@@ -44,6 +45,7 @@ public:
 
   u64 GetRawSize() const override;
   bool Read(u64 offset, u64 nbytes, u8* out_ptr) override;
+  void SetReadQueueDepth(u32 queue_depth) override { m_reader.SetQueueDepth(queue_depth); }
 
 private:
   CISOFileReader(File::IOFile file);
@@ -52,6 +54,7 @@ private:
   static const MapType UNUSED_BLOCK_ID = UINT16_MAX;
 
   File::IOFile m_file;
+  BatchedFileReader m_reader{m_file};
   u64 m_size;
   u32 m_block_size;
   MapType m_ciso_map[CISO_MAP_SIZE];
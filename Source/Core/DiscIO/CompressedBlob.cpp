@@ -11,7 +11,9 @@
 #include <cinttypes>
 #include <cstdio>
 #include <cstring>
+#include <list>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <utility>
 #include <vector>
@@ -26,6 +28,7 @@
 #include "Common/StringUtil.h"
 #include "DiscIO/Blob.h"
 #include "DiscIO/CompressedBlob.h"
+#include "DiscIO/ConversionPipeline.h"
 #include "DiscIO/DiscScrubber.h"
 #include "DiscIO/Volume.h"
 
@@ -33,8 +36,48 @@ namespace DiscIO
 {
 bool IsGCZBlob(File::IOFile& file);
 
+class CompressedBlobReader::Inflater
+{
+public:
+  Inflater() { m_initialized = inflateInit(&m_stream) == Z_OK; }
+  ~Inflater()
+  {
+    if (m_initialized)
+      inflateEnd(&m_stream);
+  }
+
+  Inflater(const Inflater&) = delete;
+  Inflater& operator=(const Inflater&) = delete;
+
+  // GCZ blocks are always decompressed as a whole, so zlib is asked to finish in one call. That
+  // keeps it in its fast path and saves it from keeping a copy of the output in its window.
+  // Returns the zlib status, and sets <out_size> to the number of bytes that were written.
+  int Inflate(u8* in, u32 in_size, u8* out, u32 out_capacity, u32* out_size)
+  {
+    *out_size = 0;
+    if (!m_initialized)
+      return Z_MEM_ERROR;
+
+    const int reset_status = inflateReset(&m_stream);
+    if (reset_status != Z_OK)
+      return reset_status;
+
+    m_stream.next_in = in;
+    m_stream.avail_in = in_size;
+    m_stream.next_out = out;
+    m_stream.avail_out = out_capacity;
+    const int status = inflate(&m_stream, Z_FINISH);
+    *out_size = out_capacity - m_stream.avail_out;
+    return status;
+  }
+
+private:
+  z_stream m_stream = {};
+  bool m_initialized;
+};
+
 CompressedBlobReader::CompressedBlobReader(File::IOFile file, const std::string& filename)
-    : m_file(std::move(file)), m_file_name(filename)
+    : m_file(std::move(file)), m_inflater(std::make_unique<Inflater>()), m_file_name(filename)
 {
   m_file_size = m_file.GetSize();
   m_file.Seek(0, SEEK_SET);
@@ -71,6 +114,9 @@ std::unique_ptr<CompressedBlobReader> CompressedBlobReader::Create(File::IOFile
 
 CompressedBlobReader::~CompressedBlobReader()
 {
+  // Don't make the prefetch thread finish its queue before it can be stopped
+  std::lock_guard lk(m_prefetch_lock);
+  m_queued_blocks.clear();
 }
 
 // IMPORTANT: Calling this function invalidates all earlier pointers gotten from this function.
@@ -87,6 +133,30 @@ u64 CompressedBlobReader::GetBlockCompressedSize(u64 block_num) const
 }
 
 bool CompressedBlobReader::GetBlock(u64 block_num, u8* out_ptr)
+{
+  const bool sequential = m_last_block && block_num == *m_last_block + 1;
+  m_last_block = block_num;
+  if (!sequential)
+    m_read_ahead_end = 0;
+
+  const bool prefetched = m_prefetch_thread_started && TakePrefetchedBlock(block_num, out_ptr);
+
+  // Queueing the next blocks first lets them be decompressed while this one is
+  if (sequential && m_read_ahead_blocks != 0 && block_num + 1 < m_header.num_blocks)
+  {
+    const u64 last_block = std::min<u64>(block_num + m_read_ahead_blocks, m_header.num_blocks - 1);
+    QueuePrefetch(std::max(block_num + 1, m_read_ahead_end), last_block);
+    m_read_ahead_end = last_block + 1;
+  }
+
+  if (prefetched)
+    return true;
+
+  return DecompressBlock(block_num, out_ptr, m_inflater.get(), &m_zlib_buffer, true);
+}
+
+bool CompressedBlobReader::DecompressBlock(u64 block_num, u8* out_ptr, Inflater* inflater,
+                                           std::vector<u8>* buffer, bool report_errors) const
 {
   bool uncompressed = false;
   u32 comp_block_size = (u32)GetBlockCompressedSize(block_num);
@@ -95,246 +165,391 @@ bool CompressedBlobReader::GetBlock(u64 block_num, u8* out_ptr)
   if (offset & (1ULL << 63))
   {
     if (comp_block_size != m_header.block_size)
+    {
+      if (!report_errors)
+        return false;
       PanicAlert("Uncompressed block with wrong size");
+    }
     uncompressed = true;
     offset &= ~(1ULL << 63);
   }
 
-  // clear unused part of zlib buffer. maybe this can be deleted when it works fully.
-  memset(&m_zlib_buffer[comp_block_size], 0, m_zlib_buffer.size() - comp_block_size);
+  if (comp_block_size > buffer->size())
+  {
+    if (report_errors)
+      PanicAlert("Block %" PRIu64 " is larger than it can be when decompressed", block_num);
+    return false;
+  }
 
-  m_file.Seek(offset, SEEK_SET);
-  if (!m_file.ReadBytes(m_zlib_buffer.data(), comp_block_size))
+  if (!m_file.ReadBytesAt(buffer->data(), comp_block_size, offset))
   {
-    PanicAlertT("The disc image \"%s\" is truncated, some of the data is missing.",
-                m_file_name.c_str());
-    m_file.Clear();
+    if (report_errors)
+    {
+      PanicAlertT("The disc image \"%s\" is truncated, some of the data is missing.",
+                  m_file_name.c_str());
+    }
     return false;
   }
 
   // First, check hash.
-  u32 block_hash = Common::HashAdler32(m_zlib_buffer.data(), comp_block_size);
+  u32 block_hash = Common::HashAdler32(buffer->data(), comp_block_size);
   if (block_hash != m_hashes[block_num])
+  {
+    if (!report_errors)
+      return false;
     PanicAlertT("The disc image \"%s\" is corrupt.\n"
                 "Hash of block %" PRIu64 " is %08x instead of %08x.",
                 m_file_name.c_str(), block_num, block_hash, m_hashes[block_num]);
+  }
 
   if (uncompressed)
   {
-    std::copy(m_zlib_buffer.begin(), m_zlib_buffer.begin() + comp_block_size, out_ptr);
+    std::copy(buffer->begin(), buffer->begin() + comp_block_size, out_ptr);
   }
   else
   {
-    z_stream z = {};
-    z.next_in = m_zlib_buffer.data();
-    z.avail_in = comp_block_size;
-    if (z.avail_in > m_header.block_size)
-    {
-      PanicAlert("We have a problem");
-    }
-    z.next_out = out_ptr;
-    z.avail_out = m_header.block_size;
-    inflateInit(&z);
-    int status = inflate(&z, Z_FULL_FLUSH);
-    u32 uncomp_size = m_header.block_size - z.avail_out;
+    u32 uncomp_size;
+    const int status =
+        inflater->Inflate(buffer->data(), comp_block_size, out_ptr, m_header.block_size,
+                          &uncomp_size);
     if (status != Z_STREAM_END)
     {
+      if (!report_errors)
+        return false;
       // this seem to fire wrongly from time to time
       // to be sure, don't use compressed isos :P
       PanicAlert("Failure reading block %" PRIu64 " - out of data and not at end.", block_num);
     }
-    inflateEnd(&z);
     if (uncomp_size != m_header.block_size)
     {
-      PanicAlert("Wrong block size");
+      if (report_errors)
+        PanicAlert("Wrong block size");
       return false;
     }
   }
   return true;
 }
 
-bool CompressFileToBlob(const std::string& infile_path, const std::string& outfile_path,
-                        u32 sub_type, int block_size, CompressCB callback, void* arg)
+void CompressedBlobReader::SetReadQueueDepth(u32 queue_depth)
 {
-  bool scrubbing = false;
+  m_read_ahead_blocks = queue_depth > 1 ? std::max(READ_AHEAD_SIZE / m_header.block_size, 1u) : 0;
+}
 
-  File::IOFile infile(infile_path, "rb");
-  if (IsGCZBlob(infile))
-  {
-    PanicAlertT("\"%s\" is already compressed! Cannot compress it further.", infile_path.c_str());
+bool CompressedBlobReader::HintWillNeed(u64 offset, u64 size)
+{
+  if (m_read_ahead_blocks == 0 || size == 0 || offset >= m_header.data_size)
     return false;
-  }
 
-  if (!infile)
+  // Only as much as can be kept around until it gets read
+  const u64 first_block = offset / m_header.block_size;
+  const u64 last_block = std::min<u64>({(offset + size - 1) / m_header.block_size,
+                                        first_block + m_read_ahead_blocks - 1,
+                                        m_header.num_blocks - 1});
+  for (u64 block = first_block; block <= last_block; ++block)
   {
-    PanicAlertT("Failed to open the input file \"%s\".", infile_path.c_str());
-    return false;
+    if (!IsBlockCached(block))
+      QueuePrefetch(block, block);
   }
+  return true;
+}
 
-  File::IOFile outfile(outfile_path, "wb");
-  if (!outfile)
+void CompressedBlobReader::QueuePrefetch(u64 first_block, u64 last_block)
+{
+  if (!m_prefetch_thread_started)
   {
-    PanicAlertT("Failed to open the output file \"%s\".\n"
-                "Check that you have permissions to write the target folder and that the media can "
-                "be written.",
-                outfile_path.c_str());
-    return false;
+    m_prefetch_inflater = std::make_unique<Inflater>();
+    m_prefetch_zlib_buffer.resize(m_zlib_buffer.size());
+    m_prefetch_thread.Reset([this](u64 block_num) { PrefetchBlock(block_num); });
+    m_prefetch_thread_started = true;
   }
 
-  DiscScrubber disc_scrubber;
-  std::unique_ptr<VolumeDisc> volume;
-  if (sub_type == 1)
+  std::lock_guard lk(m_prefetch_lock);
+  for (u64 block = first_block; block <= last_block; ++block)
   {
-    volume = CreateDisc(infile_path);
-    if (!volume || !disc_scrubber.SetupScrub(volume.get(), block_size))
+    if (m_block_in_progress == block || m_prefetched_blocks.count(block) != 0 ||
+        !m_queued_blocks.insert(block).second)
     {
-      PanicAlertT("\"%s\" failed to be scrubbed. Probably the image is corrupt.",
-                  infile_path.c_str());
-      return false;
+      continue;
     }
-
-    scrubbing = true;
+    m_prefetch_thread.EmplaceItem(block);
   }
+}
 
-  z_stream z = {};
-  if (deflateInit(&z, 9) != Z_OK)
-    return false;
+void CompressedBlobReader::PrefetchBlock(u64 block_num)
+{
+  {
+    std::lock_guard lk(m_prefetch_lock);
+    // The block may have been decompressed by GetBlock in the meantime
+    if (m_queued_blocks.erase(block_num) == 0)
+      return;
+    m_block_in_progress = block_num;
+  }
 
-  callback(Common::GetStringT("Files opened, ready to compress."), 0, arg);
+  // Errors aren't reported here. GetBlock decompresses the block again and reports them.
+  std::vector<u8> data(m_header.block_size);
+  const bool success = DecompressBlock(block_num, data.data(), m_prefetch_inflater.get(),
+                                       &m_prefetch_zlib_buffer, false);
 
-  CompressedBlobHeader header;
-  header.magic_cookie = GCZ_MAGIC;
-  header.sub_type = sub_type;
-  header.block_size = block_size;
-  header.data_size = infile.GetSize();
-
-  // round upwards!
-  header.num_blocks = (u32)((header.data_size + (block_size - 1)) / block_size);
-
-  std::vector<u64> offsets(header.num_blocks);
-  std::vector<u32> hashes(header.num_blocks);
-  std::vector<u8> out_buf(block_size);
-  std::vector<u8> in_buf(block_size);
-
-  // seek past the header (we will write it at the end)
-  outfile.Seek(sizeof(CompressedBlobHeader), SEEK_CUR);
-  // seek past the offset and hash tables (we will write them at the end)
-  outfile.Seek((sizeof(u64) + sizeof(u32)) * header.num_blocks, SEEK_CUR);
-  // seek to the start of the input file to make sure we get everything
-  infile.Seek(0, SEEK_SET);
-
-  // Now we are ready to write compressed data!
-  u64 position = 0;
-  int num_compressed = 0;
-  int num_stored = 0;
-  int progress_monitor = std::max<int>(1, header.num_blocks / 1000);
-  bool success = true;
-
-  for (u32 i = 0; i < header.num_blocks; i++)
-  {
-    if (i % progress_monitor == 0)
+  {
+    std::lock_guard lk(m_prefetch_lock);
+    m_block_in_progress.reset();
+    if (success)
     {
-      const u64 inpos = infile.Tell();
-      int ratio = 0;
-      if (inpos != 0)
-        ratio = (int)(100 * position / inpos);
-
-      const std::string temp =
-          StringFromFormat(Common::GetStringT("%i of %i blocks. Compression ratio %i%%").c_str(), i,
-                           header.num_blocks, ratio);
-      bool was_cancelled = !callback(temp, (float)i / (float)header.num_blocks, arg);
-      if (was_cancelled)
+      m_prefetched_blocks.emplace(block_num, std::move(data));
+      m_prefetch_order.push_back(block_num);
+      // The blocks that were decompressed first have most likely been skipped over
+      if (m_prefetched_blocks.size() > 2 * m_read_ahead_blocks)
       {
-        success = false;
-        break;
+        m_prefetched_blocks.erase(m_prefetch_order.front());
+        m_prefetch_order.pop_front();
       }
     }
+  }
+  m_prefetch_done.notify_all();
+}
 
-    offsets[i] = position;
+bool CompressedBlobReader::TakePrefetchedBlock(u64 block_num, u8* out_ptr)
+{
+  std::unique_lock lk(m_prefetch_lock);
+  m_prefetch_done.wait(lk, [&] { return m_block_in_progress != block_num; });
 
-    size_t read_bytes;
-    if (scrubbing)
-      read_bytes = disc_scrubber.GetNextBlock(infile, in_buf.data());
-    else
-      infile.ReadArray(in_buf.data(), header.block_size, &read_bytes);
-    if (read_bytes < header.block_size)
-      std::fill(in_buf.begin() + read_bytes, in_buf.begin() + header.block_size, 0);
+  // If it's still waiting in the queue, it's quicker to decompress it right away
+  m_queued_blocks.erase(block_num);
 
-    int retval = deflateReset(&z);
-    z.next_in = in_buf.data();
-    z.avail_in = header.block_size;
-    z.next_out = out_buf.data();
-    z.avail_out = block_size;
+  const auto it = m_prefetched_blocks.find(block_num);
+  if (it == m_prefetched_blocks.end())
+    return false;
 
-    if (retval != Z_OK)
+  std::copy(it->second.begin(), it->second.end(), out_ptr);
+  m_prefetched_blocks.erase(it);
+  m_prefetch_order.erase(std::find(m_prefetch_order.begin(), m_prefetch_order.end(), block_num));
+  return true;
+}
+
+namespace
+{
+// Writes a GCZ file. The header and the offset and hash tables come first in the file, but can
+// only be filled in at the end, so space is left for them.
+class GCZOutput final : public ConversionOutput
+{
+public:
+  GCZOutput(File::IOFile* file, u32 sub_type, u32 block_size, u64 data_size) : m_file(file)
+  {
+    m_header.magic_cookie = GCZ_MAGIC;
+    m_header.sub_type = sub_type;
+    m_header.block_size = block_size;
+    m_header.data_size = data_size;
+    // round upwards!
+    m_header.num_blocks = static_cast<u32>((data_size + (block_size - 1)) / block_size);
+
+    m_offsets.resize(m_header.num_blocks);
+    m_hashes.resize(m_header.num_blocks);
+  }
+
+  ~GCZOutput()
+  {
+    for (z_stream& z : m_streams)
+      deflateEnd(&z);
+  }
+
+  bool Start()
+  {
+    // seek past the header and the offset and hash tables (we will write them at the end)
+    return m_file->Seek(sizeof(CompressedBlobHeader) +
+                            (sizeof(u64) + sizeof(u32)) * m_header.num_blocks,
+                        SEEK_SET);
+  }
+
+  void ProcessBlock(ConversionBlock* block) const override
+  {
+    const u32 block_size = m_header.block_size;
+    block->compressed_data.resize(block_size);
+
+    z_stream* z = AcquireStream();
+    int status = z ? deflateReset(z) : Z_MEM_ERROR;
+    u32 avail_out = 0;
+    if (status == Z_OK)
     {
-      ERROR_LOG(DISCIO, "Deflate failed");
-      success = false;
-      break;
+      z->next_in = block->data.data();
+      z->avail_in = block_size;
+      z->next_out = block->compressed_data.data();
+      z->avail_out = block_size;
+      status = deflate(z, Z_FINISH);
+      avail_out = z->avail_out;
     }
+    ReleaseStream(z);
 
-    int status = deflate(&z, Z_FINISH);
-    int comp_size = block_size - z.avail_out;
-
-    u8* write_buf;
-    int write_size;
-    if ((status != Z_STREAM_END) || (z.avail_out < 10))
+    if (status != Z_STREAM_END || avail_out < 10)
     {
-      // PanicAlert("%i %i Store %i", i*block_size, position, comp_size);
       // let's store uncompressed
-      write_buf = in_buf.data();
-      offsets[i] |= 0x8000000000000000ULL;
-      write_size = block_size;
-      num_stored++;
+      block->is_compressed = false;
+      block->hash = Common::HashAdler32(block->data.data(), block_size);
     }
     else
     {
       // let's store compressed
-      // PanicAlert("Comp %i to %i", block_size, comp_size);
-      write_buf = out_buf.data();
-      write_size = comp_size;
-      num_compressed++;
+      block->is_compressed = true;
+      block->compressed_data.resize(block_size - avail_out);
+      block->hash =
+          Common::HashAdler32(block->compressed_data.data(), block->compressed_data.size());
     }
+  }
+
+  bool WriteBlock(const ConversionBlock& block) override
+  {
+    const std::vector<u8>& data = block.is_compressed ? block.compressed_data : block.data;
+
+    m_offsets[block.index] = m_position;
+    if (!block.is_compressed)
+      m_offsets[block.index] |= 0x8000000000000000ULL;
+    m_hashes[block.index] = block.hash;
 
-    if (!outfile.WriteBytes(write_buf, write_size))
+    m_position += data.size();
+    return m_file->WriteBytes(data.data(), data.size());
+  }
+
+  bool Finish() override
+  {
+    // Okay, go back and fill in headers
+    m_header.compressed_data_size = m_position;
+    return m_file->Seek(0, SEEK_SET) && m_file->WriteArray(&m_header, 1) &&
+           m_file->WriteArray(m_offsets.data(), m_header.num_blocks) &&
+           m_file->WriteArray(m_hashes.data(), m_header.num_blocks);
+  }
+
+  u64 GetCompressedSize() const { return m_position; }
+
+private:
+  // Every thread that compresses a block needs its own z_stream. They are kept around because
+  // deflateInit allocates several hundred KiB.
+  z_stream* AcquireStream() const
+  {
+    std::lock_guard lk(m_streams_lock);
+    if (!m_free_streams.empty())
     {
-      PanicAlertT("Failed to write the output file \"%s\".\n"
-                  "Check that you have enough space available on the target drive.",
-                  outfile_path.c_str());
-      success = false;
-      break;
+      z_stream* z = m_free_streams.back();
+      m_free_streams.pop_back();
+      return z;
     }
 
-    position += write_size;
+    z_stream& z = m_streams.emplace_back();
+    if (deflateInit(&z, 9) != Z_OK)
+    {
+      ERROR_LOG(DISCIO, "Deflate failed");
+      m_streams.pop_back();
+      return nullptr;
+    }
+    return &z;
+  }
 
-    hashes[i] = Common::HashAdler32(write_buf, write_size);
+  void ReleaseStream(z_stream* z) const
+  {
+    if (!z)
+      return;
+    std::lock_guard lk(m_streams_lock);
+    m_free_streams.push_back(z);
   }
 
-  header.compressed_data_size = position;
+  File::IOFile* m_file;
+  CompressedBlobHeader m_header;
+  std::vector<u64> m_offsets;
+  std::vector<u32> m_hashes;
+  u64 m_position = 0;
 
-  if (!success)
+  mutable std::mutex m_streams_lock;
+  mutable std::list<z_stream> m_streams;
+  mutable std::vector<z_stream*> m_free_streams;
+};
+}  // namespace
+
+bool CompressFileToBlob(const std::string& infile_path, const std::string& outfile_path,
+                        u32 sub_type, int block_size, CompressCB callback, void* arg)
+{
   {
-    // Remove the incomplete output file.
-    outfile.Close();
-    File::Delete(outfile_path);
+    File::IOFile infile(infile_path, "rb");
+    if (IsGCZBlob(infile))
+    {
+      PanicAlertT("\"%s\" is already compressed! Cannot compress it further.",
+                  infile_path.c_str());
+      return false;
+    }
   }
-  else
+
+  // Any format that can be read can be compressed, not only plain disc images
+  std::unique_ptr<BlobReader> reader = CreateBlobReader(infile_path);
+  if (!reader)
   {
-    // Okay, go back and fill in headers
-    outfile.Seek(0, SEEK_SET);
-    outfile.WriteArray(&header, 1);
-    outfile.WriteArray(offsets.data(), header.num_blocks);
-    outfile.WriteArray(hashes.data(), header.num_blocks);
+    PanicAlertT("Failed to open the input file \"%s\".", infile_path.c_str());
+    return false;
+  }
+
+  File::IOFile outfile(outfile_path, "wb");
+  if (!outfile)
+  {
+    PanicAlertT("Failed to open the output file \"%s\".\n"
+                "Check that you have permissions to write the target folder and that the media can "
+                "be written.",
+                outfile_path.c_str());
+    return false;
   }
 
-  // Cleanup
-  deflateEnd(&z);
+  DiscScrubber disc_scrubber;
+  std::unique_ptr<VolumeDisc> volume;
+  if (sub_type == 1)
+  {
+    volume = CreateDisc(infile_path);
+    if (!volume || !disc_scrubber.SetupScrub(volume.get(), block_size))
+    {
+      PanicAlertT("\"%s\" failed to be scrubbed. Probably the image is corrupt.",
+                  infile_path.c_str());
+      return false;
+    }
+  }
 
+  if (callback)
+    callback(Common::GetStringT("Files opened, ready to compress."), 0, arg);
+
+  GCZOutput output(&outfile, sub_type, block_size, reader->GetDataSize());
+  const auto update_progress = [&](u64 blocks_done, u64 num_blocks) {
+    if (!callback)
+      return true;
+
+    int ratio = 0;
+    if (blocks_done != 0)
+      ratio = static_cast<int>(100 * output.GetCompressedSize() / (blocks_done * block_size));
+
+    const std::string temp =
+        StringFromFormat(Common::GetStringT("%i of %i blocks. Compression ratio %i%%").c_str(),
+                         static_cast<int>(blocks_done), static_cast<int>(num_blocks), ratio);
+    return callback(temp, static_cast<float>(blocks_done) / num_blocks, arg);
+  };
+
+  bool success = output.Start();
   if (success)
   {
-    callback(Common::GetStringT("Done compressing disc image."), 1.0f, arg);
+    success = ConvertBlob(reader.get(), volume ? &disc_scrubber : nullptr, block_size, &output,
+                          update_progress);
   }
-  return success;
+
+  // This is only reported here, because the conversion may write on a thread other than this one
+  if (!success && !outfile)
+  {
+    PanicAlertT("Failed to write the output file \"%s\".\n"
+                "Check that you have enough space available on the target drive.",
+                outfile_path.c_str());
+  }
+
+  if (!success)
+  {
+    // Remove the incomplete output file.
+    outfile.Close();
+    File::Delete(outfile_path);
+    return false;
+  }
+
+  if (callback)
+    callback(Common::GetStringT("Done compressing disc image."), 1.0f, arg);
+  return true;
 }
 
 bool DecompressBlobToFile(const std::string& infile_path, const std::string& outfile_path,
@@ -370,47 +585,30 @@ bool DecompressBlobToFile(const std::string& infile_path, const std::string& out
 
   const CompressedBlobHeader& header = reader->GetHeader();
   static const size_t BUFFER_BLOCKS = 32;
-  size_t buffer_size = header.block_size * BUFFER_BLOCKS;
-  size_t last_buffer_size = header.block_size * (header.num_blocks % BUFFER_BLOCKS);
-  std::vector<u8> buffer(buffer_size);
-  u32 num_buffers = (header.num_blocks + BUFFER_BLOCKS - 1) / BUFFER_BLOCKS;
-  int progress_monitor = std::max<int>(1, num_buffers / 100);
-  bool success = true;
+  const auto update_progress = [&](u64 buffers_done, u64 num_buffers) {
+    return !callback || callback(Common::GetStringT("Unpacking"),
+                                 static_cast<float>(buffers_done) / num_buffers, arg);
+  };
+
+  // Lets blocks be decompressed on a second thread while the previous ones are being read
+  reader->SetReadQueueDepth(2);
 
-  for (u64 i = 0; i < num_buffers; i++)
+  PlainFileOutput output(&outfile, header.data_size);
+  const bool success = ConvertBlob(reader.get(), nullptr, header.block_size * BUFFER_BLOCKS,
+                                   &output, update_progress);
+  if (!success)
   {
-    if (i % progress_monitor == 0)
-    {
-      const bool was_cancelled =
-          !callback(Common::GetStringT("Unpacking"), (float)i / (float)num_buffers, arg);
-      if (was_cancelled)
-      {
-        success = false;
-        break;
-      }
-    }
-    const size_t sz = i == num_buffers - 1 ? last_buffer_size : buffer_size;
-    reader->Read(i * buffer_size, sz, buffer.data());
-    if (!outfile.WriteBytes(buffer.data(), sz))
+    if (!outfile)
     {
       PanicAlertT("Failed to write the output file \"%s\".\n"
                   "Check that you have enough space available on the target drive.",
                   outfile_path.c_str());
-      success = false;
-      break;
     }
-  }
 
-  if (!success)
-  {
     // Remove the incomplete output file.
     outfile.Close();
     File::Delete(outfile_path);
   }
-  else
-  {
-    outfile.Resize(header.data_size);
-  }
 
   return success;
 }
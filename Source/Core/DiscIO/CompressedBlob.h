@@ -13,12 +13,19 @@
 
 #pragma once
 
+#include <condition_variable>
+#include <deque>
+#include <map>
 #include <memory>
+#include <mutex>
+#include <optional>
+#include <set>
 #include <string>
 #include <vector>
 
 #include "Common/CommonTypes.h"
 #include "Common/File.h"
+#include "Common/WorkQueueThread.h"
 #include "DiscIO/Blob.h"
 
 namespace DiscIO
@@ -55,9 +62,29 @@ public:
   u64 GetBlockCompressedSize(u64 block_num) const;
   bool GetBlock(u64 block_num, u8* out_ptr) override;
 
+  // A queue depth above 1 lets blocks be decompressed ahead of sequential reads on a background
+  // thread, as well as the blocks passed to HintWillNeed.
+  void SetReadQueueDepth(u32 queue_depth) override;
+  bool HintWillNeed(u64 offset, u64 size) override;
+
 private:
+  // Holds on to a z_stream, so that it doesn't have to be set up again for every block
+  class Inflater;
+
+  // How far ahead of sequential reads blocks get decompressed in the background
+  static constexpr u32 READ_AHEAD_SIZE = 0x100000;
+
   CompressedBlobReader(File::IOFile file, const std::string& filename);
 
+  // Safe to call from several threads, as long as each one uses its own inflater and buffer.
+  bool DecompressBlock(u64 block_num, u8* out_ptr, Inflater* inflater, std::vector<u8>* buffer,
+                       bool report_errors) const;
+
+  void QueuePrefetch(u64 first_block, u64 last_block);
+  void PrefetchBlock(u64 block_num);
+  // Returns false if the block wasn't decompressed in the background
+  bool TakePrefetchedBlock(u64 block_num, u8* out_ptr);
+
   CompressedBlobHeader m_header;
   std::vector<u64> m_block_pointers;
   std::vector<u32> m_hashes;
@@ -65,7 +92,28 @@ private:
   File::IOFile m_file;
   u64 m_file_size;
   std::vector<u8> m_zlib_buffer;
+  std::unique_ptr<Inflater> m_inflater;
   std::string m_file_name;
+
+  u32 m_read_ahead_blocks = 0;
+  std::optional<u64> m_last_block;
+  // Everything before this has been queued for the current sequential stream
+  u64 m_read_ahead_end = 0;
+
+  // Only used by the prefetch thread
+  std::unique_ptr<Inflater> m_prefetch_inflater;
+  std::vector<u8> m_prefetch_zlib_buffer;
+
+  std::mutex m_prefetch_lock;
+  std::condition_variable m_prefetch_done;
+  std::set<u64> m_queued_blocks;
+  std::optional<u64> m_block_in_progress;
+  std::map<u64, std::vector<u8>> m_prefetched_blocks;
+  // The keys of m_prefetched_blocks, in the order they were decompressed
+  std::deque<u64> m_prefetch_order;
+  bool m_prefetch_thread_started = false;
+  // Declared last, so that the thread is stopped before anything it uses is destroyed
+  Common::WorkQueueThread<u64> m_prefetch_thread;
 };
 
 }  // namespace DiscIO
@@ -0,0 +1,141 @@
+// Copyright 2019 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include "DiscIO/ConversionPipeline.h"
+
+#include <algorithm>
+#include <array>
+#include <cinttypes>
+#include <thread>
+#include <vector>
+
+#include "Common/CommonTypes.h"
+#include "Common/File.h"
+#include "Common/Logging/Log.h"
+#include "Common/WorkerPool.h"
+#include "DiscIO/Blob.h"
+#include "DiscIO/DiscScrubber.h"
+
+namespace DiscIO
+{
+// How much data each thread gets to process per batch
+constexpr u64 BATCH_SIZE_PER_THREAD = 0x100000;
+
+PlainFileOutput::PlainFileOutput(File::IOFile* file, u64 data_size)
+    : m_file(file), m_data_size(data_size)
+{
+}
+
+bool PlainFileOutput::WriteBlock(const ConversionBlock& block)
+{
+  const size_t size =
+      static_cast<size_t>(std::min<u64>(block.data.size(), m_data_size - block.offset));
+  return m_file->WriteBytes(block.data.data(), size);
+}
+
+static bool ReadBlocks(BlobReader* reader, const DiscScrubber* scrubber, u32 block_size,
+                       u64 first_block, size_t count, std::vector<ConversionBlock>* blocks)
+{
+  const u64 data_size = reader->GetDataSize();
+  for (size_t i = 0; i < count; ++i)
+  {
+    ConversionBlock& block = (*blocks)[i];
+    block.index = first_block + i;
+    block.offset = block.index * block_size;
+    block.data.resize(block_size);
+
+    if (scrubber && scrubber->CanBlockBeScrubbed(block.offset))
+    {
+      std::fill(block.data.begin(), block.data.end(), 0);
+      continue;
+    }
+
+    const u32 read_size = static_cast<u32>(std::min<u64>(block_size, data_size - block.offset));
+    if (!reader->Read(block.offset, read_size, block.data.data()))
+    {
+      ERROR_LOG(DISCIO, "Failed to read 0x%x bytes at 0x%" PRIx64 " for conversion", read_size,
+                block.offset);
+      return false;
+    }
+    std::fill(block.data.begin() + read_size, block.data.end(), 0);
+  }
+  return true;
+}
+
+static bool WriteBlocks(ConversionOutput* output, const std::vector<ConversionBlock>& blocks,
+                        size_t count)
+{
+  for (size_t i = 0; i < count; ++i)
+  {
+    if (!output->WriteBlock(blocks[i]))
+      return false;
+  }
+  return true;
+}
+
+bool ConvertBlob(BlobReader* reader, const DiscScrubber* scrubber, u32 block_size,
+                 ConversionOutput* output, const ConversionProgressCallback& update_progress)
+{
+  const u64 num_blocks = (reader->GetDataSize() + block_size - 1) / block_size;
+
+  Common::WorkerPool pool(std::max(std::thread::hardware_concurrency(), 1u), "Disc Converter");
+  const u64 batch_blocks =
+      std::max<u64>(pool.GetThreadCount() * BATCH_SIZE_PER_THREAD / block_size, 1);
+  const u64 num_batches = (num_blocks + batch_blocks - 1) / batch_blocks;
+  const auto batch_count = [&](u64 batch) {
+    return static_cast<size_t>(std::min(batch_blocks, num_blocks - batch * batch_blocks));
+  };
+
+  // While one batch is processed, the next one is read into the second slot and the previous one
+  // is written from the third.
+  std::array<std::vector<ConversionBlock>, 3> batches;
+  for (std::vector<ConversionBlock>& batch : batches)
+    batch.resize(static_cast<size_t>(std::min(batch_blocks, num_blocks)));
+
+  if (num_batches != 0 &&
+      !ReadBlocks(reader, scrubber, block_size, 0, batch_count(0), &batches[0]))
+  {
+    return false;
+  }
+
+  for (u64 i = 0; i <= num_batches; ++i)
+  {
+    const bool write_previous = i != 0;
+    const bool read_next = i + 1 < num_batches;
+    const size_t process_count = i < num_batches ? batch_count(i) : 0;
+
+    // Each flag is only touched by a single task, and ParallelFor synchronizes with all tasks
+    bool write_success = true;
+    bool read_success = true;
+    pool.ParallelFor(process_count + 2, [&](size_t j) {
+      if (j == 0)
+      {
+        if (write_previous)
+          write_success = WriteBlocks(output, batches[(i - 1) % 3], batch_count(i - 1));
+      }
+      else if (j == 1)
+      {
+        if (read_next)
+        {
+          read_success = ReadBlocks(reader, scrubber, block_size, (i + 1) * batch_blocks,
+                                    batch_count(i + 1), &batches[(i + 1) % 3]);
+        }
+      }
+      else
+      {
+        output->ProcessBlock(&batches[i % 3][j - 2]);
+      }
+    });
+
+    if (!write_success || !read_success)
+      return false;
+
+    if (update_progress && !update_progress(std::min(i * batch_blocks, num_blocks), num_blocks))
+      return false;
+  }
+
+  return output->Finish();
+}
+
+}  // namespace DiscIO
@@ -0,0 +1,76 @@
+// Copyright 2019 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <functional>
+#include <vector>
+
+#include "Common/CommonTypes.h"
+
+namespace File
+{
+class IOFile;
+}
+
+namespace DiscIO
+{
+class BlobReader;
+class DiscScrubber;
+
+struct ConversionBlock
+{
+  u64 index;
+  u64 offset;
+  // Always a full block. The part past the end of the disc, and scrubbed blocks, are zeroes.
+  std::vector<u8> data;
+
+  // Filled in by ConversionOutput::ProcessBlock for outputs which don't store the data as is
+  std::vector<u8> compressed_data;
+  bool is_compressed;
+  u32 hash;
+};
+
+// Where ConvertBlob sends the blocks it has read. A format writer only has to say how a single
+// block gets processed and how the processed blocks get stored.
+class ConversionOutput
+{
+public:
+  virtual ~ConversionOutput() = default;
+
+  // Called on several threads at once, for different blocks.
+  virtual void ProcessBlock(ConversionBlock* block) const {}
+  // Called once for every block, in block order. Can run at the same time as ProcessBlock calls
+  // for later blocks, but never on more than one thread at once.
+  virtual bool WriteBlock(const ConversionBlock& block) = 0;
+  // Called once all blocks have been written.
+  virtual bool Finish() { return true; }
+};
+
+// Writes the data of the disc as is.
+class PlainFileOutput final : public ConversionOutput
+{
+public:
+  PlainFileOutput(File::IOFile* file, u64 data_size);
+
+  bool WriteBlock(const ConversionBlock& block) override;
+
+private:
+  File::IOFile* m_file;
+  u64 m_data_size;
+};
+
+using ConversionProgressCallback = std::function<bool(u64 blocks_done, u64 num_blocks)>;
+
+// Reads all data of <reader> in blocks of <block_size> bytes and passes them to <output>.
+// Blocks which <scrubber> (can be nullptr) considers unused are not read, but replaced by zeroes.
+//
+// Reading, processing and writing overlap: while one batch of blocks is processed on all cores,
+// the next one is read and the previous one is written. <update_progress> is called on the
+// calling thread after every batch, and can return false to cancel the conversion.
+// Returns false if reading or writing failed or the conversion was cancelled.
+bool ConvertBlob(BlobReader* reader, const DiscScrubber* scrubber, u32 block_size,
+                 ConversionOutput* output, const ConversionProgressCallback& update_progress);
+
+}  // namespace DiscIO
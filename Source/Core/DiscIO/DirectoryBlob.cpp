@@ -8,17 +8,23 @@
 #include <array>
 #include <cinttypes>
 #include <cstring>
+#include <ctime>
+#include <functional>
+#include <list>
 #include <locale>
 #include <map>
 #include <memory>
+#include <optional>
 #include <set>
 #include <string>
+#include <thread>
 #include <utility>
 #include <variant>
 #include <vector>
 
 #include "Common/Align.h"
 #include "Common/Assert.h"
+#include "Common/ChunkFile.h"
 #include "Common/CommonPaths.h"
 #include "Common/CommonTypes.h"
 #include "Common/File.h"
@@ -60,6 +66,49 @@ constexpr u8 ENTRY_SIZE = 0x0c;
 constexpr u8 FILE_ENTRY = 0;
 constexpr u8 DIRECTORY_ENTRY = 1;
 
+// "DFST"
+constexpr u32 FST_CACHE_MAGIC = 0x54534644;
+constexpr u32 FST_CACHE_VERSION = 1;
+
+// A file or directory which was used to build an FST, and the state it was in at the time
+struct FSTCacheEntry
+{
+  void DoState(PointerWrap& p)
+  {
+    p.Do(path);
+    p.Do(modification_time);
+    p.Do(size);
+    p.Do(data_offset);
+    p.Do(is_directory);
+  }
+
+  std::string path;
+  s64 modification_time;
+  u64 size;
+  u64 data_offset;
+  bool is_directory;
+};
+
+const File::IOFile* ContentFileCache::Open(const std::string& path)
+{
+  auto it = std::find_if(m_files.begin(), m_files.end(),
+                         [&path](const OpenFile& file) { return file.path == path; });
+  if (it != m_files.end())
+  {
+    m_files.splice(m_files.begin(), m_files, it);
+    return &m_files.front().file;
+  }
+
+  File::IOFile file(path, "rb");
+  if (!file)
+    return nullptr;
+
+  if (m_files.size() >= MAX_OPEN_FILES)
+    m_files.pop_back();
+  m_files.push_front(OpenFile{path, std::move(file)});
+  return &m_files.front().file;
+}
+
 DiscContent::DiscContent(u64 offset, u64 size, const std::string& path)
     : m_offset(offset), m_size(size), m_content_source(path)
 {
@@ -89,7 +138,7 @@ u64 DiscContent::GetSize() const
   return m_size;
 }
 
-bool DiscContent::Read(u64* offset, u64* length, u8** buffer) const
+bool DiscContent::Read(u64* offset, u64* length, u8** buffer, ContentFileCache* file_cache) const
 {
   if (m_size == 0)
     return true;
@@ -103,9 +152,8 @@ bool DiscContent::Read(u64* offset, u64* length, u8** buffer) const
 
     if (std::holds_alternative<std::string>(m_content_source))
     {
-      File::IOFile file(std::get<std::string>(m_content_source), "rb");
-      file.Seek(offset_in_content, SEEK_SET);
-      if (!file.ReadBytes(*buffer, bytes_to_read))
+      const File::IOFile* file = file_cache->Open(std::get<std::string>(m_content_source));
+      if (!file || !file->ReadBytesAt(*buffer, bytes_to_read, offset_in_content))
         return false;
     }
     else
@@ -148,7 +196,8 @@ u64 DiscContentContainer::CheckSizeAndAdd(u64 offset, u64 max_size, const std::s
   return size;
 }
 
-bool DiscContentContainer::Read(u64 offset, u64 length, u8* buffer) const
+bool DiscContentContainer::Read(u64 offset, u64 length, u8* buffer,
+                                ContentFileCache* file_cache) const
 {
   // Determine which DiscContent the offset refers to
   std::set<DiscContent>::const_iterator it = m_contents.upper_bound(DiscContent(offset));
@@ -158,7 +207,7 @@ bool DiscContentContainer::Read(u64 offset, u64 length, u8* buffer) const
     // Zero fill to start of DiscContent data
     PadToAddress(it->GetOffset(), &offset, &length, &buffer);
 
-    if (!it->Read(&offset, &length, &buffer))
+    if (!it->Read(&offset, &length, &buffer, file_cache))
       return false;
 
     ++it;
@@ -377,7 +426,7 @@ bool DirectoryBlobReader::Read(u64 offset, u64 length, u8* buffer)
 {
   // TODO: We don't handle raw access to the encrypted area of Wii discs correctly.
   return (m_is_wii ? m_nonpartition_contents : m_gamecube_pseudopartition.GetContents())
-      .Read(offset, length, buffer);
+      .Read(offset, length, buffer, &m_file_cache);
 }
 
 bool DirectoryBlobReader::SupportsReadWiiDecrypted() const
@@ -394,7 +443,7 @@ bool DirectoryBlobReader::ReadWiiDecrypted(u64 offset, u64 size, u8* buffer, u64
   if (it == m_partitions.end())
     return false;
 
-  return it->second.GetContents().Read(offset, size, buffer);
+  return it->second.GetContents().Read(offset, size, buffer, &m_file_cache);
 }
 
 BlobType DirectoryBlobReader::GetBlobType() const
@@ -663,33 +712,48 @@ u64 DirectoryBlobPartition::SetDOL(u64 dol_address)
 
 void DirectoryBlobPartition::BuildFST(u64 fst_address)
 {
-  m_fst_data.clear();
+  const std::string cache_path = GetFSTCachePath();
+  if (!LoadFSTCache(cache_path, fst_address))
+  {
+    m_fst_data.clear();
 
-  File::FSTEntry rootEntry = File::ScanDirectoryTree(m_root_directory + "files/", true);
+    File::FSTEntry rootEntry = File::ScanDirectoryTree(m_root_directory + "files/", true);
 
-  ConvertUTF8NamesToSHIFTJIS(&rootEntry);
+    ConvertUTF8NamesToSHIFTJIS(&rootEntry);
 
-  u32 name_table_size = Common::AlignUp(ComputeNameSize(rootEntry), 1ull << m_address_shift);
-  u64 total_entries = rootEntry.size + 1;  // The root entry itself isn't counted in rootEntry.size
+    u32 name_table_size = Common::AlignUp(ComputeNameSize(rootEntry), 1ull << m_address_shift);
+    // The root entry itself isn't counted in rootEntry.size
+    u64 total_entries = rootEntry.size + 1;
 
-  const u64 name_table_offset = total_entries * ENTRY_SIZE;
-  m_fst_data.resize(name_table_offset + name_table_size);
+    const u64 name_table_offset = total_entries * ENTRY_SIZE;
+    m_fst_data.resize(name_table_offset + name_table_size);
 
-  // 32 KiB aligned start of data on disc
-  u64 current_data_address = Common::AlignUp(fst_address + m_fst_data.size(), 0x8000ull);
+    // 32 KiB aligned start of data on disc
+    u64 current_data_address = Common::AlignUp(fst_address + m_fst_data.size(), 0x8000ull);
 
-  u32 fst_offset = 0;   // Offset within FST data
-  u32 name_offset = 0;  // Offset within name table
-  u32 root_offset = 0;  // Offset of root of FST
+    u32 fst_offset = 0;   // Offset within FST data
+    u32 name_offset = 0;  // Offset within name table
+    u32 root_offset = 0;  // Offset of root of FST
 
-  // write root entry
-  WriteEntryData(&fst_offset, DIRECTORY_ENTRY, 0, 0, total_entries, m_address_shift);
+    // write root entry
+    WriteEntryData(&fst_offset, DIRECTORY_ENTRY, 0, 0, total_entries, m_address_shift);
 
-  WriteDirectory(rootEntry, &fst_offset, &name_offset, &current_data_address, root_offset,
-                 name_table_offset);
+    std::vector<FSTCacheEntry> cache_entries;
+    cache_entries.push_back(FSTCacheEntry{rootEntry.physicalName, 0, 0, 0, true});
+    WriteDirectory(rootEntry, &fst_offset, &name_offset, &current_data_address, root_offset,
+                   name_table_offset, &cache_entries);
 
-  // overflow check, compare the aligned name offset with the aligned name table size
-  ASSERT(Common::AlignUp(name_offset, 1ull << m_address_shift) == name_table_size);
+    // overflow check, compare the aligned name offset with the aligned name table size
+    ASSERT(Common::AlignUp(name_offset, 1ull << m_address_shift) == name_table_size);
+
+    m_data_size = current_data_address;
+
+    SaveFSTCache(cache_path, fst_address, &cache_entries);
+  }
+  else
+  {
+    m_fst_loaded_from_cache = true;
+  }
 
   // write FST size and location
   Write32((u32)(fst_address >> m_address_shift), 0x0424, &m_disc_header);
@@ -697,8 +761,195 @@ void DirectoryBlobPartition::BuildFST(u64 fst_address)
   Write32((u32)(m_fst_data.size() >> m_address_shift), 0x042c, &m_disc_header);
 
   m_contents.Add(fst_address, m_fst_data);
+}
+
+static std::string GetFSTCacheDirectory()
+{
+  return File::GetUserPath(D_CACHE_IDX) + "DirectoryBlobs/";
+}
 
-  m_data_size = current_data_address;
+std::string DirectoryBlobPartition::GetFSTCachePath() const
+{
+  return GetFSTCacheDirectory() +
+         StringFromFormat("%016" PRIx64, static_cast<u64>(std::hash<std::string>{}(
+                                             m_root_directory))) +
+         ".fst";
+}
+
+static std::vector<u8> ReadFSTCacheFile(const std::string& cache_path)
+{
+  File::IOFile file(cache_path, "rb");
+  std::vector<u8> buffer(file.GetSize());
+  if (buffer.size() < 0x20 || !file.ReadBytes(buffer.data(), buffer.size()))
+    return {};
+  return buffer;
+}
+
+// Returns false if the file wasn't written by this version, or is truncated
+static bool DoFSTCacheHeader(PointerWrap& p, u64 file_size, u64* fst_address, u32* address_shift,
+                             std::string* root_directory)
+{
+  u32 magic = FST_CACHE_MAGIC;
+  u32 version = FST_CACHE_VERSION;
+  u64 stored_file_size = file_size;
+  p.Do(magic);
+  p.Do(version);
+  p.Do(stored_file_size);
+  if (magic != FST_CACHE_MAGIC || version != FST_CACHE_VERSION || stored_file_size != file_size)
+    return false;
+
+  p.Do(*fst_address);
+  p.Do(*address_shift);
+  p.Do(*root_directory);
+  return true;
+}
+
+// Returns nothing if the file can't be used by this version
+static std::optional<std::string> GetFSTCacheRootDirectory(const std::string& cache_path)
+{
+  std::vector<u8> buffer = ReadFSTCacheFile(cache_path);
+  if (buffer.empty())
+    return std::nullopt;
+
+  u8* ptr = buffer.data();
+  PointerWrap p(&ptr, PointerWrap::MODE_READ);
+  u64 fst_address;
+  u32 address_shift;
+  std::string root_directory;
+  if (!DoFSTCacheHeader(p, buffer.size(), &fst_address, &address_shift, &root_directory))
+    return std::nullopt;
+
+  return root_directory;
+}
+
+void DeleteUnusedFSTCaches()
+{
+  // Temporary files are normally renamed or deleted right away. Ones which are older than this
+  // were left behind by a write that was interrupted.
+  constexpr s64 MAX_TEMP_FILE_AGE = 60 * 60;
+  const s64 now = static_cast<s64>(std::time(nullptr));
+
+  const File::FSTEntry cache_directory = File::ScanDirectoryTree(GetFSTCacheDirectory(), false);
+  for (const File::FSTEntry& entry : cache_directory.children)
+  {
+    if (entry.isDirectory)
+      continue;
+
+    bool unused;
+    if (PathEndsWith(entry.virtualName, ".tmp"))
+    {
+      unused = File::FileInfo(entry.physicalName).GetModificationTime() + MAX_TEMP_FILE_AGE < now;
+    }
+    else
+    {
+      const std::optional<std::string> root_directory =
+          GetFSTCacheRootDirectory(entry.physicalName);
+      unused = !root_directory || !File::IsDirectory(*root_directory);
+    }
+
+    if (unused)
+    {
+      INFO_LOG(DISCIO, "Deleting unused FST cache %s", entry.physicalName.c_str());
+      File::Delete(entry.physicalName);
+    }
+  }
+}
+
+bool DirectoryBlobPartition::LoadFSTCache(const std::string& cache_path, u64 fst_address)
+{
+  std::vector<u8> buffer = ReadFSTCacheFile(cache_path);
+  if (buffer.empty())
+    return false;
+
+  u8* ptr = buffer.data();
+  PointerWrap p(&ptr, PointerWrap::MODE_READ);
+  u64 cached_fst_address;
+  u32 cached_address_shift;
+  std::string cached_root_directory;
+  if (!DoFSTCacheHeader(p, buffer.size(), &cached_fst_address, &cached_address_shift,
+                        &cached_root_directory) ||
+      cached_fst_address != fst_address || cached_address_shift != m_address_shift ||
+      cached_root_directory != m_root_directory)
+  {
+    return false;
+  }
+
+  std::vector<u8> fst_data;
+  u64 data_size;
+  std::vector<FSTCacheEntry> entries;
+  p.Do(fst_data);
+  p.Do(data_size);
+  p.DoEachElement(
+      entries, [](PointerWrap& state, FSTCacheEntry& entry) { entry.DoState(state); });
+  if (ptr != buffer.data() + buffer.size())
+    return false;
+
+  // Adding, removing or renaming a file changes the modification time of its directory,
+  // and modifying a file changes its own modification time. Modification times only have a
+  // resolution of one second, so anything which was modified in the second the cache was written
+  // could have been modified again without it being noticeable.
+  const s64 cache_time = File::FileInfo(cache_path).GetModificationTime();
+  for (const FSTCacheEntry& entry : entries)
+  {
+    const File::FileInfo info(entry.path);
+    if (entry.modification_time >= cache_time ||
+        info.GetModificationTime() != entry.modification_time ||
+        (entry.is_directory ? !info.IsDirectory() :
+                              !info.IsFile() || info.GetSize() != entry.size))
+    {
+      INFO_LOG(DISCIO, "Rebuilding the FST for %s since %s has changed", m_root_directory.c_str(),
+               entry.path.c_str());
+      return false;
+    }
+  }
+
+  m_fst_data = std::move(fst_data);
+  m_data_size = data_size;
+  for (const FSTCacheEntry& entry : entries)
+  {
+    if (!entry.is_directory)
+      m_contents.Add(entry.data_offset, entry.size, entry.path);
+  }
+
+  INFO_LOG(DISCIO, "Loaded the FST for %s from %s", m_root_directory.c_str(), cache_path.c_str());
+  return true;
+}
+
+void DirectoryBlobPartition::SaveFSTCache(const std::string& cache_path, u64 fst_address,
+                                          std::vector<FSTCacheEntry>* entries)
+{
+  for (FSTCacheEntry& entry : *entries)
+    entry.modification_time = File::FileInfo(entry.path).GetModificationTime();
+
+  const auto do_state = [&](PointerWrap& p, u64 file_size) {
+    DoFSTCacheHeader(p, file_size, &fst_address, &m_address_shift, &m_root_directory);
+    p.Do(m_fst_data);
+    p.Do(m_data_size);
+    p.DoEachElement(
+        *entries, [](PointerWrap& state, FSTCacheEntry& entry) { entry.DoState(state); });
+  };
+
+  u8* ptr = nullptr;
+  PointerWrap p(&ptr, PointerWrap::MODE_MEASURE);
+  do_state(p, 0);
+  std::vector<u8> buffer(reinterpret_cast<size_t>(ptr));
+  ptr = buffer.data();
+  p.SetMode(PointerWrap::MODE_WRITE);
+  do_state(p, buffer.size());
+
+  // Several threads can be building the FST of the same directory, for instance when a game is
+  // started while the game list is being refreshed, so the file is written under a unique name
+  // and then renamed.
+  const std::string temp_path =
+      cache_path + StringFromFormat(".%zx.tmp", std::hash<std::thread::id>{}(
+                                                    std::this_thread::get_id()));
+  if (!File::CreateFullPath(cache_path) ||
+      !File::IOFile(temp_path, "wb").WriteBytes(buffer.data(), buffer.size()) ||
+      !File::Rename(temp_path, cache_path))
+  {
+    WARN_LOG(DISCIO, "Failed to write the FST cache %s", cache_path.c_str());
+    File::Delete(temp_path);
+  }
 }
 
 void DirectoryBlobPartition::WriteEntryData(u32* entry_offset, u8 type, u32 name_offset,
@@ -727,42 +978,51 @@ void DirectoryBlobPartition::WriteEntryName(u32* name_offset, const std::string&
 
 void DirectoryBlobPartition::WriteDirectory(const File::FSTEntry& parent_entry, u32* fst_offset,
                                             u32* name_offset, u64* data_offset,
-                                            u32 parent_entry_index, u64 name_table_offset)
+                                            u32 parent_entry_index, u64 name_table_offset,
+                                            std::vector<FSTCacheEntry>* cache_entries)
 {
-  std::vector<File::FSTEntry> sorted_entries = parent_entry.children;
+  // Sorting pointers avoids copying the whole subtree of every directory
+  std::vector<const File::FSTEntry*> sorted_entries;
+  sorted_entries.reserve(parent_entry.children.size());
+  for (const File::FSTEntry& entry : parent_entry.children)
+    sorted_entries.push_back(&entry);
 
   // Sort for determinism
   std::sort(sorted_entries.begin(), sorted_entries.end(),
-            [](const File::FSTEntry& one, const File::FSTEntry& two) {
-              const std::string one_upper = ASCIIToUppercase(one.virtualName);
-              const std::string two_upper = ASCIIToUppercase(two.virtualName);
-              return one_upper == two_upper ? one.virtualName < two.virtualName :
+            [](const File::FSTEntry* one, const File::FSTEntry* two) {
+              const std::string one_upper = ASCIIToUppercase(one->virtualName);
+              const std::string two_upper = ASCIIToUppercase(two->virtualName);
+              return one_upper == two_upper ? one->virtualName < two->virtualName :
                                               one_upper < two_upper;
             });
 
-  for (const File::FSTEntry& entry : sorted_entries)
+  for (const File::FSTEntry* entry : sorted_entries)
   {
-    if (entry.isDirectory)
+    if (entry->isDirectory)
     {
       u32 entry_index = *fst_offset / ENTRY_SIZE;
       WriteEntryData(fst_offset, DIRECTORY_ENTRY, *name_offset, parent_entry_index,
-                     entry_index + entry.size + 1, 0);
-      WriteEntryName(name_offset, entry.virtualName, name_table_offset);
+                     entry_index + entry->size + 1, 0);
+      WriteEntryName(name_offset, entry->virtualName, name_table_offset);
+      cache_entries->push_back(FSTCacheEntry{entry->physicalName, 0, 0, 0, true});
 
-      WriteDirectory(entry, fst_offset, name_offset, data_offset, entry_index, name_table_offset);
+      WriteDirectory(*entry, fst_offset, name_offset, data_offset, entry_index, name_table_offset,
+                     cache_entries);
     }
     else
     {
       // put entry in FST
-      WriteEntryData(fst_offset, FILE_ENTRY, *name_offset, *data_offset, entry.size,
+      WriteEntryData(fst_offset, FILE_ENTRY, *name_offset, *data_offset, entry->size,
                      m_address_shift);
-      WriteEntryName(name_offset, entry.virtualName, name_table_offset);
+      WriteEntryName(name_offset, entry->virtualName, name_table_offset);
 
       // write entry to virtual disc
-      m_contents.Add(*data_offset, entry.size, entry.physicalName);
+      m_contents.Add(*data_offset, entry->size, entry->physicalName);
+      cache_entries->push_back(
+          FSTCacheEntry{entry->physicalName, 0, entry->size, *data_offset, false});
 
       // 32 KiB aligned - many games are fine with less alignment, but not all
-      *data_offset = Common::AlignUp(*data_offset + entry.size, 0x8000ull);
+      *data_offset = Common::AlignUp(*data_offset + entry->size, 0x8000ull);
     }
   }
 }
@@ -5,6 +5,7 @@
 #pragma once
 
 #include <cstddef>
+#include <list>
 #include <map>
 #include <memory>
 #include <optional>
@@ -14,22 +15,49 @@
 #include <vector>
 
 #include "Common/CommonTypes.h"
+#include "Common/File.h"
 #include "Common/FileUtil.h"
 #include "DiscIO/Blob.h"
 
 namespace File
 {
 struct FSTEntry;
-class IOFile;
 }  // namespace File
 
 namespace DiscIO
 {
 enum class PartitionType : u32;
+struct FSTCacheEntry;
 
 // Returns true if the path is inside a DirectoryBlob and doesn't represent the DirectoryBlob itself
 bool ShouldHideFromGameList(const std::string& volume_path);
 
+// Deletes cached FSTs of directories which don't exist anymore, and ones which were written by a
+// different version. Caches of directories which still exist are kept even if they are outdated,
+// since they get replaced the next time the directory is used.
+void DeleteUnusedFSTCaches();
+
+// Keeps the most recently read files open. Opening a file for every read is slow, and it also
+// stops the OS from noticing sequential reads and reading ahead of them.
+class ContentFileCache
+{
+public:
+  static constexpr size_t MAX_OPEN_FILES = 32;
+
+  // Returns nullptr if the file can't be opened
+  const File::IOFile* Open(const std::string& path);
+
+private:
+  struct OpenFile
+  {
+    std::string path;
+    File::IOFile file;
+  };
+
+  // Most recently used first
+  std::list<OpenFile> m_files;
+};
+
 class DiscContent
 {
 public:
@@ -44,7 +72,7 @@ public:
   u64 GetOffset() const;
   u64 GetEndOffset() const;
   u64 GetSize() const;
-  bool Read(u64* offset, u64* length, u8** buffer) const;
+  bool Read(u64* offset, u64* length, u8** buffer, ContentFileCache* file_cache) const;
 
   bool operator==(const DiscContent& other) const { return GetEndOffset() == other.GetEndOffset(); }
   bool operator!=(const DiscContent& other) const { return !(*this == other); }
@@ -72,7 +100,7 @@ public:
   u64 CheckSizeAndAdd(u64 offset, const std::string& path);
   u64 CheckSizeAndAdd(u64 offset, u64 max_size, const std::string& path);
 
-  bool Read(u64 offset, u64 length, u8* buffer) const;
+  bool Read(u64 offset, u64 length, u8* buffer, ContentFileCache* file_cache) const;
 
 private:
   std::set<DiscContent> m_contents;
@@ -95,6 +123,7 @@ public:
   const std::string& GetRootDirectory() const { return m_root_directory; }
   const std::vector<u8>& GetHeader() const { return m_disc_header; }
   const DiscContentContainer& GetContents() const { return m_contents; }
+  bool WasFSTLoadedFromCache() const { return m_fst_loaded_from_cache; }
 
 private:
   void SetDiscHeaderAndDiscType(std::optional<bool> is_wii);
@@ -107,12 +136,20 @@ private:
 
   void BuildFST(u64 fst_address);
 
+  // Building the FST requires scanning the whole files directory. The result is cached on disk,
+  // and reused as long as none of the files and directories it was built from have changed.
+  std::string GetFSTCachePath() const;
+  bool LoadFSTCache(const std::string& cache_path, u64 fst_address);
+  void SaveFSTCache(const std::string& cache_path, u64 fst_address,
+                    std::vector<FSTCacheEntry>* entries);
+
   // FST creation
   void WriteEntryData(u32* entry_offset, u8 type, u32 name_offset, u64 data_offset, u64 length,
                       u32 address_shift);
   void WriteEntryName(u32* name_offset, const std::string& name, u64 name_table_offset);
   void WriteDirectory(const File::FSTEntry& parent_entry, u32* fst_offset, u32* name_offset,
-                      u64* data_offset, u32 parent_entry_index, u64 name_table_offset);
+                      u64* data_offset, u32 parent_entry_index, u64 name_table_offset,
+                      std::vector<FSTCacheEntry>* cache_entries);
 
   DiscContentContainer m_contents;
   std::vector<u8> m_disc_header;
@@ -126,6 +163,7 @@ private:
   u32 m_address_shift = 0;
 
   u64 m_data_size;
+  bool m_fst_loaded_from_cache = false;
 };
 
 class DirectoryBlobReader : public BlobReader
@@ -184,6 +222,8 @@ private:
   std::vector<std::vector<u8>> m_partition_headers;
 
   u64 m_data_size;
+
+  ContentFileCache m_file_cache;
 };
 
 }  // namespace DiscIO
@@ -5,14 +5,19 @@
 #include "DiscIO/DiscExtractor.h"
 
 #include <algorithm>
+#include <atomic>
 #include <cinttypes>
 #include <locale>
+#include <mutex>
 #include <optional>
+#include <thread>
+#include <vector>
 
 #include "Common/CommonTypes.h"
 #include "Common/File.h"
 #include "Common/FileUtil.h"
 #include "Common/StringUtil.h"
+#include "Common/WorkerPool.h"
 #include "DiscIO/Enums.h"
 #include "DiscIO/Filesystem.h"
 #include "DiscIO/Volume.h"
@@ -107,14 +112,228 @@ bool ExportData(const Volume& volume, const Partition& partition, u64 offset, u6
   return true;
 }
 
+namespace
+{
+struct ExportedFile
+{
+  std::string path;
+  std::string export_path;
+  u64 offset;
+  u64 size;
+  u32 pieces_left = 0;
+  bool failed = false;
+  // Set once the file has been created on the host
+  bool created = false;
+};
+
+// The part of a file that is contained in a span
+struct ExportPiece
+{
+  size_t file_index;
+  u64 offset_in_span;
+  u64 offset_in_file;
+  u64 size;
+  bool failed = false;
+};
+
+// A contiguous range of the partition which is read at once
+struct ExportSpan
+{
+  u64 offset;
+  u64 size;
+  std::vector<ExportPiece> pieces;
+};
+}  // Anonymous namespace
+
+// Files are read in spans of at most this size, which may contain many small files
+constexpr u64 EXPORT_SPAN_SIZE = 0x1000000;
+// Files which are closer to each other than this are read together, along with what's between them
+constexpr u64 EXPORT_MAX_GAP = 0x40000;
+constexpr unsigned int MAX_EXPORT_THREADS = 8;
+
+static std::vector<ExportSpan> PlanExportSpans(std::vector<ExportedFile>* files)
+{
+  std::vector<size_t> order;
+  order.reserve(files->size());
+  for (size_t i = 0; i < files->size(); ++i)
+  {
+    if (!(*files)[i].failed)
+      order.push_back(i);
+  }
+  std::stable_sort(order.begin(), order.end(), [files](size_t a, size_t b) {
+    return (*files)[a].offset < (*files)[b].offset;
+  });
+
+  std::vector<ExportSpan> spans;
+  for (size_t file_index : order)
+  {
+    ExportedFile& file = (*files)[file_index];
+    u64 offset_in_file = 0;
+    while (offset_in_file < file.size)
+    {
+      const u64 offset = file.offset + offset_in_file;
+      if (spans.empty() || offset < spans.back().offset ||
+          offset > spans.back().offset + spans.back().size + EXPORT_MAX_GAP ||
+          offset - spans.back().offset >= EXPORT_SPAN_SIZE)
+      {
+        spans.push_back(ExportSpan{offset, 0, {}});
+      }
+
+      ExportSpan& span = spans.back();
+      const u64 offset_in_span = offset - span.offset;
+      const u64 size = std::min(file.size - offset_in_file, EXPORT_SPAN_SIZE - offset_in_span);
+      span.pieces.push_back(ExportPiece{file_index, offset_in_span, offset_in_file, size});
+      span.size = std::max(span.size, offset_in_span + size);
+
+      ++file.pieces_left;
+      offset_in_file += size;
+    }
+  }
+
+  return spans;
+}
+
+static void ReadAndWriteSpan(const Volume& volume, const Partition& partition,
+                             std::vector<ExportedFile>* files, std::mutex* read_lock,
+                             std::mutex* create_lock, ExportSpan* span)
+{
+  std::vector<u8> buffer(span->size);
+  bool read_success;
+  if (read_lock)
+  {
+    std::lock_guard lk(*read_lock);
+    read_success = volume.Read(span->offset, span->size, buffer.data(), partition);
+  }
+  else
+  {
+    read_success = volume.Read(span->offset, span->size, buffer.data(), partition);
+  }
+
+  for (ExportPiece& piece : span->pieces)
+  {
+    if (!read_success)
+    {
+      piece.failed = true;
+      continue;
+    }
+
+    // Files are only created once there is something to write to them, so that an export which
+    // gets cancelled or fails early doesn't leave empty files behind. Large files are written by
+    // several threads, which is why the file is opened again for every piece.
+    ExportedFile& file = (*files)[piece.file_index];
+    {
+      std::lock_guard lk(*create_lock);
+      if (!file.created)
+        file.created = File::IOFile(file.export_path, "wb").IsOpen();
+    }
+
+    File::IOFile f(file.export_path, "r+b");
+    piece.failed = !f || !f.Seek(piece.offset_in_file, SEEK_SET) ||
+                   !f.WriteBytes(buffer.data() + piece.offset_in_span, piece.size);
+  }
+}
+
+// Reads the files sorted by their offsets in large spans, which are read and written on several
+// threads. update_progress is called on the calling thread whenever a file has been exported,
+// and can cancel the export by returning true. Returns false if cancelled. Files which weren't
+// exported completely, because of an error or because the export was cancelled, are deleted.
+static bool ExportFiles(const Volume& volume, const Partition& partition,
+                        std::vector<ExportedFile>* files,
+                        const std::function<bool(const std::string& path)>& update_progress)
+{
+  const auto on_file_exported = [&update_progress](const ExportedFile& file) {
+    if (file.failed)
+      ERROR_LOG(DISCIO, "Could not export %s", file.export_path.c_str());
+    return update_progress && update_progress(file.path);
+  };
+
+  std::vector<ExportSpan> spans = PlanExportSpans(files);
+
+  // Empty files have nothing to wait for
+  for (ExportedFile& file : *files)
+  {
+    if (file.pieces_left != 0)
+      continue;
+
+    file.created = File::IOFile(file.export_path, "wb").IsOpen();
+    file.failed = !file.created;
+    if (on_file_exported(file))
+      return false;
+  }
+
+  // Volumes which don't support concurrent reads still benefit from writing on other threads
+  std::mutex read_lock;
+  std::mutex* const read_lock_ptr = volume.SupportsConcurrentReads() ? nullptr : &read_lock;
+  std::mutex create_lock;
+
+  // Spans which have been written, but which haven't been accounted for on the calling thread yet
+  std::mutex done_lock;
+  std::vector<size_t> done_spans;
+  std::atomic<bool> cancelled{false};
+
+  const auto handle_done_spans = [&] {
+    std::vector<size_t> spans_to_handle;
+    {
+      std::lock_guard lk(done_lock);
+      spans_to_handle.swap(done_spans);
+    }
+
+    for (size_t span_index : spans_to_handle)
+    {
+      for (const ExportPiece& piece : spans[span_index].pieces)
+      {
+        ExportedFile& file = (*files)[piece.file_index];
+        file.failed |= piece.failed;
+        if (--file.pieces_left == 0 && !cancelled.load(std::memory_order_relaxed) &&
+            on_file_exported(file))
+        {
+          cancelled.store(true, std::memory_order_relaxed);
+        }
+      }
+    }
+  };
+
+  // The calling thread takes part in the work, and reports the progress of all threads whenever
+  // it has finished a span, so that progress is reported about as often as spans get written.
+  const std::thread::id calling_thread = std::this_thread::get_id();
+  const size_t num_threads =
+      std::min<size_t>(spans.size(), std::min(std::thread::hardware_concurrency(),
+                                              MAX_EXPORT_THREADS));
+  Common::WorkerPool pool(std::max<size_t>(num_threads, 1), "Disc Extractor");
+  pool.ParallelFor(spans.size(), [&](size_t i) {
+    if (cancelled.load(std::memory_order_relaxed))
+      return;
+
+    ReadAndWriteSpan(volume, partition, files, read_lock_ptr, &create_lock, &spans[i]);
+    {
+      std::lock_guard lk(done_lock);
+      done_spans.push_back(i);
+    }
+
+    if (std::this_thread::get_id() == calling_thread)
+      handle_done_spans();
+  });
+  handle_done_spans();
+
+  for (const ExportedFile& file : *files)
+  {
+    if (file.created && (file.failed || file.pieces_left != 0))
+      File::Delete(file.export_path);
+  }
+
+  return !cancelled.load(std::memory_order_relaxed);
+}
+
 bool ExportFile(const Volume& volume, const Partition& partition, const FileInfo* file_info,
                 const std::string& export_filename)
 {
   if (!file_info || file_info->IsDirectory())
     return false;
 
-  return ExportData(volume, partition, file_info->GetOffset(), file_info->GetSize(),
-                    export_filename);
+  std::vector<ExportedFile> files{ExportedFile{file_info->GetPath(), export_filename,
+                                               file_info->GetOffset(), file_info->GetSize()}};
+  ExportFiles(volume, partition, &files, {});
+  return !files[0].failed;
 }
 
 bool ExportFile(const Volume& volume, const Partition& partition, std::string_view path,
@@ -127,10 +346,13 @@ bool ExportFile(const Volume& volume, const Partition& partition, std::string_vi
   return ExportFile(volume, partition, file_system->FindFileInfo(path).get(), export_filename);
 }
 
-void ExportDirectory(const Volume& volume, const Partition& partition, const FileInfo& directory,
-                     bool recursive, const std::string& filesystem_path,
-                     const std::string& export_folder,
-                     const std::function<bool(const std::string& path)>& update_progress)
+// Creates the directories and lists the files that need to be exported, in FST order.
+// Returns false if cancelled.
+static bool CollectExportedFiles(const FileInfo& directory, bool recursive,
+                                 const std::string& filesystem_path,
+                                 const std::string& export_folder,
+                                 const std::function<bool(const std::string& path)>& update_progress,
+                                 std::vector<ExportedFile>* files)
 {
   File::CreateFullPath(export_folder + '/');
 
@@ -140,23 +362,48 @@ void ExportDirectory(const Volume& volume, const Partition& partition, const Fil
     const std::string path = filesystem_path + name;
     const std::string export_path = export_folder + '/' + name;
 
-    if (update_progress(path))
-      return;
-
     DEBUG_LOG(DISCIO, "%s", export_path.c_str());
 
     if (!file_info.IsDirectory())
     {
-      if (File::Exists(export_path))
-        NOTICE_LOG(DISCIO, "%s already exists", export_path.c_str());
-      else if (!ExportFile(volume, partition, &file_info, export_path))
-        ERROR_LOG(DISCIO, "Could not export %s", export_path.c_str());
+      if (!File::Exists(export_path))
+      {
+        files->push_back(
+            ExportedFile{path, export_path, file_info.GetOffset(), file_info.GetSize()});
+        continue;
+      }
+
+      NOTICE_LOG(DISCIO, "%s already exists", export_path.c_str());
+      if (update_progress(path))
+        return false;
     }
-    else if (recursive)
+    else
     {
-      ExportDirectory(volume, partition, file_info, recursive, path, export_path, update_progress);
+      if (update_progress(path))
+        return false;
+
+      if (recursive && !CollectExportedFiles(file_info, recursive, path, export_path,
+                                             update_progress, files))
+      {
+        return false;
+      }
     }
   }
+
+  return true;
+}
+
+void ExportDirectory(const Volume& volume, const Partition& partition, const FileInfo& directory,
+                     bool recursive, const std::string& filesystem_path,
+                     const std::string& export_folder,
+                     const std::function<bool(const std::string& path)>& update_progress)
+{
+  std::vector<ExportedFile> files;
+  if (CollectExportedFiles(directory, recursive, filesystem_path, export_folder, update_progress,
+                           &files))
+  {
+    ExportFiles(volume, partition, &files, update_progress);
+  }
 }
 
 bool ExportWiiUnencryptedHeader(const Volume& volume, const std::string& export_filename)
@@ -17,11 +17,6 @@
 #include <vector>
 #include "Common/CommonTypes.h"
 
-namespace File
-{
-class IOFile;
-}
-
 namespace DiscIO
 {
 class FileInfo;
@@ -35,7 +30,6 @@ public:
   ~DiscScrubber();
 
   bool SetupScrub(const Volume* disc, int block_size);
-  size_t GetNextBlock(File::IOFile& in, u8* buffer);
   bool CanBlockBeScrubbed(u64 offset) const;
 
 private:
@@ -72,7 +66,6 @@ private:
 
   std::vector<u8> m_free_table;
   u64 m_file_size = 0;
-  u64 m_block_count = 0;
   u32 m_block_size = 0;
   bool m_is_scrubbing = false;
 };
@@ -2,10 +2,20 @@
 // Licensed under GPLv2+
 // Refer to the license.txt file included.
 
+#include <algorithm>
+#include <cstring>
 #include <memory>
 #include <string>
 #include <utility>
 
+#ifdef _WIN32
+#include <io.h>
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
 #include "DiscIO/FileBlob.h"
 
 namespace DiscIO
@@ -15,6 +25,19 @@ PlainFileReader::PlainFileReader(File::IOFile file) : m_file(std::move(file))
   m_size = m_file.GetSize();
 }
 
+PlainFileReader::~PlainFileReader()
+{
+  if (!m_mapped_data)
+    return;
+
+#ifdef _WIN32
+  UnmapViewOfFile(m_mapped_data);
+  CloseHandle(m_mapping_handle);
+#else
+  munmap(const_cast<u8*>(m_mapped_data), static_cast<size_t>(m_size));
+#endif
+}
+
 std::unique_ptr<PlainFileReader> PlainFileReader::Create(File::IOFile file)
 {
   if (file)
@@ -25,15 +48,67 @@ std::unique_ptr<PlainFileReader> PlainFileReader::Create(File::IOFile file)
 
 bool PlainFileReader::Read(u64 offset, u64 nbytes, u8* out_ptr)
 {
-  if (m_file.Seek(offset, SEEK_SET) && m_file.ReadBytes(out_ptr, nbytes))
+  if (m_mapped_data)
   {
+    if (offset > static_cast<u64>(m_size) || nbytes > m_size - offset)
+      return false;
+
+    std::memcpy(out_ptr, m_mapped_data + offset, static_cast<size_t>(nbytes));
     return true;
   }
-  else
+
+  return m_reader.Read(offset, nbytes, out_ptr);
+}
+
+bool PlainFileReader::MapIntoMemory()
+{
+  if (m_mapped_data)
+    return true;
+
+  // Disc images don't fit well into the address space of 32-bit processes
+  if (sizeof(void*) < 8 || m_size <= 0)
+    return false;
+
+#ifdef _WIN32
+  const HANDLE file = reinterpret_cast<HANDLE>(_get_osfhandle(_fileno(m_file.GetHandle())));
+  const HANDLE mapping = CreateFileMapping(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  if (!mapping)
+    return false;
+
+  void* data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+  if (!data)
   {
-    m_file.Clear();
+    CloseHandle(mapping);
     return false;
   }
+  m_mapping_handle = mapping;
+#else
+  void* data = mmap(nullptr, static_cast<size_t>(m_size), PROT_READ, MAP_SHARED,
+                    fileno(m_file.GetHandle()), 0);
+  if (data == MAP_FAILED)
+    return false;
+#endif
+
+  m_mapped_data = static_cast<const u8*>(data);
+  return true;
+}
+
+bool PlainFileReader::HintWillNeed(u64 offset, u64 size)
+{
+#ifdef _WIN32
+  return false;
+#else
+  if (!m_mapped_data || offset >= static_cast<u64>(m_size))
+    return false;
+
+  // madvise wants a page aligned address
+  const u64 page_size = static_cast<u64>(sysconf(_SC_PAGESIZE));
+  const u64 start = offset / page_size * page_size;
+  const u64 end = std::min<u64>(offset + size, m_size);
+  madvise(const_cast<u8*>(m_mapped_data) + start, static_cast<size_t>(end - start),
+          MADV_WILLNEED);
+  return true;
+#endif
 }
 
 }  // namespace DiscIO
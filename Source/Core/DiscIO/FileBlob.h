@@ -10,6 +10,7 @@
 
 #include "Common/CommonTypes.h"
 #include "Common/File.h"
+#include "DiscIO/BatchedFileReader.h"
 #include "DiscIO/Blob.h"
 
 namespace DiscIO
@@ -18,18 +19,29 @@ class PlainFileReader : public BlobReader
 {
 public:
   static std::unique_ptr<PlainFileReader> Create(File::IOFile file);
+  ~PlainFileReader();
 
   BlobType GetBlobType() const override { return BlobType::PLAIN; }
   u64 GetRawSize() const override { return m_size; }
   u64 GetDataSize() const override { return m_size; }
   bool IsDataSizeAccurate() const override { return true; }
   bool Read(u64 offset, u64 nbytes, u8* out_ptr) override;
+  void SetReadQueueDepth(u32 queue_depth) override { m_reader.SetQueueDepth(queue_depth); }
+  bool MapIntoMemory() override;
+  bool HintWillNeed(u64 offset, u64 size) override;
 
 private:
   PlainFileReader(File::IOFile file);
 
   File::IOFile m_file;
+  BatchedFileReader m_reader{m_file};
   s64 m_size;
+
+  // The whole file, if it has been mapped into memory
+  const u8* m_mapped_data = nullptr;
+#ifdef _WIN32
+  void* m_mapping_handle = nullptr;
+#endif
 };
 
 }  // namespace DiscIO
@@ -181,14 +181,16 @@ void NANDImporter::ProcessFile(const NANDFSTEntry& entry, const std::string& par
   std::array<u8, 16> key{};
   std::copy(&m_nand_keys[NAND_AES_KEY_OFFSET], &m_nand_keys[NAND_AES_KEY_OFFSET + key.size()],
             key.begin());
+  const auto aes_context = Common::AES::CreateContext(key.data(), Common::AES::Mode::Decrypt);
   u16 sub = Common::swap16(entry.sub);
   u32 remaining_bytes = Common::swap32(entry.size);
 
+  std::vector<u8> block(NAND_FAT_BLOCK_SIZE);
   while (remaining_bytes > 0)
   {
-    std::array<u8, 16> iv{};
-    std::vector<u8> block = Common::AES::Decrypt(
-        key.data(), iv.data(), &m_nand[NAND_FAT_BLOCK_SIZE * sub], NAND_FAT_BLOCK_SIZE);
+    const std::array<u8, 16> iv{};
+    aes_context->CryptIV(iv.data(), &m_nand[NAND_FAT_BLOCK_SIZE * sub], block.data(),
+                         NAND_FAT_BLOCK_SIZE);
     u32 size = remaining_bytes < NAND_FAT_BLOCK_SIZE ? remaining_bytes : NAND_FAT_BLOCK_SIZE;
     file.WriteBytes(block.data(), size);
     remaining_bytes -= size;
@@ -60,6 +60,24 @@ public:
   }
 
   virtual bool IsEncryptedAndHashed() const { return false; }
+  // Lets volumes which have to decrypt what they read keep up to <cache_size_mb> MiB of decrypted
+  // data in memory, and decrypt <read_ahead_clusters> clusters ahead of sequential reads on a
+  // separate thread. Does nothing for other volumes.
+  virtual void ConfigureDecryptionCache(u32 cache_size_mb, u32 read_ahead_clusters) {}
+  // Passes these settings on to the BlobReader of volumes which have one. See BlobReader.
+  virtual void ConfigureBlobReader(u32 cache_size_mb, u32 read_queue_depth) {}
+  // Maps the disc image into memory if its BlobReader supports that. See BlobReader.
+  virtual bool MapIntoMemory() { return false; }
+  // Lets the volume start bringing data which is going to be read soon into memory in the
+  // background. Returns false if that can't be done without actually reading the data.
+  virtual bool HintWillRead(u64 offset, u64 length, const Partition& partition) const
+  {
+    return false;
+  }
+  // Whether Read may be called from several threads at once. This is only guaranteed for
+  // partitions that have been read from before (for instance to load their file system),
+  // because partition details are loaded lazily.
+  virtual bool SupportsConcurrentReads() const { return false; }
   virtual std::vector<Partition> GetPartitions() const { return {}; }
   virtual Partition GetGamePartition() const { return PARTITION_NONE; }
   virtual std::optional<u32> GetPartitionType(const Partition& partition) const { return {}; }
@@ -52,6 +52,25 @@ bool VolumeGC::Read(u64 offset, u64 length, u8* buffer, const Partition& partiti
   return m_reader->Read(offset, length, buffer);
 }
 
+void VolumeGC::ConfigureBlobReader(u32 cache_size_mb, u32 read_queue_depth)
+{
+  m_reader->SetCacheSize(cache_size_mb);
+  m_reader->SetReadQueueDepth(read_queue_depth);
+}
+
+bool VolumeGC::MapIntoMemory()
+{
+  return m_reader->MapIntoMemory();
+}
+
+bool VolumeGC::HintWillRead(u64 offset, u64 length, const Partition& partition) const
+{
+  if (partition != PARTITION_NONE)
+    return false;
+
+  return m_reader->HintWillNeed(offset, length);
+}
+
 const FileSystem* VolumeGC::GetFileSystem(const Partition& partition) const
 {
   return m_file_system->get();
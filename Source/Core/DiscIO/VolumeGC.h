@@ -32,6 +32,9 @@ public:
   ~VolumeGC();
   bool Read(u64 offset, u64 length, u8* buffer,
             const Partition& partition = PARTITION_NONE) const override;
+  void ConfigureBlobReader(u32 cache_size_mb, u32 read_queue_depth) override;
+  bool MapIntoMemory() override;
+  bool HintWillRead(u64 offset, u64 length, const Partition& partition) const override;
   const FileSystem* GetFileSystem(const Partition& partition = PARTITION_NONE) const override;
   std::string GetGameID(const Partition& partition = PARTITION_NONE) const override;
   std::string GetGameTDBID(const Partition& partition = PARTITION_NONE) const override;
@@ -14,7 +14,6 @@
 #include <unordered_set>
 
 #include <mbedtls/md5.h>
-#include <mbedtls/sha1.h>
 #include <zlib.h>
 
 #include "Common/Align.h"
@@ -663,10 +662,7 @@ void VolumeVerifier::SetUpHashing()
   }
 
   if (m_hashes_to_calculate.sha1)
-  {
-    mbedtls_sha1_init(&m_sha1_context);
-    mbedtls_sha1_starts_ret(&m_sha1_context);
-  }
+    m_sha1_context = Common::SHA1::CreateContext();
 }
 
 void VolumeVerifier::WaitForAsyncOperations() const
@@ -762,7 +758,7 @@ void VolumeVerifier::Process()
       if (m_hashes_to_calculate.sha1)
       {
         m_sha1_future = std::async(std::launch::async, [this] {
-          mbedtls_sha1_update_ret(&m_sha1_context, m_data.data(), m_data.size());
+          m_sha1_context->Update(m_data.data(), m_data.size());
         });
       }
     }
@@ -878,8 +874,8 @@ void VolumeVerifier::Finish()
 
     if (m_hashes_to_calculate.sha1)
     {
-      m_result.hashes.sha1 = std::vector<u8>(20);
-      mbedtls_sha1_finish_ret(&m_sha1_context, m_result.hashes.sha1.data());
+      const Common::SHA1::Digest digest = m_sha1_context->Finish();
+      m_result.hashes.sha1 = std::vector<u8>(digest.begin(), digest.end());
     }
   }
 
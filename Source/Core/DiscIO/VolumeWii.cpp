@@ -6,12 +6,13 @@
 
 #include <algorithm>
 #include <array>
+#include <cinttypes>
 #include <cstddef>
 #include <cstring>
+#include <iterator>
 #include <map>
-#include <mbedtls/aes.h>
-#include <mbedtls/sha1.h>
 #include <memory>
+#include <mutex>
 #include <optional>
 #include <string>
 #include <utility>
@@ -19,6 +20,8 @@
 
 #include "Common/Assert.h"
 #include "Common/CommonTypes.h"
+#include "Common/Crypto/AES.h"
+#include "Common/Crypto/SHA1.h"
 #include "Common/Logging/Log.h"
 #include "Common/MsgHandler.h"
 #include "Common/Swap.h"
@@ -33,18 +36,21 @@
 
 namespace DiscIO
 {
+// Reads of at least this many whole clusters skip the cluster cache
+constexpr u64 BULK_READ_MIN_CLUSTERS = 16;
+constexpr u64 BULK_READ_MAX_CLUSTERS = 256;
+
 VolumeWii::VolumeWii(std::unique_ptr<BlobReader> reader)
-    : m_reader(std::move(reader)), m_game_partition(PARTITION_NONE),
-      m_last_decrypted_block(UINT64_MAX)
+    : m_reader(std::move(reader)), m_game_partition(PARTITION_NONE)
 {
   ASSERT(m_reader);
 
-  m_encrypted = m_reader->ReadSwapped<u32>(0x60) == u32(0);
+  m_encrypted = ReadRawSwapped<u32>(0x60) == u32(0);
 
   for (u32 partition_group = 0; partition_group < 4; ++partition_group)
   {
     const std::optional<u32> number_of_partitions =
-        m_reader->ReadSwapped<u32>(0x40000 + (partition_group * 8));
+        ReadRawSwapped<u32>(0x40000 + (partition_group * 8));
     if (!number_of_partitions)
       continue;
 
@@ -63,7 +69,7 @@ VolumeWii::VolumeWii(std::unique_ptr<BlobReader> reader)
       const Partition partition(*partition_offset);
 
       const std::optional<u32> partition_type =
-          m_reader->ReadSwapped<u32>(*partition_table_offset + (i * 8) + 4);
+          ReadRawSwapped<u32>(*partition_table_offset + (i * 8) + 4);
       if (!partition_type)
         continue;
 
@@ -73,13 +79,13 @@ VolumeWii::VolumeWii(std::unique_ptr<BlobReader> reader)
 
       auto get_ticket = [this, partition]() -> IOS::ES::TicketReader {
         std::vector<u8> ticket_buffer(sizeof(IOS::ES::Ticket));
-        if (!m_reader->Read(partition.offset, ticket_buffer.size(), ticket_buffer.data()))
+        if (!ReadRaw(partition.offset, ticket_buffer.size(), ticket_buffer.data()))
           return INVALID_TICKET;
         return IOS::ES::TicketReader{std::move(ticket_buffer)};
       };
 
       auto get_tmd = [this, partition]() -> IOS::ES::TMDReader {
-        const std::optional<u32> tmd_size = m_reader->ReadSwapped<u32>(partition.offset + 0x2a4);
+        const std::optional<u32> tmd_size = ReadRawSwapped<u32>(partition.offset + 0x2a4);
         const std::optional<u64> tmd_address =
             ReadSwappedAndShifted(partition.offset + 0x2a8, PARTITION_NONE);
         if (!tmd_size || !tmd_address)
@@ -92,19 +98,19 @@ VolumeWii::VolumeWii(std::unique_ptr<BlobReader> reader)
           return INVALID_TMD;
         }
         std::vector<u8> tmd_buffer(*tmd_size);
-        if (!m_reader->Read(partition.offset + *tmd_address, *tmd_size, tmd_buffer.data()))
+        if (!ReadRaw(partition.offset + *tmd_address, *tmd_size, tmd_buffer.data()))
           return INVALID_TMD;
         return IOS::ES::TMDReader{std::move(tmd_buffer)};
       };
 
       auto get_cert_chain = [this, partition]() -> std::vector<u8> {
-        const std::optional<u32> size = m_reader->ReadSwapped<u32>(partition.offset + 0x2ac);
+        const std::optional<u32> size = ReadRawSwapped<u32>(partition.offset + 0x2ac);
         const std::optional<u64> address =
             ReadSwappedAndShifted(partition.offset + 0x2b0, PARTITION_NONE);
         if (!size || !address)
           return {};
         std::vector<u8> cert_chain(*size);
-        if (!m_reader->Read(partition.offset + *address, *size, cert_chain.data()))
+        if (!ReadRaw(partition.offset + *address, *size, cert_chain.data()))
           return {};
         return cert_chain;
       };
@@ -117,19 +123,17 @@ VolumeWii::VolumeWii(std::unique_ptr<BlobReader> reader)
         if (!h3_table_offset)
           return {};
         std::vector<u8> h3_table(H3_TABLE_SIZE);
-        if (!m_reader->Read(partition.offset + *h3_table_offset, H3_TABLE_SIZE, h3_table.data()))
+        if (!ReadRaw(partition.offset + *h3_table_offset, H3_TABLE_SIZE, h3_table.data()))
           return {};
         return h3_table;
       };
 
-      auto get_key = [this, partition]() -> std::unique_ptr<mbedtls_aes_context> {
+      auto get_key = [this, partition]() -> std::unique_ptr<Common::AES::Context> {
         const IOS::ES::TicketReader& ticket = *m_partitions[partition].ticket;
         if (!ticket.IsValid())
           return nullptr;
         const std::array<u8, 16> key = ticket.GetTitleKey();
-        std::unique_ptr<mbedtls_aes_context> aes_context = std::make_unique<mbedtls_aes_context>();
-        mbedtls_aes_setkey_dec(aes_context.get(), key.data(), 128);
-        return aes_context;
+        return Common::AES::CreateContext(key.data(), Common::AES::Mode::Decrypt);
       };
 
       auto get_file_system = [this, partition]() -> std::unique_ptr<FileSystem> {
@@ -142,7 +146,7 @@ VolumeWii::VolumeWii(std::unique_ptr<BlobReader> reader)
       };
 
       m_partitions.emplace(
-          partition, PartitionDetails{Common::Lazy<std::unique_ptr<mbedtls_aes_context>>(get_key),
+          partition, PartitionDetails{Common::Lazy<std::unique_ptr<Common::AES::Context>>(get_key),
                                       Common::Lazy<IOS::ES::TicketReader>(get_ticket),
                                       Common::Lazy<IOS::ES::TMDReader>(get_tmd),
                                       Common::Lazy<std::vector<u8>>(get_cert_chain),
@@ -155,12 +159,204 @@ VolumeWii::VolumeWii(std::unique_ptr<BlobReader> reader)
 
 VolumeWii::~VolumeWii()
 {
+  // Pending read-ahead requests are dropped, and the thread is stopped when it gets destroyed.
+  m_shutting_down.Set();
+
+  const ClusterCacheStats stats = GetClusterCacheStats();
+  if (stats.hits + stats.misses != 0)
+  {
+    INFO_LOG(DISCIO,
+             "Cluster cache: %" PRIu64 " hits, %" PRIu64 " misses, %" PRIu64
+             " clusters read ahead (%" PRIu64 " used)",
+             stats.hits, stats.misses, stats.read_ahead, stats.read_ahead_hits);
+  }
+}
+
+void VolumeWii::ConfigureDecryptionCache(u32 cache_size_mb, u32 read_ahead_clusters)
+{
+  std::lock_guard lk(m_cache_lock);
+  // Always keep the cluster that is being read from, and room for what is read ahead of it.
+  const size_t cache_size_clusters = u64(cache_size_mb) * 1024 * 1024 / BLOCK_DATA_SIZE;
+  m_max_cached_clusters = std::max<size_t>(cache_size_clusters, read_ahead_clusters + 1);
+  m_read_ahead_clusters = read_ahead_clusters;
+  while (m_cache.size() > m_max_cached_clusters)
+  {
+    m_cache_index.erase(m_cache.back().offset);
+    m_cache.pop_back();
+  }
+}
+
+void VolumeWii::ConfigureBlobReader(u32 cache_size_mb, u32 read_queue_depth)
+{
+  std::lock_guard lk(m_reader_lock);
+  m_reader->SetCacheSize(cache_size_mb);
+  m_reader->SetReadQueueDepth(read_queue_depth);
+}
+
+bool VolumeWii::MapIntoMemory()
+{
+  std::lock_guard lk(m_reader_lock);
+  return m_reader->MapIntoMemory();
+}
+
+VolumeWii::ClusterCacheStats VolumeWii::GetClusterCacheStats() const
+{
+  std::lock_guard lk(m_cache_lock);
+  return m_cache_stats;
+}
+
+bool VolumeWii::ReadRaw(u64 offset, u64 length, u8* buffer) const
+{
+  std::lock_guard lk(m_reader_lock);
+  return m_reader->Read(offset, length, buffer);
+}
+
+template <typename T>
+std::optional<T> VolumeWii::ReadRawSwapped(u64 offset) const
+{
+  std::lock_guard lk(m_reader_lock);
+  return m_reader->ReadSwapped<T>(offset);
+}
+
+bool VolumeWii::ReadAndDecryptCluster(u64 offset, const Common::AES::Context* key,
+                                      u8* buffer) const
+{
+  if (!ReadRaw(offset, BLOCK_TOTAL_SIZE, buffer))
+    return false;
+
+  // The IV is at 0x3D0 - 0x3DF and gets overwritten, but nothing else
+  // is used from the 0x000 - 0x3FF part of the cluster. It contains the
+  // SHA-1 hashes that IOS uses to check that discs aren't tampered with.
+  // http://wiibrew.org/wiki/Wii_Disc#Encrypted
+  key->Crypt(&buffer[0x3D0], &buffer[BLOCK_HEADER_SIZE], &buffer[BLOCK_HEADER_SIZE],
+             BLOCK_DATA_SIZE);
+  return true;
+}
+
+bool VolumeWii::CopyFromCache(u64 offset, const Common::AES::Context* key, u64 offset_in_cluster,
+                              u64 size, u8* out) const
+{
+  std::unique_lock lk(m_cache_lock);
+
+  // If the read-ahead thread is already working on this cluster, waiting for it is faster than
+  // doing the work a second time.
+  m_read_ahead_done.wait(lk, [&] { return m_pending_read_ahead.count(offset) == 0; });
+
+  const auto it = m_cache_index.find(offset);
+  if (it == m_cache_index.end() || it->second->key != key)
+  {
+    ++m_cache_stats.misses;
+    return false;
+  }
+
+  CachedCluster& cluster = *it->second;
+  ++m_cache_stats.hits;
+  if (cluster.read_ahead)
+  {
+    ++m_cache_stats.read_ahead_hits;
+    cluster.read_ahead = false;
+  }
+  std::memcpy(out, cluster.data.data() + offset_in_cluster, static_cast<size_t>(size));
+  m_cache.splice(m_cache.begin(), m_cache, it->second);
+  return true;
+}
+
+void VolumeWii::InsertIntoCache(u64 offset, const Common::AES::Context* key, const u8* data,
+                                bool read_ahead) const
+{
+  std::lock_guard lk(m_cache_lock);
+
+  auto it = m_cache_index.find(offset);
+  if (it == m_cache_index.end())
+  {
+    if (m_cache.size() < m_max_cached_clusters)
+    {
+      m_cache.emplace_front(
+          CachedCluster{offset, key, read_ahead, std::vector<u8>(BLOCK_DATA_SIZE)});
+    }
+    else
+    {
+      // Reuse the buffer of the least recently used cluster.
+      m_cache_index.erase(m_cache.back().offset);
+      m_cache.splice(m_cache.begin(), m_cache, std::prev(m_cache.end()));
+    }
+    it = m_cache_index.emplace(offset, m_cache.begin()).first;
+  }
+  else
+  {
+    m_cache.splice(m_cache.begin(), m_cache, it->second);
+  }
+
+  CachedCluster& cluster = m_cache.front();
+  cluster.offset = offset;
+  cluster.key = key;
+  cluster.read_ahead = read_ahead;
+  std::memcpy(cluster.data.data(), data, BLOCK_DATA_SIZE);
+}
+
+void VolumeWii::UpdateReadAhead(u64 offset, const Common::AES::Context* key) const
+{
+  // Needs this many consecutive clusters to be read before treating the reads as a stream.
+  constexpr u32 SEQUENTIAL_THRESHOLD = 2;
+
+  std::lock_guard lk(m_cache_lock);
+  if (m_read_ahead_clusters == 0 || offset == m_last_read_cluster)
+    return;
+
+  if (offset == m_last_read_cluster + BLOCK_TOTAL_SIZE)
+    ++m_sequential_reads;
+  else
+    m_sequential_reads = 0;
+  m_last_read_cluster = offset;
+
+  if (m_sequential_reads < SEQUENTIAL_THRESHOLD)
+    return;
+
+  if (!m_read_ahead_thread_running)
+  {
+    m_read_ahead_buffer.resize(BLOCK_TOTAL_SIZE);
+    m_read_ahead_thread.Reset([this](ReadAheadRequest request) { ReadAhead(request); });
+    m_read_ahead_thread_running = true;
+  }
+
+  const u64 disc_size = m_reader->GetDataSize();
+  for (u32 i = 1; i <= m_read_ahead_clusters; ++i)
+  {
+    const u64 next_offset = offset + i * BLOCK_TOTAL_SIZE;
+    if (next_offset + BLOCK_TOTAL_SIZE > disc_size)
+      break;
+
+    const auto it = m_cache_index.find(next_offset);
+    if ((it != m_cache_index.end() && it->second->key == key) ||
+        !m_pending_read_ahead.insert(next_offset).second)
+    {
+      continue;
+    }
+    m_read_ahead_thread.EmplaceItem(ReadAheadRequest{next_offset, key});
+  }
+}
+
+void VolumeWii::ReadAhead(ReadAheadRequest request) const
+{
+  if (!m_shutting_down.IsSet() &&
+      ReadAndDecryptCluster(request.offset, request.key, m_read_ahead_buffer.data()))
+  {
+    InsertIntoCache(request.offset, request.key, &m_read_ahead_buffer[BLOCK_HEADER_SIZE], true);
+    std::lock_guard lk(m_cache_lock);
+    ++m_cache_stats.read_ahead;
+  }
+
+  {
+    std::lock_guard lk(m_cache_lock);
+    m_pending_read_ahead.erase(request.offset);
+  }
+  m_read_ahead_done.notify_all();
 }
 
 bool VolumeWii::Read(u64 offset, u64 length, u8* buffer, const Partition& partition) const
 {
   if (partition == PARTITION_NONE)
-    return m_reader->Read(offset, length, buffer);
+    return ReadRaw(offset, length, buffer);
 
   auto it = m_partitions.find(partition);
   if (it == m_partitions.end())
@@ -168,50 +364,61 @@ bool VolumeWii::Read(u64 offset, u64 length, u8* buffer, const Partition& partit
   const PartitionDetails& partition_details = it->second;
 
   if (!m_encrypted)
-  {
-    return m_reader->Read(partition.offset + *partition_details.data_offset + offset, length,
-                          buffer);
-  }
+    return ReadRaw(partition.offset + *partition_details.data_offset + offset, length, buffer);
 
   if (m_reader->SupportsReadWiiDecrypted())
+  {
+    std::lock_guard lk(m_reader_lock);
     return m_reader->ReadWiiDecrypted(offset, length, buffer, partition.offset);
+  }
 
-  mbedtls_aes_context* aes_context = partition_details.key->get();
+  const Common::AES::Context* aes_context = partition_details.key->get();
   if (!aes_context)
     return false;
 
-  std::vector<u8> read_buffer(BLOCK_TOTAL_SIZE);
+  std::vector<u8> read_buffer;
   while (length > 0)
   {
     // Calculate offsets
     u64 block_offset_on_disc = partition.offset + *partition_details.data_offset +
                                offset / BLOCK_DATA_SIZE * BLOCK_TOTAL_SIZE;
     u64 data_offset_in_block = offset % BLOCK_DATA_SIZE;
+    u64 copy_size = std::min(length, BLOCK_DATA_SIZE - data_offset_in_block);
 
-    if (m_last_decrypted_block != block_offset_on_disc)
+    // Large reads bypass the cache and fetch many clusters with one raw read. The reader is then
+    // only locked for the raw read, so threads which read different parts of a partition at the
+    // same time also decrypt them in parallel.
+    if (data_offset_in_block == 0 && length >= BULK_READ_MIN_CLUSTERS * BLOCK_DATA_SIZE)
     {
-      // Read the current block
-      if (!m_reader->Read(block_offset_on_disc, BLOCK_TOTAL_SIZE, read_buffer.data()))
+      const u64 clusters = std::min<u64>(length / BLOCK_DATA_SIZE, BULK_READ_MAX_CLUSTERS);
+      read_buffer.resize(clusters * BLOCK_TOTAL_SIZE);
+      if (!ReadRaw(block_offset_on_disc, read_buffer.size(), read_buffer.data()))
         return false;
 
-      // Decrypt the block's data.
-      // 0x3D0 - 0x3DF in read_buffer will be overwritten,
-      // but that won't affect anything, because we won't
-      // use the content of read_buffer anymore after this
-      mbedtls_aes_crypt_cbc(aes_context, MBEDTLS_AES_DECRYPT, BLOCK_DATA_SIZE, &read_buffer[0x3D0],
-                            &read_buffer[BLOCK_HEADER_SIZE], m_last_decrypted_block_data);
-      m_last_decrypted_block = block_offset_on_disc;
-
-      // The only thing we currently use from the 0x000 - 0x3FF part
-      // of the block is the IV (at 0x3D0), but it also contains SHA-1
-      // hashes that IOS uses to check that discs aren't tampered with.
-      // http://wiibrew.org/wiki/Wii_Disc#Encrypted
+      for (u64 i = 0; i < clusters; ++i)
+      {
+        u8* cluster = &read_buffer[i * BLOCK_TOTAL_SIZE];
+        aes_context->Crypt(&cluster[0x3D0], &cluster[BLOCK_HEADER_SIZE],
+                           buffer + i * BLOCK_DATA_SIZE, BLOCK_DATA_SIZE);
+      }
+
+      length -= clusters * BLOCK_DATA_SIZE;
+      buffer += clusters * BLOCK_DATA_SIZE;
+      offset += clusters * BLOCK_DATA_SIZE;
+      continue;
     }
 
-    // Copy the decrypted data
-    u64 copy_size = std::min(length, BLOCK_DATA_SIZE - data_offset_in_block);
-    memcpy(buffer, &m_last_decrypted_block_data[data_offset_in_block],
-           static_cast<size_t>(copy_size));
+    if (!CopyFromCache(block_offset_on_disc, aes_context, data_offset_in_block, copy_size, buffer))
+    {
+      read_buffer.resize(BLOCK_TOTAL_SIZE);
+      if (!ReadAndDecryptCluster(block_offset_on_disc, aes_context, read_buffer.data()))
+        return false;
+
+      const u8* decrypted_data = &read_buffer[BLOCK_HEADER_SIZE];
+      std::memcpy(buffer, decrypted_data + data_offset_in_block, static_cast<size_t>(copy_size));
+      InsertIntoCache(block_offset_on_disc, aes_context, decrypted_data, false);
+    }
+    UpdateReadAhead(block_offset_on_disc, aes_context);
 
     // Update offsets
     length -= copy_size;
@@ -318,7 +525,7 @@ std::string VolumeWii::GetGameTDBID(const Partition& partition) const
 
 Region VolumeWii::GetRegion() const
 {
-  const std::optional<u32> region_code = m_reader->ReadSwapped<u32>(0x4E000);
+  const std::optional<u32> region_code = ReadRawSwapped<u32>(0x4E000);
   if (!region_code)
     return Region::Unknown;
   const Region region = static_cast<Region>(*region_code);
@@ -442,9 +649,7 @@ bool VolumeWii::CheckH3TableIntegrity(const Partition& partition) const
   if (contents.size() != 1)
     return false;
 
-  std::array<u8, 20> h3_table_sha1;
-  mbedtls_sha1_ret(h3_table.data(), h3_table.size(), h3_table_sha1.data());
-  return h3_table_sha1 == contents[0].sha1;
+  return Common::SHA1::CalculateDigest(h3_table.data(), h3_table.size()) == contents[0].sha1;
 }
 
 bool VolumeWii::CheckBlockIntegrity(u64 block_index, const std::vector<u8>& encrypted_data,
@@ -462,41 +667,39 @@ bool VolumeWii::CheckBlockIntegrity(u64 block_index, const std::vector<u8>& encr
   if (block_index / 64 * SHA1_SIZE >= partition_details.h3_table->size())
     return false;
 
-  mbedtls_aes_context* aes_context = partition_details.key->get();
+  const Common::AES::Context* aes_context = partition_details.key->get();
   if (!aes_context)
     return false;
 
   u8 cluster_metadata[BLOCK_HEADER_SIZE];
-  u8 iv[16] = {0};
-  mbedtls_aes_crypt_cbc(aes_context, MBEDTLS_AES_DECRYPT, BLOCK_HEADER_SIZE, iv,
-                        encrypted_data.data(), cluster_metadata);
+  const u8 zero_iv[16] = {};
+  aes_context->CryptIV(zero_iv, encrypted_data.data(), cluster_metadata, BLOCK_HEADER_SIZE);
 
   u8 cluster_data[BLOCK_DATA_SIZE];
-  std::memcpy(iv, encrypted_data.data() + 0x3D0, 16);
-  mbedtls_aes_crypt_cbc(aes_context, MBEDTLS_AES_DECRYPT, BLOCK_DATA_SIZE, iv,
-                        encrypted_data.data() + BLOCK_HEADER_SIZE, cluster_data);
+  aes_context->CryptIV(encrypted_data.data() + 0x3D0, encrypted_data.data() + BLOCK_HEADER_SIZE,
+                       cluster_data, BLOCK_DATA_SIZE);
 
-  for (u32 hash_index = 0; hash_index < 31; ++hash_index)
-  {
-    u8 h0_hash[SHA1_SIZE];
-    mbedtls_sha1_ret(cluster_data + hash_index * 0x400, 0x400, h0_hash);
-    if (memcmp(h0_hash, cluster_metadata + hash_index * SHA1_SIZE, SHA1_SIZE))
-      return false;
-  }
+  // The 31 H0 hashes are independent of each other, so they are computed together.
+  u8 h0_hashes[SHA1_SIZE * 31];
+  Common::SHA1::CalculateDigests(cluster_data, 0x400, 31, h0_hashes);
+  if (memcmp(h0_hashes, cluster_metadata, sizeof(h0_hashes)))
+    return false;
 
-  u8 h1_hash[SHA1_SIZE];
-  mbedtls_sha1_ret(cluster_metadata, SHA1_SIZE * 31, h1_hash);
-  if (memcmp(h1_hash, cluster_metadata + 0x280 + (block_index % 8) * SHA1_SIZE, SHA1_SIZE))
+  const Common::SHA1::Digest h1_hash =
+      Common::SHA1::CalculateDigest(cluster_metadata, SHA1_SIZE * 31);
+  if (memcmp(h1_hash.data(), cluster_metadata + 0x280 + (block_index % 8) * SHA1_SIZE, SHA1_SIZE))
     return false;
 
-  u8 h2_hash[SHA1_SIZE];
-  mbedtls_sha1_ret(cluster_metadata + 0x280, SHA1_SIZE * 8, h2_hash);
-  if (memcmp(h2_hash, cluster_metadata + 0x340 + (block_index / 8 % 8) * SHA1_SIZE, SHA1_SIZE))
+  const Common::SHA1::Digest h2_hash =
+      Common::SHA1::CalculateDigest(cluster_metadata + 0x280, SHA1_SIZE * 8);
+  if (memcmp(h2_hash.data(), cluster_metadata + 0x340 + (block_index / 8 % 8) * SHA1_SIZE,
+             SHA1_SIZE))
     return false;
 
-  u8 h3_hash[SHA1_SIZE];
-  mbedtls_sha1_ret(cluster_metadata + 0x340, SHA1_SIZE * 8, h3_hash);
-  if (memcmp(h3_hash, partition_details.h3_table->data() + block_index / 64 * SHA1_SIZE, SHA1_SIZE))
+  const Common::SHA1::Digest h3_hash =
+      Common::SHA1::CalculateDigest(cluster_metadata + 0x340, SHA1_SIZE * 8);
+  if (memcmp(h3_hash.data(), partition_details.h3_table->data() + block_index / 64 * SHA1_SIZE,
+             SHA1_SIZE))
     return false;
 
   return true;
@@ -512,7 +715,7 @@ bool VolumeWii::CheckBlockIntegrity(u64 block_index, const Partition& partition)
       partition.offset + *partition_details.data_offset + block_index * BLOCK_TOTAL_SIZE;
 
   std::vector<u8> cluster(BLOCK_TOTAL_SIZE);
-  if (!m_reader->Read(cluster_offset, cluster.size(), cluster.data()))
+  if (!ReadRaw(cluster_offset, cluster.size(), cluster.data()))
     return false;
   return CheckBlockIntegrity(block_index, cluster, partition);
 }
@@ -4,15 +4,22 @@
 
 #pragma once
 
+#include <condition_variable>
+#include <list>
 #include <map>
-#include <mbedtls/aes.h>
 #include <memory>
+#include <mutex>
 #include <optional>
 #include <string>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 #include "Common/CommonTypes.h"
+#include "Common/Crypto/AES.h"
+#include "Common/Flag.h"
 #include "Common/Lazy.h"
+#include "Common/WorkQueueThread.h"
 #include "Core/IOS/ES/Formats.h"
 #include "DiscIO/Filesystem.h"
 #include "DiscIO/Volume.h"
@@ -30,10 +37,24 @@ enum class Platform;
 class VolumeWii : public VolumeDisc
 {
 public:
+  struct ClusterCacheStats
+  {
+    u64 hits = 0;
+    u64 misses = 0;
+    // Clusters which were decrypted ahead of time, and how many of those were read later
+    u64 read_ahead = 0;
+    u64 read_ahead_hits = 0;
+  };
+
   VolumeWii(std::unique_ptr<BlobReader> reader);
   ~VolumeWii();
   bool Read(u64 offset, u64 length, u8* buffer, const Partition& partition) const override;
   bool IsEncryptedAndHashed() const override;
+  void ConfigureDecryptionCache(u32 cache_size_mb, u32 read_ahead_clusters) override;
+  void ConfigureBlobReader(u32 cache_size_mb, u32 read_queue_depth) override;
+  bool MapIntoMemory() override;
+  bool SupportsConcurrentReads() const override { return true; }
+  ClusterCacheStats GetClusterCacheStats() const;
   std::vector<Partition> GetPartitions() const override;
   Partition GetGamePartition() const override;
   std::optional<u32> GetPartitionType(const Partition& partition) const override;
@@ -75,13 +96,17 @@ public:
   static constexpr unsigned int BLOCK_DATA_SIZE = 0x7C00;
   static constexpr unsigned int BLOCK_TOTAL_SIZE = BLOCK_HEADER_SIZE + BLOCK_DATA_SIZE;
 
+  // Used until ConfigureDecryptionCache is called. No reads are done ahead by default, since most
+  // volumes only get opened to read a few things from them.
+  static constexpr u32 DEFAULT_CACHED_CLUSTERS = 16;
+
 protected:
   u32 GetOffsetShift() const override { return 2; }
 
 private:
   struct PartitionDetails
   {
-    Common::Lazy<std::unique_ptr<mbedtls_aes_context>> key;
+    Common::Lazy<std::unique_ptr<Common::AES::Context>> key;
     Common::Lazy<IOS::ES::TicketReader> ticket;
     Common::Lazy<IOS::ES::TMDReader> tmd;
     Common::Lazy<std::vector<u8>> cert_chain;
@@ -91,13 +116,61 @@ private:
     u32 type;
   };
 
+  struct CachedCluster
+  {
+    u64 offset;
+    // Clusters are only valid for the partition they were decrypted for
+    const Common::AES::Context* key;
+    bool read_ahead;
+    std::vector<u8> data;
+  };
+
+  struct ReadAheadRequest
+  {
+    u64 offset;
+    const Common::AES::Context* key;
+  };
+
+  // The reader is shared with the read-ahead thread, so all reads go through these.
+  bool ReadRaw(u64 offset, u64 length, u8* buffer) const;
+  template <typename T>
+  std::optional<T> ReadRawSwapped(u64 offset) const;
+
+  // Reads the cluster at <offset> (relative to the start of the disc) and decrypts its data in
+  // place, at BLOCK_HEADER_SIZE in <buffer>.
+  bool ReadAndDecryptCluster(u64 offset, const Common::AES::Context* key, u8* buffer) const;
+  bool CopyFromCache(u64 offset, const Common::AES::Context* key, u64 offset_in_cluster,
+                     u64 size, u8* out) const;
+  void InsertIntoCache(u64 offset, const Common::AES::Context* key, const u8* data,
+                       bool read_ahead) const;
+  void UpdateReadAhead(u64 offset, const Common::AES::Context* key) const;
+  void ReadAhead(ReadAheadRequest request) const;
+
   std::unique_ptr<BlobReader> m_reader;
   std::map<Partition, PartitionDetails> m_partitions;
   Partition m_game_partition;
   bool m_encrypted;
 
-  mutable u64 m_last_decrypted_block;
-  mutable u8 m_last_decrypted_block_data[BLOCK_DATA_SIZE];
+  mutable std::mutex m_reader_lock;
+
+  mutable std::mutex m_cache_lock;
+  mutable std::condition_variable m_read_ahead_done;
+  // Most recently used first
+  mutable std::list<CachedCluster> m_cache;
+  mutable std::unordered_map<u64, std::list<CachedCluster>::iterator> m_cache_index;
+  mutable std::unordered_set<u64> m_pending_read_ahead;
+  mutable ClusterCacheStats m_cache_stats;
+  mutable u64 m_last_read_cluster = UINT64_MAX;
+  mutable u32 m_sequential_reads = 0;
+  size_t m_max_cached_clusters = DEFAULT_CACHED_CLUSTERS;
+  u32 m_read_ahead_clusters = 0;
+  mutable bool m_read_ahead_thread_running = false;
+
+  // Only used on the read-ahead thread
+  mutable std::vector<u8> m_read_ahead_buffer;
+  Common::Flag m_shutting_down;
+  // Declared last so that it is stopped before anything it uses is destroyed
+  mutable Common::WorkQueueThread<ReadAheadRequest> m_read_ahead_thread;
 };
 
 }  // namespace DiscIO
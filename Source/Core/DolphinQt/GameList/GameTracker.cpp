@@ -136,6 +136,8 @@ void GameTracker::StartInternal()
   if (cache_updated)
     m_cache.Save();
 
+  DiscIO::DeleteUnusedFSTCaches();
+
   QueueOnObject(this, [] { Settings::Instance().NotifyMetadataRefreshComplete(); });
 }
 
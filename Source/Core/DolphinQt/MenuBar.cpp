@@ -757,6 +757,14 @@ void MenuBar::AddMovieMenu()
   dump_audio->setChecked(SConfig::GetInstance().m_DumpAudio);
   connect(dump_audio, &QAction::toggled,
           [](bool value) { SConfig::GetInstance().m_DumpAudio = value; });
+
+#if defined(HAVE_FFMPEG)
+  auto* dump_audio_flac = movie_menu->addAction(tr("Compress Audio Dumps (FLAC)"));
+  dump_audio_flac->setCheckable(true);
+  dump_audio_flac->setChecked(SConfig::GetInstance().m_DumpAudioFLAC);
+  connect(dump_audio_flac, &QAction::toggled,
+          [](bool value) { SConfig::GetInstance().m_DumpAudioFLAC = value; });
+#endif
 }
 
 void MenuBar::AddJITMenu()
@@ -96,6 +96,12 @@ GameFile::GameFile() = default;
 
 GameFile::GameFile(std::string path) : m_file_path(std::move(path))
 {
+  {
+    const File::FileInfo info(m_file_path);
+    m_host_file_size = info.GetSize();
+    m_host_file_mtime = info.GetModificationTime();
+  }
+
   {
     std::string name, extension;
     SplitPath(m_file_path, nullptr, &name, &extension);
@@ -155,6 +161,12 @@ bool GameFile::IsValid() const
   return true;
 }
 
+bool GameFile::HostFileChanged() const
+{
+  const File::FileInfo info(m_file_path);
+  return info.GetSize() != m_host_file_size || info.GetModificationTime() != m_host_file_mtime;
+}
+
 bool GameFile::CustomCoverChanged()
 {
   if (!m_custom_cover.buffer.empty() || !Config::Get(Config::MAIN_USE_GAME_COVERS))
@@ -298,6 +310,9 @@ void GameFile::DoState(PointerWrap& p)
   p.Do(m_file_size);
   p.Do(m_volume_size);
 
+  p.Do(m_host_file_size);
+  p.Do(m_host_file_mtime);
+
   p.Do(m_short_names);
   p.Do(m_long_names);
   p.Do(m_short_makers);
@@ -82,6 +82,9 @@ public:
   const std::string& GetApploaderDate() const { return m_apploader_date; }
   u64 GetFileSize() const { return m_file_size; }
   u64 GetVolumeSize() const { return m_volume_size; }
+  // Returns true if the file on disk doesn't have the size and modification time that it had
+  // when this GameFile was created, which means that the metadata might be out of date.
+  bool HostFileChanged() const;
   const GameBanner& GetBannerImage() const;
   const GameCover& GetCoverImage() const;
   void DoState(PointerWrap& p);
@@ -115,6 +118,9 @@ private:
   u64 m_file_size{};
   u64 m_volume_size{};
 
+  u64 m_host_file_size{};
+  s64 m_host_file_mtime{};
+
   std::map<DiscIO::Language, std::string> m_short_names;
   std::map<DiscIO::Language, std::string> m_long_names;
   std::map<DiscIO::Language, std::string> m_short_makers;
@@ -6,11 +6,14 @@
 
 #include <algorithm>
 #include <cstddef>
+#include <cstring>
 #include <functional>
 #include <list>
 #include <memory>
 #include <mutex>
 #include <string>
+#include <thread>
+#include <unordered_map>
 #include <unordered_set>
 #include <utility>
 #include <vector>
@@ -20,6 +23,7 @@
 #include "Common/File.h"
 #include "Common/FileSearch.h"
 #include "Common/FileUtil.h"
+#include "Common/WorkerPool.h"
 
 #include "DiscIO/DirectoryBlob.h"
 
@@ -27,7 +31,43 @@
 
 namespace UICommon
 {
-static constexpr u32 CACHE_REVISION = 15;  // Last changed in PR 7816
+static constexpr u32 CACHE_REVISION = 16;  // Last changed to store host file modification times
+
+// "DGLC"
+static constexpr u32 CACHE_MAGIC = 0x434C4744;
+
+// Compacting the cache file isn't worth it until it contains at least this many stale records
+static constexpr size_t MIN_RECORDS_TO_COMPACT = 256;
+
+// The number of files each scanning thread gets per batch in GameFileCache::Update
+static constexpr size_t SCAN_BATCH_SIZE_PER_THREAD = 4;
+static constexpr unsigned int MAX_SCAN_THREADS = 8;
+
+struct CacheFileHeader
+{
+  u32 magic;
+  u32 revision;
+};
+
+enum class RecordType : u32
+{
+  Add = 1,
+  Remove = 2,
+};
+
+// Every record in the cache file starts with this, followed by <size> bytes of data
+struct RecordHeader
+{
+  RecordType type;
+  u32 size;
+};
+
+static size_t GetScanThreadCount()
+{
+  // Scanning is mostly limited by I/O, but reading from several files at once helps on SSDs and
+  // network shares, and the banners of Wii discs have to be decrypted.
+  return std::clamp(std::thread::hardware_concurrency(), 1u, MAX_SCAN_THREADS);
+}
 
 std::vector<std::string> FindAllGamePaths(const std::vector<std::string>& directories_to_scan,
                                           bool recursive_scan)
@@ -64,6 +104,8 @@ void GameFileCache::Clear(DeleteOnDisk delete_on_disk)
     File::Delete(m_path);
 
   m_cached_files.clear();
+  m_dirty_paths.clear();
+  m_rewrite_needed = true;
 }
 
 std::shared_ptr<const GameFile> GameFileCache::AddOrGet(const std::string& path,
@@ -72,12 +114,22 @@ std::shared_ptr<const GameFile> GameFileCache::AddOrGet(const std::string& path,
   auto it = std::find_if(
       m_cached_files.begin(), m_cached_files.end(),
       [&path](const std::shared_ptr<GameFile>& file) { return file->GetFilePath() == path; });
-  const bool found = it != m_cached_files.cend();
+  bool found = it != m_cached_files.cend();
+  if (found && (*it)->HostFileChanged())
+  {
+    // Scan the file again instead of returning outdated metadata
+    *it = std::move(m_cached_files.back());
+    m_cached_files.pop_back();
+    m_dirty_paths.insert(path);
+    *cache_changed = true;
+    found = false;
+  }
   if (!found)
   {
     std::shared_ptr<UICommon::GameFile> game = std::make_shared<GameFile>(path);
     if (!game->IsValid())
       return nullptr;
+    m_dirty_paths.insert(path);
     m_cached_files.emplace_back(std::move(game));
   }
   std::shared_ptr<GameFile>& result = found ? *it : m_cached_files.back();
@@ -105,26 +157,44 @@ bool GameFileCache::Update(
 
   bool cache_changed = false;
 
+  Common::WorkerPool pool(GetScanThreadCount(), "Game List Scanner");
+
+  // Checking whether files have been modified only needs a stat call per file, but that can
+  // still take a while for large libraries on network shares.
+  std::vector<u8> host_file_changed(m_cached_files.size());
+  pool.ParallelFor(m_cached_files.size(), [&](size_t i) {
+    host_file_changed[i] = game_paths.count(m_cached_files[i]->GetFilePath()) != 0 &&
+                           m_cached_files[i]->HostFileChanged();
+  });
+
   // Delete paths that aren't in game_paths from m_cached_files,
   // while simultaneously deleting paths that are in m_cached_files from game_paths.
+  // Modified files are also deleted from m_cached_files, but are kept in game_paths
+  // so that they get scanned again.
   // For the sake of speed, we don't care about maintaining the order of m_cached_files.
   {
     auto it = m_cached_files.begin();
     auto end = m_cached_files.end();
+    auto changed_it = host_file_changed.begin();
+    auto changed_end = host_file_changed.end();
     while (it != end)
     {
-      if (game_paths.erase((*it)->GetFilePath()))
+      if (!*changed_it && game_paths.erase((*it)->GetFilePath()))
       {
         ++it;
+        ++changed_it;
       }
       else
       {
         if (game_removed_from_cache)
           game_removed_from_cache((*it)->GetFilePath());
 
+        m_dirty_paths.insert((*it)->GetFilePath());
         cache_changed = true;
         --end;
+        --changed_end;
         *it = std::move(*end);
+        *changed_it = *changed_end;
       }
     }
     m_cached_files.erase(it, m_cached_files.end());
@@ -132,14 +202,30 @@ bool GameFileCache::Update(
 
   // Now that the previous loop has run, game_paths only contains paths that
   // aren't in m_cached_files, so we simply add all of them to m_cached_files.
-  for (const std::string& path : game_paths)
+  // They are scanned in batches so that the callback gets called for some games
+  // before all of them have been scanned.
+  const std::vector<std::string> paths_to_scan(game_paths.begin(), game_paths.end());
+  const size_t batch_size = pool.GetThreadCount() * SCAN_BATCH_SIZE_PER_THREAD;
+  std::vector<std::shared_ptr<GameFile>> scanned_files;
+  for (size_t batch_start = 0; batch_start < paths_to_scan.size(); batch_start += batch_size)
   {
-    auto file = std::make_shared<GameFile>(path);
-    if (file->IsValid())
+    const size_t count = std::min(batch_size, paths_to_scan.size() - batch_start);
+    scanned_files.assign(count, nullptr);
+    pool.ParallelFor(count, [&](size_t i) {
+      auto file = std::make_shared<GameFile>(paths_to_scan[batch_start + i]);
+      if (file->IsValid())
+        scanned_files[i] = std::move(file);
+    });
+
+    for (std::shared_ptr<GameFile>& file : scanned_files)
     {
+      if (!file)
+        continue;
+
       if (game_added_to_cache)
         game_added_to_cache(file);
 
+      m_dirty_paths.insert(file->GetFilePath());
       cache_changed = true;
       m_cached_files.push_back(std::move(file));
     }
@@ -192,85 +278,209 @@ bool GameFileCache::UpdateAdditionalMetadata(std::shared_ptr<GameFile>* game_fil
     copy->CustomCoverCommit();
 
   *game_file = std::move(copy);
+  m_dirty_paths.insert((*game_file)->GetFilePath());
 
   return true;
 }
 
 bool GameFileCache::Load()
 {
-  return SyncCacheFile(false);
+  File::IOFile f(m_path, "rb");
+  if (!f)
+    return false;
+
+  std::vector<u8> buffer(f.GetSize());
+  CacheFileHeader header;
+  if (buffer.size() < sizeof(header) || !f.ReadBytes(buffer.data(), buffer.size()))
+  {
+    OnCacheFileError();
+    return false;
+  }
+
+  std::memcpy(&header, buffer.data(), sizeof(header));
+  if (header.magic != CACHE_MAGIC || header.revision != CACHE_REVISION)
+  {
+    OnCacheFileError();
+    return false;
+  }
+
+  std::vector<std::shared_ptr<GameFile>> cached_files;
+  std::unordered_map<std::string, size_t> indices;
+  size_t record_count = 0;
+  size_t position = sizeof(header);
+  while (buffer.size() - position >= sizeof(RecordHeader))
+  {
+    RecordHeader record;
+    std::memcpy(&record, buffer.data() + position, sizeof(record));
+
+    // A record that doesn't fit in the file was cut off while it was being appended.
+    // Everything before it is still valid.
+    if (record.size > buffer.size() - position - sizeof(record))
+      break;
+
+    u8* const record_start = buffer.data() + position + sizeof(record);
+    u8* ptr = record_start;
+    PointerWrap p(&ptr, PointerWrap::MODE_READ);
+    if (record.type == RecordType::Add)
+    {
+      auto file = std::make_shared<GameFile>();
+      file->DoState(p);
+      if (ptr != record_start + record.size)
+      {
+        OnCacheFileError();
+        return false;
+      }
+
+      const auto [it, inserted] = indices.emplace(file->GetFilePath(), cached_files.size());
+      if (inserted)
+        cached_files.push_back(std::move(file));
+      else
+        cached_files[it->second] = std::move(file);
+    }
+    else if (record.type == RecordType::Remove)
+    {
+      std::string path;
+      p.Do(path);
+      if (ptr != record_start + record.size)
+      {
+        OnCacheFileError();
+        return false;
+      }
+
+      const auto it = indices.find(path);
+      if (it != indices.end())
+      {
+        const size_t index = it->second;
+        indices.erase(it);
+        if (index != cached_files.size() - 1)
+        {
+          cached_files[index] = std::move(cached_files.back());
+          indices[cached_files[index]->GetFilePath()] = index;
+        }
+        cached_files.pop_back();
+      }
+    }
+    else
+    {
+      OnCacheFileError();
+      return false;
+    }
+
+    position += sizeof(record) + record.size;
+    ++record_count;
+  }
+
+  m_cached_files = std::move(cached_files);
+  m_dirty_paths.clear();
+  m_record_count = record_count;
+  m_synced_file_size = position;
+  // Appending after a cut off record would make the appended records unreadable
+  m_rewrite_needed = position != buffer.size();
+  return true;
 }
 
 bool GameFileCache::Save()
 {
-  return SyncCacheFile(true);
+  // Rewriting the whole file gets rid of records that have been superseded by later records.
+  // The file is also rewritten if something other than this GameFileCache has modified it.
+  if (m_rewrite_needed || File::GetSize(m_path) != m_synced_file_size ||
+      m_record_count + m_dirty_paths.size() > m_cached_files.size() * 2 + MIN_RECORDS_TO_COMPACT)
+  {
+    return RewriteCacheFile();
+  }
+
+  return AppendToCacheFile();
 }
 
-bool GameFileCache::SyncCacheFile(bool save)
+static void AppendRecord(std::vector<u8>* buffer, RecordType type,
+                         const std::function<void(PointerWrap&)>& do_state)
 {
-  const char* open_mode = save ? "wb" : "rb";
-  File::IOFile f(m_path, open_mode);
-  if (!f)
-    return false;
-  bool success = false;
-  if (save)
-  {
-    // Measure the size of the buffer.
-    u8* ptr = nullptr;
-    PointerWrap p(&ptr, PointerWrap::MODE_MEASURE);
-    DoState(&p);
-    const size_t buffer_size = reinterpret_cast<size_t>(ptr);
-
-    // Then actually do the write.
-    std::vector<u8> buffer(buffer_size);
-    ptr = &buffer[0];
-    p.SetMode(PointerWrap::MODE_WRITE);
-    DoState(&p, buffer_size);
-    if (f.WriteBytes(buffer.data(), buffer.size()))
-      success = true;
-  }
-  else
+  u8* ptr = nullptr;
+  PointerWrap p(&ptr, PointerWrap::MODE_MEASURE);
+  do_state(p);
+  const RecordHeader record{type, static_cast<u32>(reinterpret_cast<size_t>(ptr))};
+
+  const size_t record_position = buffer->size();
+  buffer->resize(record_position + sizeof(record) + record.size);
+  std::memcpy(buffer->data() + record_position, &record, sizeof(record));
+
+  ptr = buffer->data() + record_position + sizeof(record);
+  p.SetMode(PointerWrap::MODE_WRITE);
+  do_state(p);
+}
+
+static void AppendAddRecord(std::vector<u8>* buffer, const std::shared_ptr<GameFile>& file)
+{
+  AppendRecord(buffer, RecordType::Add, [&file](PointerWrap& p) { file->DoState(p); });
+}
+
+bool GameFileCache::AppendToCacheFile()
+{
+  if (m_dirty_paths.empty())
+    return true;
+
+  std::unordered_map<std::string, const std::shared_ptr<GameFile>*> files_by_path;
+  files_by_path.reserve(m_cached_files.size());
+  for (const std::shared_ptr<GameFile>& file : m_cached_files)
+    files_by_path.emplace(file->GetFilePath(), &file);
+
+  std::vector<u8> buffer;
+  for (const std::string& path : m_dirty_paths)
   {
-    std::vector<u8> buffer(f.GetSize());
-    if (!buffer.empty() && f.ReadBytes(buffer.data(), buffer.size()))
+    const auto it = files_by_path.find(path);
+    if (it != files_by_path.end())
     {
-      u8* ptr = buffer.data();
-      PointerWrap p(&ptr, PointerWrap::MODE_READ);
-      DoState(&p, buffer.size());
-      if (p.GetMode() == PointerWrap::MODE_READ)
-        success = true;
+      AppendAddRecord(&buffer, *it->second);
+    }
+    else
+    {
+      std::string path_copy = path;
+      AppendRecord(&buffer, RecordType::Remove, [&path_copy](PointerWrap& p) { p.Do(path_copy); });
     }
   }
-  if (!success)
+
+  File::IOFile f(m_path, "ab");
+  if (!f || !f.WriteBytes(buffer.data(), buffer.size()))
   {
-    // If some file operation failed, try to delete the probably-corrupted cache
     f.Close();
-    File::Delete(m_path);
+    OnCacheFileError();
+    return false;
   }
-  return success;
+
+  m_record_count += m_dirty_paths.size();
+  m_synced_file_size += buffer.size();
+  m_dirty_paths.clear();
+  return true;
 }
 
-void GameFileCache::DoState(PointerWrap* p, u64 size)
+bool GameFileCache::RewriteCacheFile()
 {
-  struct
-  {
-    u32 revision;
-    u64 expected_size;
-  } header = {CACHE_REVISION, size};
-  p->Do(header);
-  if (p->GetMode() == PointerWrap::MODE_READ)
+  std::vector<u8> buffer(sizeof(CacheFileHeader));
+  const CacheFileHeader header{CACHE_MAGIC, CACHE_REVISION};
+  std::memcpy(buffer.data(), &header, sizeof(header));
+  for (const std::shared_ptr<GameFile>& file : m_cached_files)
+    AppendAddRecord(&buffer, file);
+
+  File::IOFile f(m_path, "wb");
+  if (!f || !f.WriteBytes(buffer.data(), buffer.size()))
   {
-    if (header.revision != CACHE_REVISION || header.expected_size != size)
-    {
-      p->SetMode(PointerWrap::MODE_MEASURE);
-      return;
-    }
+    f.Close();
+    OnCacheFileError();
+    return false;
   }
-  p->DoEachElement(m_cached_files, [](PointerWrap& state, std::shared_ptr<GameFile>& elem) {
-    if (state.GetMode() == PointerWrap::MODE_READ)
-      elem = std::make_shared<GameFile>();
-    elem->DoState(state);
-  });
+
+  m_record_count = m_cached_files.size();
+  m_synced_file_size = buffer.size();
+  m_rewrite_needed = false;
+  m_dirty_paths.clear();
+  return true;
+}
+
+void GameFileCache::OnCacheFileError()
+{
+  // If some file operation failed, try to delete the probably-corrupted cache
+  File::Delete(m_path);
+  m_rewrite_needed = true;
 }
 
 }  // namespace UICommon
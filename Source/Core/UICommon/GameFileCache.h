@@ -8,12 +8,11 @@
 #include <functional>
 #include <memory>
 #include <string>
+#include <unordered_set>
 #include <vector>
 
 #include "Common/CommonTypes.h"
 
-class PointerWrap;
-
 namespace UICommon
 {
 class GameFile;
@@ -42,23 +41,35 @@ public:
   std::shared_ptr<const GameFile> AddOrGet(const std::string& path, bool* cache_changed);
 
   // These functions return true if the call modified the cache.
+  // Files which aren't in the cache, or which have been modified since they were cached, are
+  // scanned on several threads. The callbacks are only called on the calling thread.
   bool Update(const std::vector<std::string>& all_game_paths,
               std::function<void(const std::shared_ptr<const GameFile>&)> game_added_to_cache = {},
               std::function<void(const std::string&)> game_removed_from_cache = {});
   bool UpdateAdditionalMetadata(
       std::function<void(const std::shared_ptr<const GameFile>&)> game_updated = {});
 
+  // The cache file is a log of added and removed entries. Save only appends the entries that
+  // have changed since the last Load or Save, unless the file has to be compacted.
   bool Load();
   bool Save();
 
 private:
   bool UpdateAdditionalMetadata(std::shared_ptr<GameFile>* game_file);
 
-  bool SyncCacheFile(bool save);
-  void DoState(PointerWrap* p, u64 size = 0);
+  bool AppendToCacheFile();
+  bool RewriteCacheFile();
+  void OnCacheFileError();
 
   std::string m_path;
   std::vector<std::shared_ptr<GameFile>> m_cached_files;
+
+  // Paths of entries that have been added, changed or removed since the cache file was synced
+  std::unordered_set<std::string> m_dirty_paths;
+  // The state of the cache file as of the last Load or Save
+  size_t m_record_count = 0;
+  u64 m_synced_file_size = 0;
+  bool m_rewrite_needed = true;
 };
 
 }  // namespace UICommon
@@ -22,6 +22,9 @@ u8 DSP::Host::ReadHostMemory(u32 addr)
 void DSP::Host::WriteHostMemory(u8 value, u32 addr)
 {
 }
+void DSP::Host::PrepareMemoryAccess()
+{
+}
 void DSP::Host::OSD_AddMessage(std::string str, u32 ms)
 {
 }
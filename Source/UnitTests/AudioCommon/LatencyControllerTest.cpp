@@ -0,0 +1,164 @@
+// Copyright 2019 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <array>
+#include <memory>
+
+#include <gtest/gtest.h>
+
+#include "AudioCommon/AudioCommon.h"
+#include "AudioCommon/LatencyController.h"
+#include "AudioCommon/NullSoundStream.h"
+#include "Common/CommonTypes.h"
+#include "Common/Config/Config.h"
+#include "Core/ConfigLoaders/BaseConfigLoader.h"
+#include "Core/ConfigManager.h"
+
+using AudioCommon::LatencyController;
+
+namespace
+{
+constexpr unsigned int SAMPLE_RATE = 48000;
+constexpr unsigned int FRAMES_PER_CALLBACK = 512;
+constexpr double PERIOD_US = 1000000.0 * FRAMES_PER_CALLBACK / SAMPLE_RATE;
+
+class LatencyControllerTest : public testing::Test
+{
+protected:
+  LatencyControllerTest() { m_controller.SetClock([this] { return static_cast<u64>(m_time); }); }
+
+  // Simulates <seconds> of callbacks which are <jitter_us> early or late in turns.
+  void RunCallbacks(double seconds, double jitter_us = 0.0)
+  {
+    const int count = static_cast<int>(seconds * 1000000.0 / PERIOD_US);
+    for (int i = 0; i < count; ++i)
+    {
+      m_time += PERIOD_US + ((i & 1) ? jitter_us : -jitter_us);
+      m_controller.OnCallback(FRAMES_PER_CALLBACK, FRAMES_PER_CALLBACK);
+    }
+  }
+
+  void Starve(int callbacks)
+  {
+    for (int i = 0; i < callbacks; ++i)
+    {
+      m_time += PERIOD_US;
+      m_controller.OnCallback(FRAMES_PER_CALLBACK, FRAMES_PER_CALLBACK / 4);
+    }
+  }
+
+  double m_time = 1000000.0;
+  LatencyController m_controller{SAMPLE_RATE};
+};
+}  // namespace
+
+TEST_F(LatencyControllerTest, StablePlaybackShrinksTarget)
+{
+  m_controller.Reset(80.0);
+  RunCallbacks(1.0);
+  EXPECT_DOUBLE_EQ(80.0, m_controller.GetTargetLatency());
+
+  RunCallbacks(120.0);
+  const LatencyController::Stats stats = m_controller.GetStats();
+  EXPECT_EQ(0u, stats.underruns);
+  EXPECT_NEAR(2 * PERIOD_US / 1000.0, stats.target_latency_ms, 1.0);
+  EXPECT_NEAR(PERIOD_US / 1000.0, stats.average_period_ms, 0.01);
+  EXPECT_LT(stats.jitter_ms, 0.01);
+}
+
+TEST_F(LatencyControllerTest, UnderrunGrowsTarget)
+{
+  m_controller.Reset(30.0);
+  RunCallbacks(1.0);
+  const double target = m_controller.GetTargetLatency();
+
+  // A dropout only counts once, however long it lasts.
+  Starve(10);
+  EXPECT_EQ(1u, m_controller.GetStats().underruns);
+  EXPECT_NEAR(target + PERIOD_US / 1000.0, m_controller.GetTargetLatency(), 0.01);
+
+  RunCallbacks(0.5);
+  Starve(1);
+  EXPECT_EQ(2u, m_controller.GetStats().underruns);
+  EXPECT_NEAR(target + 2 * PERIOD_US / 1000.0, m_controller.GetTargetLatency(), 0.01);
+
+  // The target is held for a while after an underrun.
+  RunCallbacks(1.5);
+  EXPECT_NEAR(target + 2 * PERIOD_US / 1000.0, m_controller.GetTargetLatency(), 0.01);
+}
+
+TEST_F(LatencyControllerTest, JitterRaisesTarget)
+{
+  m_controller.Reset(5.0);
+  RunCallbacks(2.0, 4000.0);
+  const LatencyController::Stats stats = m_controller.GetStats();
+  EXPECT_NEAR(4.0, stats.jitter_ms, 0.1);
+  EXPECT_GE(stats.target_latency_ms, 2 * PERIOD_US / 1000.0 + 4 * 3.9);
+
+  // Once the callbacks are regular again, the target goes back down.
+  RunCallbacks(120.0);
+  EXPECT_NEAR(2 * PERIOD_US / 1000.0, m_controller.GetTargetLatency(), 1.0);
+}
+
+TEST_F(LatencyControllerTest, TargetStaysWithinLimits)
+{
+  m_controller.SetLimits(10.0, 40.0);
+  m_controller.Reset(200.0);
+  EXPECT_DOUBLE_EQ(40.0, m_controller.GetTargetLatency());
+
+  for (int i = 0; i < 10; ++i)
+  {
+    RunCallbacks(0.1);
+    Starve(1);
+  }
+  EXPECT_EQ(10u, m_controller.GetStats().underruns);
+  EXPECT_DOUBLE_EQ(40.0, m_controller.GetTargetLatency());
+}
+
+// Drives the mixer of a NullSound stream like a backend with a fixed buffer size would, and checks
+// that the controller sees the mixer running dry once emulation stops pushing samples.
+TEST(LatencyControllerMixer, NullSoundStream)
+{
+  Config::Init();
+  Config::AddLayer(ConfigLoaders::GenerateBaseConfigLoader());
+  SConfig::Init();
+  SConfig::GetInstance().m_audio_adaptive_latency = true;
+
+  g_sound_stream = std::make_unique<NullSound>();
+  ASSERT_TRUE(g_sound_stream->Init());
+  Mixer* mixer = g_sound_stream->GetMixer();
+
+  u64 time = 1000000;
+  mixer->GetLatencyController().SetClock([&time] { return time; });
+
+  // 16 ms of 32 kHz audio per push, and 256 frames (16/3 ms) at 48 kHz per callback.
+  std::array<short, 512 * 2> dma_samples{};
+  std::array<short, 256 * 2> output;
+  for (int i = 0; i < 5; ++i)
+    mixer->PushSamples(dma_samples.data(), 512);
+
+  for (int i = 0; i < 3 * 200; ++i)
+  {
+    if (i % 3 == 0)
+      mixer->PushSamples(dma_samples.data(), 512);
+    time += 16000 / 3 + (i % 3 == 0 ? 1 : 0);
+    mixer->Mix(output.data(), 256);
+  }
+  EXPECT_EQ(0u, AudioCommon::GetLatencyStats().underruns);
+  const double target = mixer->GetLatencyController().GetTargetLatency();
+
+  for (int i = 0; i < 50; ++i)
+  {
+    time += 16000 / 3;
+    mixer->Mix(output.data(), 256);
+  }
+  const LatencyController::Stats stats = AudioCommon::GetLatencyStats();
+  EXPECT_EQ(650u, stats.callbacks);
+  EXPECT_EQ(1u, stats.underruns);
+  EXPECT_GT(stats.target_latency_ms, target);
+
+  g_sound_stream.reset();
+  SConfig::Shutdown();
+  Config::Shutdown();
+}
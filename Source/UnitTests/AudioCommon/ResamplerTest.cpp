@@ -0,0 +1,95 @@
+// Copyright 2019 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <array>
+#include <cmath>
+#include <complex>
+#include <cstring>
+#include <random>
+
+#include <gtest/gtest.h>
+
+#include "AudioCommon/Resampler.h"
+#include "Common/CommonTypes.h"
+
+using namespace AudioCommon;
+
+// Gain of a phase's filter for a sine wave at <frequency>, relative to the input sample rate.
+static double GetGain(const ResamplerPhase& phase, double frequency)
+{
+  constexpr double pi = 3.14159265358979323846;
+  std::complex<double> sum = 0.0;
+  for (u32 i = 0; i < RESAMPLER_TAPS; ++i)
+    sum += static_cast<double>(phase.coefficients[i]) * std::polar(1.0, -2 * pi * frequency * i);
+  return std::abs(sum) / (1 << RESAMPLER_COEFFICIENT_SHIFT);
+}
+
+TEST(Resampler, VectorizedTapsMatchGeneric)
+{
+  std::mt19937 rng(0);
+  const std::array<const ResamplerTable*, 3> tables{{&GetResamplerTable(32000, 48000),
+                                                     &GetResamplerTable(48000, 48000),
+                                                     &GetResamplerTable(48000, 32000)}};
+  for (const ResamplerTable* table : tables)
+  {
+    for (const ResamplerPhase& phase : *table)
+    {
+      for (int iteration = 0; iteration < 100; ++iteration)
+      {
+        std::array<s16, RESAMPLER_TAPS> samples;
+        for (s16& sample : samples)
+        {
+          // Include full scale samples, which give the largest sums
+          const u32 kind = rng() % 4;
+          sample = kind == 0 ? -32768 : kind == 1 ? 32767 : static_cast<s16>(rng());
+        }
+
+        ASSERT_EQ(ApplyResamplerTapsGeneric(samples.data(), phase.coefficients.data()),
+                  ApplyResamplerTaps(samples.data(), phase.coefficients.data()));
+      }
+    }
+  }
+}
+
+TEST(Resampler, UnityGainAtDC)
+{
+  for (const ResamplerTable* table : {&GetResamplerTable(32000, 48000),
+                                      &GetResamplerTable(48000, 32000),
+                                      &GetResamplerTable(48000, 8000)})
+  {
+    for (const ResamplerPhase& phase : *table)
+    {
+      s32 sum = 0;
+      for (s16 coefficient : phase.coefficients)
+        sum += coefficient;
+      EXPECT_EQ(1 << RESAMPLER_COEFFICIENT_SHIFT, sum);
+    }
+  }
+}
+
+TEST(Resampler, SameTableForSameRates)
+{
+  EXPECT_EQ(&GetResamplerTable(32000, 48000), &GetResamplerTable(32000, 48000));
+  EXPECT_NE(&GetResamplerTable(48000, 32000), &GetResamplerTable(48000, 44100));
+}
+
+TEST(Resampler, UpsamplingDoesNotLowerCutoff)
+{
+  const ResamplerTable& upsampling = GetResamplerTable(32000, 48000);
+  const ResamplerTable& same_rate = GetResamplerTable(48000, 48000);
+  EXPECT_EQ(0, std::memcmp(&upsampling, &same_rate, sizeof(ResamplerTable)));
+}
+
+TEST(Resampler, DownsamplingAttenuatesAliasedFrequencies)
+{
+  // 20 kHz in 48 kHz audio is above the Nyquist frequency of 32 kHz audio, and would alias.
+  constexpr double frequency = 20000.0 / 48000.0;
+  const ResamplerTable& same_rate = GetResamplerTable(48000, 48000);
+  const ResamplerTable& downsampling = GetResamplerTable(48000, 32000);
+  for (u32 i = 0; i < RESAMPLER_PHASES; i += RESAMPLER_PHASES / 8)
+    EXPECT_LT(GetGain(downsampling[i], frequency), GetGain(same_rate[i], frequency) / 2);
+
+  // Low frequencies must still pass.
+  EXPECT_GT(GetGain(downsampling[0], 1000.0 / 48000.0), 0.95);
+}
@@ -0,0 +1,67 @@
+// Copyright 2019 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <array>
+#include <memory>
+
+#include <gtest/gtest.h>
+
+#include "AudioCommon/AudioCommon.h"
+#include "AudioCommon/Mixer.h"
+#include "AudioCommon/NullSoundStream.h"
+#include "Common/CommonTypes.h"
+#include "Common/Config/Config.h"
+#include "Common/Swap.h"
+#include "Core/ConfigLoaders/BaseConfigLoader.h"
+#include "Core/ConfigManager.h"
+
+// The buses pushed with PushSurroundSamples come out on the matching speakers, without going
+// through the stereo mix that is pushed alongside them.
+TEST(SurroundMix, DiscreteChannels)
+{
+  Config::Init();
+  Config::AddLayer(ConfigLoaders::GenerateBaseConfigLoader());
+  SConfig::Init();
+  SConfig::GetInstance().m_audio_discrete_surround = true;
+
+  g_sound_stream = std::make_unique<NullSound>();
+  ASSERT_TRUE(g_sound_stream->Init());
+  Mixer* mixer = g_sound_stream->GetMixer();
+
+  // Big endian, right channel first, like the AX output.
+  constexpr s16 LEFT = 8000;
+  constexpr s16 RIGHT = -4000;
+  constexpr s16 SURROUND = 6000;
+  std::array<s16, 160 * 2> lr;
+  std::array<s16, 160> surround;
+  std::array<s16, 160 * 2> stereo_mix;
+  for (size_t i = 0; i < surround.size(); ++i)
+  {
+    lr[i * 2] = Common::swap16(RIGHT);
+    lr[i * 2 + 1] = Common::swap16(LEFT);
+    surround[i] = SURROUND;
+    stereo_mix[i * 2] = Common::swap16(static_cast<s16>(RIGHT + SURROUND));
+    stereo_mix[i * 2 + 1] = Common::swap16(static_cast<s16>(LEFT - SURROUND));
+  }
+
+  std::array<float, 240 * 6> output;
+  for (int i = 0; i < 20; ++i)
+  {
+    mixer->PushSamples(stereo_mix.data(), 160);
+    mixer->PushSurroundSamples(lr.data(), surround.data(), 160);
+    mixer->MixSurround(output.data(), 240);
+  }
+
+  const float* frame = &output[120 * 6];
+  EXPECT_NEAR(LEFT / 32767.0f, frame[0], 0.01f);
+  EXPECT_NEAR(RIGHT / 32767.0f, frame[1], 0.01f);
+  EXPECT_EQ(0.0f, frame[2]);
+  EXPECT_EQ(0.0f, frame[3]);
+  EXPECT_NEAR(SURROUND * 0.7071f / 32767.0f, frame[4], 0.01f);
+  EXPECT_NEAR(SURROUND * 0.7071f / 32767.0f, frame[5], 0.01f);
+
+  g_sound_stream.reset();
+  SConfig::Shutdown();
+  Config::Shutdown();
+}
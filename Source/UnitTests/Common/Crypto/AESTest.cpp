@@ -0,0 +1,160 @@
+// Copyright 2019 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "Common/CommonTypes.h"
+#include "Common/Crypto/AES.h"
+
+using Common::AES::Implementation;
+using Common::AES::Mode;
+
+namespace
+{
+constexpr std::array<Implementation, 4> IMPLEMENTATIONS{
+    {Implementation::Generic, Implementation::AESNI, Implementation::VAES, Implementation::ARMv8}};
+
+// NIST SP 800-38A, F.2.1 and F.2.2
+constexpr std::array<u8, 16> KEY{{0x2b, 0x7e, 0x15, 0x16, 0x28, 0xae, 0xd2, 0xa6, 0xab, 0xf7, 0x15,
+                                  0x88, 0x09, 0xcf, 0x4f, 0x3c}};
+constexpr std::array<u8, 16> IV{{0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a,
+                                 0x0b, 0x0c, 0x0d, 0x0e, 0x0f}};
+constexpr std::array<u8, 64> PLAINTEXT{
+    {0x6b, 0xc1, 0xbe, 0xe2, 0x2e, 0x40, 0x9f, 0x96, 0xe9, 0x3d, 0x7e, 0x11, 0x73,
+     0x93, 0x17, 0x2a, 0xae, 0x2d, 0x8a, 0x57, 0x1e, 0x03, 0xac, 0x9c, 0x9e, 0xb7,
+     0x6f, 0xac, 0x45, 0xaf, 0x8e, 0x51, 0x30, 0xc8, 0x1c, 0x46, 0xa3, 0x5c, 0xe4,
+     0x11, 0xe5, 0xfb, 0xc1, 0x19, 0x1a, 0x0a, 0x52, 0xef, 0xf6, 0x9f, 0x24, 0x45,
+     0xdf, 0x4f, 0x9b, 0x17, 0xad, 0x2b, 0x41, 0x7b, 0xe6, 0x6c, 0x37, 0x10}};
+constexpr std::array<u8, 64> CIPHERTEXT{
+    {0x76, 0x49, 0xab, 0xac, 0x81, 0x19, 0xb2, 0x46, 0xce, 0xe9, 0x8e, 0x9b, 0x12,
+     0xe9, 0x19, 0x7d, 0x50, 0x86, 0xcb, 0x9b, 0x50, 0x72, 0x19, 0xee, 0x95, 0xdb,
+     0x11, 0x3a, 0x91, 0x76, 0x78, 0xb2, 0x73, 0xbe, 0xd6, 0xb8, 0xe3, 0xc1, 0x74,
+     0x3b, 0x71, 0x16, 0xe6, 0x9e, 0x22, 0x22, 0x95, 0x16, 0x3f, 0xf1, 0xca, 0xa1,
+     0x68, 0x1f, 0xac, 0x09, 0x12, 0x0e, 0xca, 0x30, 0x75, 0x86, 0xe1, 0xa7}};
+
+std::vector<u8> MakeData(size_t size, u32 seed)
+{
+  std::vector<u8> data(size);
+  for (u8& byte : data)
+  {
+    seed = seed * 1664525 + 1013904223;
+    byte = static_cast<u8>(seed >> 24);
+  }
+  return data;
+}
+}  // namespace
+
+TEST(AES, KnownAnswer)
+{
+  for (Implementation implementation : IMPLEMENTATIONS)
+  {
+    if (!Common::AES::IsSupported(implementation))
+      continue;
+    SCOPED_TRACE(Common::AES::GetImplementationName(implementation));
+
+    std::array<u8, 64> buffer;
+    std::array<u8, 16> iv = IV;
+    Common::AES::CreateContext(KEY.data(), Mode::Encrypt, implementation)
+        ->Crypt(iv.data(), PLAINTEXT.data(), buffer.data(), buffer.size());
+    EXPECT_EQ(CIPHERTEXT, buffer);
+    EXPECT_TRUE(std::equal(iv.begin(), iv.end(), CIPHERTEXT.end() - 16));
+
+    iv = IV;
+    Common::AES::CreateContext(KEY.data(), Mode::Decrypt, implementation)
+        ->Crypt(iv.data(), buffer.data(), buffer.data(), buffer.size());
+    EXPECT_EQ(PLAINTEXT, buffer);
+    EXPECT_TRUE(std::equal(iv.begin(), iv.end(), CIPHERTEXT.end() - 16));
+  }
+}
+
+// Every block count up to a few parallel batches, in place and out of place, split into two calls
+// to check that the IV is chained correctly.
+TEST(AES, MatchesGeneric)
+{
+  const std::vector<u8> key = MakeData(16, 1);
+  const std::vector<u8> iv = MakeData(16, 2);
+  const std::vector<u8> input = MakeData(40 * 16, 3);
+
+  for (Mode mode : {Mode::Encrypt, Mode::Decrypt})
+  {
+    const auto generic = Common::AES::CreateContext(key.data(), mode, Implementation::Generic);
+    for (Implementation implementation : IMPLEMENTATIONS)
+    {
+      if (!Common::AES::IsSupported(implementation))
+        continue;
+      SCOPED_TRACE(Common::AES::GetImplementationName(implementation));
+      const auto context = Common::AES::CreateContext(key.data(), mode, implementation);
+
+      for (size_t blocks = 1; blocks <= 40; ++blocks)
+      {
+        SCOPED_TRACE(blocks);
+        const size_t size = blocks * 16;
+        std::vector<u8> expected(size);
+        std::vector<u8> expected_iv = iv;
+        generic->Crypt(expected_iv.data(), input.data(), expected.data(), size);
+
+        std::vector<u8> output(size);
+        std::vector<u8> output_iv = iv;
+        const size_t split = blocks / 3 * 16;
+        context->Crypt(output_iv.data(), input.data(), output.data(), split);
+        context->Crypt(output_iv.data(), input.data() + split, output.data() + split, size - split);
+        EXPECT_EQ(expected, output);
+        EXPECT_EQ(expected_iv, output_iv);
+
+        std::vector<u8> in_place(input.begin(), input.begin() + size);
+        context->CryptIV(iv.data(), in_place.data(), in_place.data(), size);
+        EXPECT_EQ(expected, in_place);
+      }
+    }
+  }
+}
+
+TEST(AES, ConvenienceFunctions)
+{
+  std::array<u8, 16> iv = IV;
+  EXPECT_TRUE(std::equal(CIPHERTEXT.begin(), CIPHERTEXT.end(),
+                         Common::AES::Encrypt(KEY.data(), iv.data(), PLAINTEXT.data(), 64).begin()));
+
+  std::array<u8, 64> buffer = CIPHERTEXT;
+  iv = IV;
+  Common::AES::DecryptEncrypt(KEY.data(), iv.data(), buffer.data(), buffer.data(), buffer.size(),
+                              Mode::Decrypt);
+  EXPECT_EQ(PLAINTEXT, buffer);
+}
+
+// Decryption throughput on the data area of Wii disc clusters, for each implementation the CPU
+// supports. Being machine-dependent, it only runs with --gtest_also_run_disabled_tests.
+TEST(AES, DISABLED_Benchmark)
+{
+  constexpr size_t CLUSTER_DATA_SIZE = 0x7c00;
+  constexpr size_t CLUSTERS = 1024;
+  const std::vector<u8> key = MakeData(16, 4);
+  std::vector<u8> buffer = MakeData(CLUSTER_DATA_SIZE, 5);
+
+  for (Implementation implementation : IMPLEMENTATIONS)
+  {
+    if (!Common::AES::IsSupported(implementation))
+      continue;
+
+    const auto context = Common::AES::CreateContext(key.data(), Mode::Decrypt, implementation);
+    std::array<u8, 16> iv{};
+    const auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < CLUSTERS; ++i)
+      context->Crypt(iv.data(), buffer.data(), buffer.data(), buffer.size());
+    const auto end = std::chrono::steady_clock::now();
+
+    const double seconds = std::chrono::duration<double>(end - start).count();
+    const double mib_per_second = CLUSTERS * CLUSTER_DATA_SIZE / seconds / (1024 * 1024);
+    std::printf("AES-128-CBC decryption, %s: %.1f MiB/s\n",
+                Common::AES::GetImplementationName(implementation), mib_per_second);
+    RecordProperty(Common::AES::GetImplementationName(implementation),
+                   static_cast<int>(mib_per_second));
+  }
+}
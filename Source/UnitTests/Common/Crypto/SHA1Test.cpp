@@ -0,0 +1,150 @@
+// Copyright 2019 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include <mbedtls/sha1.h>
+
+#include "Common/CommonTypes.h"
+#include "Common/Crypto/SHA1.h"
+
+using Common::SHA1::Digest;
+using Common::SHA1::Implementation;
+
+namespace
+{
+constexpr std::array<Implementation, 4> IMPLEMENTATIONS{{Implementation::Generic,
+                                                         Implementation::MultiBuffer,
+                                                         Implementation::SHANI,
+                                                         Implementation::ARMv8}};
+
+std::vector<u8> MakeData(size_t size, u32 seed)
+{
+  std::vector<u8> data(size);
+  for (u8& byte : data)
+  {
+    seed = seed * 1664525 + 1013904223;
+    byte = static_cast<u8>(seed >> 24);
+  }
+  return data;
+}
+
+Digest ReferenceDigest(const u8* data, size_t size)
+{
+  Digest digest;
+  mbedtls_sha1_ret(data, size, digest.data());
+  return digest;
+}
+}  // namespace
+
+TEST(SHA1, KnownAnswer)
+{
+  // FIPS 180-2, appendix A.1
+  constexpr std::array<u8, 3> MESSAGE{{'a', 'b', 'c'}};
+  constexpr Digest EXPECTED{{0xa9, 0x99, 0x3e, 0x36, 0x47, 0x06, 0x81, 0x6a, 0xba, 0x3e,
+                             0x25, 0x71, 0x78, 0x50, 0xc2, 0x6c, 0x9c, 0xd0, 0xd8, 0x9d}};
+  EXPECT_EQ(EXPECTED, Common::SHA1::CalculateDigest(MESSAGE.data(), MESSAGE.size()));
+
+  for (Implementation implementation : IMPLEMENTATIONS)
+  {
+    if (!Common::SHA1::IsSupported(implementation))
+      continue;
+    SCOPED_TRACE(Common::SHA1::GetImplementationName(implementation));
+
+    Digest digest;
+    Common::SHA1::CalculateDigests(MESSAGE.data(), MESSAGE.size(), 1, digest.data(),
+                                   implementation);
+    EXPECT_EQ(EXPECTED, digest);
+  }
+}
+
+// Lengths around the padding boundaries, fed to the streaming context in uneven pieces.
+TEST(SHA1, ContextMatchesReference)
+{
+  const std::vector<u8> data = MakeData(300, 1);
+  for (Implementation implementation : IMPLEMENTATIONS)
+  {
+    const auto context_check = Common::SHA1::CreateContext(implementation);
+    if (!Common::SHA1::IsSupported(implementation) || !context_check)
+      continue;
+    SCOPED_TRACE(Common::SHA1::GetImplementationName(implementation));
+
+    for (size_t size = 0; size <= data.size(); ++size)
+    {
+      SCOPED_TRACE(size);
+      const auto context = Common::SHA1::CreateContext(implementation);
+      size_t offset = 0;
+      for (size_t piece = 1; offset < size; piece = piece * 3 + 1)
+      {
+        const size_t piece_size = std::min(piece, size - offset);
+        context->Update(data.data() + offset, piece_size);
+        offset += piece_size;
+      }
+      EXPECT_EQ(ReferenceDigest(data.data(), size), context->Finish());
+      EXPECT_EQ(ReferenceDigest(data.data(), size),
+                Common::SHA1::CalculateDigest(data.data(), size));
+    }
+  }
+}
+
+TEST(SHA1, MultipleMessages)
+{
+  const std::vector<u8> data = MakeData(31 * 0x400, 2);
+  for (Implementation implementation : IMPLEMENTATIONS)
+  {
+    if (!Common::SHA1::IsSupported(implementation))
+      continue;
+    SCOPED_TRACE(Common::SHA1::GetImplementationName(implementation));
+
+    for (size_t size : {0, 1, 55, 56, 64, 119, 0x400})
+    {
+      for (size_t count = 1; count <= data.size() / std::max<size_t>(size, 1) && count <= 31;
+           ++count)
+      {
+        SCOPED_TRACE(testing::Message() << size << " x " << count);
+        std::vector<u8> digests(count * Common::SHA1::DIGEST_LEN + 1, 0xcc);
+        Common::SHA1::CalculateDigests(data.data(), size, count, digests.data(), implementation);
+        for (size_t i = 0; i < count; ++i)
+        {
+          const Digest expected = ReferenceDigest(data.data() + i * size, size);
+          EXPECT_TRUE(std::equal(expected.begin(), expected.end(),
+                                 digests.begin() + i * Common::SHA1::DIGEST_LEN));
+        }
+        // Nothing past the last digest may be written.
+        EXPECT_EQ(0xcc, digests.back());
+      }
+    }
+  }
+}
+
+// Throughput of the H0 hashes of Wii disc clusters. Run with --gtest_also_run_disabled_tests.
+TEST(SHA1, DISABLED_Benchmark)
+{
+  constexpr size_t CLUSTERS = 1024;
+  const std::vector<u8> data = MakeData(31 * 0x400, 3);
+  std::array<u8, 31 * Common::SHA1::DIGEST_LEN> digests;
+
+  for (Implementation implementation : IMPLEMENTATIONS)
+  {
+    if (!Common::SHA1::IsSupported(implementation))
+      continue;
+
+    const auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < CLUSTERS; ++i)
+      Common::SHA1::CalculateDigests(data.data(), 0x400, 31, digests.data(), implementation);
+    const auto end = std::chrono::steady_clock::now();
+
+    const double seconds = std::chrono::duration<double>(end - start).count();
+    const double mib_per_second = CLUSTERS * data.size() / seconds / (1024 * 1024);
+    std::printf("SHA-1 H0 hashing, %s: %.1f MiB/s\n",
+                Common::SHA1::GetImplementationName(implementation), mib_per_second);
+    RecordProperty(Common::SHA1::GetImplementationName(implementation),
+                   static_cast<int>(mib_per_second));
+  }
+}
@@ -0,0 +1,88 @@
+// Copyright 2019 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <atomic>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "Common/WorkerPool.h"
+
+TEST(WorkerPool, ThreadCountIncludesCaller)
+{
+  EXPECT_EQ(1u, Common::WorkerPool(0, "Test").GetThreadCount());
+  EXPECT_EQ(1u, Common::WorkerPool(1, "Test").GetThreadCount());
+  EXPECT_EQ(4u, Common::WorkerPool(4, "Test").GetThreadCount());
+}
+
+TEST(WorkerPool, SingleThreadRunsOnCaller)
+{
+  Common::WorkerPool pool(1, "Test");
+  const std::thread::id caller = std::this_thread::get_id();
+  std::vector<size_t> order;
+  pool.ParallelFor(5, [&](size_t i) {
+    EXPECT_EQ(caller, std::this_thread::get_id());
+    order.push_back(i);
+  });
+  EXPECT_EQ((std::vector<size_t>{0, 1, 2, 3, 4}), order);
+}
+
+TEST(WorkerPool, EmptyRangeCallsNothing)
+{
+  Common::WorkerPool pool(4, "Test");
+  bool called = false;
+  pool.ParallelFor(0, [&](size_t) { called = true; });
+  EXPECT_FALSE(called);
+}
+
+TEST(WorkerPool, EveryIndexRunsOnce)
+{
+  Common::WorkerPool pool(4, "Test");
+  for (size_t count : {1, 2, 3, 4, 5, 17, 1000})
+  {
+    std::vector<std::atomic<int>> calls(count);
+    pool.ParallelFor(count, [&](size_t i) { calls[i].fetch_add(1); });
+    for (size_t i = 0; i < count; ++i)
+      ASSERT_EQ(1, calls[i].load()) << "index " << i << " of " << count;
+  }
+}
+
+TEST(WorkerPool, AllWorkIsDoneOnReturn)
+{
+  Common::WorkerPool pool(3, "Test");
+  std::vector<int> results(64);
+  for (int round = 0; round < 1000; ++round)
+  {
+    pool.ParallelFor(results.size(), [&](size_t i) {
+      // Give the other threads a chance to pick up indices
+      if (i % 8 == 0)
+        std::this_thread::yield();
+      results[i] = round;
+    });
+    for (int result : results)
+      ASSERT_EQ(round, result);
+  }
+}
+
+TEST(WorkerPool, WorkRunsOnSeveralThreads)
+{
+  Common::WorkerPool pool(2, "Test");
+  const std::thread::id caller = std::this_thread::get_id();
+  std::atomic<bool> on_worker{false};
+  std::atomic<bool> on_caller{false};
+
+  // Each index waits until the other thread has taken one, so both threads must take part.
+  pool.ParallelFor(2, [&](size_t) {
+    std::atomic<bool>& self = std::this_thread::get_id() == caller ? on_caller : on_worker;
+    std::atomic<bool>& other = &self == &on_caller ? on_worker : on_caller;
+    self = true;
+    while (!other)
+      std::this_thread::yield();
+  });
+
+  EXPECT_TRUE(on_worker);
+  EXPECT_TRUE(on_caller);
+}
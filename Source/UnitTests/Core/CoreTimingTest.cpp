@@ -4,12 +4,20 @@
 
 #include <gtest/gtest.h>
 
+#include <algorithm>
 #include <array>
 #include <bitset>
+#include <chrono>
+#include <cstdio>
+#include <random>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "Common/Config/Config.h"
 #include "Common/FileUtil.h"
+#include "Core/Config/MainSettings.h"
+#include "Core/ConfigLoaders/BaseConfigLoader.h"
 #include "Core/ConfigManager.h"
 #include "Core/Core.h"
 #include "Core/CoreTiming.h"
@@ -37,11 +45,13 @@ void CallbackTemplate(u64 userdata, s64 lateness)
 class ScopeInit final
 {
 public:
-  ScopeInit() : m_profile_path(File::CreateTempDir())
+  explicit ScopeInit(bool timing_wheel = false) : m_profile_path(File::CreateTempDir())
   {
     Core::DeclareAsCPUThread();
     UICommon::SetUserDirectory(m_profile_path);
     Config::Init();
+    Config::AddLayer(ConfigLoaders::GenerateBaseConfigLoader());
+    Config::SetBase(Config::MAIN_TIMING_WHEEL, timing_wheel);
     SConfig::Init();
     PowerPC::Init(PowerPC::CPUCore::Interpreter);
     CoreTiming::Init();
@@ -347,3 +357,169 @@ TEST(CoreTiming, Overclocking)
   SConfig::GetInstance().m_OCFactor = 1.0;
   AdvanceAndCheck(4, MAX_SLICE_LENGTH);
 }
+
+namespace QueueComparisonTest
+{
+static std::vector<std::pair<u64, s64>> s_fired;
+static std::mt19937 s_rng;
+static CoreTiming::EventType* s_cb_random = nullptr;
+static CoreTiming::EventType* s_cb_removed = nullptr;
+
+static void RandomRescheduleCallback(u64 userdata, s64 lateness)
+{
+  s_fired.emplace_back(userdata, lateness);
+  // Mix short, long and very long (beyond the wheel's range) delays, with lots of collisions.
+  const u32 kind = s_rng() % 8;
+  s64 delay;
+  if (kind < 5)
+    delay = s_rng() % 64;
+  else if (kind < 7)
+    delay = s_rng() % 100000;
+  else
+    delay = s_rng() % 1000;
+  CoreTiming::ScheduleEvent(delay, s_cb_random, userdata + 1);
+  if (s_rng() % 16 == 0)
+    CoreTiming::ScheduleEvent((s64{1} << 32) + delay, s_cb_random, userdata + 2);
+  if (kind == 0)
+    CoreTiming::ScheduleEvent(delay, s_cb_removed, userdata);
+  else if (kind == 1)
+    CoreTiming::RemoveEvent(s_cb_removed);
+}
+
+static std::vector<std::pair<u64, s64>> RunRandomSchedule(bool timing_wheel)
+{
+  ScopeInit guard(timing_wheel);
+  s_fired.clear();
+  s_rng.seed(1234);
+
+  s_cb_random = CoreTiming::RegisterEvent("callbackRandom", RandomRescheduleCallback);
+  s_cb_removed = CoreTiming::RegisterEvent("callbackRemoved", RandomRescheduleCallback);
+
+  CoreTiming::Advance();
+  for (u64 i = 0; i < 16; ++i)
+    CoreTiming::ScheduleEvent(static_cast<s64>(i * 37), s_cb_random, i << 32);
+
+  for (int i = 0; i < 20000; ++i)
+  {
+    // Execute a random part of the slice to make some events run late.
+    PowerPC::ppcState.downcount = static_cast<int>(s_rng() % (PowerPC::ppcState.downcount + 1));
+    CoreTiming::Advance();
+  }
+
+  // Jump far ahead so that the events beyond the range of the timing wheel run too.
+  CoreTiming::g.global_timer += s64{1} << 33;
+  for (int i = 0; i < 100; ++i)
+  {
+    PowerPC::ppcState.downcount = 0;
+    CoreTiming::Advance();
+  }
+  return s_fired;
+}
+}  // namespace QueueComparisonTest
+
+TEST(CoreTiming, TimingWheelMatchesHeap)
+{
+  using namespace QueueComparisonTest;
+
+  const std::vector<std::pair<u64, s64>> heap = RunRandomSchedule(false);
+  const std::vector<std::pair<u64, s64>> wheel = RunRandomSchedule(true);
+  EXPECT_GT(heap.size(), 1000u);
+  EXPECT_EQ(heap, wheel);
+}
+
+namespace QueueBenchmark
+{
+static CoreTiming::EventType* s_cb = nullptr;
+static u32 s_period = 0;
+
+static void PeriodicCallback(u64 userdata, s64 lateness)
+{
+  // Spread of periods roughly resembling the usual mix of audio, video and SI/EXI events.
+  s_period = s_period * 1664525 + 1013904223;
+  CoreTiming::ScheduleEvent(100 + (s_period >> 16) % 20000 - lateness, s_cb, userdata);
+}
+
+static double Run(bool timing_wheel)
+{
+  ScopeInit guard(timing_wheel);
+  s_period = 0;
+  s_cb = CoreTiming::RegisterEvent("callbackPeriodic", PeriodicCallback);
+
+  CoreTiming::Advance();
+  for (u64 i = 0; i < 32; ++i)
+    CoreTiming::ScheduleEvent(static_cast<s64>(i * 100), s_cb, i);
+
+  const auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < 200000; ++i)
+  {
+    PowerPC::ppcState.downcount = 0;
+    CoreTiming::Advance();
+  }
+  const auto end = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::milli>(end - start).count();
+}
+}  // namespace QueueBenchmark
+
+// Only prints timings, so it is left out of the regular test pass.
+// Run it with --gtest_also_run_disabled_tests.
+TEST(CoreTiming, DISABLED_QueueBenchmark)
+{
+  const double heap_ms = QueueBenchmark::Run(false);
+  const double wheel_ms = QueueBenchmark::Run(true);
+  std::printf("CoreTiming queue benchmark: heap %.2f ms, timing wheel %.2f ms\n", heap_ms,
+              wheel_ms);
+  RecordProperty("HeapMs", static_cast<int>(heap_ms));
+  RecordProperty("TimingWheelMs", static_cast<int>(wheel_ms));
+}
+
+TEST(CoreTiming, EventTypeStats)
+{
+  ScopeInit guard;
+
+  CoreTiming::EventType* cb_a = CoreTiming::RegisterEvent("callbackA", CallbackTemplate<0>);
+  CoreTiming::EventType* cb_b = CoreTiming::RegisterEvent("callbackB", CallbackTemplate<1>);
+
+  CoreTiming::Advance();
+
+  // Events that fire while stats are disabled aren't counted.
+  CoreTiming::ScheduleEvent(100, cb_a, CB_IDS[0]);
+  AdvanceAndCheck(0, MAX_SLICE_LENGTH);
+
+  CoreTiming::SetStatsEnabled(true);
+  CoreTiming::ScheduleEvent(100, cb_a, CB_IDS[0]);
+  AdvanceAndCheck(0, MAX_SLICE_LENGTH);
+  CoreTiming::ScheduleEvent(100, cb_b, CB_IDS[1]);
+  AdvanceAndCheck(1, MAX_SLICE_LENGTH, 5, -5);
+  CoreTiming::ScheduleEvent(100, cb_b, CB_IDS[1]);
+  AdvanceAndCheck(1, MAX_SLICE_LENGTH, 1000, -1000);
+
+  const std::vector<CoreTiming::EventTypeStats> stats = CoreTiming::GetEventTypeStats();
+  const auto find = [&](const std::string& name) {
+    return *std::find_if(stats.begin(), stats.end(),
+                         [&](const CoreTiming::EventTypeStats& s) { return s.name == name; });
+  };
+  const CoreTiming::EventTypeStats a = find("callbackA");
+  const CoreTiming::EventTypeStats b = find("callbackB");
+  EXPECT_EQ(1u, a.fires);
+  EXPECT_EQ(1u, a.lateness_histogram[0]);
+  EXPECT_EQ(2u, b.fires);
+  EXPECT_EQ(1u, b.lateness_histogram[3]);   // 5 cycles: [4, 8)
+  EXPECT_EQ(1u, b.lateness_histogram[10]);  // 1000 cycles: [512, 1024)
+
+  CoreTiming::ResetEventTypeStats();
+  CoreTiming::SetStatsEnabled(false);
+  for (const CoreTiming::EventTypeStats& s : CoreTiming::GetEventTypeStats())
+    EXPECT_EQ(0u, s.fires);
+}
+
+TEST(CoreTiming, StatsAreDisabledInNewSession)
+{
+  {
+    ScopeInit guard;
+    CoreTiming::SetStatsEnabled(true);
+    EXPECT_TRUE(CoreTiming::AreStatsEnabled());
+  }
+
+  ScopeInit guard;
+  EXPECT_FALSE(CoreTiming::AreStatsEnabled());
+}
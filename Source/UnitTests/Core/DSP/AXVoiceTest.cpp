@@ -0,0 +1,205 @@
+// Copyright 2019 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <array>
+#include <iterator>
+#include <random>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "Common/CommonTypes.h"
+#include "Common/WorkerPool.h"
+
+#define AX_GC
+#include "Core/HW/DSPHLE/UCodes/AXVoice.h"
+
+using namespace DSP::HLE;
+
+// Straightforward per-sample versions of the AX mixing and resampling code, which the block based
+// implementations must match exactly.
+static void ReferenceMixAdd(int* out, const s16* input, u32 count, u16* pvol, s16* dpop, bool ramp)
+{
+  u16& volume = pvol[0];
+  const u16 volume_delta = ramp ? pvol[1] : 0;
+
+  for (u32 i = 0; i < count; ++i)
+  {
+    s64 sample = input[i];
+    sample *= volume;
+    sample >>= 15;
+    sample = std::clamp((s32)sample, -32767, 32767);
+
+    out[i] += (s16)sample;
+    volume += volume_delta;
+
+    *dpop = (s16)sample;
+  }
+}
+
+static u32 ReferenceLinearResample(const std::vector<s16>& input, s16* output, u32 count,
+                                   s16* last_samples, u32 curr_pos, u32 ratio)
+{
+  u32 read_samples_count = 0;
+  s16 temp[4];
+  u32 idx = 0;
+
+  temp[idx++ & 3] = last_samples[0];
+  temp[idx++ & 3] = last_samples[1];
+  temp[idx++ & 3] = last_samples[2];
+  temp[idx++ & 3] = last_samples[3];
+
+  for (u32 i = 0; i < count; ++i)
+  {
+    curr_pos += ratio;
+    while (curr_pos >= 0x10000)
+    {
+      temp[idx++ & 3] = input[read_samples_count++];
+      curr_pos -= 0x10000;
+    }
+
+    u16 curr_frac = curr_pos & 0xFFFF;
+    u16 inv_curr_frac = -curr_frac;
+    if (curr_frac)
+    {
+      s32 s0 = temp[idx++ & 3];
+      s32 s1 = temp[idx++ & 3];
+      output[i] = ((s0 * inv_curr_frac) + (s1 * curr_frac)) >> 16;
+      idx += 2;
+    }
+    else
+    {
+      output[i] = temp[idx++ & 3];
+      idx += 3;
+    }
+  }
+
+  last_samples[3] = temp[--idx & 3];
+  last_samples[2] = temp[--idx & 3];
+  last_samples[1] = temp[--idx & 3];
+  last_samples[0] = temp[--idx & 3];
+  return curr_pos;
+}
+
+TEST(AXVoice, MixAddMatchesReference)
+{
+  std::mt19937 rng(0);
+  for (int iteration = 0; iteration < 10000; ++iteration)
+  {
+    std::array<s16, MAX_SAMPLES_PER_FRAME> input;
+    for (s16& sample : input)
+      sample = (iteration & 1) ? static_cast<s16>(rng()) : ((rng() & 1) ? -32768 : 32767);
+
+    std::array<int, MAX_SAMPLES_PER_FRAME> expected_out;
+    for (int& sample : expected_out)
+      sample = static_cast<int>(rng());
+    std::array<int, MAX_SAMPLES_PER_FRAME> out = expected_out;
+
+    const u32 count = 1 + rng() % MAX_SAMPLES_PER_FRAME;
+    const bool ramp = rng() & 1;
+    u16 expected_vol[2] = {static_cast<u16>(rng()), static_cast<u16>(rng())};
+    u16 vol[2] = {expected_vol[0], expected_vol[1]};
+    s16 expected_dpop = 0;
+    s16 dpop = 0;
+
+    ReferenceMixAdd(expected_out.data(), input.data(), count, expected_vol, &expected_dpop, ramp);
+    MixAdd(out.data(), input.data(), count, vol, &dpop, ramp);
+
+    ASSERT_EQ(expected_out, out);
+    ASSERT_EQ(expected_vol[0], vol[0]);
+    ASSERT_EQ(expected_dpop, dpop);
+  }
+}
+
+TEST(AXVoice, ResampleMatchesReference)
+{
+  std::mt19937 rng(1);
+  for (int iteration = 0; iteration < 10000; ++iteration)
+  {
+    std::vector<s16> input(MAX_SAMPLES_PER_FRAME * 4 + 1);
+    for (s16& sample : input)
+      sample = static_cast<s16>(rng());
+
+    // The documented ratio range is 1/512 to 4.
+    const u32 ratio = 0x80 + rng() % 0x40000;
+    const u32 curr_pos = rng() & 0xFFFF;
+    const u32 count = 4 + rng() % (MAX_SAMPLES_PER_FRAME - 3);
+    s16 expected_last_samples[4];
+    for (s16& sample : expected_last_samples)
+      sample = static_cast<s16>(rng());
+    s16 last_samples[4];
+    std::copy(std::begin(expected_last_samples), std::end(expected_last_samples), last_samples);
+
+    std::array<s16, MAX_SAMPLES_PER_FRAME> expected_output{};
+    const u32 expected_pos = ReferenceLinearResample(input, expected_output.data(), count,
+                                                     expected_last_samples, curr_pos, ratio);
+
+    const u32 input_count = GetResampleInputCount(count, curr_pos, ratio, SRCTYPE_LINEAR);
+    ASSERT_LE(input_count, input.size());
+    std::vector<s16> buffer(std::begin(last_samples), std::end(last_samples));
+    buffer.insert(buffer.end(), input.begin(), input.begin() + input_count);
+
+    std::array<s16, MAX_SAMPLES_PER_FRAME> output{};
+    const u32 pos = ResampleAudio(buffer.data(), output.data(), count, last_samples, curr_pos,
+                                  ratio, SRCTYPE_LINEAR, nullptr);
+
+    ASSERT_EQ(expected_pos, pos);
+    ASSERT_EQ(expected_output, output);
+    ASSERT_TRUE(std::equal(std::begin(expected_last_samples), std::end(expected_last_samples),
+                           std::begin(last_samples)));
+  }
+}
+
+TEST(AXVoice, ParallelPBProcessingMatchesSerial)
+{
+  constexpr size_t NUM_BUFFERS = std::size(AXBuffers{}.ptrs);
+  std::mt19937 rng(2);
+  for (size_t num_threads : {2, 3, 8})
+  {
+    Common::WorkerPool pool(num_threads, "Test");
+    std::vector<int> partial_buffers;
+    for (int iteration = 0; iteration < 100; ++iteration)
+    {
+      std::vector<u32> pb_addrs(1 + rng() % 64);
+      for (u32& addr : pb_addrs)
+        addr = static_cast<u32>(rng());
+
+      std::array<u32, NUM_BUFFERS> buffer_lengths;
+      for (u32& length : buffer_lengths)
+        length = 1 + rng() % 160;
+
+      // Mixes samples which depend on the PB into every buffer.
+      const auto process_pb = [&](u32 addr, const AXBuffers& buffers) {
+        std::mt19937 pb_rng(addr);
+        for (size_t i = 0; i < NUM_BUFFERS; ++i)
+        {
+          for (u32 j = 0; j < buffer_lengths[i]; ++j)
+            buffers.ptrs[i][j] += static_cast<s16>(pb_rng());
+        }
+      };
+
+      std::array<std::vector<int>, NUM_BUFFERS> expected;
+      std::array<std::vector<int>, NUM_BUFFERS> actual;
+      AXBuffers expected_buffers;
+      AXBuffers actual_buffers;
+      for (size_t i = 0; i < NUM_BUFFERS; ++i)
+      {
+        expected[i].resize(buffer_lengths[i]);
+        for (int& sample : expected[i])
+          sample = static_cast<s16>(rng());
+        actual[i] = expected[i];
+        expected_buffers.ptrs[i] = expected[i].data();
+        actual_buffers.ptrs[i] = actual[i].data();
+      }
+
+      for (u32 addr : pb_addrs)
+        process_pb(addr, expected_buffers);
+      ProcessPBsInParallel(pool, pb_addrs, actual_buffers, buffer_lengths.data(), partial_buffers,
+                           process_pb);
+
+      ASSERT_EQ(expected, actual);
+    }
+  }
+}
@@ -2,7 +2,10 @@
 // Licensed under GPLv2+
 // Refer to the license.txt file included.
 
+#include <algorithm>
 #include <array>
+#include <random>
+#include <vector>
 
 #include <gtest/gtest.h>
 
@@ -186,3 +189,110 @@ TEST(DSPAccelerator, CurrentAddressSkips)
   accelerator.TestRead();
   EXPECT_EQ(accelerator.GetCurrentAddress(), 0x00000013u);
 }
+
+// Accelerator reading from a buffer of random data, which restarts reads when it loops.
+class MemoryAccelerator : public DSP::Accelerator
+{
+public:
+  MemoryAccelerator(const std::vector<u8>& memory, bool looping)
+      : m_memory(memory), m_looping(looping)
+  {
+  }
+
+  u32 GetEndExceptionCount() const { return m_end_exceptions; }
+
+protected:
+  void OnEndException() override
+  {
+    ++m_end_exceptions;
+    if (m_looping)
+      SetYn2(GetYn2());
+  }
+  u8 ReadMemory(u32 address) override { return m_memory[address & (m_memory.size() - 1)]; }
+  void WriteMemory(u32 address, u8 value) override {}
+
+private:
+  const std::vector<u8>& m_memory;
+  bool m_looping;
+  u32 m_end_exceptions = 0;
+};
+
+// Checks that ReadSamples gives the same results as calling Read() repeatedly, for random
+// addresses starting at <base>.
+static void CheckReadSamplesMatchesRead(u32 base)
+{
+  std::mt19937 rng(0);
+  std::vector<u8> memory(0x1000);
+  for (u8& byte : memory)
+    byte = static_cast<u8>(rng());
+
+  constexpr std::array<u16, 3> formats{{0x00, 0x0A, 0x19}};
+  for (int iteration = 0; iteration < 3000; ++iteration)
+  {
+    const bool looping = iteration & 1;
+    MemoryAccelerator expected(memory, looping);
+    MemoryAccelerator accelerator(memory, looping);
+
+    std::array<s16, 16> coefs;
+    for (s16& coef : coefs)
+      coef = static_cast<s16>(rng() % 0x1000) - 0x800;
+
+    const u32 start = base + rng() % 0x1000;
+    const u32 end = start + 1 + rng() % 0x200;
+    const u32 current = start + rng() % (end - start);
+    const u16 format = formats[rng() % formats.size()];
+    const u16 pred_scale = static_cast<u16>(rng());
+    const s16 yn1 = static_cast<s16>(rng());
+    const s16 yn2 = static_cast<s16>(rng());
+    for (MemoryAccelerator* acc : {&expected, &accelerator})
+    {
+      acc->SetStartAddress(start);
+      acc->SetEndAddress(end);
+      acc->SetCurrentAddress(current);
+      acc->SetSampleFormat(format);
+      acc->SetPredScale(pred_scale);
+      acc->SetYn1(yn1);
+      acc->SetYn2(yn2);
+    }
+
+    std::vector<s16> expected_samples(1 + rng() % 0x400);
+    for (s16& sample : expected_samples)
+      sample = static_cast<s16>(expected.Read(coefs.data()));
+
+    std::vector<s16> samples(expected_samples.size());
+    u32 i = 0;
+    while (i < samples.size())
+    {
+      const u32 count = std::min<u32>(static_cast<u32>(samples.size()) - i, 1 + rng() % 0x80);
+      const u32 exceptions = accelerator.GetEndExceptionCount();
+      const u32 read = accelerator.ReadSamples(coefs.data(), &samples[i], count);
+      ASSERT_GE(read, 1u);
+      ASSERT_LE(read, count);
+      // Reads only stop early right after an end exception.
+      if (read < count)
+        ASSERT_EQ(exceptions + 1, accelerator.GetEndExceptionCount());
+      i += read;
+    }
+
+    ASSERT_EQ(expected_samples, samples);
+    ASSERT_EQ(expected.GetCurrentAddress(), accelerator.GetCurrentAddress());
+    ASSERT_EQ(expected.GetYn1(), accelerator.GetYn1());
+    ASSERT_EQ(expected.GetYn2(), accelerator.GetYn2());
+    ASSERT_EQ(expected.GetPredScale(), accelerator.GetPredScale());
+    ASSERT_EQ(expected.GetEndExceptionCount(), accelerator.GetEndExceptionCount());
+  }
+}
+
+TEST(DSPAccelerator, ReadSamplesMatchesRead)
+{
+  CheckReadSamplesMatchesRead(0);
+}
+
+// The current address is masked after every sample, so runs near the top of the address space
+// must wrap around just like single reads do. The end address can also be masked to below the
+// current address there, in which case reads go on until the current address wraps.
+TEST(DSPAccelerator, ReadSamplesMatchesReadAtMaskedAddresses)
+{
+  CheckReadSamplesMatchesRead(0x3ffff800);
+  CheckReadSamplesMatchesRead(0xbffff800);
+}
@@ -0,0 +1,79 @@
+// Copyright 2019 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <array>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "Common/CommonTypes.h"
+#include "Core/DSP/DSPAnalyzer.h"
+#include "Core/DSP/DSPCore.h"
+#include "Core/DSP/DSPTables.h"
+
+using namespace DSP;
+
+class DSPAnalyzerTest : public testing::Test
+{
+protected:
+  DSPAnalyzerTest()
+  {
+    InitInstructionTable();
+    m_old_iram = g_dsp.iram;
+    m_old_irom = g_dsp.irom;
+    g_dsp.iram = m_iram.data();
+    g_dsp.irom = m_irom.data();
+  }
+
+  virtual ~DSPAnalyzerTest()
+  {
+    g_dsp.iram = m_old_iram;
+    g_dsp.irom = m_old_irom;
+  }
+
+  // Places <code> at <address> in IRAM, followed by a jump back to <address>
+  u8 AnalyzeLoop(u16 address, std::vector<u16> code)
+  {
+    code.push_back(0x029f);  // JMP
+    code.push_back(address);
+    std::copy(code.begin(), code.end(), m_iram.begin() + address);
+    Analyzer::Analyze();
+    return Analyzer::GetCodeFlags(address);
+  }
+
+  std::array<u16, DSP_IRAM_SIZE> m_iram{};
+  std::array<u16, DSP_IROM_SIZE> m_irom{};
+  u16* m_old_iram;
+  u16* m_old_irom;
+};
+
+TEST_F(DSPAnalyzerTest, MailboxPollsCanBeParked)
+{
+  // AX: waiting for the CPU to read the DSP mailbox
+  const u8 ax_flags = AnalyzeLoop(0x100, {0x26fc, 0x02a0, 0x8000, 0x029c, 0x0100});
+  EXPECT_TRUE(ax_flags & Analyzer::CODE_IDLE_SKIP);
+  EXPECT_TRUE(ax_flags & Analyzer::CODE_MAILBOX_POLL);
+
+  // Zelda: waiting for mail from the CPU
+  const u8 zelda_flags = AnalyzeLoop(0x200, {0x00de, 0xfffe, 0x02c0, 0x8000, 0x029c, 0x0200});
+  EXPECT_TRUE(zelda_flags & Analyzer::CODE_IDLE_SKIP);
+  EXPECT_TRUE(zelda_flags & Analyzer::CODE_MAILBOX_POLL);
+}
+
+TEST_F(DSPAnalyzerTest, DRAMPollIsNotParked)
+{
+  // Zelda: waiting for a flag in DRAM, which the DSP's own exception handlers can set. The DSP
+  // may only be given its slice back early, not parked until the CPU writes a mailbox.
+  const u8 flags = AnalyzeLoop(0x300, {0x00da, 0x0352, 0x8600, 0x0295, 0x0300});
+  EXPECT_TRUE(flags & Analyzer::CODE_IDLE_SKIP);
+  EXPECT_FALSE(flags & Analyzer::CODE_MAILBOX_POLL);
+}
+
+TEST_F(DSPAnalyzerTest, OtherLoopsAreNotIdle)
+{
+  // LRS $AC0.M, @DMBH; ANDF $AC0.M, #0x4000 polls a different bit
+  const u8 flags = AnalyzeLoop(0x400, {0x26fc, 0x02a0, 0x4000, 0x029c, 0x0400});
+  EXPECT_FALSE(flags & Analyzer::CODE_IDLE_SKIP);
+  EXPECT_FALSE(flags & Analyzer::CODE_MAILBOX_POLL);
+}
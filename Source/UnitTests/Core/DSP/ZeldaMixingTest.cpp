@@ -0,0 +1,282 @@
+// Copyright 2019 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <array>
+#include <random>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "Common/CommonTypes.h"
+#include "Core/HW/DSPHLE/UCodes/Zelda.h"
+
+using namespace DSP::HLE;
+
+// Per-sample versions of the Zelda UCode processing, as originally implemented by the renderer.
+// The block based implementations must match them exactly.
+namespace Reference
+{
+static void ApplyVolumeInPlace(s16* buf, size_t count, u16 vol, u32 int_bits)
+{
+  for (size_t i = 0; i < count; ++i)
+  {
+    s32 tmp = (u32)buf[i] * (u32)vol;
+    tmp >>= 16 - int_bits;
+    buf[i] = (s16)std::clamp(tmp, -0x8000, 0x7FFF);
+  }
+}
+
+static s32 AddBuffersWithVolumeRamp(s16* dst, const s16* src, size_t count, s32 vol, s32 step)
+{
+  for (size_t i = 0; i < count; ++i)
+  {
+    dst[i] += ((vol >> 16) * src[i]) >> 16;
+    vol += step;
+  }
+  return vol;
+}
+
+static void AddBuffersWithVolume(s16* dst, const s16* src, size_t count, u16 vol)
+{
+  while (count--)
+  {
+    s32 vol_src = ((s32)*src++ * (s32)vol) >> 15;
+    *dst++ += std::clamp(vol_src, -0x8000, 0x7FFF);
+  }
+}
+
+static void Resample(s16* dst, size_t count, const s16* src, u32* pos, u32 ratio,
+                     const s16* resampling_coeffs)
+{
+  for (size_t n = 0; n < count; ++n)
+  {
+    u32 coeffs_idx = ((*pos & 0xFFF) >> 6) * 4;
+    const s16* coeffs = &resampling_coeffs[coeffs_idx];
+    const s16* input = &src[*pos >> 12];
+
+    s64 dst_sample_unclamped = 0;
+    for (size_t i = 0; i < 4; ++i)
+      dst_sample_unclamped += (s64)2 * coeffs[i] * input[i];
+    dst_sample_unclamped >>= 16;
+
+    dst[n] = (s16)std::clamp<s64>(dst_sample_unclamped, -0x8000, 0x7FFF);
+
+    *pos += ratio;
+  }
+}
+
+static void ApplyReverbFilter(s16* buffer, size_t count, const s16* coeffs)
+{
+  for (size_t i = 0; i < count; ++i)
+  {
+    s32 sample = 0;
+    for (u16 j = 0; j < 8; ++j)
+      sample += (s32)buffer[i + j] * coeffs[j];
+    sample >>= 15;
+    buffer[i] = std::clamp(sample, -0x8000, 0x7FFF);
+  }
+}
+
+static void DecodeAFCBlock(s16* dst, const u8* src, bool hq, const s16* afc_coeffs, s16* yn1_ptr,
+                           s16* yn2_ptr)
+{
+  s16 nibbles[16];
+  s16 delta = 1 << ((*src >> 4) & 0xF);
+  s16 idx = (*src & 0xF);
+  src++;
+
+  if (hq)
+  {
+    for (size_t i = 0; i < 16; i += 2)
+    {
+      nibbles[i + 0] = *src >> 4;
+      nibbles[i + 1] = *src & 0xF;
+      src++;
+    }
+    for (auto& nibble : nibbles)
+    {
+      if (nibble >= 8)
+        nibble -= 16;
+      nibble <<= 11;
+    }
+  }
+  else
+  {
+    for (size_t i = 0; i < 16; i += 4)
+    {
+      nibbles[i + 0] = (*src >> 6) & 3;
+      nibbles[i + 1] = (*src >> 4) & 3;
+      nibbles[i + 2] = (*src >> 2) & 3;
+      nibbles[i + 3] = (*src >> 0) & 3;
+      src++;
+    }
+    for (auto& nibble : nibbles)
+    {
+      if (nibble >= 2)
+        nibble -= 4;
+      nibble <<= 13;
+    }
+  }
+
+  s32 yn1 = *yn1_ptr, yn2 = *yn2_ptr;
+  for (size_t i = 0; i < 16; ++i)
+  {
+    s32 sample =
+        delta * nibbles[i] + yn1 * afc_coeffs[idx * 2] + yn2 * afc_coeffs[idx * 2 + 1];
+    sample >>= 11;
+    sample = std::clamp(sample, -0x8000, 0x7fff);
+    *dst++ = (s16)sample;
+    yn2 = yn1;
+    yn1 = sample;
+  }
+
+  *yn2_ptr = yn2;
+  *yn1_ptr = yn1;
+}
+}  // namespace Reference
+
+static s16 RandomSample(std::mt19937& rng, bool extremes)
+{
+  if (extremes && (rng() & 3) == 0)
+    return (rng() & 1) ? -0x8000 : 0x7FFF;
+  return static_cast<s16>(rng());
+}
+
+TEST(ZeldaMixing, ApplyVolumeMatchesReference)
+{
+  std::mt19937 rng(0);
+  for (int iteration = 0; iteration < 10000; ++iteration)
+  {
+    std::array<s16, 0x50> expected;
+    for (s16& sample : expected)
+      sample = RandomSample(rng, iteration & 1);
+    std::array<s16, 0x50> buffer = expected;
+
+    const size_t count = 1 + rng() % expected.size();
+    const u16 vol = static_cast<u16>(rng());
+    const u32 int_bits = (rng() & 1) ? 1 : 4;
+    Reference::ApplyVolumeInPlace(expected.data(), count, vol, int_bits);
+    ZeldaMixing::ApplyVolumeInPlace(buffer.data(), count, vol, int_bits);
+
+    ASSERT_EQ(expected, buffer);
+  }
+}
+
+TEST(ZeldaMixing, AddBuffersMatchesReference)
+{
+  std::mt19937 rng(1);
+  for (int iteration = 0; iteration < 10000; ++iteration)
+  {
+    std::array<s16, 0x50> src;
+    for (s16& sample : src)
+      sample = RandomSample(rng, iteration & 1);
+    std::array<s16, 0x50> expected;
+    for (s16& sample : expected)
+      sample = RandomSample(rng, iteration & 1);
+    std::array<s16, 0x50> dst = expected;
+
+    const size_t count = 1 + rng() % src.size();
+    if (rng() & 1)
+    {
+      const u16 vol = static_cast<u16>(rng());
+      Reference::AddBuffersWithVolume(expected.data(), src.data(), count, vol);
+      ZeldaMixing::AddBuffersWithVolume(dst.data(), src.data(), count, vol);
+    }
+    else
+    {
+      // Volumes and steps as computed by the renderer from 16 bit volumes.
+      const s16 current_volume = static_cast<s16>(rng());
+      const s16 volume_delta = static_cast<s16>(rng()) / 2;
+      const s32 step = (volume_delta << 16) / static_cast<s32>(count);
+      const s32 expected_vol = Reference::AddBuffersWithVolumeRamp(
+          expected.data(), src.data(), count, current_volume << 16, step);
+      const s32 vol = ZeldaMixing::AddBuffersWithVolumeRamp(dst.data(), src.data(), count,
+                                                            current_volume << 16, step);
+      ASSERT_EQ(expected_vol, vol);
+    }
+
+    ASSERT_EQ(expected, dst);
+  }
+}
+
+TEST(ZeldaMixing, ReverbFilterMatchesReference)
+{
+  std::mt19937 rng(2);
+  for (int iteration = 0; iteration < 10000; ++iteration)
+  {
+    std::array<s16, 0x58> expected;
+    for (s16& sample : expected)
+      sample = RandomSample(rng, iteration & 1);
+    std::array<s16, 0x58> buffer = expected;
+    s16 coeffs[8];
+    for (s16& coeff : coeffs)
+      coeff = RandomSample(rng, iteration & 2);
+
+    Reference::ApplyReverbFilter(expected.data(), 0x50, coeffs);
+    ZeldaMixing::ApplyReverbFilter(buffer.data(), 0x50, coeffs);
+
+    ASSERT_EQ(expected, buffer);
+  }
+}
+
+// Runs a voice through AFC decoding and resampling, as the renderer does for a voice on each
+// frame, and checks that every frame of output and the voice state match the reference.
+TEST(ZeldaMixing, AFCVoiceMatchesReference)
+{
+  std::mt19937 rng(3);
+
+  std::array<s16, 0x20> afc_coeffs;
+  for (s16& coeff : afc_coeffs)
+    coeff = static_cast<s16>(rng() % 0x1000) - 0x800;
+  std::array<s16, 0x100> resampling_coeffs;
+  for (s16& coeff : resampling_coeffs)
+    coeff = RandomSample(rng, true);
+
+  for (int voice = 0; voice < 200; ++voice)
+  {
+    const bool hq = voice & 1;
+    const size_t block_size = hq ? 9 : 5;
+    // Resampling ratios up to 4:1 use the interpolating resampler.
+    const u32 ratio = 1 + rng() % 0x3FFF;
+
+    s16 expected_yn1 = 0, expected_yn2 = 0, yn1 = 0, yn2 = 0;
+    u32 expected_pos = rng() & 0xFFF;
+    u32 pos = expected_pos;
+
+    for (int frame = 0; frame < 20; ++frame)
+    {
+      // Enough blocks for 0x50 output samples, plus the 4 samples of filter history.
+      const u32 raw_count = ((expected_pos + 0x50 * ratio) >> 12) + 4;
+      const size_t block_count = (raw_count + 15) / 16;
+
+      std::vector<u8> afc_data(block_count * block_size);
+      for (u8& byte : afc_data)
+        byte = static_cast<u8>(rng());
+
+      std::vector<s16> expected_raw(block_count * 16), raw(block_count * 16);
+      for (size_t b = 0; b < block_count; ++b)
+      {
+        Reference::DecodeAFCBlock(&expected_raw[b * 16], &afc_data[b * block_size], hq,
+                                  afc_coeffs.data(), &expected_yn1, &expected_yn2);
+        ZeldaMixing::DecodeAFCBlock(&raw[b * 16], &afc_data[b * block_size], hq,
+                                    afc_coeffs.data(), &yn1, &yn2);
+      }
+      ASSERT_EQ(expected_raw, raw);
+      ASSERT_EQ(expected_yn1, yn1);
+      ASSERT_EQ(expected_yn2, yn2);
+
+      std::array<s16, 0x50> expected_out, out;
+      Reference::Resample(expected_out.data(), expected_out.size(), expected_raw.data(),
+                          &expected_pos, ratio, resampling_coeffs.data());
+      ZeldaMixing::Resample(out.data(), out.size(), raw.data(), &pos, ratio,
+                            resampling_coeffs.data());
+      ASSERT_EQ(expected_out, out);
+      ASSERT_EQ(expected_pos, pos);
+
+      expected_pos &= 0xFFF;
+      pos &= 0xFFF;
+    }
+  }
+}
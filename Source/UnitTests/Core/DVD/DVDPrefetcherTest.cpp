@@ -0,0 +1,156 @@
+// Copyright 2019 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <optional>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include "Common/CommonTypes.h"
+#include "Common/FileUtil.h"
+#include "Core/HW/DVD/DVDPrefetcher.h"
+#include "DiscIO/Volume.h"
+
+using DVDThread::Prefetcher;
+
+namespace
+{
+constexpr u64 LOOKAHEAD_US = 1000000;
+constexpr DiscIO::Partition PARTITION(0x50000);
+}  // namespace
+
+TEST(DVDPrefetcher, NothingToDoForRandomReads)
+{
+  Prefetcher prefetcher(LOOKAHEAD_US);
+  EXPECT_FALSE(prefetcher.GetNextPrefetch());
+
+  prefetcher.OnRead(PARTITION, 0x10000, 0x8000, 0);
+  prefetcher.OnRead(PARTITION, 0x90000, 0x8000, 10);
+  prefetcher.OnRead(DiscIO::PARTITION_NONE, 0x98000, 0x8000, 20);
+  EXPECT_FALSE(prefetcher.GetNextPrefetch());
+}
+
+TEST(DVDPrefetcher, ReadsAheadOfSequentialReads)
+{
+  Prefetcher prefetcher(LOOKAHEAD_US);
+  prefetcher.OnRead(PARTITION, 0x10000, 0x8000, 0);
+  prefetcher.OnRead(PARTITION, 0x18000, 0x8000, 10);
+
+  u64 expected_offset = 0x20000;
+  while (const std::optional<Prefetcher::Range> range = prefetcher.GetNextPrefetch())
+  {
+    EXPECT_EQ(PARTITION, range->partition);
+    EXPECT_EQ(expected_offset, range->offset);
+    EXPECT_LE(range->length, Prefetcher::MAX_PREFETCH_SIZE);
+    expected_offset += range->length;
+  }
+  EXPECT_EQ(0x20000 + Prefetcher::READ_AHEAD_SIZE, expected_offset);
+
+  // Reading what was prefetched only extends the window by the amount that was read
+  prefetcher.OnRead(PARTITION, 0x20000, 0x8000, 20);
+  const std::optional<Prefetcher::Range> range = prefetcher.GetNextPrefetch();
+  ASSERT_TRUE(range);
+  EXPECT_EQ(0x20000 + Prefetcher::READ_AHEAD_SIZE, range->offset);
+  EXPECT_EQ(0x8000u, range->length);
+  EXPECT_FALSE(prefetcher.GetNextPrefetch());
+
+  // Seeking elsewhere ends the stream
+  prefetcher.OnRead(PARTITION, 0x400000, 0x8000, 30);
+  EXPECT_FALSE(prefetcher.GetNextPrefetch());
+}
+
+TEST(DVDPrefetcher, RecordsMergedAccessLog)
+{
+  Prefetcher prefetcher(LOOKAHEAD_US);
+  prefetcher.SetRecording(true);
+  prefetcher.OnRead(PARTITION, 0x10000, 0x8000, 500);
+  prefetcher.OnRead(PARTITION, 0x18000, 0x8000, 600);
+  prefetcher.OnRead(DiscIO::PARTITION_NONE, 0x18000, 0x20, 700);
+
+  const auto& log = prefetcher.GetAccessLog();
+  ASSERT_EQ(2u, log.size());
+  EXPECT_EQ(0u, log[0].time_us);
+  EXPECT_EQ(PARTITION.offset, log[0].partition_offset);
+  EXPECT_EQ(0x10000u, log[0].offset);
+  EXPECT_EQ(0x10000u, log[0].length);
+  EXPECT_EQ(200u, log[1].time_us);
+  EXPECT_EQ(DiscIO::PARTITION_NONE.offset, log[1].partition_offset);
+  EXPECT_EQ(200u, prefetcher.GetRecordedDuration());
+}
+
+TEST(DVDPrefetcher, ReplaysAccessLog)
+{
+  const std::string temp_dir = File::CreateTempDir();
+  const std::string path = temp_dir + "/access.dvdlog";
+
+  {
+    Prefetcher recorder(LOOKAHEAD_US);
+    recorder.SetRecording(true);
+    recorder.OnRead(PARTITION, 0x0, 0x20, 0);
+    recorder.OnRead(PARTITION, 0x100000, 0x30000, 500000);
+    recorder.OnRead(PARTITION, 0x800000, 0x8000, 3000000);
+    ASSERT_TRUE(recorder.SaveAccessLog(path));
+  }
+
+  Prefetcher prefetcher(LOOKAHEAD_US);
+  ASSERT_TRUE(prefetcher.LoadAccessLog(path));
+  File::DeleteDirRecursively(temp_dir);
+  EXPECT_EQ(3000000u, prefetcher.GetReplayedDuration());
+
+  // Only what is within a second of emulated time gets prefetched, in pieces of limited size
+  prefetcher.OnRead(PARTITION, 0x0, 0x20, 1000);
+  std::optional<Prefetcher::Range> range = prefetcher.GetNextPrefetch();
+  ASSERT_TRUE(range);
+  EXPECT_EQ(0x0u, range->offset);
+  range = prefetcher.GetNextPrefetch();
+  ASSERT_TRUE(range);
+  EXPECT_EQ(0x100000u, range->offset);
+  EXPECT_EQ(Prefetcher::MAX_PREFETCH_SIZE, range->length);
+  range = prefetcher.GetNextPrefetch();
+  ASSERT_TRUE(range);
+  EXPECT_EQ(0x100000u + Prefetcher::MAX_PREFETCH_SIZE, range->offset);
+  EXPECT_EQ(0x30000u - Prefetcher::MAX_PREFETCH_SIZE, range->length);
+  EXPECT_FALSE(prefetcher.GetNextPrefetch());
+
+  prefetcher.OnRead(PARTITION, 0x700000, 0x20, 2500000);
+  range = prefetcher.GetNextPrefetch();
+  ASSERT_TRUE(range);
+  EXPECT_EQ(0x800000u, range->offset);
+  EXPECT_FALSE(prefetcher.GetNextPrefetch());
+}
+
+TEST(DVDPrefetcher, WritesBigEndianAccessLog)
+{
+  const std::string temp_dir = File::CreateTempDir();
+  const std::string path = temp_dir + "/access.dvdlog";
+
+  Prefetcher prefetcher(LOOKAHEAD_US);
+  prefetcher.SetRecording(true);
+  prefetcher.OnRead(PARTITION, 0x123456789, 0x20, 0);
+  ASSERT_TRUE(prefetcher.SaveAccessLog(path));
+
+  std::string data;
+  ASSERT_TRUE(File::ReadFileToString(path, data));
+  File::DeleteDirRecursively(temp_dir);
+
+  const std::string expected("DVDL\0\0\0\2"
+                             "\0\0\0\0\0\0\0\0"
+                             "\0\0\0\0\0\5\0\0"
+                             "\0\0\0\1\x23\x45\x67\x89"
+                             "\0\0\0\x20",
+                             36);
+  EXPECT_EQ(expected, data);
+}
+
+TEST(DVDPrefetcher, RejectsInvalidAccessLog)
+{
+  const std::string temp_dir = File::CreateTempDir();
+  const std::string path = temp_dir + "/access.dvdlog";
+  ASSERT_TRUE(File::WriteStringToFile(path, "not an access log"));
+
+  Prefetcher prefetcher(LOOKAHEAD_US);
+  EXPECT_FALSE(prefetcher.LoadAccessLog(path));
+  EXPECT_FALSE(prefetcher.LoadAccessLog(temp_dir + "/missing.dvdlog"));
+  File::DeleteDirRecursively(temp_dir);
+}
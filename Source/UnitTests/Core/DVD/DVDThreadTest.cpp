@@ -0,0 +1,143 @@
+// Copyright 2019 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "Common/CommonTypes.h"
+#include "Common/Config/Config.h"
+#include "Common/FileUtil.h"
+#include "Common/Flag.h"
+#include "Common/Logging/LogManager.h"
+#include "Core/ConfigLoaders/BaseConfigLoader.h"
+#include "Core/ConfigManager.h"
+#include "Core/Core.h"
+#include "Core/CoreTiming.h"
+#include "Core/HW/DVD/DVDInterface.h"
+#include "Core/HW/DVD/DVDThread.h"
+#include "Core/PowerPC/PowerPC.h"
+#include "DiscIO/Blob.h"
+#include "DiscIO/VolumeGC.h"
+#include "UICommon/UICommon.h"
+
+namespace
+{
+constexpr u64 DISC_SIZE = 0x400000;
+// Two sequential reads, which make the DVD thread prefetch what comes after them
+constexpr u64 FIRST_READ_OFFSET = 0x10000;
+constexpr u32 READ_LENGTH = 0x8000;
+constexpr u64 PREFETCH_OFFSET = FIRST_READ_OFFSET + 2 * READ_LENGTH;
+
+// Reads of all TestBlobReaders which haven't returned yet
+std::atomic<int> s_reads_in_progress{0};
+
+// A GameCube disc in memory whose reads take long enough for the DVD thread to still be
+// prefetching when the test replaces the disc
+class TestBlobReader final : public DiscIO::BlobReader
+{
+public:
+  TestBlobReader() : m_data(DISC_SIZE)
+  {
+    // GameCube magic word
+    const u8 magic[] = {0xc2, 0x33, 0x9f, 0x3d};
+    std::memcpy(&m_data[0x1c], magic, sizeof(magic));
+  }
+
+  ~TestBlobReader()
+  {
+    // Gives a DVD thread which is wrongly running while the disc is replaced time to start reading
+    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    EXPECT_EQ(0, s_reads_in_progress.load());
+  }
+
+  DiscIO::BlobType GetBlobType() const override { return DiscIO::BlobType::PLAIN; }
+  u64 GetRawSize() const override { return m_data.size(); }
+  u64 GetDataSize() const override { return m_data.size(); }
+  bool IsDataSizeAccurate() const override { return true; }
+
+  bool Read(u64 offset, u64 size, u8* out_ptr) override
+  {
+    ++s_reads_in_progress;
+    if (offset >= PREFETCH_OFFSET)
+      prefetch_started.Set();
+
+    std::this_thread::sleep_for(std::chrono::microseconds(200));
+    const bool success = offset + size <= m_data.size();
+    if (success)
+      std::memcpy(out_ptr, &m_data[offset], static_cast<size_t>(size));
+
+    --s_reads_in_progress;
+    return success;
+  }
+
+  Common::Flag prefetch_started;
+
+private:
+  std::vector<u8> m_data;
+};
+}  // namespace
+
+class DVDThreadTest : public testing::Test
+{
+protected:
+  DVDThreadTest() : m_profile_path(File::CreateTempDir())
+  {
+    Core::DeclareAsCPUThread();
+    UICommon::SetUserDirectory(m_profile_path);
+    Config::Init();
+    Config::AddLayer(ConfigLoaders::GenerateBaseConfigLoader());
+    SConfig::Init();
+    // The DVD thread checks whether file accesses should be logged
+    LogManager::Init();
+    PowerPC::Init(PowerPC::CPUCore::Interpreter);
+    CoreTiming::Init();
+    DVDThread::Start();
+  }
+
+  virtual ~DVDThreadTest()
+  {
+    DVDThread::Stop();
+    CoreTiming::Shutdown();
+    PowerPC::Shutdown();
+    LogManager::Shutdown();
+    SConfig::Shutdown();
+    Config::Shutdown();
+    Core::UndeclareAsCPUThread();
+    File::DeleteDirRecursively(m_profile_path);
+  }
+
+  std::string m_profile_path;
+};
+
+TEST_F(DVDThreadTest, SetDiscWhilePrefetching)
+{
+  for (int i = 0; i < 20; ++i)
+  {
+    auto reader = std::make_unique<TestBlobReader>();
+    TestBlobReader* const reader_ptr = reader.get();
+    DVDThread::SetDisc(std::make_unique<DiscIO::VolumeGC>(std::move(reader)));
+
+    for (u64 offset = FIRST_READ_OFFSET; offset < PREFETCH_OFFSET; offset += READ_LENGTH)
+    {
+      DVDThread::StartRead(offset, READ_LENGTH, DiscIO::PARTITION_NONE,
+                           DVDInterface::ReplyType::NoReply, 1000000);
+    }
+
+    // The old disc gets destroyed in the middle of the prefetch
+    const auto timeout = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (!reader_ptr->prefetch_started.IsSet() && std::chrono::steady_clock::now() < timeout)
+      std::this_thread::yield();
+    ASSERT_TRUE(reader_ptr->prefetch_started.IsSet());
+  }
+
+  DVDThread::SetDisc(nullptr);
+  EXPECT_FALSE(DVDThread::HasDisc());
+}
@@ -0,0 +1,89 @@
+// Copyright 2019 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <gtest/gtest.h>
+
+#include "Common/CommonTypes.h"
+#include "Core/PowerPC/JitCommon/FastmemFaultCounter.h"
+
+TEST(FastmemFaultCounter, UnknownAccessUsesFastmem)
+{
+  FastmemFaultCounter counter;
+  EXPECT_TRUE(counter.ShouldUseFastmem(0x80003100));
+}
+
+TEST(FastmemFaultCounter, SingleFaultKeepsFastmem)
+{
+  FastmemFaultCounter counter;
+  EXPECT_FALSE(counter.RecordFault(0x80003100));
+  EXPECT_TRUE(counter.ShouldUseFastmem(0x80003100));
+}
+
+TEST(FastmemFaultCounter, ThresholdDisablesFastmem)
+{
+  FastmemFaultCounter counter;
+  for (u32 i = 1; i < FastmemFaultCounter::THRESHOLD; ++i)
+    EXPECT_FALSE(counter.RecordFault(0x80003100));
+  EXPECT_TRUE(counter.RecordFault(0x80003100));
+
+  EXPECT_FALSE(counter.ShouldUseFastmem(0x80003100));
+  EXPECT_TRUE(counter.ShouldUseFastmem(0x80003104));
+}
+
+TEST(FastmemFaultCounter, FaultsAreCountedPerAddress)
+{
+  FastmemFaultCounter counter;
+  for (u32 i = 1; i < FastmemFaultCounter::THRESHOLD; ++i)
+  {
+    EXPECT_FALSE(counter.RecordFault(0x80003100));
+    EXPECT_FALSE(counter.RecordFault(0x80003104));
+  }
+  EXPECT_TRUE(counter.ShouldUseFastmem(0x80003100));
+  EXPECT_TRUE(counter.ShouldUseFastmem(0x80003104));
+}
+
+TEST(FastmemFaultCounter, CompilingAgesCountBackToFastmem)
+{
+  FastmemFaultCounter counter;
+  for (u32 i = 0; i < FastmemFaultCounter::THRESHOLD; ++i)
+    counter.RecordFault(0x80003100);
+
+  // The recompilation right after reaching the threshold is done without fastmem
+  ASSERT_FALSE(counter.ShouldUseFastmem(0x80003100));
+  counter.OnCompiled(0x80003100);
+
+  // The one after that tries fastmem again, but a single further fault is enough to go back
+  EXPECT_TRUE(counter.ShouldUseFastmem(0x80003100));
+  EXPECT_TRUE(counter.RecordFault(0x80003100));
+  EXPECT_FALSE(counter.ShouldUseFastmem(0x80003100));
+}
+
+TEST(FastmemFaultCounter, CompilingDoesNotAgeCountBelowThreshold)
+{
+  FastmemFaultCounter counter;
+  for (u32 i = 1; i < FastmemFaultCounter::THRESHOLD; ++i)
+    counter.RecordFault(0x80003100);
+  counter.OnCompiled(0x80003100);
+  counter.OnCompiled(0x80003100);
+
+  EXPECT_TRUE(counter.RecordFault(0x80003100));
+}
+
+TEST(FastmemFaultCounter, ForgetAndClearResetCounts)
+{
+  FastmemFaultCounter counter;
+  for (u32 i = 0; i < FastmemFaultCounter::THRESHOLD; ++i)
+  {
+    counter.RecordFault(0x80003100);
+    counter.RecordFault(0x80003104);
+  }
+
+  counter.Forget(0x80003100);
+  EXPECT_TRUE(counter.ShouldUseFastmem(0x80003100));
+  EXPECT_FALSE(counter.ShouldUseFastmem(0x80003104));
+
+  counter.Clear();
+  EXPECT_TRUE(counter.ShouldUseFastmem(0x80003104));
+  EXPECT_FALSE(counter.RecordFault(0x80003104));
+}
@@ -0,0 +1,214 @@
+// Copyright 2019 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "Common/CommonTypes.h"
+#include "Common/Config/Config.h"
+#include "Common/FileUtil.h"
+#include "Core/ConfigLoaders/BaseConfigLoader.h"
+#include "Core/ConfigManager.h"
+#include "Core/CoreTiming.h"
+#include "Core/HW/Memmap.h"
+#include "Core/PowerPC/PPCAnalyst.h"
+#include "Core/PowerPC/PowerPC.h"
+#include "UICommon/UICommon.h"
+
+namespace
+{
+constexpr u32 LOOP_ADDRESS = 0x3000;
+constexpr u32 FUNCTION_ADDRESS = 0x3100;
+
+// Encodings of the few instructions the tests need
+constexpr u32 DForm(u32 opcd, u32 rd, u32 ra, s16 simm)
+{
+  return (opcd << 26) | (rd << 21) | (ra << 16) | static_cast<u16>(simm);
+}
+constexpr u32 lwz(u32 rd, s16 d, u32 ra)
+{
+  return DForm(32, rd, ra, d);
+}
+constexpr u32 stw(u32 rs, s16 d, u32 ra)
+{
+  return DForm(36, rs, ra, d);
+}
+constexpr u32 stwu(u32 rs, s16 d, u32 ra)
+{
+  return DForm(37, rs, ra, d);
+}
+constexpr u32 addi(u32 rd, u32 ra, s16 simm)
+{
+  return DForm(14, rd, ra, simm);
+}
+constexpr u32 lis(u32 rd, s16 simm)
+{
+  return DForm(15, rd, 0, simm);
+}
+constexpr u32 cmpwi(u32 ra, s16 simm)
+{
+  return DForm(11, 0, ra, simm);
+}
+constexpr u32 mflr(u32 rd)
+{
+  return (31 << 26) | (rd << 21) | (8 << 16) | (339 << 1);
+}
+constexpr u32 mtlr(u32 rs)
+{
+  return (31 << 26) | (rs << 21) | (8 << 16) | (467 << 1);
+}
+constexpr u32 blr = 0x4e800020;
+// Branches with a displacement in bytes
+constexpr u32 bc(u32 bo, u32 bi, s32 displacement)
+{
+  return (16 << 26) | (bo << 21) | (bi << 16) | (static_cast<u32>(displacement) & 0xfffc);
+}
+constexpr u32 bne(s32 displacement)
+{
+  return bc(4, 2, displacement);
+}
+constexpr u32 bdnz(s32 displacement)
+{
+  return bc(16, 0, displacement);
+}
+constexpr u32 bl(s32 displacement)
+{
+  return (18 << 26) | (static_cast<u32>(displacement) & 0x3fffffc) | 1;
+}
+
+// Polls the interrupt cause register of the processor interface until it is non-zero
+const std::vector<u32> POLL_PI = {lis(4, -0x3400), lwz(3, 0x3000, 4), cmpwi(3, 0)};
+}  // namespace
+
+class PPCAnalystTest : public testing::Test
+{
+protected:
+  PPCAnalystTest() : m_profile_path(File::CreateTempDir())
+  {
+    UICommon::SetUserDirectory(m_profile_path);
+    Config::Init();
+    Config::AddLayer(ConfigLoaders::GenerateBaseConfigLoader());
+    SConfig::Init();
+    PowerPC::Init(PowerPC::CPUCore::Interpreter);
+    CoreTiming::Init();
+    Memory::Init();
+
+    m_analyzer.SetOption(PPCAnalyst::PPCAnalyzer::OPTION_BRANCH_FOLLOW);
+  }
+
+  virtual ~PPCAnalystTest()
+  {
+    Memory::Shutdown();
+    CoreTiming::Shutdown();
+    PowerPC::Shutdown();
+    SConfig::Shutdown();
+    Config::Shutdown();
+    File::DeleteDirRecursively(m_profile_path);
+  }
+
+  static void WriteCode(u32 address, const std::vector<u32>& code)
+  {
+    for (size_t i = 0; i < code.size(); ++i)
+      Memory::Write_U32(code[i], address + static_cast<u32>(i * 4));
+  }
+
+  // Analyzes a loop at LOOP_ADDRESS that ends with a branch back to its start
+  bool IsIdleLoop(const std::vector<u32>& code)
+  {
+    WriteCode(LOOP_ADDRESS, code);
+
+    PPCAnalyst::BlockStats stats;
+    PPCAnalyst::BlockRegStats gpa;
+    PPCAnalyst::BlockRegStats fpa;
+    PPCAnalyst::CodeBlock block;
+    block.m_stats = &stats;
+    block.m_gpa = &gpa;
+    block.m_fpa = &fpa;
+    PPCAnalyst::CodeBuffer buffer(32);
+
+    m_analyzer.Analyze(LOOP_ADDRESS, &block, &buffer, buffer.size());
+    for (u32 i = 0; i < block.m_num_instructions; ++i)
+    {
+      if (buffer[i].opinfo->type == OpType::Branch && buffer[i].branchTo == LOOP_ADDRESS)
+        return buffer[i].branchIsIdleLoop;
+    }
+    ADD_FAILURE() << "The loop does not branch back to its start";
+    return false;
+  }
+
+  // Loops around POLL_PI with <before> and <after> around it
+  bool IsIdlePoll(std::vector<u32> before, const std::vector<u32>& after)
+  {
+    std::vector<u32> code = std::move(before);
+    code.insert(code.end(), POLL_PI.begin(), POLL_PI.end());
+    code.insert(code.end(), after.begin(), after.end());
+    code.push_back(bne(-static_cast<s32>(code.size() * 4)));
+    return IsIdleLoop(code);
+  }
+
+  std::string m_profile_path;
+  PPCAnalyst::PPCAnalyzer m_analyzer;
+};
+
+TEST_F(PPCAnalystTest, AcceptsPlainPoll)
+{
+  EXPECT_TRUE(IsIdlePoll({}, {}));
+}
+
+TEST_F(PPCAnalystTest, AcceptsStackFrame)
+{
+  // The value is written to the new frame before it is read back
+  EXPECT_TRUE(IsIdlePoll({stwu(1, -16, 1)}, {stw(3, 8, 1), lwz(3, 8, 1), addi(1, 1, 16)}));
+}
+
+TEST_F(PPCAnalystTest, AcceptsPollThroughCall)
+{
+  // A leaf function with a stack frame, which gets inlined into the loop
+  WriteCode(FUNCTION_ADDRESS, {stwu(1, -16, 1), lis(4, -0x3400), lwz(3, 0x3000, 4),
+                               stw(3, 8, 1), lwz(3, 8, 1), addi(1, 1, 16), blr});
+  EXPECT_TRUE(IsIdleLoop({bl(FUNCTION_ADDRESS - LOOP_ADDRESS), cmpwi(3, 0), bne(-8)}));
+}
+
+TEST_F(PPCAnalystTest, AcceptsLinkRegisterWrittenInLoop)
+{
+  // LR is only read after the bl in the same iteration wrote it
+  EXPECT_TRUE(IsIdlePoll({bl(4), mflr(5), mtlr(5)}, {}));
+}
+
+TEST_F(PPCAnalystTest, RejectsStoreThroughOtherRegister)
+{
+  EXPECT_FALSE(IsIdlePoll({}, {stw(3, 0, 5)}));
+}
+
+TEST_F(PPCAnalystTest, RejectsStackSlotReadBeforeWrite)
+{
+  // A counter on the stack, which is different in every iteration
+  EXPECT_FALSE(IsIdlePoll({lwz(6, 8, 1), addi(6, 6, 1), stw(6, 8, 1)}, {}));
+}
+
+TEST_F(PPCAnalystTest, RejectsUnbalancedStackPointer)
+{
+  EXPECT_FALSE(IsIdlePoll({stwu(1, -16, 1)}, {}));
+  EXPECT_FALSE(IsIdlePoll({stwu(1, -16, 1)}, {addi(1, 1, 8)}));
+}
+
+TEST_F(PPCAnalystTest, RejectsLoadIntoStackPointer)
+{
+  // Follows a back chain that is set up before the loop
+  EXPECT_FALSE(IsIdlePoll({lwz(1, 0, 1)}, {}));
+  EXPECT_FALSE(IsIdlePoll({stw(1, 8, 1), lwz(1, 8, 1)}, {}));
+}
+
+TEST_F(PPCAnalystTest, RejectsLinkRegisterChangedInLoop)
+{
+  // LR is read before the loop writes it, so the value it had before the loop gets lost
+  EXPECT_FALSE(IsIdlePoll({mflr(5), addi(5, 5, 4), mtlr(5)}, {}));
+}
+
+TEST_F(PPCAnalystTest, RejectsCTRLoop)
+{
+  EXPECT_FALSE(IsIdleLoop({lis(4, -0x3400), lwz(3, 0x3000, 4), bdnz(-8)}));
+}
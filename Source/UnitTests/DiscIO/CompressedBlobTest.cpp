@@ -0,0 +1,79 @@
+// Copyright 2019 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "Common/CommonTypes.h"
+#include "Common/File.h"
+#include "Common/FileUtil.h"
+#include "DiscIO/Blob.h"
+
+namespace
+{
+constexpr u32 BLOCK_SIZE = 0x4000;
+constexpr u64 DATA_SIZE = 0x800000;
+}  // namespace
+
+class CompressedBlobTest : public testing::Test
+{
+protected:
+  CompressedBlobTest() : m_temp_dir{File::CreateTempDir()}, m_data(DATA_SIZE)
+  {
+    for (size_t i = 0; i < m_data.size(); ++i)
+      m_data[i] = static_cast<u8>(i / 3 + i / BLOCK_SIZE);
+
+    const std::string iso_path = m_temp_dir + "/disc.iso";
+    m_gcz_path = m_temp_dir + "/disc.gcz";
+    File::IOFile file(iso_path, "wb");
+    EXPECT_TRUE(file.WriteBytes(m_data.data(), m_data.size()));
+    file.Close();
+    EXPECT_TRUE(DiscIO::CompressFileToBlob(iso_path, m_gcz_path, 0, BLOCK_SIZE));
+  }
+
+  virtual ~CompressedBlobTest() { File::DeleteDirRecursively(m_temp_dir); }
+
+  void ExpectRead(DiscIO::BlobReader* reader, u64 offset, u64 size)
+  {
+    std::vector<u8> buffer(size);
+    ASSERT_TRUE(reader->Read(offset, size, buffer.data()));
+    EXPECT_TRUE(std::equal(buffer.begin(), buffer.end(), m_data.begin() + offset));
+  }
+
+  std::string m_temp_dir;
+  std::string m_gcz_path;
+  std::vector<u8> m_data;
+};
+
+TEST_F(CompressedBlobTest, ReadsAheadOfSequentialReads)
+{
+  std::unique_ptr<DiscIO::BlobReader> reader = DiscIO::CreateBlobReader(m_gcz_path);
+  ASSERT_TRUE(reader);
+  reader->SetReadQueueDepth(4);
+
+  for (u64 offset = 0; offset < DATA_SIZE; offset += 0x1000)
+    ExpectRead(reader.get(), offset, 0x1000);
+}
+
+TEST_F(CompressedBlobTest, ReadsHintedRanges)
+{
+  std::unique_ptr<DiscIO::BlobReader> reader = DiscIO::CreateBlobReader(m_gcz_path);
+  ASSERT_TRUE(reader);
+  EXPECT_FALSE(reader->HintWillNeed(0x100000, 0x40000));
+
+  reader->SetReadQueueDepth(4);
+  EXPECT_TRUE(reader->HintWillNeed(0x100000, 0x40000));
+  EXPECT_FALSE(reader->HintWillNeed(DATA_SIZE, 0x1000));
+
+  ExpectRead(reader.get(), 0x120000, 0x8000);
+  ExpectRead(reader.get(), 0x100123, 0x30000);
+  ExpectRead(reader.get(), DATA_SIZE - 0x5000, 0x5000);
+
+  // Destroying the reader right after hinting doesn't have to wait for the hinted blocks
+  EXPECT_TRUE(reader->HintWillNeed(0, DATA_SIZE));
+}
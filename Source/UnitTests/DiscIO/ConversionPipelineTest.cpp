@@ -0,0 +1,126 @@
+// Copyright 2019 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "Common/CommonTypes.h"
+#include "Common/File.h"
+#include "Common/FileUtil.h"
+#include "DiscIO/Blob.h"
+#include "DiscIO/ConversionPipeline.h"
+
+namespace
+{
+constexpr u32 BLOCK_SIZE = 0x4000;
+
+// Half of every block compresses well, the other half doesn't
+std::vector<u8> CreateTestData(size_t size)
+{
+  std::vector<u8> data(size);
+  u32 state = 1;
+  for (size_t i = 0; i < size; ++i)
+  {
+    state = state * 1103515245 + 12345;
+    data[i] = (i / (BLOCK_SIZE / 2)) % 2 ? static_cast<u8>(state >> 16) : static_cast<u8>(i / 7);
+  }
+  return data;
+}
+
+class RecordingOutput final : public DiscIO::ConversionOutput
+{
+public:
+  void ProcessBlock(DiscIO::ConversionBlock* block) const override { block->hash = 0x1234; }
+
+  bool WriteBlock(const DiscIO::ConversionBlock& block) override
+  {
+    EXPECT_EQ(0x1234u, block.hash);
+    EXPECT_EQ(m_data.size(), block.offset);
+    m_data.insert(m_data.end(), block.data.begin(), block.data.end());
+    return true;
+  }
+
+  std::vector<u8> m_data;
+};
+}  // namespace
+
+class ConversionPipelineTest : public testing::Test
+{
+protected:
+  ConversionPipelineTest() : m_temp_dir{File::CreateTempDir()} {}
+  virtual ~ConversionPipelineTest() { File::DeleteDirRecursively(m_temp_dir); }
+
+  std::string CreateDisc(const std::vector<u8>& data)
+  {
+    const std::string path = m_temp_dir + "/disc.iso";
+    File::IOFile file(path, "wb");
+    EXPECT_TRUE(file.WriteBytes(data.data(), data.size()));
+    return path;
+  }
+
+  std::string m_temp_dir;
+};
+
+TEST_F(ConversionPipelineTest, WritesBlocksInOrder)
+{
+  const std::vector<u8> data = CreateTestData(0x2000000 + 0x123);
+  std::unique_ptr<DiscIO::BlobReader> reader = DiscIO::CreateBlobReader(CreateDisc(data));
+  ASSERT_TRUE(reader);
+
+  RecordingOutput output;
+  u64 last_progress = 0;
+  ASSERT_TRUE(DiscIO::ConvertBlob(reader.get(), nullptr, BLOCK_SIZE, &output,
+                                  [&](u64 blocks_done, u64 num_blocks) {
+                                    EXPECT_GE(blocks_done, last_progress);
+                                    last_progress = blocks_done;
+                                    return true;
+                                  }));
+  EXPECT_EQ((data.size() + BLOCK_SIZE - 1) / BLOCK_SIZE, last_progress);
+
+  // The last block is padded with zeroes
+  ASSERT_EQ(last_progress * BLOCK_SIZE, output.m_data.size());
+  EXPECT_TRUE(std::equal(data.begin(), data.end(), output.m_data.begin()));
+  EXPECT_TRUE(std::all_of(output.m_data.begin() + data.size(), output.m_data.end(),
+                          [](u8 byte) { return byte == 0; }));
+}
+
+TEST_F(ConversionPipelineTest, CompressesAndDecompressesGCZ)
+{
+  const std::vector<u8> data = CreateTestData(0x1000000 + 0x123);
+  const std::string iso_path = CreateDisc(data);
+  const std::string gcz_path = m_temp_dir + "/disc.gcz";
+  const std::string decompressed_path = m_temp_dir + "/decompressed.iso";
+
+  ASSERT_TRUE(DiscIO::CompressFileToBlob(iso_path, gcz_path, 0, BLOCK_SIZE, nullptr, nullptr));
+  EXPECT_LT(File::GetSize(gcz_path), data.size());
+
+  std::unique_ptr<DiscIO::BlobReader> reader = DiscIO::CreateBlobReader(gcz_path);
+  ASSERT_TRUE(reader);
+  EXPECT_EQ(DiscIO::BlobType::GCZ, reader->GetBlobType());
+  ASSERT_EQ(data.size(), reader->GetDataSize());
+  std::vector<u8> read_data(data.size());
+  ASSERT_TRUE(reader->Read(0, read_data.size(), read_data.data()));
+  EXPECT_EQ(data, read_data);
+  reader.reset();
+
+  ASSERT_TRUE(DiscIO::DecompressBlobToFile(gcz_path, decompressed_path, nullptr, nullptr));
+  std::string decompressed;
+  ASSERT_TRUE(File::ReadFileToString(decompressed_path, decompressed));
+  EXPECT_TRUE(std::equal(data.begin(), data.end(), decompressed.begin(), decompressed.end(),
+                         [](u8 a, char b) { return a == static_cast<u8>(b); }));
+}
+
+TEST_F(ConversionPipelineTest, RemovesOutputWhenCancelled)
+{
+  const std::string iso_path = CreateDisc(CreateTestData(0x4000000));
+  const std::string gcz_path = m_temp_dir + "/disc.gcz";
+
+  const auto cancel = [](const std::string&, float percent, void*) { return percent == 0; };
+  EXPECT_FALSE(DiscIO::CompressFileToBlob(iso_path, gcz_path, 0, BLOCK_SIZE, cancel, nullptr));
+  EXPECT_FALSE(File::Exists(gcz_path));
+}
@@ -0,0 +1,238 @@
+// Copyright 2019 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <ctime>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <utime.h>
+#endif
+
+#include <gtest/gtest.h>
+
+#include "Common/CommonPaths.h"
+#include "Common/CommonTypes.h"
+#include "Common/File.h"
+#include "Common/FileUtil.h"
+#include "Common/StringUtil.h"
+#include "DiscIO/DirectoryBlob.h"
+
+using DiscIO::DirectoryBlobPartition;
+
+namespace
+{
+// Well before anything the tests write, so that the cache can tell unmodified files apart
+const s64 PAST_TIME = static_cast<s64>(std::time(nullptr)) - 1000;
+
+// Lets the tests change files without changing their modification times, or the other way around
+bool SetModificationTime(const std::string& path, s64 time)
+{
+#ifdef _WIN32
+  // Directories can only be opened with FILE_FLAG_BACKUP_SEMANTICS
+  const HANDLE handle =
+      CreateFile(UTF8ToTStr(path).c_str(), FILE_WRITE_ATTRIBUTES,
+                 FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING,
+                 FILE_FLAG_BACKUP_SEMANTICS, nullptr);
+  if (handle == INVALID_HANDLE_VALUE)
+    return false;
+
+  // 100 ns intervals since 1601
+  const u64 file_time = (static_cast<u64>(time) + 11644473600) * 10000000;
+  const FILETIME ft{static_cast<DWORD>(file_time), static_cast<DWORD>(file_time >> 32)};
+  const bool success = SetFileTime(handle, nullptr, nullptr, &ft) != 0;
+  CloseHandle(handle);
+  return success;
+#else
+  utimbuf times;
+  times.actime = static_cast<time_t>(time);
+  times.modtime = static_cast<time_t>(time);
+  return utime(path.c_str(), &times) == 0;
+#endif
+}
+
+void WriteFile(const std::string& path, size_t size, u8 seed)
+{
+  std::vector<u8> data(size);
+  for (size_t i = 0; i < data.size(); ++i)
+    data[i] = static_cast<u8>(i * 7 + seed);
+
+  File::IOFile file(path, "wb");
+  EXPECT_TRUE(file.WriteBytes(data.data(), data.size()));
+}
+}  // namespace
+
+class DirectoryBlobTest : public testing::Test
+{
+protected:
+  DirectoryBlobTest()
+      : m_temp_dir{File::CreateTempDir()}, m_root{m_temp_dir + "/disc/"},
+        m_cache_dir{m_temp_dir + "/Cache/DirectoryBlobs/"}
+  {
+    File::SetUserPath(D_CACHE_IDX, m_temp_dir + "/Cache/");
+
+    File::CreateFullPath(m_root + "sys/");
+    std::vector<u8> boot_bin(0x440);
+    // GameCube magic word
+    boot_bin[0x1c] = 0xc2;
+    boot_bin[0x1d] = 0x33;
+    boot_bin[0x1e] = 0x9f;
+    boot_bin[0x1f] = 0x3d;
+    File::IOFile(m_root + "sys/boot.bin", "wb").WriteBytes(boot_bin.data(), boot_bin.size());
+    WriteFile(m_root + "sys/main.dol", 0x100, 0);
+
+    File::CreateFullPath(m_root + "files/dir/");
+    WriteFile(m_root + "files/opening.bnr", 0x1960, 1);
+    WriteFile(m_root + "files/dir/a.bin", 0x8001, 2);
+    WriteFile(m_root + "files/dir/b.bin", 0x20, 3);
+    BackdateFiles();
+  }
+
+  virtual ~DirectoryBlobTest() { File::DeleteDirRecursively(m_temp_dir); }
+
+  void Backdate(const std::string& path_in_root)
+  {
+    EXPECT_TRUE(SetModificationTime(m_root + path_in_root, PAST_TIME));
+  }
+
+  void BackdateFiles()
+  {
+    const auto backdate_tree = [](const File::FSTEntry& entry, const auto& recurse) -> void {
+      EXPECT_TRUE(SetModificationTime(entry.physicalName, PAST_TIME));
+      for (const File::FSTEntry& child : entry.children)
+        recurse(child, recurse);
+    };
+    backdate_tree(File::ScanDirectoryTree(m_root + "files/", true), backdate_tree);
+  }
+
+  // Builds the partition twice, and checks that the second one was built from the cache that the
+  // first one wrote if and only if <cache_used> is set, and that both have the same data.
+  void BuildTwice(bool cache_used)
+  {
+    const DirectoryBlobPartition first(m_root, false);
+    const DirectoryBlobPartition second(m_root, false);
+    EXPECT_EQ(cache_used, second.WasFSTLoadedFromCache());
+    EXPECT_EQ(ReadAll(first), ReadAll(second));
+  }
+
+  std::vector<u8> ReadAll(const DirectoryBlobPartition& partition)
+  {
+    DiscIO::ContentFileCache file_cache;
+    std::vector<u8> data(partition.GetDataSize());
+    EXPECT_TRUE(partition.GetContents().Read(0, data.size(), data.data(), &file_cache));
+    return data;
+  }
+
+  // Changes something about the files directory, and checks that the cache gets rebuilt
+  // and then reused, and that the data is the same as without the cache.
+  template <typename ChangeFunction>
+  void ExpectRebuiltAfter(ChangeFunction change)
+  {
+    BuildTwice(true);
+    change();
+
+    const DirectoryBlobPartition rebuilt(m_root, false);
+    EXPECT_FALSE(rebuilt.WasFSTLoadedFromCache());
+
+    // Anything which the change left with a current modification time would stop the cache from
+    // being used, as it could have been modified again in the second that the cache was written.
+    BackdateFiles();
+    File::Delete(m_cache_dir + GetCacheFileName());
+    const DirectoryBlobPartition uncached(m_root, false);
+    const DirectoryBlobPartition cached(m_root, false);
+    EXPECT_FALSE(uncached.WasFSTLoadedFromCache());
+    EXPECT_TRUE(cached.WasFSTLoadedFromCache());
+    EXPECT_EQ(ReadAll(uncached), ReadAll(rebuilt));
+    EXPECT_EQ(ReadAll(uncached), ReadAll(cached));
+  }
+
+  std::string GetCacheFileName()
+  {
+    const File::FSTEntry cache_dir = File::ScanDirectoryTree(m_cache_dir, false);
+    EXPECT_EQ(1u, cache_dir.children.size());
+    return cache_dir.children.empty() ? "" : cache_dir.children[0].virtualName;
+  }
+
+  std::string m_temp_dir;
+  std::string m_root;
+  std::string m_cache_dir;
+};
+
+TEST_F(DirectoryBlobTest, ReusesCacheOfUnchangedDirectory)
+{
+  BuildTwice(true);
+  EXPECT_TRUE(File::Exists(m_cache_dir + GetCacheFileName()));
+}
+
+TEST_F(DirectoryBlobTest, IgnoresCacheWrittenWhileFileWasModified)
+{
+  // The file could have been modified again in the same second, without its time changing
+  EXPECT_TRUE(SetModificationTime(m_root + "files/dir/b.bin",
+                                  static_cast<s64>(std::time(nullptr)) + 1000));
+  BuildTwice(false);
+}
+
+TEST_F(DirectoryBlobTest, RebuildsAfterAddingFile)
+{
+  ExpectRebuiltAfter([this] { WriteFile(m_root + "files/dir/c.bin", 0x10, 4); });
+
+  const DirectoryBlobPartition partition(m_root, false);
+  const std::vector<u8> data = ReadAll(partition);
+  EXPECT_NE(std::string::npos, std::string(data.begin(), data.end()).find("c.bin"));
+}
+
+TEST_F(DirectoryBlobTest, RebuildsAfterRemovingFile)
+{
+  ExpectRebuiltAfter([this] { File::Delete(m_root + "files/dir/a.bin"); });
+}
+
+TEST_F(DirectoryBlobTest, RebuildsAfterEditingFile)
+{
+  // Same size, different modification time
+  ExpectRebuiltAfter([this] { WriteFile(m_root + "files/opening.bnr", 0x1960, 5); });
+}
+
+TEST_F(DirectoryBlobTest, RebuildsAfterResizingFile)
+{
+  // Different size, same modification time
+  ExpectRebuiltAfter([this] {
+    WriteFile(m_root + "files/opening.bnr", 0x1000, 1);
+    Backdate("files/opening.bnr");
+  });
+}
+
+TEST_F(DirectoryBlobTest, RebuildsAfterReplacingFileWithDirectory)
+{
+  // The parent directory and the entry keep their modification times, only the type changes
+  ExpectRebuiltAfter([this] {
+    File::Delete(m_root + "files/dir/b.bin");
+    File::CreateDir(m_root + "files/dir/b.bin");
+    Backdate("files/dir/b.bin");
+    Backdate("files/dir/");
+  });
+}
+
+TEST_F(DirectoryBlobTest, DeletesUnusedCaches)
+{
+  BuildTwice(true);
+  const std::string cache_path = m_cache_dir + GetCacheFileName();
+  File::WriteStringToFile(m_cache_dir + "0123456789abcdef.fst", "not an FST cache");
+  File::WriteStringToFile(m_cache_dir + "0123456789abcdef.fst.1.tmp", "interrupted write");
+  // A day old
+  EXPECT_TRUE(SetModificationTime(m_cache_dir + "0123456789abcdef.fst.1.tmp",
+                                  static_cast<s64>(std::time(nullptr)) - 24 * 60 * 60));
+  File::WriteStringToFile(m_cache_dir + "0123456789abcdef.fst.2.tmp", "write in progress");
+
+  DiscIO::DeleteUnusedFSTCaches();
+  EXPECT_TRUE(File::Exists(cache_path));
+  EXPECT_FALSE(File::Exists(m_cache_dir + "0123456789abcdef.fst"));
+  EXPECT_FALSE(File::Exists(m_cache_dir + "0123456789abcdef.fst.1.tmp"));
+  EXPECT_TRUE(File::Exists(m_cache_dir + "0123456789abcdef.fst.2.tmp"));
+
+  File::DeleteDirRecursively(m_root);
+  DiscIO::DeleteUnusedFSTCaches();
+  EXPECT_FALSE(File::Exists(cache_path));
+}
@@ -0,0 +1,165 @@
+// Copyright 2019 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "Common/CommonTypes.h"
+#include "DiscIO/Blob.h"
+
+namespace
+{
+constexpr u32 BLOCK_SIZE = 0x800;
+constexpr u32 CHUNK_BLOCKS = 128;
+constexpr u64 CHUNK_SIZE = u64(BLOCK_SIZE) * CHUNK_BLOCKS;
+// The last chunk is only half full
+constexpr u64 DATA_SIZE = 20 * CHUNK_SIZE + CHUNK_SIZE / 2;
+
+// Serves blocks from memory and remembers which runs of blocks were asked for
+class TestSectorReader final : public DiscIO::SectorReader
+{
+public:
+  explicit TestSectorReader(const std::vector<u8>& data) : m_data(data)
+  {
+    SetSectorSize(BLOCK_SIZE);
+    SetChunkSize(CHUNK_BLOCKS);
+  }
+
+  DiscIO::BlobType GetBlobType() const override { return DiscIO::BlobType::PLAIN; }
+  u64 GetRawSize() const override { return m_data.size(); }
+  u64 GetDataSize() const override { return m_data.size(); }
+  bool IsDataSizeAccurate() const override { return true; }
+
+  bool IsChunkCached(u64 chunk) const { return IsBlockCached(chunk * CHUNK_BLOCKS); }
+
+  // (first block, number of blocks) of every ReadMultipleAlignedBlocks call
+  std::vector<std::pair<u64, u64>> reads;
+
+private:
+  bool GetBlock(u64 block_num, u8* out) override
+  {
+    return ReadMultipleAlignedBlocks(block_num, 1, out);
+  }
+
+  bool ReadMultipleAlignedBlocks(u64 block_num, u64 num_blocks, u8* out_ptr) override
+  {
+    reads.emplace_back(block_num, num_blocks);
+    if ((block_num + num_blocks) * BLOCK_SIZE > m_data.size())
+      return false;
+    std::copy_n(m_data.begin() + block_num * BLOCK_SIZE, num_blocks * BLOCK_SIZE, out_ptr);
+    return true;
+  }
+
+  const std::vector<u8>& m_data;
+};
+}  // namespace
+
+class SectorReaderTest : public testing::Test
+{
+protected:
+  SectorReaderTest() : m_data(DATA_SIZE), m_reader(m_data)
+  {
+    for (size_t i = 0; i < m_data.size(); ++i)
+      m_data[i] = static_cast<u8>(i / 5 + i / BLOCK_SIZE);
+  }
+
+  void ExpectRead(u64 offset, u64 size)
+  {
+    std::vector<u8> buffer(size);
+    ASSERT_TRUE(m_reader.Read(offset, size, buffer.data()));
+    EXPECT_TRUE(std::equal(buffer.begin(), buffer.end(), m_data.begin() + offset));
+  }
+
+  std::vector<u8> m_data;
+  TestSectorReader m_reader;
+};
+
+TEST_F(SectorReaderTest, ReadsMatchPlainData)
+{
+  // Unaligned reads of all sizes, including ones crossing many chunks and the end of the disc
+  u32 state = 1;
+  for (int i = 0; i < 200; ++i)
+  {
+    state = state * 1103515245 + 12345;
+    const u64 offset = state % DATA_SIZE;
+    state = state * 1103515245 + 12345;
+    const u64 size = std::min<u64>(state % (3 * CHUNK_SIZE) + 1, DATA_SIZE - offset);
+    ExpectRead(offset, size);
+  }
+  ExpectRead(DATA_SIZE - 1, 1);
+  ExpectRead(0, DATA_SIZE);
+}
+
+TEST_F(SectorReaderTest, CoalescesUncachedChunks)
+{
+  ExpectRead(CHUNK_SIZE + 0x123, 4 * CHUNK_SIZE);
+  ASSERT_EQ(1u, m_reader.reads.size());
+  EXPECT_EQ(CHUNK_BLOCKS, m_reader.reads[0].first);
+  EXPECT_EQ(5 * CHUNK_BLOCKS, m_reader.reads[0].second);
+  EXPECT_EQ(5u, m_reader.GetCacheStats().misses);
+  EXPECT_EQ(1u, m_reader.GetCacheStats().reads);
+  // The chunks after the first one were already there when the read got to them
+  EXPECT_EQ(4u, m_reader.GetCacheStats().hits);
+
+  ExpectRead(CHUNK_SIZE, 5 * CHUNK_SIZE);
+  EXPECT_EQ(1u, m_reader.reads.size());
+  EXPECT_EQ(9u, m_reader.GetCacheStats().hits);
+}
+
+TEST_F(SectorReaderTest, CoalescingStopsAtCachedChunks)
+{
+  ExpectRead(2 * CHUNK_SIZE, 1);
+  m_reader.reads.clear();
+
+  ExpectRead(0, 5 * CHUNK_SIZE);
+  const std::vector<std::pair<u64, u64>> expected{{0, 2 * CHUNK_BLOCKS},
+                                                  {3 * CHUNK_BLOCKS, 2 * CHUNK_BLOCKS}};
+  EXPECT_EQ(expected, m_reader.reads);
+}
+
+TEST_F(SectorReaderTest, CoalescingClampsToEndOfDisc)
+{
+  ExpectRead(18 * CHUNK_SIZE, DATA_SIZE - 18 * CHUNK_SIZE);
+  ASSERT_EQ(1u, m_reader.reads.size());
+  EXPECT_EQ(18 * CHUNK_BLOCKS, m_reader.reads[0].first);
+  EXPECT_EQ(2 * CHUNK_BLOCKS + CHUNK_BLOCKS / 2, m_reader.reads[0].second);
+
+  std::vector<u8> buffer(BLOCK_SIZE);
+  EXPECT_FALSE(m_reader.Read(DATA_SIZE, BLOCK_SIZE, buffer.data()));
+}
+
+TEST_F(SectorReaderTest, EvictsLeastRecentlyUsedChunk)
+{
+  // 1 MiB fits four chunks
+  m_reader.SetCacheSize(1);
+
+  for (u64 chunk = 0; chunk < 4; ++chunk)
+    ExpectRead(chunk * CHUNK_SIZE, 1);
+  ExpectRead(0, 1);
+  ExpectRead(4 * CHUNK_SIZE, 1);
+
+  EXPECT_TRUE(m_reader.IsChunkCached(0));
+  EXPECT_FALSE(m_reader.IsChunkCached(1));
+  EXPECT_TRUE(m_reader.IsChunkCached(2));
+  EXPECT_TRUE(m_reader.IsChunkCached(3));
+  EXPECT_TRUE(m_reader.IsChunkCached(4));
+}
+
+TEST_F(SectorReaderTest, CoalescingIsLimitedByCacheSize)
+{
+  m_reader.SetCacheSize(1);
+
+  ExpectRead(0, 8 * CHUNK_SIZE);
+  EXPECT_EQ(2u, m_reader.reads.size());
+  for (const auto& read : m_reader.reads)
+    EXPECT_EQ(4 * CHUNK_BLOCKS, read.second);
+
+  // Only the chunks read last are still cached
+  EXPECT_FALSE(m_reader.IsChunkCached(3));
+  EXPECT_TRUE(m_reader.IsChunkCached(4));
+  EXPECT_TRUE(m_reader.IsChunkCached(7));
+}
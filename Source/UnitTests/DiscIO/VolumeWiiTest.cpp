@@ -0,0 +1,316 @@
+// Copyright 2019 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "Common/CommonTypes.h"
+#include "Common/Crypto/AES.h"
+#include "Common/Swap.h"
+#include "Core/IOS/ES/Formats.h"
+#include "Core/IOS/IOSC.h"
+#include "DiscIO/Blob.h"
+#include "DiscIO/Volume.h"
+#include "DiscIO/VolumeWii.h"
+
+namespace
+{
+constexpr u64 PARTITION_OFFSET = 0x50000;
+constexpr u64 DATA_OFFSET = 0x20000;
+constexpr u32 CLUSTERS = 64;
+constexpr u64 CLUSTER_SIZE = DiscIO::VolumeWii::BLOCK_TOTAL_SIZE;
+constexpr u64 CLUSTER_DATA_SIZE = DiscIO::VolumeWii::BLOCK_DATA_SIZE;
+// The smallest cache ConfigureDecryptionCache can be set to
+constexpr u32 CACHE_CLUSTERS = 1024 * 1024 / CLUSTER_DATA_SIZE;
+
+// A disc in memory, which counts how often each cluster of the partition is read. Reads of one
+// cluster can be held back until the test allows them.
+class TestBlobReader final : public DiscIO::BlobReader
+{
+public:
+  explicit TestBlobReader(std::vector<u8> data) : m_data(std::move(data)) {}
+
+  DiscIO::BlobType GetBlobType() const override { return DiscIO::BlobType::PLAIN; }
+  u64 GetRawSize() const override { return m_data.size(); }
+  u64 GetDataSize() const override { return m_data.size(); }
+  bool IsDataSizeAccurate() const override { return true; }
+
+  bool Read(u64 offset, u64 size, u8* out_ptr) override
+  {
+    if (offset + size > m_data.size())
+      return false;
+
+    std::unique_lock lk(m_lock);
+    if (offset >= PARTITION_OFFSET + DATA_OFFSET)
+    {
+      const u64 cluster = (offset - PARTITION_OFFSET - DATA_OFFSET) / CLUSTER_SIZE;
+      ++m_cluster_reads[cluster];
+      if (cluster == m_held_cluster)
+      {
+        m_held_read_started = true;
+        m_cv.notify_all();
+        m_cv.wait(lk, [&] { return m_held_cluster != cluster; });
+      }
+    }
+    std::memcpy(out_ptr, &m_data[offset], static_cast<size_t>(size));
+    return true;
+  }
+
+  u32 GetClusterReads(u64 cluster)
+  {
+    std::lock_guard lk(m_lock);
+    return m_cluster_reads[cluster];
+  }
+
+  void HoldCluster(u64 cluster)
+  {
+    std::lock_guard lk(m_lock);
+    m_held_cluster = cluster;
+    m_held_read_started = false;
+  }
+
+  void WaitForHeldRead()
+  {
+    std::unique_lock lk(m_lock);
+    m_cv.wait(lk, [&] { return m_held_read_started; });
+  }
+
+  void Release()
+  {
+    {
+      std::lock_guard lk(m_lock);
+      m_held_cluster = UINT64_MAX;
+    }
+    m_cv.notify_all();
+  }
+
+private:
+  std::vector<u8> m_data;
+  std::mutex m_lock;
+  std::condition_variable m_cv;
+  std::map<u64, u32> m_cluster_reads;
+  u64 m_held_cluster = UINT64_MAX;
+  bool m_held_read_started = false;
+};
+
+u8 GetDataByte(u64 offset)
+{
+  return static_cast<u8>(offset / 7 + offset / CLUSTER_DATA_SIZE);
+}
+
+template <typename T>
+void WriteSwapped(std::vector<u8>* data, u64 offset, T value)
+{
+  value = Common::FromBigEndian(value);
+  std::memcpy(&(*data)[offset], &value, sizeof(T));
+}
+
+// Builds an encrypted disc with a single partition, whose data is GetDataByte(offset).
+std::vector<u8> CreateDisc()
+{
+  std::vector<u8> disc(PARTITION_OFFSET + DATA_OFFSET + CLUSTERS * CLUSTER_SIZE);
+
+  WriteSwapped<u32>(&disc, 0x40000, 1);
+  WriteSwapped<u32>(&disc, 0x40004, 0x40020 >> 2);
+  WriteSwapped<u32>(&disc, 0x40020, PARTITION_OFFSET >> 2);
+  WriteSwapped<u32>(&disc, 0x40024, 0);
+
+  std::vector<u8> ticket(sizeof(IOS::ES::Ticket));
+  WriteSwapped<u32>(&ticket, 0, static_cast<u32>(IOS::SignatureType::RSA2048));
+  WriteSwapped<u64>(&ticket, offsetof(IOS::ES::Ticket, title_id), 0x0001000052414241);
+  for (size_t i = 0; i < 16; ++i)
+    ticket[offsetof(IOS::ES::Ticket, title_key) + i] = static_cast<u8>(i * 17);
+  const std::array<u8, 16> key = IOS::ES::TicketReader(ticket).GetTitleKey();
+  std::copy(ticket.begin(), ticket.end(), disc.begin() + PARTITION_OFFSET);
+  WriteSwapped<u32>(&disc, PARTITION_OFFSET + 0x2b8, DATA_OFFSET >> 2);
+
+  const auto context = Common::AES::CreateContext(key.data(), Common::AES::Mode::Encrypt);
+  for (u64 i = 0; i < CLUSTERS; ++i)
+  {
+    u8* cluster = &disc[PARTITION_OFFSET + DATA_OFFSET + i * CLUSTER_SIZE];
+    for (size_t j = 0; j < 16; ++j)
+      cluster[0x3d0 + j] = static_cast<u8>(i + j);
+    u8* data = cluster + DiscIO::VolumeWii::BLOCK_HEADER_SIZE;
+    for (u64 j = 0; j < CLUSTER_DATA_SIZE; ++j)
+      data[j] = GetDataByte(i * CLUSTER_DATA_SIZE + j);
+    context->CryptIV(&cluster[0x3d0], data, data, CLUSTER_DATA_SIZE);
+  }
+
+  return disc;
+}
+}  // namespace
+
+class VolumeWiiTest : public testing::Test
+{
+protected:
+  VolumeWiiTest()
+  {
+    auto reader = std::make_unique<TestBlobReader>(CreateDisc());
+    m_reader = reader.get();
+    m_volume = std::make_unique<DiscIO::VolumeWii>(std::move(reader));
+    m_partition = m_volume->GetGamePartition();
+  }
+
+  // Reads a part of a cluster and checks the decrypted data
+  void ReadCluster(u64 cluster)
+  {
+    const u64 offset = cluster * CLUSTER_DATA_SIZE + 0x100;
+    std::vector<u8> buffer(0x200);
+    ASSERT_TRUE(m_volume->Read(offset, buffer.size(), buffer.data(), m_partition));
+    for (size_t i = 0; i < buffer.size(); ++i)
+      ASSERT_EQ(GetDataByte(offset + i), buffer[i]) << "cluster " << cluster;
+  }
+
+  void WaitForReadAhead(u64 clusters)
+  {
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (m_volume->GetClusterCacheStats().read_ahead < clusters &&
+           std::chrono::steady_clock::now() < deadline)
+    {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    ASSERT_EQ(clusters, m_volume->GetClusterCacheStats().read_ahead);
+  }
+
+  TestBlobReader* m_reader;
+  std::unique_ptr<DiscIO::VolumeWii> m_volume;
+  DiscIO::Partition m_partition;
+};
+
+TEST_F(VolumeWiiTest, ReadsDecryptedData)
+{
+  ASSERT_NE(DiscIO::PARTITION_NONE, m_partition);
+
+  std::vector<u8> buffer(CLUSTERS * CLUSTER_DATA_SIZE - 0x10);
+  ASSERT_TRUE(m_volume->Read(0x10, buffer.size(), buffer.data(), m_partition));
+  for (size_t i = 0; i < buffer.size(); ++i)
+    ASSERT_EQ(GetDataByte(0x10 + i), buffer[i]) << i;
+}
+
+TEST_F(VolumeWiiTest, RepeatedReadsHitCache)
+{
+  m_volume->ConfigureDecryptionCache(1, 0);
+
+  ReadCluster(5);
+  ReadCluster(5);
+  ReadCluster(5);
+
+  EXPECT_EQ(1u, m_reader->GetClusterReads(5));
+  const DiscIO::VolumeWii::ClusterCacheStats stats = m_volume->GetClusterCacheStats();
+  EXPECT_EQ(2u, stats.hits);
+  EXPECT_EQ(1u, stats.misses);
+}
+
+TEST_F(VolumeWiiTest, EvictsLeastRecentlyUsedCluster)
+{
+  m_volume->ConfigureDecryptionCache(1, 0);
+
+  // Fill the cache, and make cluster 0 the most recently used one
+  for (u64 i = 0; i < CACHE_CLUSTERS; ++i)
+    ReadCluster(i);
+  ReadCluster(0);
+
+  // Evicts cluster 1
+  ReadCluster(CACHE_CLUSTERS);
+
+  ReadCluster(0);
+  EXPECT_EQ(1u, m_reader->GetClusterReads(0));
+  ReadCluster(2);
+  EXPECT_EQ(1u, m_reader->GetClusterReads(2));
+  ReadCluster(1);
+  EXPECT_EQ(2u, m_reader->GetClusterReads(1));
+}
+
+TEST_F(VolumeWiiTest, ShrinkingCacheEvictsOldestClusters)
+{
+  m_volume->ConfigureDecryptionCache(2, 0);
+  for (u64 i = 0; i < CACHE_CLUSTERS + 2; ++i)
+    ReadCluster(i);
+
+  m_volume->ConfigureDecryptionCache(1, 0);
+
+  ReadCluster(CACHE_CLUSTERS + 1);
+  ReadCluster(2);
+  ReadCluster(1);
+  EXPECT_EQ(1u, m_reader->GetClusterReads(CACHE_CLUSTERS + 1));
+  EXPECT_EQ(1u, m_reader->GetClusterReads(2));
+  EXPECT_EQ(2u, m_reader->GetClusterReads(1));
+}
+
+TEST_F(VolumeWiiTest, SequentialReadsAreReadAhead)
+{
+  m_volume->ConfigureDecryptionCache(1, 4);
+
+  // Reading ahead starts once reads look sequential
+  ReadCluster(10);
+  ReadCluster(11);
+  EXPECT_EQ(0u, m_volume->GetClusterCacheStats().read_ahead);
+  ReadCluster(12);
+  WaitForReadAhead(4);
+
+  for (u64 i = 13; i <= 16; ++i)
+  {
+    ReadCluster(i);
+    EXPECT_EQ(1u, m_reader->GetClusterReads(i));
+  }
+
+  // Every read kept the read-ahead going, so nothing was read twice
+  EXPECT_EQ(4u, m_volume->GetClusterCacheStats().read_ahead_hits);
+}
+
+TEST_F(VolumeWiiTest, RandomReadsAreNotReadAhead)
+{
+  m_volume->ConfigureDecryptionCache(1, 4);
+
+  for (u64 cluster : {20, 3, 40, 7, 21, 8})
+    ReadCluster(cluster);
+
+  EXPECT_EQ(0u, m_volume->GetClusterCacheStats().read_ahead);
+  EXPECT_EQ(0u, m_reader->GetClusterReads(41));
+}
+
+TEST_F(VolumeWiiTest, ReadAheadStopsAtEndOfDisc)
+{
+  m_volume->ConfigureDecryptionCache(1, 4);
+
+  for (u64 i = CLUSTERS - 4; i < CLUSTERS; ++i)
+    ReadCluster(i);
+
+  // Only the last cluster was left to read ahead
+  WaitForReadAhead(1);
+  for (u64 i = CLUSTERS - 4; i < CLUSTERS; ++i)
+    EXPECT_EQ(1u, m_reader->GetClusterReads(i));
+}
+
+TEST_F(VolumeWiiTest, ReadWaitsForPendingReadAhead)
+{
+  m_volume->ConfigureDecryptionCache(1, 1);
+
+  m_reader->HoldCluster(23);
+  ReadCluster(20);
+  ReadCluster(21);
+  ReadCluster(22);
+  m_reader->WaitForHeldRead();
+
+  // Cluster 23 is being read ahead, so this read has to wait for it instead of reading it again
+  std::thread reader_thread([this] { ReadCluster(23); });
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  m_reader->Release();
+  reader_thread.join();
+
+  EXPECT_EQ(1u, m_reader->GetClusterReads(23));
+  EXPECT_EQ(1u, m_volume->GetClusterCacheStats().read_ahead_hits);
+}
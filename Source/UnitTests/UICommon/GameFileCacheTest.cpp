@@ -0,0 +1,147 @@
+// Copyright 2019 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "Common/CommonTypes.h"
+#include "Common/FileUtil.h"
+#include "UICommon/GameFile.h"
+#include "UICommon/GameFileCache.h"
+
+using UICommon::GameFile;
+using UICommon::GameFileCache;
+
+class GameFileCacheTest : public testing::Test
+{
+protected:
+  GameFileCacheTest() : m_temp_dir{File::CreateTempDir()}, m_cache_path{m_temp_dir + "/cache"} {}
+
+  virtual ~GameFileCacheTest() { File::DeleteDirRecursively(m_temp_dir); }
+
+  // DOL files are listed no matter what they contain, so there is no need for real games
+  std::vector<std::string> CreateGames(size_t count)
+  {
+    std::vector<std::string> paths;
+    for (size_t i = 0; i < count; ++i)
+    {
+      paths.push_back(m_temp_dir + "/game" + std::to_string(i) + ".dol");
+      EXPECT_TRUE(File::WriteStringToFile(paths.back(), "game"));
+    }
+    return paths;
+  }
+
+  std::string m_temp_dir;
+  std::string m_cache_path;
+};
+
+TEST_F(GameFileCacheTest, ScansAddedAndRemovedFiles)
+{
+  std::vector<std::string> paths = CreateGames(50);
+
+  GameFileCache cache(m_cache_path);
+  size_t added = 0;
+  EXPECT_TRUE(cache.Update(paths, [&](const std::shared_ptr<const GameFile>&) { ++added; }));
+  EXPECT_EQ(50u, added);
+  EXPECT_EQ(50u, cache.GetSize());
+
+  EXPECT_FALSE(cache.Update(paths));
+
+  const std::string removed_path = paths.back();
+  paths.pop_back();
+  std::vector<std::string> removed;
+  EXPECT_TRUE(cache.Update(paths, {}, [&](const std::string& path) { removed.push_back(path); }));
+  ASSERT_EQ(1u, removed.size());
+  EXPECT_EQ(removed_path, removed[0]);
+  EXPECT_EQ(49u, cache.GetSize());
+}
+
+TEST_F(GameFileCacheTest, RescansModifiedFiles)
+{
+  const std::vector<std::string> paths = CreateGames(3);
+
+  GameFileCache cache(m_cache_path);
+  cache.Update(paths);
+  ASSERT_TRUE(File::WriteStringToFile(paths[1], "modified game"));
+
+  std::vector<std::string> removed;
+  std::vector<std::shared_ptr<const GameFile>> added;
+  EXPECT_TRUE(cache.Update(
+      paths, [&](const std::shared_ptr<const GameFile>& game) { added.push_back(game); },
+      [&](const std::string& path) { removed.push_back(path); }));
+  ASSERT_EQ(1u, removed.size());
+  EXPECT_EQ(paths[1], removed[0]);
+  ASSERT_EQ(1u, added.size());
+  EXPECT_EQ(paths[1], added[0]->GetFilePath());
+  EXPECT_EQ(13u, added[0]->GetFileSize());
+  EXPECT_EQ(3u, cache.GetSize());
+}
+
+TEST_F(GameFileCacheTest, SavesIncrementally)
+{
+  std::vector<std::string> paths = CreateGames(10);
+
+  {
+    GameFileCache cache(m_cache_path);
+    cache.Update(paths);
+    ASSERT_TRUE(cache.Save());
+  }
+
+  const u64 full_size = File::GetSize(m_cache_path);
+
+  {
+    GameFileCache cache(m_cache_path);
+    ASSERT_TRUE(cache.Load());
+    EXPECT_EQ(10u, cache.GetSize());
+
+    // Removing a game only appends a small record
+    paths.erase(paths.begin());
+    EXPECT_TRUE(cache.Update(paths));
+    ASSERT_TRUE(cache.Save());
+    EXPECT_GT(File::GetSize(m_cache_path), full_size);
+    EXPECT_LT(File::GetSize(m_cache_path), full_size + full_size / 10);
+
+    paths.push_back(CreateGames(11).back());
+    EXPECT_TRUE(cache.Update(paths));
+    ASSERT_TRUE(cache.Save());
+  }
+
+  GameFileCache cache(m_cache_path);
+  ASSERT_TRUE(cache.Load());
+  std::vector<std::string> loaded_paths;
+  cache.ForEach([&](const std::shared_ptr<const GameFile>& game) {
+    loaded_paths.push_back(game->GetFilePath());
+  });
+  std::sort(loaded_paths.begin(), loaded_paths.end());
+  std::sort(paths.begin(), paths.end());
+  EXPECT_EQ(paths, loaded_paths);
+  EXPECT_FALSE(cache.Update(paths));
+}
+
+TEST_F(GameFileCacheTest, IgnoresCutOffRecords)
+{
+  const std::vector<std::string> paths = CreateGames(2);
+  {
+    GameFileCache cache(m_cache_path);
+    cache.Update(paths);
+    ASSERT_TRUE(cache.Save());
+  }
+
+  // Simulate an append that was interrupted
+  std::string contents;
+  ASSERT_TRUE(File::ReadFileToString(m_cache_path, contents));
+  ASSERT_TRUE(File::WriteStringToFile(m_cache_path, contents + contents.substr(8, 20)));
+
+  GameFileCache cache(m_cache_path);
+  ASSERT_TRUE(cache.Load());
+  EXPECT_EQ(2u, cache.GetSize());
+
+  ASSERT_TRUE(File::WriteStringToFile(m_cache_path, "not a cache"));
+  EXPECT_FALSE(cache.Load());
+  EXPECT_FALSE(File::Exists(m_cache_path));
+}